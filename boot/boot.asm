@@ -10,10 +10,54 @@ header_start:
     dd 0                          ; Architecture (0 for i386/protected mode)
     dd header_end - header_start  ; Total header length
     dd -(0xe85250d6 + 0 + (header_end - header_start)) ; Checksum
+
+    ; Information request tag: ask GRUB for the command line (type 1), the
+    ; memory map (type 6) and the framebuffer (type 8) in the boot
+    ; information structure it passes to us in EBX.
+    ; Tags are u16 type, u16 flags, u32 size, and each starts on an 8-byte boundary.
+    align 8
+info_request_tag_start:
+    dw 1                          ; Type 1: information request
+    dw 0                          ; Flags: the requested information is required
+    dd info_request_tag_end - info_request_tag_start ; Size of this tag
+    dd 1                          ; Command line
+    dd 6                          ; Memory map
+    dd 8                          ; Framebuffer
+info_request_tag_end:
+
+    ; Framebuffer tag: ask for a 1024x768 linear framebuffer with 32 bits per
+    ; pixel, which kernel/kfb.c draws the console on. It is optional: if GRUB
+    ; cannot set a graphics mode, the kernel stays in VGA text mode.
+    align 8
+framebuffer_tag_start:
+    dw 5                          ; Type 5: framebuffer
+    dw 1                          ; Flags: optional
+    dd framebuffer_tag_end - framebuffer_tag_start ; Size of this tag
+    dd 1024                       ; Width in pixels
+    dd 768                        ; Height in pixels
+    dd 32                         ; Bits per pixel
+framebuffer_tag_end:
+
     ; End tag (required by Multiboot2 spec)
-    dw 0, 0, 8
+    align 8
+    dw 0, 0                       ; Type 0, flags 0
+    dd 8                          ; Size 8
 header_end:
 
+; Page directories for the 2MB-page direct map above 1GB on CPUs without 1GB
+; pages: 31 of them extend it to 32GB.
+BOOT_2M_TABLES equ 31
+
+; --- Boot-Phase Timestamps ---
+; BOOT_STAMP n stores the TSC in boot_tsc[n] (KBOOT_* in kernel/kboot.h), so
+; kernel/kboot.c can report how long each step of the boot took. RDTSC works
+; in every mode and needs nothing set up; it clobbers EAX and EDX.
+%macro BOOT_STAMP 1
+    rdtsc
+    mov [boot_tsc + %1 * 8], eax
+    mov [boot_tsc + %1 * 8 + 4], edx
+%endmacro
+
 ; --- 32-bit Entry Point ---
 [bits 32]
 global _start
@@ -21,43 +65,74 @@ _start:
     ; Set up the stack pointer (ESP for 32-bit, RSP will be set later in 64-bit)
     mov esp, stack_top
 
-    ; 1. Set up Page Tables for Long Mode
-    ;    We will identity map the first 1GB of memory (0x0 to 0x40000000).
-    ;    This is done using 2MB pages for simplicity.
-    ;    PML4 (Page Map Level 4) table: 512 entries, each pointing to a PDPT.
-    ;    PDPT (Page Directory Pointer Table): 512 entries, each pointing to a PD.
-    ;    PD (Page Directory): 512 entries, each pointing to a 2MB page.
-
-    ; PML4 entry points to PDPT_table
-    mov edi, pml4_table
-    mov esi, pdpt_table
-    mov eax, esi
-    or eax, 0x3 ; Present (P=1), Read/Write (RW=1)
+    ; GRUB passes the Multiboot2 magic value in EAX and the physical address of
+    ; the boot information structure in EBX. Save both before anything (such as
+    ; CPUID) clobbers them; they become the arguments of kernel_main.
+    mov [multiboot_magic], eax
+    mov [multiboot_info], ebx
+    BOOT_STAMP 0         ; KBOOT_START
+
+    ; 1. Choose the Page Tables for Long Mode
+    ;    The tables themselves are emitted at assembly time (see .data below),
+    ;    so there is nothing to fill in here:
+    ;    PML4 entry 0 -> pdpt_table, which maps the first 512GB of physical
+    ;    memory virtual == physical (the "direct map"):
+    ;      PDPT entry 0 -> pd_table: the first 1GB in 2MB pages, except
+    ;        PD entry 0 -> pt_low_table: the first 2MB in 4KB pages, so the
+    ;        legacy VGA window and the option ROM/BIOS area can get their own
+    ;        caching attributes (see the PAT setup in step 1b below).
+    ;      PDPT entries 1..511: one 1GB page each, for all RAM above 1GB at
+    ;        one TLB entry per gigabyte.
+    ;    1GB pages need CPUID.80000001h:EDX.PDPE1GB (bit 26). Without it,
+    ;    PDPT entries 1..BOOT_2M_TABLES point to the page directories in
+    ;    boot_pd_tables instead, which map the next BOOT_2M_TABLES gigabytes in
+    ;    2MB pages, and the remaining entries are cleared. RAM beyond that is
+    ;    mapped on demand by kernel/kvmm.c, as MMIO is. Either way kvmm_init()
+    ;    later trims the entries to the RAM the memory map reports.
+    mov eax, 0x80000001
+    cpuid                ; Clobbers EBX, which is saved already
+    bt edx, 26           ; PDPE1GB supported?
+    jc .have_1gb_pages
+    cld                  ; The Multiboot2 spec leaves the direction flag undefined
+    mov edi, boot_pd_tables
+    mov eax, 0x40000000 | 0x83 ; First 2MB page at 1GB, P|RW|PS
+    xor edx, edx         ; High dword of the address, for RAM above 4GB
+    mov ecx, BOOT_2M_TABLES * 512
+.fill_pd:
     mov [edi], eax
-    
-    ; PDPT entry points to PD_table
-    mov edi, pdpt_table
-    mov esi, pd_table
-    mov eax, esi
-    or eax, 0x3 ; Present (P=1), Read/Write (RW=1)
+    mov [edi + 4], edx
+    add edi, 8
+    add eax, 0x200000
+    adc edx, 0
+    loop .fill_pd
+    mov edi, pdpt_table + 8
+    mov eax, boot_pd_tables + 0x03
+    mov ecx, BOOT_2M_TABLES
+.fill_pdpt:
     mov [edi], eax
-    
-    ; Fill PD_table with 2MB page entries for the first 1GB
-    mov edi, pd_table
-    mov ecx, 512 ; 512 entries in the page directory (512 * 2MB = 1GB)
-    ; Page flags for 2MB pages:
-    ;   0x1   (P=1, Present)
-    ;   0x2   (RW=1, Read/Write)
-    ;   0x80  (PS=1, Page Size - 2MB page)
-    ;   0x8   (PWT=1, Page Write-Through - important for memory-mapped I/O like VGA)
-    ;   0x10  (PCD=1, Page-Level Cache Disable - also important for memory-mapped I/O)
-    ; Combined: 0x1 | 0x2 | 0x80 | 0x8 | 0x10 = 0x9B
-    mov esi, 0x0 | 0x9B ; Initial physical address 0x0, combined flags
-.map_2mb_pages:
-    mov dword [edi], esi ; Write the page directory entry
-    add edi, 8           ; Move to the next entry (each entry is 8 bytes)
-    add esi, 0x200000    ; Increment physical address by 2MB for the next page
-    loop .map_2mb_pages  ; Loop 512 times
+    mov dword [edi + 4], 0
+    add edi, 8
+    add eax, 4096
+    loop .fill_pdpt
+    mov ecx, (511 - BOOT_2M_TABLES) * 2 ; The other PDPT entries, as dwords
+    xor eax, eax
+    rep stosd
+    mov dword [boot_direct_map_end], ((BOOT_2M_TABLES + 1) << 30) & 0xFFFFFFFF
+    mov dword [boot_direct_map_end + 4], (BOOT_2M_TABLES + 1) >> 2
+.have_1gb_pages:
+
+    ; 1b. Program the PAT (Page Attribute Table) MSR.
+    ;     The PAT index of a page is PAT*4 + PCD*2 + PWT. We keep the power-on
+    ;     defaults for entries 0-3 (WB, WT, UC-, UC) so PCD/PWT behave as usual,
+    ;     and turn entry 4 (selected by the PAT bit alone) into write-combining.
+    ;     Memory types: 0x00 UC, 0x01 WC, 0x04 WT, 0x06 WB, 0x07 UC-.
+    ;     Every x86-64 CPU supports PAT, so no CPUID check is needed.
+    ;     This is done before paging is enabled, so no cache/TLB flush is required.
+    mov ecx, 0x277       ; IA32_PAT MSR address
+    mov eax, 0x00070406  ; PA3=UC,  PA2=UC-, PA1=WT, PA0=WB
+    mov edx, 0x00070401  ; PA7=UC,  PA6=UC-, PA5=WT, PA4=WC
+    wrmsr
+    BOOT_STAMP 1         ; KBOOT_PAGE_TABLES: direct map chosen, PAT programmed
 
     ; 2. Load PML4 into CR3
     ;    CR3 holds the physical address of the PML4 table.
@@ -148,14 +223,56 @@ gdt_descriptor:
 [bits 64]
 long_mode_start:
     ; We are now in 64-bit long mode.
+    BOOT_STAMP 2         ; KBOOT_LONG_MODE: paging on, 64-bit code running
 
     ; IMPORTANT: Align the stack to 16 bytes before calling C functions.
     ; The x86-64 System V ABI requires RSP to be 16-byte aligned before a CALL.
     ; 'and rsp, 0xFFFFFFFFFFFFFFF0' clears the lower 4 bits, aligning it to a 16-byte boundary.
     and rsp, 0xFFFFFFFFFFFFFFF0
 
+    ; 7. Enable SSE (and AVX when the CPU has it)
+    ;    Vector instructions raise #UD/#NM until the OS declares it saves their state.
+    ;    CR0: clear EM (bit 2, x87 emulation), set MP (bit 1, monitor coprocessor).
+    ;    CR4: set OSFXSR (bit 9, FXSAVE/SSE enabled) and OSXMMEXCPT (bit 10, SIMD exceptions).
+    mov rax, cr0
+    and eax, ~(1 << 2)   ; Clear EM
+    or eax, (1 << 1)     ; Set MP
+    mov cr0, rax
+    mov rax, cr4
+    or eax, (1 << 9) | (1 << 10) ; Set OSFXSR and OSXMMEXCPT
+    mov cr4, rax
+
+    ;    AVX state is managed through XSAVE: if CPUID.1:ECX reports XSAVE (bit 26),
+    ;    set CR4.OSXSAVE (bit 18) and enable the x87 and SSE state components in XCR0;
+    ;    add the AVX component (bit 2) when CPUID.1:ECX reports AVX (bit 28).
+    ;    kutils.c decides at runtime whether AVX2 code may actually be used.
+    mov eax, 1
+    cpuid
+    bt ecx, 26           ; XSAVE supported?
+    jnc .no_xsave
+    mov r8d, ecx         ; Keep the feature bits; XGETBV/XSETBV use ECX
+    mov rax, cr4
+    or eax, (1 << 18)    ; Set OSXSAVE
+    mov cr4, rax
+    xor ecx, ecx         ; XCR0
+    xgetbv               ; EDX:EAX = XCR0
+    or eax, (1 << 0) | (1 << 1) ; x87 and SSE state
+    bt r8d, 28           ; AVX supported?
+    jnc .set_xcr0
+    or eax, (1 << 2)     ; AVX (upper YMM) state
+.set_xcr0:
+    xor ecx, ecx
+    xsetbv
+.no_xsave:
+
     ; The kernel_main function will be called from here.
+    ; kernel_main(uint32_t multiboot_magic, uint64_t multiboot_info):
+    ; the System V ABI passes the first two arguments in RDI and RSI.
+    ; 32-bit moves zero-extend into the full 64-bit registers.
     extern kernel_main
+    BOOT_STAMP 3         ; KBOOT_KERNEL_MAIN: SSE/AVX enabled, entering C
+    mov edi, [multiboot_magic]
+    mov esi, [multiboot_info]
     call kernel_main
 
     ; Halt the CPU indefinitely after kernel_main returns.
@@ -189,13 +306,77 @@ outb:
     out dx, al         ; Write byte from AL to port (DX)
     ret                ; Return
 
-; --- Data and BSS Sections ---
-; These sections are for uninitialized data (BSS) and should be page-aligned.
-section .bss
+; --- Boot Page Tables ---
+; Emitted at assembly time, so _start does not spend any time building them.
+; They live in .data (and therefore in the kernel image); pd_table and
+; pt_low_table are global so the kernel can inspect and tweak caching
+; attributes at runtime (see kernel/kbench.c).
+;
+; Page flags:
+;   0x03 (P|RW)                for table pointers and 4KB write-back pages
+;   0x83 (P|RW|PS)             for 2MB and 1GB pages. PCD/PWT/PAT are all clear,
+;                              which selects PAT entry 0 (write-back). Ordinary
+;                              RAM (kernel image, stack, .bss) must be cached;
+;                              only MMIO needs the uncached/write-combining
+;                              attributes.
+; In pt_low_table (4KB pages, where bit 7 is the PAT bit instead of PS):
+;   0x03 (P|RW)                -> PAT entry 0: write-back (ordinary RAM)
+;   0x83 (P|RW|PAT, bit 7)     -> PAT entry 4: write-combining (VGA window 0xA0000-0xBFFFF)
+;   0x1B (P|RW|PWT|PCD)        -> PAT entry 3: uncached (ROM/device area 0xC0000-0xFFFFF)
+section .data
 align 4096
-pml4_table: resb 4096      ; Page Map Level 4 table (4KB)
-pdpt_table: resb 4096      ; Page Directory Pointer Table (4KB)
-pd_table:   resb 4096      ; Page Directory table (4KB)
+global pd_table
+global pt_low_table
+global boot_direct_map_end
+pml4_table:                ; Page Map Level 4 table (4KB)
+    dq pdpt_table + 0x03   ; Entry 0: the first 512GB
+    times 511 dq 0         ; Entries 1..511: dynamic area (kernel/kvmm.c)
+
+pdpt_table:                ; Page Directory Pointer Table (4KB)
+    dq pd_table + 0x03     ; Entry 0: the first 1GB, in 2MB pages
+%assign gb 1
+%rep 511
+    dq (gb << 30) | 0x83   ; Entries 1..511: 1GB pages (replaced without PDPE1GB)
+%assign gb gb + 1
+%endrep
+
+pd_table:                  ; Page Directory table (4KB)
+    dq pt_low_table + 0x03 ; Entry 0: the first 2MB, in 4KB pages
+%assign mb2 1
+%rep 511
+    dq (mb2 << 21) | 0x83  ; Entries 1..511: 2MB pages
+%assign mb2 mb2 + 1
+%endrep
+
+pt_low_table:              ; Page Table for the first 2MB (4KB pages)
+%assign page 0
+%rep 512
+  %if page < 0xA0
+    dq (page << 12) | 0x03 ; 0x00000-0x9FFFF: write-back
+  %elif page < 0xC0
+    dq (page << 12) | 0x83 ; 0xA0000-0xBFFFF: write-combining
+  %elif page < 0x100
+    dq (page << 12) | 0x1B ; 0xC0000-0xFFFFF: uncached
+  %else
+    dq (page << 12) | 0x03 ; 1MB-2MB: write-back
+  %endif
+%assign page page + 1
+%endrep
+
+; One past the end of the direct map: 512GB with 1GB pages, BOOT_2M_TABLES + 1
+; gigabytes without (set in _start). kernel/kpmm.c sizes its allocators with it.
+boot_direct_map_end: dq 512 << 30
+
+; --- BSS Section ---
+; Uninitialized data, zeroed by GRUB.
+section .bss
+global boot_tsc
+multiboot_magic: resd 1    ; EAX from the bootloader (0x36d76289 for Multiboot2)
+multiboot_info:  resd 1    ; EBX from the bootloader (boot information address)
+alignb 8
+boot_tsc: resq 16          ; TSC at each boot phase (KBOOT_PHASES in kernel/kboot.h)
+alignb 4096
+boot_pd_tables: resb 4096 * BOOT_2M_TABLES ; Filled in _start only without PDPE1GB
 ; Increased stack size to 32KB (8 pages) for robust operation.
 stack_bottom: resb 4096 * 16 
 stack_top:
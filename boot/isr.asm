@@ -0,0 +1,89 @@
+; isr.asm - Interrupt Service Routine entry stubs
+;
+; Every one of the 256 IDT vectors gets a tiny stub that makes the stack look
+; the same for all interrupts (a dummy error code is pushed when the CPU does
+; not push one), pushes its vector number and jumps to isr_common.
+; isr_common saves the general purpose registers, calls the C dispatcher
+; isr_dispatch(struct interrupt_frame*) from kernel/kidt.c and returns with IRETQ.
+;
+; Only general purpose registers are saved here. The kernel is compiled with
+; -mno-sse/-mno-mmx (see the Makefile), so C interrupt handlers never touch
+; the vector registers of the code they interrupted.
+
+[bits 64]
+section .text
+
+extern isr_dispatch
+
+; Common path for all vectors.
+; Stack on entry (top first): vector, error code, RIP, CS, RFLAGS, RSP, SS.
+isr_common:
+    ; Save all general purpose registers. The order matches
+    ; struct interrupt_frame in kidt.h (r15 ends up at the lowest address).
+    push rax
+    push rbx
+    push rcx
+    push rdx
+    push rsi
+    push rdi
+    push rbp
+    push r8
+    push r9
+    push r10
+    push r11
+    push r12
+    push r13
+    push r14
+    push r15
+
+    mov rdi, rsp         ; First argument: pointer to the saved frame
+    mov rbp, rsp         ; Remember the frame (RBP is callee-saved)
+    and rsp, -16         ; The System V ABI requires a 16-byte aligned stack at CALL
+    cld                  ; The ABI also requires the direction flag to be clear
+    call isr_dispatch
+    mov rsp, rbp
+
+    pop r15
+    pop r14
+    pop r13
+    pop r12
+    pop r11
+    pop r10
+    pop r9
+    pop r8
+    pop rbp
+    pop rdi
+    pop rsi
+    pop rdx
+    pop rcx
+    pop rbx
+    pop rax
+
+    add rsp, 16          ; Drop the vector number and error code
+    iretq
+
+; Emit the 256 stubs, isr_stub_0 .. isr_stub_255.
+; Vectors 8, 10-14, 17, 21, 29 and 30 are the exceptions for which the CPU
+; pushes an error code itself; all other vectors push a 0 in its place.
+%assign vec 0
+%rep 256
+isr_stub_%+vec:
+%if (vec == 8) || (vec >= 10 && vec <= 14) || (vec == 17) || (vec == 21) || (vec == 29) || (vec == 30)
+%else
+    push 0               ; Dummy error code
+%endif
+    push vec             ; Vector number
+    jmp isr_common
+%assign vec vec + 1
+%endrep
+
+; Table of stub addresses, used by kidt_init() to fill the IDT.
+section .data
+align 8
+global isr_stub_table
+isr_stub_table:
+%assign vec 0
+%rep 256
+    dq isr_stub_%+vec
+%assign vec vec + 1
+%endrep
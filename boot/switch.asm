@@ -0,0 +1,35 @@
+; switch.asm - Thread context switch
+;
+; kthread_switch(uint64_t* save_rsp, uint64_t next_rsp) is called by the
+; scheduler in kernel/kthread.c. Only the registers the System V ABI makes
+; callee-saved need saving: for the C caller, kthread_switch is an ordinary
+; function call, so everything else is already dead or saved by the caller.
+; The outgoing thread's registers go onto its own stack, its stack pointer
+; into *save_rsp; then the incoming thread's stack is loaded and the same
+; registers are popped in reverse, and 'ret' continues wherever that thread
+; last called kthread_switch (or at thread_start for a new thread).
+;
+; RFLAGS is not switched: the scheduler always runs with interrupts
+; disabled, and each thread restores its own interrupt flag afterwards.
+; FPU/SSE/AVX state is saved and restored by the scheduler itself.
+
+[bits 64]
+section .text
+
+global kthread_switch
+kthread_switch:
+    push rbp
+    push rbx
+    push r12
+    push r13
+    push r14
+    push r15
+    mov [rdi], rsp       ; save_rsp (first argument)
+    mov rsp, rsi         ; next_rsp (second argument)
+    pop r15
+    pop r14
+    pop r13
+    pop r12
+    pop rbx
+    pop rbp
+    ret
@@ -0,0 +1,133 @@
+; trampoline.asm - Startup code for the application processors (APs)
+;
+; After INIT and a STARTUP IPI an AP begins in 16-bit real mode at the
+; physical page named by the SIPI vector. ksmp.c copies this code to
+; TRAMPOLINE_BASE (below 1MB, as real mode requires) and fills in the
+; parameter block at its end before each start. The code then walks the AP
+; through the same steps boot.asm took on the boot CPU:
+;   real mode -> 32-bit protected mode -> long mode with the kernel's page
+;   tables -> the C entry point, on the stack the BSP allocated for it.
+; Control registers, EFER, PAT and XCR0 are copied from the BSP, so the AP
+; runs with exactly the same paging, NX and SSE/AVX setup.
+;
+; The code is position dependent: every address is computed relative to
+; TRAMPOLINE_BASE with the REL() macro below, not the address it is linked at.
+
+TRAMPOLINE_BASE equ 0x8000 ; Must match KSMP_TRAMPOLINE_BASE in kernel/ksmp.h
+
+%define REL(label) (TRAMPOLINE_BASE + (label) - trampoline_start)
+
+; Selectors of the temporary GDT below. 0x08 and 0x10 match CODE_SEL and
+; DATA_SEL in boot.asm, so nothing has to be reloaded when the kernel's own
+; GDT replaces this one.
+TRAMP_CODE64_SEL equ 0x08
+TRAMP_DATA_SEL   equ 0x10
+TRAMP_CODE32_SEL equ 0x18
+
+; Only copied, never executed in place.
+section .rodata
+
+global trampoline_start
+global trampoline_end
+global trampoline_params
+
+[bits 16]
+trampoline_start:
+    cli
+    cld
+    xor ax, ax               ; Flat addressing: every REL() address is below 64KB
+    mov ds, ax
+    mov es, ax
+    mov ss, ax
+
+    lgdt [REL(tramp_gdt_descriptor)]
+    mov eax, cr0
+    or eax, 1                ; PE: protected mode
+    mov cr0, eax
+    jmp TRAMP_CODE32_SEL:REL(protected_mode)
+
+[bits 32]
+protected_mode:
+    mov ax, TRAMP_DATA_SEL
+    mov ds, ax
+    mov es, ax
+    mov ss, ax
+
+    ; Memory types first, so the first cached access already uses them.
+    mov ecx, 0x277           ; IA32_PAT
+    mov eax, [REL(param_pat)]
+    mov edx, [REL(param_pat) + 4]
+    wrmsr
+
+    mov eax, [REL(param_cr4)] ; PAE plus the BSP's SSE/XSAVE bits
+    mov cr4, eax
+    mov eax, [REL(param_cr3)] ; The kernel's PML4 (below 4GB)
+    mov cr3, eax
+    mov ecx, 0xC0000080      ; EFER: LME and, if the BSP uses it, NXE
+    mov eax, [REL(param_efer)]
+    mov edx, [REL(param_efer) + 4]
+    wrmsr
+    mov eax, [REL(param_cr0)] ; PG and PE together activate long mode
+    mov cr0, eax
+    jmp TRAMP_CODE64_SEL:REL(long_mode)
+
+[bits 64]
+long_mode:
+    mov ax, TRAMP_DATA_SEL
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax               ; The C entry point sets the GS base afterwards
+    mov ss, ax
+
+    lgdt [REL(param_gdtr)]   ; Switch to the kernel's GDT (same selectors)
+
+    ; AVX state is only usable once XCR0 enables it (see boot.asm).
+    mov eax, [REL(param_xcr0)]
+    mov edx, [REL(param_xcr0) + 4]
+    test eax, eax
+    jz .no_xsave
+    xor ecx, ecx
+    xsetbv
+.no_xsave:
+
+    ; entry(cpu_index) on this CPU's own stack. The stack top is 16-byte
+    ; aligned, as the System V ABI expects before a CALL.
+    mov rsp, [REL(param_stack)]
+    mov edi, [REL(param_cpu)]
+    mov rax, [REL(param_entry)]
+    call rax
+.hang:                       ; The entry point never returns
+    cli
+    hlt
+    jmp .hang
+
+; --- Temporary GDT ---
+    align 8
+tramp_gdt:
+    dq 0x0000000000000000    ; Null descriptor
+    dq 0x00209A0000000000    ; 0x08: 64-bit code, ring 0
+    dq 0x00CF92000000FFFF    ; 0x10: flat 4GB data
+    dq 0x00CF9A000000FFFF    ; 0x18: flat 4GB 32-bit code
+tramp_gdt_end:
+
+tramp_gdt_descriptor:
+    dw tramp_gdt_end - tramp_gdt - 1
+    dd REL(tramp_gdt)
+
+; --- Parameter Block ---
+; Written by ksmp.c before every STARTUP IPI; the layout must match
+; struct ksmp_trampoline_params there.
+    align 8
+trampoline_params:
+param_cr3:   dq 0
+param_cr4:   dq 0
+param_cr0:   dq 0
+param_efer:  dq 0
+param_pat:   dq 0
+param_xcr0:  dq 0
+param_gdtr:  dq 0, 0         ; LGDT operand: 2-byte limit, 8-byte base, padding
+param_stack: dq 0            ; Top of the AP's stack
+param_entry: dq 0            ; void entry(uint32_t cpu_index)
+param_cpu:   dq 0            ; Index passed to the entry point
+trampoline_end:
@@ -0,0 +1,45 @@
+#ifndef KHOST_H // Standard header guard to prevent multiple inclusions
+#define KHOST_H
+
+#include <stdint.h> // For uint16_t, uint64_t
+
+// --- Host Build ---
+// 'make host-bench' compiles kernel/kutils.c, kmath.c, kformat.c, kfb.c,
+// kfont.c, kkbd.c and kprint.c with the host compiler (and the kernel's own
+// CFLAGS, so the code measured is the code the kernel runs) and links them
+// with:
+//   khost_mocks.c   what those files need from the rest of the kernel:
+//                   outb/inb, the serial console and kjob_parallel_for are
+//                   replaced by in-memory versions, the multiboot and paging
+//                   calls of kfb_init() fail, and the GS base points at
+//                   a per-CPU block, as ksmp_early_init() does at boot;
+//   khost_kprint.c  kprint.c itself, with VGA memory swapped for an array;
+//   khost_bench.c   unit tests and the benchmark runner (JSON on stdout).
+
+#define KHOST_VGA_CELLS (32768 / 2) // VGA text memory, as kprint.c's hardware scrolling uses it
+
+// Mock hardware, filled in by the kernel code under test.
+extern uint16_t khost_vga_memory[KHOST_VGA_CELLS]; // Stands in for 0xB8000
+extern uint64_t khost_port_writes;                 // outb calls (CRTC cursor and start address)
+extern uint64_t khost_serial_bytes;                // Bytes handed to kserial_write/kserial_puts
+
+// --- Function Declarations ---
+
+// khost_init: Sets up the per-CPU block and attaches the mock VGA memory.
+// Must run before any kernel function.
+void khost_init(void);
+
+// khost_kprint_attach: Points kprint.c's vga_buffer at 'vga'.
+void khost_kprint_attach(uint16_t* vga);
+
+// khost_scroll_screen: Calls kprint.c's internal scroll_screen() once.
+void khost_scroll_screen(void);
+
+// khost_hold_print_lock: Takes (1) or releases (0) kprint.c's print_lock,
+// standing in for a CPU that died while printing.
+void khost_hold_print_lock(int hold);
+
+// khost_screen_cell: The shadow buffer cell at screen position (x, y).
+uint16_t khost_screen_cell(int x, int y);
+
+#endif // KHOST_H
@@ -0,0 +1,500 @@
+#include <stdint.h>
+#include <stdio.h>   // printf, fprintf
+#include <string.h>  // strlen, strcmp, memset, memcmp, memcpy
+#include <stdlib.h>  // aligned_alloc
+#include <time.h>    // clock_gettime
+#include "khost.h"
+#include "../kernel/kutils.h"  // Code under test: conversions and string primitives
+#include "../kernel/kmath.h"   // Code under test: k_add_n, k_multiply_n, k_divide
+#include "../kernel/kprint.h"  // Code under test: kprint, kprint_at, kclear_screen
+#include "../kernel/kformat.h" // Code under test: ksnprintf
+#include "../kernel/kfb.h"     // Code under test: the framebuffer console
+#include "../kernel/kkbd.h"    // Code under test: the PS/2 scancode decoder
+#include "../kernel/kcpu.h"    // k_rdtsc
+
+// --- Host Unit Tests and Benchmarks ---
+// First a few unit tests of the kernel code (results against libc or known
+// strings, the mock VGA memory after printing), then each benchmark is run
+// BENCH_REPS times and its fastest run is kept: the fewest TSC cycles and the
+// fewest nanoseconds per operation, and bytes per second from the latter.
+// Everything is written as one JSON object on stdout, so results can be
+// stored and compared between commits. The exit status is 1 if a test failed.
+
+#define BENCH_REPS 7
+#define MAX_RESULTS 32
+
+// One benchmark's best run.
+struct bench_result {
+    const char* name;
+    uint64_t ops;           // Operations per run
+    double cycles_per_op;   // TSC cycles
+    double ns_per_op;
+    uint64_t bytes_per_op;  // Bytes produced or consumed by one operation (0: not meaningful)
+};
+
+static struct bench_result results[MAX_RESULTS];
+static int result_count = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+static volatile uint64_t sink; // Keeps the compiler from discarding results
+
+// --- Helper Function: tsc_now ---
+// The TSC, fenced so the measured code cannot drift across the read.
+static inline uint64_t tsc_now(void) {
+    __asm__ volatile ("lfence" : : : "memory");
+    uint64_t tsc = k_rdtsc();
+    __asm__ volatile ("lfence" : : : "memory");
+    return tsc;
+}
+
+// --- Helper Function: ns_now ---
+static uint64_t ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// --- Helper Function: check ---
+// Records one test result; failures are described on stderr.
+static void check(int ok, const char* what, int line) {
+    if (ok) {
+        tests_passed++;
+    } else {
+        tests_failed++;
+        fprintf(stderr, "FAIL (line %d): %s\n", line, what);
+    }
+}
+#define CHECK(cond) check((cond) != 0, #cond, __LINE__)
+
+// --- Helper Function: run_bench ---
+// Runs fn(ops) BENCH_REPS times and records the best run.
+static void run_bench(const char* name, void (*fn)(uint64_t ops), uint64_t ops, uint64_t bytes_per_op) {
+    uint64_t best_cycles = UINT64_MAX;
+    uint64_t best_ns = UINT64_MAX;
+    fn(ops / 8 + 1); // Warm up caches and branch predictors
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        uint64_t ns = ns_now();
+        uint64_t cycles = tsc_now();
+        fn(ops);
+        cycles = tsc_now() - cycles;
+        ns = ns_now() - ns;
+        if (cycles < best_cycles) best_cycles = cycles;
+        if (ns < best_ns) best_ns = ns;
+    }
+    if (result_count < MAX_RESULTS) {
+        struct bench_result* r = &results[result_count++];
+        r->name = name;
+        r->ops = ops;
+        r->cycles_per_op = (double)best_cycles / (double)ops;
+        r->ns_per_op = (double)best_ns / (double)ops;
+        r->bytes_per_op = bytes_per_op;
+    }
+}
+
+// --- Test Data ---
+#define CONVERT_VALUES 256
+static int convert_values[CONVERT_VALUES];
+static char convert_strings[CONVERT_VALUES][12];
+static uint64_t convert_bytes = 0; // Characters in all of convert_strings
+static char long_string[4096 + 1];
+static char short_string[64 + 1];
+
+static void init_test_data(void) {
+    uint32_t seed = 12345;
+    for (int i = 0; i < CONVERT_VALUES; i++) {
+        seed = seed * 1664525 + 1013904223; // LCG, as kbench.c uses
+        int value = (int)((seed >> 1) >> (i % 31)); // Spread over every digit count
+        convert_values[i] = (i & 1) ? -value : value;
+        snprintf(convert_strings[i], sizeof(convert_strings[i]), "%d", convert_values[i]);
+        convert_bytes += strlen(convert_strings[i]);
+    }
+    memset(long_string, 'x', sizeof(long_string) - 1);
+    memset(short_string, 'x', sizeof(short_string) - 1);
+}
+
+// --- Helper Function: decode ---
+// Runs scancodes through a decoder and collects the keys pressed.
+// Returns:
+//   The number of keys stored in 'keys' (at most 'max').
+static int decode(struct kkbd_decoder* d, const uint8_t* codes, int n, uint16_t* keys, int max) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        struct kkey_event event;
+        if (kkbd_decode(d, codes[i], &event) && count < max) {
+            keys[count++] = event.key;
+        }
+    }
+    return count;
+}
+#define DECODE(d, keys, ...) \
+    decode((d), (const uint8_t[]){ __VA_ARGS__ }, sizeof((uint8_t[]){ __VA_ARGS__ }), (keys), 8)
+
+// --- Unit Tests: kkbd ---
+static void run_decoder_tests(void) {
+    struct kkbd_decoder d = KKBD_DECODER_INIT;
+    uint16_t keys[8];
+
+    // Plain keys; releases produce nothing.
+    CHECK(DECODE(&d, keys, 0x1E, 0x9E, 0x02, 0x82, 0x1C, 0x9C) == 3 && keys[0] == 'a' && keys[1] == '1' && keys[2] == '\n');
+
+    // Shift, held on either side.
+    CHECK(DECODE(&d, keys, 0x2A, 0x1E, 0x02, 0xAA, 0x1E) == 3 && keys[0] == 'A' && keys[1] == '!' && keys[2] == 'a');
+    CHECK(DECODE(&d, keys, 0x2A, 0x36, 0xAA, 0x1E, 0xB6, 0x1E) == 2 && keys[0] == 'A' && keys[1] == 'a');
+
+    // Caps Lock affects letters only, Shift inverts it, and a held (repeating)
+    // Caps Lock toggles once.
+    CHECK(DECODE(&d, keys, 0x3A, 0x3A, 0x3A, 0xBA, 0x1E, 0x02, 0x2A, 0x1E, 0xAA) == 3 &&
+          keys[0] == 'A' && keys[1] == '1' && keys[2] == 'a');
+    CHECK(DECODE(&d, keys, 0x3A, 0xBA, 0x1E) == 1 && keys[0] == 'a');
+
+    // Gray arrows, and the keypad with Num Lock off and on.
+    CHECK(DECODE(&d, keys, 0xE0, 0x48, 0xE0, 0xC8, 0xE0, 0x4B, 0x48, 0x4C) == 3 &&
+          keys[0] == KEY_UP && keys[1] == KEY_LEFT && keys[2] == KEY_UP);
+    CHECK(DECODE(&d, keys, 0x45, 0xC5, 0x48, 0x53, 0xE0, 0x48, 0x45, 0xC5) == 3 &&
+          keys[0] == '8' && keys[1] == '.' && keys[2] == KEY_UP);
+
+    // Right Ctrl (0xE0 prefixed) with a letter gives its control code.
+    struct kkey_event event;
+    CHECK(DECODE(&d, keys, 0xE0, 0x1D) == 0);
+    CHECK(kkbd_decode(&d, 0x2E, &event) && event.key == 3 && (event.modifiers & KMOD_RCTRL));
+    CHECK(DECODE(&d, keys, 0xAE, 0xE0, 0x9D, 0x2E) == 1 && keys[0] == 'c');
+
+    // Pause is one key, and its 0x1D bytes do not leave Ctrl held.
+    CHECK(DECODE(&d, keys, 0xE1, 0x1D, 0x45, 0xE1, 0x9D, 0xC5, 0x2E) == 2 && keys[0] == KEY_PAUSE && keys[1] == 'c');
+
+    // Print Screen's "fake shift" is ignored; unknown codes and ACKs too.
+    CHECK(DECODE(&d, keys, 0xE0, 0x2A, 0xE0, 0x37, 0xE0, 0xB7, 0xE0, 0xAA, 0x1E) == 2 &&
+          keys[0] == KEY_PRINT_SCREEN && keys[1] == 'a');
+    CHECK(DECODE(&d, keys, 0xFA, 0x00, 0x5A, 0x1E) == 1 && keys[0] == 'a');
+}
+
+// --- Unit Tests ---
+static void run_tests(void) {
+    char buf[80];
+
+    // Conversions against libc.
+    for (int i = 0; i < CONVERT_VALUES; i++) {
+        k_itoa(convert_values[i], buf, 10);
+        CHECK(strcmp(buf, convert_strings[i]) == 0);
+        CHECK(k_atoi(convert_strings[i]) == convert_values[i]);
+    }
+    CHECK(strcmp(k_itoa(255, buf, 16), "ff") == 0);
+    CHECK(strcmp(k_itoa(10, buf, 2), "1010") == 0);
+    CHECK(k_u64toa(UINT64_MAX, buf, 10) == 20 && strcmp(buf, "18446744073709551615") == 0);
+    int64_t parsed;
+    CHECK(k_parse_i64("-9223372036854775809", 0, 10, &parsed) == K_PARSE_OVERFLOW);
+
+    // k_strlen at every SIMD level, every alignment and lengths across the vector widths.
+    for (int level = K_SIMD_SCALAR; level <= k_simd_best_level(); level++) {
+        k_simd_set_level(level);
+        int ok = 1;
+        for (int offset = 0; offset < 32; offset++) {
+            for (int length = 0; length < 200; length++) {
+                char saved = long_string[offset + length];
+                long_string[offset + length] = '\0';
+                ok &= k_strlen(long_string + offset) == length;
+                long_string[offset + length] = saved;
+            }
+        }
+        CHECK(ok);
+    }
+    k_simd_set_level(k_simd_best_level());
+
+    // kmath.
+    int numbers[5] = { 1, 2, 3, 4, 5 };
+    CHECK(k_add_n(numbers, 5) == 15);
+    CHECK(k_multiply_n(numbers, 5) == 120);
+    CHECK(k_divide(7, 2) == 3);
+    CHECK(k_divide(7, 0) == 0);
+
+    // kformat.
+    ksnprintf(buf, sizeof(buf), "%d|%5s|%-3u|%08x|%llu", -42, "ab", 7u, 0xbeefu, 1ULL << 40);
+    CHECK(strcmp(buf, "-42|   ab|7  |0000beef|1099511627776") == 0);
+    // '+' and ' ' do nothing for unsigned conversions; GCC warns about
+    // exactly that, which is what is being tested here.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat"
+    ksnprintf(buf, sizeof(buf), "%+d|% d|%+u|% u|%+x", 5, 5, 5u, 5u, 5u);
+#pragma GCC diagnostic pop
+    CHECK(strcmp(buf, "+5| 5|5|5|5") == 0);
+
+    // kprint into the mock VGA memory: with hardware scrolling off, screen
+    // row y is VGA memory row y.
+    kprint_set_hw_scroll(0);
+    kclear_screen();
+    kprint_at("Hi", 3, 2, VGA_ATTRIB_YELLOW_ON_BLACK);
+    CHECK(khost_vga_memory[2 * VGA_WIDTH + 3] == ((VGA_ATTRIB_YELLOW_ON_BLACK << 8) | 'H'));
+    CHECK(khost_vga_memory[2 * VGA_WIDTH + 4] == ((VGA_ATTRIB_YELLOW_ON_BLACK << 8) | 'i'));
+    khost_scroll_screen();
+    CHECK((khost_screen_cell(3, 1) & 0xFF) == 'H');
+    CHECK((khost_screen_cell(3, 2) & 0xFF) == ' ');
+
+    // Printing past the bottom line scrolls, in both modes.
+    for (int hw = 0; hw <= 1; hw++) {
+        kprint_set_hw_scroll(hw);
+        kclear_screen();
+        for (int line = 0; line < 30; line++) {
+            ksnprintf(buf, sizeof(buf), "line %d\n", line);
+            kprint(buf, VGA_ATTRIB_WHITE_ON_BLACK);
+        }
+        CHECK((khost_screen_cell(5, VGA_HEIGHT - 2) & 0xFF) == '2' && (khost_screen_cell(6, VGA_HEIGHT - 2) & 0xFF) == '9');
+        CHECK((khost_screen_cell(5, 0) & 0xFF) == '6');
+    }
+
+    // The panic path gets through even while print_lock is held forever,
+    // onto the screen and the serial console.
+    kclear_screen();
+    uint64_t serial_before = khost_serial_bytes;
+    khost_hold_print_lock(1);
+    kprint_panic("PANIC", VGA_ATTRIB_RED_ON_BLACK);
+    khost_hold_print_lock(0);
+    CHECK((khost_screen_cell(0, 0) & 0xFF) == 'P' && (khost_screen_cell(4, 0) & 0xFF) == 'C');
+    CHECK(khost_serial_bytes - serial_before == 5);
+
+    run_decoder_tests();
+}
+
+// --- Benchmarks ---
+// Each runs its operation 'ops' times; the data cycles through the test arrays.
+
+static void bench_itoa(uint64_t ops) {
+    char buf[16];
+    for (uint64_t i = 0; i < ops; i++) {
+        k_itoa(convert_values[i % CONVERT_VALUES], buf, 10);
+        sink = (uint64_t)buf[0];
+    }
+}
+
+static void bench_atoi(uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        sink = (uint64_t)k_atoi(convert_strings[i % CONVERT_VALUES]);
+    }
+}
+
+static void bench_strlen_short(uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        sink = (uint64_t)k_strlen(short_string);
+    }
+}
+
+static void bench_strlen_long(uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        sink = (uint64_t)k_strlen(long_string);
+    }
+}
+
+// A 40-character line and its newline, at the bottom of the screen: every
+// call prints and scrolls once.
+#define KPRINT_LINE "The quick brown fox jumps over the dog.\n"
+static void bench_kprint(uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        kprint(KPRINT_LINE, VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+}
+
+// scroll_screen() only moves the rings; the rows reach (mock) VGA memory
+// in the flush, so that is included.
+static void bench_scroll(uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        khost_scroll_screen();
+        kprint_flush();
+    }
+}
+
+// Two 79-character lines drawn in turn at the same place, so every character
+// cell changes on every call.
+#define KPRINT_AT_LINE_A "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ!\"#$%&'()*+,-./:;"
+#define KPRINT_AT_LINE_B "=>?@[\\]^_`{|}~ The quick brown fox jumps over the lazy dog. 0123456789 ABCDEFGH"
+static void bench_kprint_at(uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        kprint_at((i & 1) ? KPRINT_AT_LINE_B : KPRINT_AT_LINE_A, 0, 10, VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+}
+
+// Scancodes of typed text, as a keyboard (or QEMU's sendkey) sends them:
+// every key pressed and released, capitals wrapped in Left Shift.
+#define TYPING_KEYS 1000
+static uint8_t typing_codes[TYPING_KEYS * 4];
+static int typing_length = 0;
+
+static void init_typing(void) {
+    static const uint8_t letters[] = { 0x10, 0x11, 0x12, 0x13, 0x14, 0x1E, 0x1F, 0x20, 0x2C, 0x2D, 0x39 };
+    for (int i = 0; i < TYPING_KEYS; i++) {
+        uint8_t code = letters[i % sizeof(letters)];
+        int capital = i % 7 == 0;
+        if (capital) typing_codes[typing_length++] = 0x2A;
+        typing_codes[typing_length++] = code;
+        typing_codes[typing_length++] = code | 0x80;
+        if (capital) typing_codes[typing_length++] = 0xAA;
+    }
+}
+
+static void bench_decode(uint64_t ops) {
+    struct kkbd_decoder d = KKBD_DECODER_INIT;
+    struct kkey_event event;
+    uint64_t keys = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        keys += (uint64_t)kkbd_decode(&d, typing_codes[i % typing_length], &event);
+    }
+    sink = keys;
+}
+
+static const char* simd_names[3] = { "scalar", "sse2", "avx2" };
+
+static void run_benchmarks(void) {
+    static char names[3][2][32];
+    run_bench("k_itoa", bench_itoa, 1000000, convert_bytes / CONVERT_VALUES);
+    run_bench("k_atoi", bench_atoi, 1000000, convert_bytes / CONVERT_VALUES);
+    for (int level = K_SIMD_SCALAR; level <= k_simd_best_level(); level++) {
+        k_simd_set_level(level);
+        snprintf(names[level][0], sizeof(names[level][0]), "k_strlen/64/%s", simd_names[level]);
+        snprintf(names[level][1], sizeof(names[level][1]), "k_strlen/4096/%s", simd_names[level]);
+        run_bench(names[level][0], bench_strlen_short, 1000000, 64);
+        run_bench(names[level][1], bench_strlen_long, 50000, 4096);
+    }
+    k_simd_set_level(k_simd_best_level());
+
+    init_typing();
+    run_bench("kkbd_decode/typing", bench_decode, 10000000, 1);
+
+    kprint_set_hw_scroll(1);
+    run_bench("kprint/line/hw-scroll", bench_kprint, 200000, strlen(KPRINT_LINE));
+    run_bench("scroll_screen/hw-scroll", bench_scroll, 1000000, VGA_WIDTH * 2);
+    kprint_set_hw_scroll(0);
+    run_bench("kprint/line/full-copy", bench_kprint, 200000, strlen(KPRINT_LINE));
+    run_bench("scroll_screen/full-copy", bench_scroll, 200000, VGA_WIDTH * 2);
+    kprint_set_hw_scroll(1);
+}
+
+// --- Framebuffer Console ---
+// Attaches a 1024x768 framebuffer in ordinary memory (scale 2: 12x24 cells,
+// the grid at pixel (32, 84)), checks a few pixels, then measures kprint on
+// it. kprint stays on the framebuffer from here on, so this runs last.
+#define FB_WIDTH  1024
+#define FB_HEIGHT 768
+#define FB_PIXEL(x, y) fb_pixels[(y) * FB_WIDTH + (x)]
+static uint32_t* fb_pixels;
+
+static void run_framebuffer(void) {
+    struct kfb_mode mode = { 0, FB_WIDTH, FB_HEIGHT, FB_WIDTH * 4, 16, 8, 8, 8, 0, 8 };
+    fb_pixels = aligned_alloc(64, FB_WIDTH * FB_HEIGHT * 4);
+    mode.pixels = fb_pixels;
+    uint32_t* back_buffer = aligned_alloc(64, kfb_back_buffer_bytes(&mode));
+    uint32_t* glyph_cache = aligned_alloc(64, kfb_glyph_cache_bytes(&mode));
+    // 1024x768 fits 170x64 cells of 6x12 pixels, centered at (2, 0).
+    int columns, rows;
+    CHECK(kfb_scale(&mode) == 1);
+    kfb_grid(&mode, &columns, &rows);
+    CHECK(columns == 170 && rows == 64);
+    CHECK(kfb_attach(&mode, back_buffer, glyph_cache));
+    kprint_set_size(columns, rows);
+    CHECK(kprint_columns() == 170 && kprint_rows() == 64);
+    kprint_redraw();
+
+    // 'A' in bright white: font row 2 is .###.., row 5 #####.
+    kclear_screen();
+    kprint_at("A", 0, 0, VGA_ATTRIB_WHITE_ON_BLACK);
+    CHECK(FB_PIXEL(2, 2) == 0x000000);
+    CHECK(FB_PIXEL(3, 2) == 0xFFFFFF && FB_PIXEL(4, 2) == 0xFFFFFF);
+    CHECK(FB_PIXEL(2, 5) == 0xFFFFFF);
+    CHECK(FB_PIXEL(1, 5) == 0x000000); // Margin
+
+    // The cursor is an underline on the cell's bottom font row.
+    CHECK(FB_PIXEL(2, 11) == 0xFFFFFF && FB_PIXEL(7, 11) == 0xFFFFFF);
+    kset_cursor_pos(5, 5);
+    CHECK(FB_PIXEL(2, 11) == 0x000000);
+    CHECK(FB_PIXEL(2 + 5 * 6, 5 * 12 + 11) == 0xFFFFFF);
+
+    // The columns and rows past 80x25 are part of the console.
+    kprint_at("A", 169, 62, VGA_ATTRIB_WHITE_ON_BLACK);
+    CHECK(FB_PIXEL(2 + 169 * 6 + 1, 62 * 12 + 2) == 0xFFFFFF);
+
+    // Scrolling moves 'B' (font row 2: ####..) from row 1 to row 0.
+    kprint_at("B", 0, 1, VGA_ATTRIB_WHITE_ON_BLACK);
+    khost_scroll_screen();
+    kprint_flush();
+    CHECK(FB_PIXEL(2, 2) == 0xFFFFFF);
+    CHECK(FB_PIXEL(2, 2 + 12) == 0x000000);
+
+    // A scroll turns the back buffer ring and clears the new bottom row, so
+    // a printed line draws only its own characters (and the cursor). The
+    // framebuffer is never read back: each present after a scroll copies the
+    // grid once, and a batch of scrolls still copies it once. The result
+    // must match a full redraw pixel for pixel.
+    static uint32_t scrolled[FB_WIDTH * FB_HEIGHT];
+    struct kfb_stats before, after;
+    uint64_t grid_bytes = 170 * 6 * 64 * 12 * 4;
+    kset_cursor_pos(0, kprint_rows() - 1);
+    kfb_get_stats(&before);
+    for (int line = 0; line < 10; line++) {
+        kprint("scrolled line\n", VGA_ATTRIB_LIGHT_CYAN_ON_BLACK);
+    }
+    kfb_get_stats(&after);
+    uint64_t bytes_per_line = (after.pixels_presented - before.pixels_presented) * 4 / (after.scrolls - before.scrolls);
+    CHECK(after.scrolls - before.scrolls == 10);
+    CHECK(bytes_per_line <= grid_bytes);
+    CHECK(after.cells_drawn - before.cells_drawn <= 10 * (13 + 2));
+    kfb_get_stats(&before);
+    kprint_batch_begin();
+    for (int line = 0; line < 10; line++) {
+        kprint("scrolled line\n", VGA_ATTRIB_LIGHT_CYAN_ON_BLACK);
+    }
+    kprint_batch_end();
+    kfb_get_stats(&after);
+    CHECK((after.pixels_presented - before.pixels_presented) * 4 <= grid_bytes);
+    memcpy(scrolled, fb_pixels, sizeof(scrolled));
+    CHECK(kfb_attach(&mode, back_buffer, glyph_cache));
+    kprint_redraw();
+    CHECK(memcmp(scrolled, fb_pixels, sizeof(scrolled)) == 0);
+
+    // The glyph cache must not change a single pixel: attaching again
+    // forgets what every cell shows, so the redraw renders them all.
+    static uint32_t cached[FB_WIDTH * FB_HEIGHT];
+    kprint("Glyph cache test: ~{|}\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    kprint_at(KPRINT_AT_LINE_A, 0, 5, VGA_ATTRIB_BLACK_ON_WHITE);
+    kprint_at(KPRINT_AT_LINE_B, 0, 6, VGA_ATTRIB_LIGHT_CYAN_ON_BLACK);
+    memcpy(cached, fb_pixels, sizeof(cached));
+    kfb_set_glyph_cache(0);
+    CHECK(kfb_attach(&mode, back_buffer, glyph_cache));
+    kprint_redraw();
+    CHECK(memcmp(cached, fb_pixels, sizeof(cached)) == 0);
+    kfb_set_glyph_cache(1);
+
+    kset_cursor_pos(0, kprint_rows() - 1);
+    run_bench("kprint/line/framebuffer", bench_kprint, 2000, strlen(KPRINT_LINE));
+    run_bench("kprint_at/line/framebuffer", bench_kprint_at, 20000, strlen(KPRINT_AT_LINE_A));
+    kfb_set_glyph_cache(0);
+    run_bench("kprint_at/line/framebuffer-nocache", bench_kprint_at, 20000, strlen(KPRINT_AT_LINE_A));
+    kfb_set_glyph_cache(1);
+}
+
+// --- Function: print_json ---
+static void print_json(void) {
+    printf("{\n");
+    printf("  \"harness\": \"host-bench\",\n");
+    printf("  \"simd_best\": \"%s\",\n", simd_names[k_simd_best_level()]);
+    printf("  \"reps\": %d,\n", BENCH_REPS);
+    printf("  \"tests\": { \"passed\": %d, \"failed\": %d },\n", tests_passed, tests_failed);
+    printf("  \"benchmarks\": [\n");
+    for (int i = 0; i < result_count; i++) {
+        const struct bench_result* r = &results[i];
+        double bytes_per_s = r->ns_per_op > 0 ? (double)r->bytes_per_op * 1e9 / r->ns_per_op : 0;
+        printf("    { \"name\": \"%s\", \"ops\": %llu, \"cycles_per_op\": %.2f, \"ns_per_op\": %.3f, "
+               "\"bytes_per_op\": %llu, \"bytes_per_s\": %.0f }%s\n",
+               r->name, (unsigned long long)r->ops, r->cycles_per_op, r->ns_per_op,
+               (unsigned long long)r->bytes_per_op, bytes_per_s, i + 1 < result_count ? "," : "");
+    }
+    printf("  ]\n");
+    printf("}\n");
+}
+
+int main(void) {
+    khost_init();
+    k_simd_init();
+    init_test_data();
+    run_tests();
+    run_benchmarks();
+    run_framebuffer();
+    print_json();
+    return tests_failed ? 1 : 0;
+}
@@ -0,0 +1,31 @@
+// --- kprint.c for the Host Build ---
+// The whole of kprint.c is compiled here, so the benchmarks can reach its
+// internal functions (scroll_screen) and redirect its static vga_buffer.
+#include "../kernel/kprint.c"
+#include "khost.h"
+
+// --- Public Function: khost_kprint_attach ---
+void khost_kprint_attach(uint16_t* vga) {
+    vga_buffer = vga;
+}
+
+// --- Public Function: khost_scroll_screen ---
+// scroll_screen() normally runs under print_lock from put_char_to_shadow;
+// the host runs single-threaded, so it is called bare.
+void khost_scroll_screen(void) {
+    scroll_screen();
+}
+
+// --- Public Function: khost_hold_print_lock ---
+void khost_hold_print_lock(int hold) {
+    if (hold) {
+        kspin_lock(&print_lock);
+    } else {
+        kspin_unlock(&print_lock);
+    }
+}
+
+// --- Public Function: khost_screen_cell ---
+uint16_t khost_screen_cell(int x, int y) {
+    return shadow_row(y)[x];
+}
@@ -0,0 +1,106 @@
+#include <stdint.h>
+#include <string.h>        // strlen
+#include <stdio.h>         // perror
+#include <stdlib.h>        // exit
+#include <unistd.h>        // syscall
+#include <sys/syscall.h>   // SYS_arch_prctl
+#include <asm/prctl.h>     // ARCH_SET_GS
+#include "khost.h"
+#include "../kernel/kinput.h" // outb, inb
+#include "../kernel/kserial.h" // kserial_write, kserial_puts
+#include "../kernel/kjob.h"   // kjob_parallel_for
+#include "../kernel/ksmp.h"   // struct ksmp_cpu
+#include "../kernel/kmultiboot.h" // kmultiboot_find_tag
+#include "../kernel/kvmm.h"   // kvmm_map, kvmm_alloc_lazy
+
+// --- Mock Hardware ---
+uint16_t khost_vga_memory[KHOST_VGA_CELLS];
+uint64_t khost_port_writes = 0;
+uint64_t khost_serial_bytes = 0;
+
+// The one CPU the host build has. Spinlocks count preemption in it, and
+// kmath.c indexes its partial results by its index (0).
+static struct ksmp_cpu host_cpu;
+
+// --- Mock: outb / inb ---
+// Port writes are only counted; reads return 0 (nothing is ever ready).
+void outb(uint16_t port, uint8_t data) {
+    (void)port;
+    (void)data;
+    khost_port_writes++;
+}
+
+uint8_t inb(uint16_t port) {
+    (void)port;
+    return 0;
+}
+
+// --- Mock: Serial Console ---
+void kserial_write(const char* data, int len) {
+    (void)data;
+    khost_serial_bytes += (uint64_t)len;
+}
+
+void kserial_puts(const char* str) {
+    khost_serial_bytes += strlen(str);
+}
+
+void kserial_panic_write(const char* str) {
+    khost_serial_bytes += strlen(str);
+}
+
+// --- Mock: kjob_parallel_for ---
+// The same pieces the pool would hand out, run one after another here.
+void kjob_parallel_for(uint64_t begin, uint64_t end, uint64_t grain, kjob_range_fn fn, void* arg) {
+    if (grain == 0) {
+        grain = 1;
+    }
+    for (uint64_t b = begin; b < end; b += grain) {
+        fn(b, end - b < grain ? end : b + grain, arg);
+    }
+}
+
+// --- Mock: kthread_resched ---
+// No scheduler on the host; need_resched is never set.
+void kthread_resched(void) {
+}
+
+// --- Mock: Boot Information and Paging ---
+// The host has no framebuffer tag, so kfb_init() never gets further than
+// the lookup; the tests attach a framebuffer in malloc'd memory instead.
+const struct multiboot_tag* kmultiboot_find_tag(uint32_t type) {
+    (void)type;
+    return 0;
+}
+
+int kvmm_map(uint64_t virt, uint64_t phys, uint64_t size, int flags) {
+    (void)virt;
+    (void)phys;
+    (void)size;
+    (void)flags;
+    return -1;
+}
+
+void* kvmm_alloc_lazy(uint64_t size, int flags) {
+    (void)size;
+    (void)flags;
+    return 0;
+}
+
+void kvmm_free_lazy(void* region) {
+    (void)region;
+}
+
+// --- Public Function: khost_init ---
+// Linux lets a process set its own GS base (glibc uses FS for thread-local
+// storage), so ksmp_this_cpu() and ksmp_cpu_index() work unchanged.
+void khost_init(void) {
+    host_cpu.self = &host_cpu;
+    host_cpu.index = 0;
+    host_cpu.online = 1;
+    if (syscall(SYS_arch_prctl, ARCH_SET_GS, &host_cpu) != 0) {
+        perror("arch_prctl(ARCH_SET_GS)");
+        exit(2);
+    }
+    khost_kprint_attach(khost_vga_memory);
+}
@@ -0,0 +1,164 @@
+#include <stdint.h>
+#include "kacpi.h"      // Our own declarations
+#include "kmultiboot.h" // ACPI tags copied by GRUB
+#include "kvmm.h"       // Mapping tables that lie above the identity map
+
+#define BIOS_AREA_START  0xE0000 // The RSDP may also be anywhere in 0xE0000-0xFFFFF
+#define BIOS_AREA_END    0x100000
+
+// Root System Description Pointer. Revision 0 ends after rsdt_address;
+// revision 2 and later add the XSDT.
+struct acpi_rsdp {
+    char signature[8];       // "RSD PTR "
+    uint8_t checksum;        // Covers the first 20 bytes
+    char oem_id[6];
+    uint8_t revision;
+    uint32_t rsdt_address;
+    uint32_t length;         // Revision 2+: size of the whole structure
+    uint64_t xsdt_address;
+    uint8_t extended_checksum;
+    uint8_t reserved[3];
+} __attribute__((packed));
+
+#define RSDP_V1_SIZE 20
+
+static const struct acpi_sdt_header* root = 0; // RSDT or XSDT, or 0
+static int root_entry_size = 4;                // 4 for the RSDT, 8 for the XSDT
+
+// --- Helper Function: checksum_ok ---
+// ACPI structures are valid when all their bytes add up to 0.
+static int checksum_ok(const void* data, uint32_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        sum += bytes[i];
+    }
+    return sum == 0;
+}
+
+// --- Helper Function: signature_is ---
+static int signature_is(const char* a, const char* b, int length) {
+    for (int i = 0; i < length; i++) {
+        if (a[i] != b[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// --- Helper Function: map_range ---
+// Identity maps (read-only) every page of [phys, phys + length) that is not
+// mapped yet. The firmware usually puts the tables at the top of RAM, which
+// is above the boot direct map on machines with more than 1GB and no 1GB
+// pages.
+// Returns:
+//   1 if the whole range is accessible.
+static int map_range(uint64_t phys, uint64_t length) {
+    uint64_t page = phys & ~(KVMM_PAGE_4K - 1);
+    uint64_t end = phys + length;
+    for (; page < end; page += KVMM_PAGE_4K) {
+        uint64_t mapped;
+        if (kvmm_translate(page, &mapped)) {
+            continue;
+        }
+        if (kvmm_map(page, page, KVMM_PAGE_4K, KVMM_NOEXEC) < 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// --- Helper Function: map_table ---
+// Maps a table's header, then the rest of it once its length is known.
+// Returns:
+//   The table, or 0 if it could not be mapped or fails its checksum.
+static const struct acpi_sdt_header* map_table(uint64_t phys) {
+    if (phys == 0 || !map_range(phys, sizeof(struct acpi_sdt_header))) {
+        return 0;
+    }
+    const struct acpi_sdt_header* table = (const struct acpi_sdt_header*)phys;
+    if (table->length < sizeof(struct acpi_sdt_header) || !map_range(phys, table->length)) {
+        return 0;
+    }
+    return checksum_ok(table, table->length) ? table : 0;
+}
+
+// --- Helper Function: rsdp_valid ---
+static int rsdp_valid(const struct acpi_rsdp* rsdp) {
+    if (!signature_is(rsdp->signature, "RSD PTR ", 8) || !checksum_ok(rsdp, RSDP_V1_SIZE)) {
+        return 0;
+    }
+    return rsdp->revision < 2 || checksum_ok(rsdp, rsdp->length);
+}
+
+// --- Helper Function: scan_for_rsdp ---
+// Without a Multiboot2 copy, the RSDP is searched on 16-byte boundaries in
+// the BIOS area (in the first megabyte, which boot.asm maps). The EBDA, the
+// other place the spec allows, is not searched; GRUB provides the tag on
+// every firmware it supports.
+static const struct acpi_rsdp* scan_for_rsdp(uint64_t start, uint64_t end) {
+    for (uint64_t addr = start; addr + sizeof(struct acpi_rsdp) <= end; addr += 16) {
+        const struct acpi_rsdp* rsdp = (const struct acpi_rsdp*)addr;
+        if (rsdp_valid(rsdp)) {
+            return rsdp;
+        }
+    }
+    return 0;
+}
+
+// --- Helper Function: find_rsdp ---
+// GRUB copies the RSDP into the boot information; prefer the ACPI 2.0 copy.
+static const struct acpi_rsdp* find_rsdp(void) {
+    const struct multiboot_tag* tag = kmultiboot_find_tag(MULTIBOOT_TAG_TYPE_ACPI_NEW);
+    if (!tag) {
+        tag = kmultiboot_find_tag(MULTIBOOT_TAG_TYPE_ACPI_OLD);
+    }
+    if (tag) {
+        const struct acpi_rsdp* rsdp = (const struct acpi_rsdp*)((const struct multiboot_tag_acpi*)tag)->rsdp;
+        if (rsdp_valid(rsdp)) {
+            return rsdp;
+        }
+    }
+
+    return scan_for_rsdp(BIOS_AREA_START, BIOS_AREA_END);
+}
+
+// --- Public Function: kacpi_init ---
+int kacpi_init(void) {
+    const struct acpi_rsdp* rsdp = find_rsdp();
+    if (!rsdp) {
+        return 0;
+    }
+    if (rsdp->revision >= 2 && rsdp->xsdt_address) {
+        root = map_table(rsdp->xsdt_address);
+        root_entry_size = 8;
+    }
+    if (!root) {
+        root = map_table(rsdp->rsdt_address);
+        root_entry_size = 4;
+    }
+    return root != 0;
+}
+
+// --- Public Function: kacpi_find_table ---
+// The root table's entries are physical addresses; in the XSDT they are
+// 64-bit but only 4-byte aligned, so they are read in two halves.
+const struct acpi_sdt_header* kacpi_find_table(const char* signature) {
+    if (!root) {
+        return 0;
+    }
+    const uint8_t* entries = (const uint8_t*)(root + 1);
+    uint32_t count = (root->length - sizeof(struct acpi_sdt_header)) / root_entry_size;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t* entry = (const uint32_t*)(entries + i * root_entry_size);
+        uint64_t phys = entry[0];
+        if (root_entry_size == 8) {
+            phys |= (uint64_t)entry[1] << 32;
+        }
+        const struct acpi_sdt_header* table = map_table(phys);
+        if (table && signature_is(table->signature, signature, 4)) {
+            return table;
+        }
+    }
+    return 0;
+}
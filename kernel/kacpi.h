@@ -0,0 +1,66 @@
+#ifndef KACPI_H // Standard header guard to prevent multiple inclusions
+#define KACPI_H
+
+#include <stdint.h> // For uint8_t, uint32_t, uint64_t
+
+// --- ACPI Tables ---
+// The firmware describes the machine in ACPI tables. The RSDP (found through
+// the Multiboot2 ACPI tags, or by scanning the BIOS area) points to the root
+// table (RSDT with 32-bit or XSDT with 64-bit entries), which lists every
+// other table. The kernel only reads tables; it has no AML interpreter.
+
+// Header shared by every table except the RSDP.
+struct acpi_sdt_header {
+    char signature[4];  // e.g. "APIC" for the MADT
+    uint32_t length;    // Size of the whole table, header included
+    uint8_t revision;
+    uint8_t checksum;   // All bytes of the table sum to 0 (mod 256)
+    char oem_id[6];
+    char oem_table_id[8];
+    uint32_t oem_revision;
+    uint32_t creator_id;
+    uint32_t creator_revision;
+} __attribute__((packed));
+
+// --- MADT (Multiple APIC Description Table, signature "APIC") ---
+// Lists the interrupt controllers: one local APIC entry per CPU core.
+struct acpi_madt {
+    struct acpi_sdt_header header;
+    uint32_t lapic_address; // Physical address of the local APICs
+    uint32_t flags;
+    // Followed by variable-length entries.
+} __attribute__((packed));
+
+struct acpi_madt_entry {
+    uint8_t type;
+    uint8_t length;
+} __attribute__((packed));
+
+#define ACPI_MADT_LOCAL_APIC          0 // struct acpi_madt_local_apic
+#define ACPI_MADT_LAPIC_ADDR_OVERRIDE 5 // 64-bit local APIC address
+
+struct acpi_madt_local_apic {
+    uint8_t type;
+    uint8_t length;
+    uint8_t processor_id;
+    uint8_t apic_id;
+    uint32_t flags;
+} __attribute__((packed));
+
+#define ACPI_MADT_CPU_ENABLED        0x1 // The core is usable now
+#define ACPI_MADT_CPU_ONLINE_CAPABLE 0x2 // The core can be enabled at run time
+
+// --- Function Declarations ---
+
+// kacpi_init: Locates the RSDP and the root table. Tables outside the boot
+// direct map are mapped (read-only) on demand, so kvmm_init() must have run.
+// Returns:
+//   1 if ACPI tables were found, 0 otherwise.
+int kacpi_init(void);
+
+// kacpi_find_table: Looks up a table by its 4-character signature.
+// Returns:
+//   The table (checksum verified), or 0 if there is none.
+const struct acpi_sdt_header* kacpi_find_table(const char* signature);
+
+#endif // KACPI_H
@@ -0,0 +1,89 @@
+#include <stdint.h>
+#include "kapic.h"    // Our own declarations
+#include "kcpu.h"     // CPUID and MSR access
+#include "kvmm.h"     // Mapping the register page
+#include "kidt.h"     // Spurious interrupt handler
+
+#define IA32_APIC_BASE_MSR 0x1B
+#define APIC_BASE_ENABLE   (1ULL << 11) // Global enable bit in IA32_APIC_BASE
+#define APIC_BASE_ADDR_MASK 0x000FFFFFFFFFF000ULL
+#define LAPIC_SOFTWARE_ENABLE 0x100     // Bit 8 of the spurious vector register
+
+static volatile uint32_t* lapic_base = 0; // 0 until kapic_init() succeeds
+
+// --- Interrupt Handler: spurious_handler ---
+// A spurious APIC interrupt is not in service, so it must not get an EOI.
+static void spurious_handler(struct interrupt_frame* frame) {
+    (void)frame;
+}
+
+// --- Public Function: kapic_init ---
+int kapic_init(void) {
+    uint32_t a, b, c, d;
+    k_cpuid(1, 0, &a, &b, &c, &d);
+    if (!(d & (1u << 9))) {
+        return 0; // No local APIC
+    }
+
+    // Map the register page at its own physical address (identity), uncached.
+    uint64_t base = k_rdmsr(IA32_APIC_BASE_MSR);
+    uint64_t phys = base & APIC_BASE_ADDR_MASK;
+    if (kvmm_map(phys, phys, KVMM_PAGE_4K, KVMM_WRITE | KVMM_NOEXEC | KVMM_CACHE_UC) < 0) {
+        return 0;
+    }
+    k_wrmsr(IA32_APIC_BASE_MSR, base | APIC_BASE_ENABLE);
+    lapic_base = (volatile uint32_t*)phys;
+
+    kidt_register_handler(LAPIC_SPURIOUS_VECTOR, spurious_handler);
+    kapic_write(LAPIC_REG_SPURIOUS, LAPIC_SOFTWARE_ENABLE | LAPIC_SPURIOUS_VECTOR);
+    kapic_write(LAPIC_REG_LVT_TIMER, LAPIC_LVT_MASKED);
+    return 1;
+}
+
+// --- Public Function: kapic_init_ap ---
+void kapic_init_ap(void) {
+    k_wrmsr(IA32_APIC_BASE_MSR, k_rdmsr(IA32_APIC_BASE_MSR) | APIC_BASE_ENABLE);
+    kapic_write(LAPIC_REG_SPURIOUS, LAPIC_SOFTWARE_ENABLE | LAPIC_SPURIOUS_VECTOR);
+    kapic_write(LAPIC_REG_LVT_TIMER, LAPIC_LVT_MASKED);
+}
+
+// --- Public Function: kapic_present ---
+int kapic_present(void) {
+    return lapic_base != 0;
+}
+
+// --- Public Functions: kapic_read / kapic_write ---
+// Registers are 16 bytes apart; only the first 32 bits of each are used.
+uint32_t kapic_read(uint32_t reg) {
+    return lapic_base[reg / 4];
+}
+
+void kapic_write(uint32_t reg, uint32_t value) {
+    lapic_base[reg / 4] = value;
+}
+
+// --- Public Function: kapic_eoi ---
+void kapic_eoi(void) {
+    kapic_write(LAPIC_REG_EOI, 0);
+}
+
+// --- Public Function: kapic_id ---
+uint32_t kapic_id(void) {
+    return kapic_read(LAPIC_REG_ID) >> 24;
+}
+
+// --- Public Function: kapic_send_ipi ---
+// The two ICR halves are written with interrupts off, so a handler on this
+// CPU cannot send its own IPI in between.
+void kapic_send_ipi(uint32_t apic_id, uint32_t command) {
+    int interrupts_were_on = k_interrupts_enabled();
+    k_disable_interrupts();
+    kapic_write(LAPIC_REG_ICR_HIGH, apic_id << 24);
+    kapic_write(LAPIC_REG_ICR_LOW, command);
+    while (kapic_read(LAPIC_REG_ICR_LOW) & LAPIC_ICR_PENDING) {
+        k_pause();
+    }
+    if (interrupts_were_on) {
+        k_enable_interrupts();
+    }
+}
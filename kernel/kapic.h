@@ -0,0 +1,75 @@
+#ifndef KAPIC_H // Standard header guard to prevent multiple inclusions
+#define KAPIC_H
+
+#include <stdint.h> // For uint32_t
+
+// --- Local APIC ---
+// Every CPU core has a local APIC: its private interrupt controller, which
+// also contains a per-core timer. Its registers are memory mapped (normally
+// at 0xFEE00000, past the end of RAM or inside a 1GB page of the direct map),
+// so kapic_init maps them uncached with the VMM. The legacy PICs stay in charge of the ISA IRQs,
+// which reach the CPU through the local APIC's LINT0 pin.
+
+// Interrupt vectors owned by the local APIC.
+#define LAPIC_TIMER_VECTOR    0xE0
+#define LAPIC_SPURIOUS_VECTOR 0xFF
+
+// Register offsets (bytes from the APIC base).
+#define LAPIC_REG_ID            0x020
+#define LAPIC_REG_EOI           0x0B0
+#define LAPIC_REG_SPURIOUS      0x0F0
+#define LAPIC_REG_ICR_LOW       0x300 // Interrupt command: writing it sends the IPI
+#define LAPIC_REG_ICR_HIGH      0x310 // Interrupt command: destination APIC ID in bits 24-31
+#define LAPIC_REG_LVT_TIMER     0x320
+#define LAPIC_REG_TIMER_INITIAL 0x380
+#define LAPIC_REG_TIMER_CURRENT 0x390
+#define LAPIC_REG_TIMER_DIVIDE  0x3E0
+
+// LVT timer modes and mask bit.
+#define LAPIC_TIMER_ONESHOT     0x00000
+#define LAPIC_TIMER_PERIODIC    0x20000
+#define LAPIC_TIMER_TSC_DEADLINE 0x40000
+#define LAPIC_LVT_MASKED        0x10000
+
+// Interrupt command (ICR low) fields. A fixed IPI is just the vector number.
+#define LAPIC_ICR_INIT          0x00500
+#define LAPIC_ICR_STARTUP       0x00600 // Vector field = start page (physical address >> 12)
+#define LAPIC_ICR_PENDING       0x01000 // Delivery status: the IPI has not been accepted yet
+#define LAPIC_ICR_LEVEL_ASSERT  0x04000
+
+// --- Function Declarations ---
+
+// kapic_init: Maps and software-enables the local APIC if the CPU has one.
+// Must run after kvmm_init().
+// Returns:
+//   1 if a local APIC is available, 0 otherwise.
+int kapic_init(void);
+
+// kapic_init_ap: Enables the local APIC of an application processor. The
+// register page is shared (every core sees its own APIC at the same address),
+// so kapic_init() on the BSP must have mapped it.
+void kapic_init_ap(void);
+
+// kapic_present: 1 once kapic_init() found and enabled a local APIC.
+int kapic_present(void);
+
+// kapic_read / kapic_write: Access a 32-bit APIC register.
+uint32_t kapic_read(uint32_t reg);
+void kapic_write(uint32_t reg, uint32_t value);
+
+// kapic_eoi: Signals the end of an APIC-delivered interrupt. Handlers for
+// APIC vectors call this themselves; isr_dispatch only acknowledges the PICs.
+void kapic_eoi(void);
+
+// kapic_id: The APIC ID of the current CPU.
+uint32_t kapic_id(void);
+
+// kapic_send_ipi: Sends an inter-processor interrupt and waits until the
+// local APIC has accepted it for delivery.
+// Parameters:
+//   apic_id: APIC ID of the destination CPU.
+//   command: The ICR low word: a vector for a fixed IPI, or LAPIC_ICR_INIT /
+//            LAPIC_ICR_STARTUP with their flags.
+void kapic_send_ipi(uint32_t apic_id, uint32_t command);
+
+#endif // KAPIC_H
@@ -0,0 +1,1473 @@
+#include <stdint.h>
+#include "kbench.h"   // Our own declarations
+#include "kcpu.h"     // k_rdtsc, CR3 and cache control helpers
+#include "kprint.h"   // kprint, kprint_at, kclear_screen, kset_cursor_pos
+#include "kinput.h"   // kgetc to wait for the user
+#include "kutils.h"   // k_itoa, k_u64toa, k_parse_i64, k_strlen, k_memset
+#include "kpmm.h"     // Physical frame allocator statistics
+#include "kheap.h"    // kmalloc/kfree and per-class counters
+#include "kvmm.h"     // Page mapping and lazy regions
+#include "ktime.h"    // Calibrated clock and sleeping
+#include "ktrace.h"   // Probe report
+#include "kserial.h"  // Serial console throughput
+#include "ksmp.h"     // Running work on the other CPUs
+#include "kjob.h"     // Work-stealing pool: CPU limit and steal counters
+#include "kmath.h"    // k_add_n / k_multiply_n as parallel workloads
+#include "kthread.h"  // Thread list and context switches
+#include "kbignum.h"  // Schoolbook vs Karatsuba multiplication
+#include "kexpr.h"    // Expression VM: folding and batch mode
+#include "kfloat.h"   // Double <-> decimal conversions
+#include "kformat.h"  // ksnprintf for the test strings
+#include "kui.h"      // Retained widgets: full redraw vs damage tracking
+#include "kboot.h"    // Boot-phase times: building the page tables
+#include "kfb.h"      // Framebuffer console: glyph cache switch and counters
+#include "kfont.h"    // Font cell size, for the mode line
+#include "kmultiboot.h" // Memory map: a gigabyte of RAM for the 1GB-page sweep
+
+// --- Boot Page Tables (defined in boot.asm) ---
+// pd_table maps 0-1GB with 2MB pages (entry 0 points to pt_low_table instead),
+// pt_low_table maps 0-2MB with 4KB pages. RAM above 1GB is mapped with 1GB
+// pages, which keep their attributes here.
+extern uint64_t pd_table[512];
+extern uint64_t pt_low_table[512];
+
+// Page table entry bits used below.
+#define PTE_PWT     0x08 // Page-level write-through
+#define PTE_PCD     0x10 // Page-level cache disable
+#define PTE_PAT_4K  0x80 // PAT bit in a 4KB page table entry (same bit is PS in a PD entry)
+
+// Saved copies of the page tables so the original attributes can be restored.
+static uint64_t saved_pd_table[512];
+static uint64_t saved_pt_low_table[512];
+
+// --- Helper Function: flush_work ---
+// Writes back this CPU's caches and drops its TLB entries (ksmp_run_all work).
+static void flush_work(void* arg) {
+    (void)arg;
+    k_wbinvd();
+    k_write_cr3(k_read_cr3());
+}
+
+// --- Helper Function: set_legacy_uncached ---
+// Switches the boot identity map between the current attributes (RAM write-back,
+// VGA write-combining) and the old "PCD|PWT on every page" layout, so the same
+// code can be timed under both. The tables are shared by every CPU, so each
+// online CPU reloads CR3 to flush stale TLB entries and writes back its caches
+// because the memory type of cached lines changes; otherwise the APs would use
+// the old memory types for the same pages until their next flush.
+// Parameters:
+//   enable: 1 to switch to the legacy uncached layout, 0 to restore.
+static void set_legacy_uncached(int enable) {
+    if (enable) {
+        for (int i = 0; i < 512; i++) {
+            saved_pd_table[i] = pd_table[i];
+            saved_pt_low_table[i] = pt_low_table[i];
+            // PD entry 0 is a pointer to pt_low_table, not a 2MB page; leave it alone.
+            if (i != 0) {
+                pd_table[i] |= PTE_PCD | PTE_PWT;
+            }
+            pt_low_table[i] = (pt_low_table[i] & ~(uint64_t)PTE_PAT_4K) | PTE_PCD | PTE_PWT;
+        }
+    } else {
+        for (int i = 0; i < 512; i++) {
+            pd_table[i] = saved_pd_table[i];
+            pt_low_table[i] = saved_pt_low_table[i];
+        }
+    }
+    ksmp_run_all(flush_work, 0);
+}
+
+// --- Public Function: kbench_print_u64 ---
+// Prints an unsigned 64-bit value in decimal.
+void kbench_print_u64(uint64_t value, uint8_t color_attribute) {
+    char buf[21]; // 20 digits for 2^64-1 plus the null terminator
+    k_u64toa(value, buf, 10);
+    kprint(buf, color_attribute);
+}
+
+// --- Benchmark Loops ---
+// Each loop returns the average number of TSC cycles per iteration.
+
+#define BENCH_PRINT_ITERS 200
+#define BENCH_SCROLL_ITERS 200
+#define BENCH_ITOA_ITERS 100000
+
+// Times kprint_at of a 70-character line (70 VGA stores plus cursor updates).
+static uint64_t bench_kprint_loop(void) {
+    const char* line = "The quick brown fox jumps over the lazy dog. 0123456789 ABCDEFGHIJKLMN";
+    uint64_t start = k_rdtsc();
+    for (int i = 0; i < BENCH_PRINT_ITERS; i++) {
+        kprint_at(line, 0, 0, VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+    return (k_rdtsc() - start) / BENCH_PRINT_ITERS;
+}
+
+// Times a newline on the last row, which goes through scroll_screen().
+static uint64_t bench_scroll_loop(void) {
+    uint64_t start = k_rdtsc();
+    for (int i = 0; i < BENCH_SCROLL_ITERS; i++) {
+        kset_cursor_pos(0, kprint_rows() - 1);
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+    return (k_rdtsc() - start) / BENCH_SCROLL_ITERS;
+}
+
+// Times k_itoa on a spread of values; pure CPU/stack work with no MMIO.
+static uint64_t bench_itoa_loop(void) {
+    char buf[16];
+    volatile char sink = 0; // Keeps the compiler from discarding the conversions
+    uint64_t start = k_rdtsc();
+    for (int i = 0; i < BENCH_ITOA_ITERS; i++) {
+        k_itoa(i * 7919, buf, 10);
+        sink = buf[0];
+    }
+    (void)sink;
+    return (k_rdtsc() - start) / BENCH_ITOA_ITERS;
+}
+
+// --- Helper Function: print_result_row ---
+// Prints one "name  before  after  speedup" row of a before/after table.
+static void print_result_row(const char* name, uint64_t before, uint64_t after) {
+    kprint(name, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    for (int pad = k_strlen(name); pad < 26; pad++) {
+        kprint(" ", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+    kbench_print_u64(before, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" -> ", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+    kbench_print_u64(after, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" cycles/op  (x", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+    // Speedup with one decimal place, computed in fixed point.
+    uint64_t ratio10 = after ? (before * 10) / after : 0;
+    kbench_print_u64(ratio10 / 10, VGA_ATTRIB_GREEN_ON_BLACK);
+    kprint(".", VGA_ATTRIB_GREEN_ON_BLACK);
+    kbench_print_u64(ratio10 % 10, VGA_ATTRIB_GREEN_ON_BLACK);
+    kprint(")\n", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+}
+
+// --- Benchmark: bench_caching ---
+// Runs the kprint, scroll and k_itoa loops with the legacy all-uncached page
+// attributes ("before") and with write-back RAM + write-combining VGA ("after").
+static void bench_caching(void) {
+    uint64_t before[3], after[3];
+
+    set_legacy_uncached(1);
+    before[0] = bench_kprint_loop();
+    before[1] = bench_scroll_loop();
+    before[2] = bench_itoa_loop();
+    set_legacy_uncached(0);
+
+    after[0] = bench_kprint_loop();
+    after[1] = bench_scroll_loop();
+    after[2] = bench_itoa_loop();
+
+    kclear_screen();
+    kprint("--- Caching: legacy UC -> WB RAM + WC VGA ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    print_result_row("kprint_at (70 chars)", before[0], after[0]);
+    print_result_row("newline + scroll_screen", before[1], after[1]);
+    print_result_row("k_itoa", before[2], after[2]);
+}
+
+// --- Benchmark: bench_scrolling ---
+// Compares a stream of newlines with full-screen scrolling against CRTC
+// start-address scrolling. Enough lines are printed to include compactions.
+static void bench_scrolling(void) {
+    uint64_t copy_cycles, ring_cycles;
+
+    kprint_set_hw_scroll(0);
+    copy_cycles = bench_scroll_loop();
+    kprint_set_hw_scroll(1);
+    ring_cycles = bench_scroll_loop();
+
+    kclear_screen();
+    kprint("--- Scrolling: full copy -> CRTC start-address ring ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    print_result_row("newline + scroll_screen", copy_cycles, ring_cycles);
+}
+
+// --- Public Function: kbench_print_u64_padded ---
+// Prints a value right-aligned in a column of the given width.
+void kbench_print_u64_padded(uint64_t value, int width, uint8_t color_attribute) {
+    kprintf(color_attribute, "%*llu", width, (unsigned long long)value);
+}
+
+// --- Benchmark: bench_memory ---
+// Times k_memcpy, k_memset and k_strlen with each SIMD level the CPU supports.
+#define BENCH_MEM_BYTES 4096
+#define BENCH_MEM_ITERS 1000
+static uint8_t bench_src[BENCH_MEM_BYTES];
+static uint8_t bench_dst[BENCH_MEM_BYTES];
+static char bench_text[1024];
+
+static void bench_memory(void) {
+    static const char* level_names[] = { "scalar", "SSE2  ", "AVX2  " };
+    uint64_t results[3][3];
+    int best = k_simd_best_level();
+
+    k_memset(bench_text, 'x', sizeof(bench_text) - 1);
+    bench_text[sizeof(bench_text) - 1] = '\0';
+
+    for (int level = K_SIMD_SCALAR; level <= best; level++) {
+        k_simd_set_level(level);
+
+        uint64_t start = k_rdtsc();
+        for (int i = 0; i < BENCH_MEM_ITERS; i++) {
+            k_memcpy(bench_dst, bench_src, BENCH_MEM_BYTES);
+        }
+        results[level][0] = (k_rdtsc() - start) / BENCH_MEM_ITERS;
+
+        start = k_rdtsc();
+        for (int i = 0; i < BENCH_MEM_ITERS; i++) {
+            k_memset(bench_dst, i, BENCH_MEM_BYTES);
+        }
+        results[level][1] = (k_rdtsc() - start) / BENCH_MEM_ITERS;
+
+        volatile int sink = 0;
+        start = k_rdtsc();
+        for (int i = 0; i < BENCH_MEM_ITERS; i++) {
+            sink += k_strlen(bench_text);
+        }
+        results[level][2] = (k_rdtsc() - start) / BENCH_MEM_ITERS;
+        (void)sink;
+    }
+    k_simd_set_level(best);
+
+    kclear_screen();
+    kprint("--- Memory primitives (cycles/op) ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    kprint("level     memcpy 4K   memset 4K  strlen 1K\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    for (int level = K_SIMD_SCALAR; level <= best; level++) {
+        kprint(level_names[level], VGA_ATTRIB_WHITE_ON_BLACK);
+        for (int op = 0; op < 3; op++) {
+            kbench_print_u64_padded(results[level][op], 12, VGA_ATTRIB_WHITE_ON_BLACK);
+        }
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+}
+
+// --- Benchmark: bench_pmm ---
+// Shows the buddy allocator's free blocks per order and times allocate/free
+// pairs of 4KB and 2MB blocks.
+#define BENCH_PMM_ITERS 1000
+static void bench_pmm(void) {
+    uint64_t cycles[2] = { 0, 0 };
+    const int orders[2] = { KPMM_ORDER_4K, KPMM_ORDER_2M };
+
+    for (int t = 0; t < 2; t++) {
+        uint64_t start = k_rdtsc();
+        for (int i = 0; i < BENCH_PMM_ITERS; i++) {
+            uint64_t frame = kpmm_alloc(orders[t], KPMM_DIRECT_ONLY);
+            if (frame) {
+                kpmm_free(frame, orders[t]);
+            }
+        }
+        cycles[t] = (k_rdtsc() - start) / BENCH_PMM_ITERS;
+    }
+
+    kclear_screen();
+    kprint("--- Physical memory ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    kprint("Usable frames: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(kpmm_total_frames(), VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("   free: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(kpmm_free_frames(), VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("   (bitmap region: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(kpmm_bitmap_free_frames(), VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(")\n\norder  block size   free blocks\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    for (int order = 0; order <= KPMM_MAX_ORDER; order++) {
+        kbench_print_u64_padded(order, 5, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded((uint64_t)4 << order, 10, VGA_ATTRIB_WHITE_ON_BLACK);
+        kprint(" KB", VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(kpmm_free_blocks(order), 14, VGA_ATTRIB_WHITE_ON_BLACK);
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+    kprint("\nalloc+free 4KB: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(cycles[0], VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" cycles   alloc+free 2MB: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(cycles[1], VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" cycles\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+}
+
+// --- Benchmark: bench_heap ---
+// Times kmalloc/kfree pairs for a small and a large object, then prints the
+// per-class counters so hot sizes and slab usage can be read off directly.
+#define BENCH_HEAP_ITERS 10000
+static void bench_heap(void) {
+    const size_t sizes[3] = { 64, 1024, 8192 };
+    uint64_t cycles[3];
+
+    for (int t = 0; t < 3; t++) {
+        uint64_t start = k_rdtsc();
+        for (int i = 0; i < BENCH_HEAP_ITERS; i++) {
+            kfree(kmalloc(sizes[t]));
+        }
+        cycles[t] = (k_rdtsc() - start) / BENCH_HEAP_ITERS;
+    }
+
+    kclear_screen();
+    kprint("--- Kernel heap ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    kprint("  size      allocs       frees    live    peak  slabs\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    for (int c = 0; c <= KHEAP_NUM_CLASSES; c++) {
+        struct kheap_class_stats stats;
+        kheap_class_stats(c, &stats);
+        if (c == KHEAP_NUM_CLASSES) {
+            kprint(" large", VGA_ATTRIB_WHITE_ON_BLACK);
+        } else {
+            kbench_print_u64_padded(stats.size, 6, VGA_ATTRIB_WHITE_ON_BLACK);
+        }
+        kbench_print_u64_padded(stats.allocs, 12, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(stats.frees, 12, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(stats.live, 8, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(stats.peak, 8, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(stats.slabs, 7, VGA_ATTRIB_WHITE_ON_BLACK);
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+    kprint("\nArena: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(karena_used(), VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" of ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(karena_reserved(), VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" bytes used\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kprint("kmalloc+kfree 64B: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(cycles[0], VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("  1KB: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(cycles[1], VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("  8KB: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(cycles[2], VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" cycles\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+}
+
+// --- Benchmark: bench_vmm ---
+// Maps the same 8MB of RAM once with 4KB pages and once with 2MB pages and
+// times mapping, a read of every 4KB page (TLB misses) and unmapping. Then
+// measures the cost of a demand-zero page fault.
+#define BENCH_VMM_BYTES (8ULL * 1024 * 1024)
+#define BENCH_VMM_PHYS  0x400000ULL // Any 2MB-aligned RAM; it is only read
+#define BENCH_VMM_LAZY_PAGES 256
+static void bench_vmm(void) {
+    uint64_t cycles[2][3];
+    uint8_t* window = kvmm_alloc_lazy(BENCH_VMM_BYTES, 0); // Reserves 2MB-aligned address space
+
+    for (int large = 0; large < 2 && window; large++) {
+        int flags = large ? 0 : KVMM_SMALL_ONLY;
+        volatile uint8_t sink = 0;
+
+        uint64_t start = k_rdtsc();
+        kvmm_map((uint64_t)window, BENCH_VMM_PHYS, BENCH_VMM_BYTES, flags);
+        cycles[large][0] = k_rdtsc() - start;
+
+        start = k_rdtsc();
+        for (uint64_t offset = 0; offset < BENCH_VMM_BYTES; offset += KVMM_PAGE_4K) {
+            sink += window[offset];
+        }
+        cycles[large][1] = (k_rdtsc() - start) / (BENCH_VMM_BYTES / KVMM_PAGE_4K);
+        (void)sink;
+
+        start = k_rdtsc();
+        kvmm_unmap((uint64_t)window, BENCH_VMM_BYTES);
+        cycles[large][2] = k_rdtsc() - start;
+    }
+    kvmm_free_lazy(window);
+
+    // Demand-zero faults: every first write to a page traps into the VMM.
+    uint64_t fault_cycles = 0;
+    uint8_t* lazy = kvmm_alloc_lazy(BENCH_VMM_LAZY_PAGES * KVMM_PAGE_4K, KVMM_WRITE);
+    if (lazy) {
+        uint64_t start = k_rdtsc();
+        for (int i = 0; i < BENCH_VMM_LAZY_PAGES; i++) {
+            lazy[i * KVMM_PAGE_4K] = 1;
+        }
+        fault_cycles = (k_rdtsc() - start) / BENCH_VMM_LAZY_PAGES;
+        kvmm_free_lazy(lazy);
+    }
+
+    kclear_screen();
+    kprint("--- Virtual memory: 8MB window, 4KB vs 2MB pages ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    if (!window) {
+        kprint("No address space for the test window.\n", VGA_ATTRIB_RED_ON_BLACK);
+        return;
+    }
+    print_result_row("map 8MB (cycles total)", cycles[0][0], cycles[1][0]);
+    print_result_row("read one byte per 4KB", cycles[0][1], cycles[1][1]);
+    print_result_row("unmap 8MB (cycles total)", cycles[0][2], cycles[1][2]);
+
+    struct kvmm_stats stats;
+    kvmm_get_stats(&stats);
+    kprint("\nDemand-zero fault: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(fault_cycles, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" cycles/page\n1GB pages: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kprint(kvmm_has_1g_pages() ? "yes" : "no", VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("   tables: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(stats.tables, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("   splits: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(stats.splits, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("   lazy faults: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(stats.lazy_faults, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+}
+
+// --- Helper Function: usable_gigabyte ---
+// Finds a 1GB-aligned gigabyte above the first that the memory map reports as
+// usable RAM throughout (possibly as several adjacent entries). A 1GB page
+// over anything else would alias the VGA window, ROMs or MMIO with write-back
+// caching, which gives an undefined memory type, or would not be RAM at all.
+// Returns:
+//   Its physical address, or 0 if there is none.
+static uint64_t usable_gigabyte(void) {
+    const struct multiboot_tag_mmap* mmap =
+        (const struct multiboot_tag_mmap*)kmultiboot_find_tag(MULTIBOOT_TAG_TYPE_MMAP);
+    if (!mmap) {
+        return 0;
+    }
+    const uint8_t* first = (const uint8_t*)mmap + sizeof(*mmap);
+    const uint8_t* end = (const uint8_t*)mmap + mmap->size;
+    for (uint64_t gb = KVMM_PAGE_1G; gb + KVMM_PAGE_1G <= kpmm_max_phys(); gb += KVMM_PAGE_1G) {
+        uint64_t covered = gb; // Everything below this is known to be RAM
+        int advanced = 1;
+        while (covered < gb + KVMM_PAGE_1G && advanced) {
+            advanced = 0;
+            for (const uint8_t* entry = first; entry < end; entry += mmap->entry_size) {
+                const struct multiboot_mmap_entry* e = (const struct multiboot_mmap_entry*)entry;
+                if (e->type == MULTIBOOT_MEMORY_AVAILABLE && e->base_addr <= covered &&
+                    e->base_addr + e->length > covered) {
+                    covered = e->base_addr + e->length;
+                    advanced = 1;
+                }
+            }
+        }
+        if (covered >= gb + KVMM_PAGE_1G) {
+            return gb;
+        }
+    }
+    return 0;
+}
+
+// --- Benchmark: bench_tlb ---
+// Sweeps the RAM between 16MB and 1GB through a window mapped three ways:
+// with 4KB, 2MB and 1GB pages (the last only with PDPE1GB), the sizes the
+// boot direct map can use. One pass loads a byte from every 4KB page, so
+// with 4KB pages nearly every load needs a page walk; with 2MB pages one
+// walk serves 512 loads, and one 1GB page covers the whole sweep. A second
+// pass reads every cache line, as a large memcpy or checksum would.
+// A 1GB page cannot start at physical 0 without covering low memory, so that
+// case maps a gigabyte of RAM found in the memory map instead and sweeps the
+// same offsets in it; it is skipped on machines that have none.
+// The TLB miss counters of the PMU differ per CPU model (and QEMU's TCG has
+// none), so the table shows the translations each sweep needs instead.
+#define BENCH_TLB_START  0x1000000ULL // 16MB: past low memory and the kernel
+#define BENCH_TLB_PASSES 2
+static void bench_tlb(void) {
+    static const char* size_names[3] = { "4KB", "2MB", "1GB" };
+    static const uint64_t page_sizes[3] = { KVMM_PAGE_4K, KVMM_PAGE_2M, KVMM_PAGE_1G };
+    uint64_t page_cycles[3] = { 0, 0, 0 };
+    uint64_t line_cycles[3] = { 0, 0, 0 };
+
+    uint64_t end = kpmm_max_phys() < KVMM_PAGE_1G ? kpmm_max_phys() : KVMM_PAGE_1G;
+    end &= ~(KVMM_PAGE_2M - 1);
+    uint64_t length = end > BENCH_TLB_START ? end - BENCH_TLB_START : 0;
+    uint64_t pages = length / KVMM_PAGE_4K;
+
+    // 2GB of address space holds one 1GB-aligned gigabyte; the window shows
+    // physical address p at base + p.
+    uint8_t* region = length ? kvmm_alloc_lazy(2 * KVMM_PAGE_1G, 0) : 0;
+    uint8_t* base = (uint8_t*)(((uint64_t)region + KVMM_PAGE_1G - 1) & ~(KVMM_PAGE_1G - 1));
+
+    uint64_t gigabyte = kvmm_has_1g_pages() ? usable_gigabyte() : 0;
+    for (int size = 0; size < 3 && region; size++) {
+        // A 1GB page can only map a whole gigabyte: the one found above.
+        uint64_t map_start = size == 2 ? 0 : BENCH_TLB_START;
+        uint64_t map_phys = size == 2 ? gigabyte : BENCH_TLB_START;
+        uint64_t map_length = size == 2 ? KVMM_PAGE_1G : length;
+        if (size == 2 && !gigabyte) {
+            break;
+        }
+        if (kvmm_map((uint64_t)base + map_start, map_phys, map_length, size == 0 ? KVMM_SMALL_ONLY : 0) < 0) {
+            continue;
+        }
+
+        volatile uint8_t sink = 0;
+        const uint8_t* sweep = base + BENCH_TLB_START;
+        uint64_t start = k_rdtsc();
+        for (int pass = 0; pass < BENCH_TLB_PASSES; pass++) {
+            for (uint64_t offset = 0; offset < length; offset += KVMM_PAGE_4K) {
+                sink += sweep[offset];
+            }
+        }
+        page_cycles[size] = (k_rdtsc() - start) / (BENCH_TLB_PASSES * pages);
+
+        start = k_rdtsc();
+        for (int pass = 0; pass < BENCH_TLB_PASSES; pass++) {
+            for (uint64_t offset = 0; offset < length; offset += 64) {
+                sink += sweep[offset];
+            }
+        }
+        line_cycles[size] = (k_rdtsc() - start) / (BENCH_TLB_PASSES * pages);
+        (void)sink;
+
+        kvmm_unmap((uint64_t)base + map_start, map_length);
+    }
+    kvmm_free_lazy(region);
+
+    kclear_screen();
+    kprint("--- TLB: linear sweep with 4KB vs 2MB vs 1GB pages ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "Direct map: %k0-%lluGB%k, 1GB pages: %k%s%k, page tables at boot: %k%llu%k ns\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)(kpmm_direct_map_end() / KVMM_PAGE_1G),
+            VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, VGA_ATTRIB_WHITE_ON_BLACK, kvmm_has_1g_pages() ? "yes" : "no",
+            VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, VGA_ATTRIB_WHITE_ON_BLACK,
+            (unsigned long long)kboot_phase_ns(KBOOT_PAGE_TABLES), VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    if (!region) {
+        kprint("\nNot enough RAM above 16MB, or no address space for the window.\n", VGA_ATTRIB_RED_ON_BLACK);
+        return;
+    }
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "Sweep: %k%lluMB%k (16MB-%lluMB), %d passes\n\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)(length >> 20), VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+            (unsigned long long)(end >> 20), BENCH_TLB_PASSES);
+    kprint("page  translations  cycles/page (1 load)  cycles/4KB (every line)\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    for (int size = 0; size < 3; size++) {
+        if (!page_cycles[size]) {
+            kprintf(VGA_ATTRIB_WHITE_ON_BLACK, "%s   %k%s\n", size_names[size], VGA_ATTRIB_DARK_GREY_ON_BLACK,
+                    size == 2 && kvmm_has_1g_pages() && !gigabyte ? "(skipped: no aligned gigabyte of RAM above 1GB)"
+                                                                  : "(not available)");
+            continue;
+        }
+        uint64_t translations = (length + page_sizes[size] - 1) / page_sizes[size];
+        uint64_t ratio10 = page_cycles[0] * 10 / page_cycles[size];
+        kprintf(VGA_ATTRIB_WHITE_ON_BLACK, "%s   %12llu  %12llu %k(x%llu.%llu)%k  %24llu\n",
+                size_names[size], (unsigned long long)translations, (unsigned long long)page_cycles[size],
+                VGA_ATTRIB_GREEN_ON_BLACK, (unsigned long long)(ratio10 / 10), (unsigned long long)(ratio10 % 10),
+                VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)line_cycles[size]);
+    }
+}
+
+// --- Benchmark: bench_timer ---
+// Sleeps for a few target durations and reports how long each sleep really
+// took, measured with the calibrated TSC clock.
+#define BENCH_TIMER_RUNS 5
+static void bench_timer(void) {
+    static const uint64_t targets_us[3] = { 100, 1000, 10000 };
+    uint64_t average_ns[3], worst_ns[3];
+
+    for (int t = 0; t < 3; t++) {
+        uint64_t total = 0, worst = 0;
+        for (int run = 0; run < BENCH_TIMER_RUNS; run++) {
+            uint64_t start = ktime_ns();
+            ksleep_ns(targets_us[t] * 1000);
+            uint64_t elapsed = ktime_ns() - start;
+            total += elapsed;
+            if (elapsed > worst) {
+                worst = elapsed;
+            }
+        }
+        average_ns[t] = total / BENCH_TIMER_RUNS;
+        worst_ns[t] = worst;
+    }
+
+    kclear_screen();
+    kprint("--- Timer: sleep accuracy ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    kprint("TSC: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(ktime_tsc_hz() / 1000000, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" MHz", VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(ktime_tsc_invariant() ? " (invariant)" : " (not invariant)", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+    kprint("   timer: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kprint(ktime_timer_name(), VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("\n\n  target us   average us     worst us\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    for (int t = 0; t < 3; t++) {
+        kbench_print_u64_padded(targets_us[t], 11, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(average_ns[t] / 1000, 13, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(worst_ns[t] / 1000, 13, VGA_ATTRIB_WHITE_ON_BLACK);
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+}
+
+// --- Benchmark: bench_trace ---
+// Shows the hottest trace probes, then measures what an empty probe costs.
+#define BENCH_TRACE_ITERS 1000
+KTRACE_DEFINE(empty_probe, "empty probe");
+
+static void bench_trace(void) {
+    kclear_screen();
+    kprint("--- Trace: top probes by total time ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    kprint_batch_begin(); // Keep the report's own flushes out of the numbers
+    ktrace_dump_top(8);
+    kprint_batch_end();
+
+    // Empty begin/end pairs, minus the cost of the bare loop.
+    uint64_t start = k_rdtsc();
+    for (int i = 0; i < BENCH_TRACE_ITERS; i++) {
+        __asm__ volatile ("" : : : "memory");
+    }
+    uint64_t loop_cycles = k_rdtsc() - start;
+    start = k_rdtsc();
+    for (int i = 0; i < BENCH_TRACE_ITERS; i++) {
+        KTRACE_BEGIN(empty_probe);
+        __asm__ volatile ("" : : : "memory");
+        KTRACE_END(empty_probe);
+    }
+    uint64_t probe_cycles = k_rdtsc() - start;
+    ktrace_drain();
+
+    kprint("\nProbe overhead: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(probe_cycles > loop_cycles ? (probe_cycles - loop_cycles) / BENCH_TRACE_ITERS : 0,
+                     VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" cycles per begin/end pair\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+}
+
+// --- Benchmark: bench_serial ---
+// Measures what a kserial_write costs the caller while the ring has room,
+// and the end-to-end rate of a stream much larger than the ring.
+#define BENCH_SERIAL_BURST  2048
+#define BENCH_SERIAL_STREAM (32 * 1024)
+static void bench_serial(void) {
+    static const char line[64] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ\n";
+
+    kclear_screen();
+    kprint("--- Serial console (COM1) ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    if (!kserial_present()) {
+        kprint("No UART found on COM1.\n", VGA_ATTRIB_RED_ON_BLACK);
+        return;
+    }
+
+    kserial_flush();
+    uint64_t start = k_rdtsc();
+    for (int sent = 0; sent < BENCH_SERIAL_BURST; sent += sizeof(line)) {
+        kserial_write(line, sizeof(line));
+    }
+    uint64_t burst_cycles = k_rdtsc() - start;
+
+    struct kserial_stats before, after;
+    kserial_flush();
+    kserial_get_stats(&before);
+    uint64_t start_ns = ktime_ns();
+    for (int sent = 0; sent < BENCH_SERIAL_STREAM; sent += sizeof(line)) {
+        kserial_write(line, sizeof(line));
+    }
+    kserial_flush();
+    uint64_t elapsed_ns = ktime_ns() - start_ns;
+    kserial_get_stats(&after);
+
+    uint64_t bytes = after.bytes_sent - before.bytes_sent; // Includes the CRs added for '\n'
+    kprint("Caller cost, ring not full: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(burst_cycles / BENCH_SERIAL_BURST, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" cycles/byte\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kprint("Stream of ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(bytes, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" bytes: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(elapsed_ns ? bytes * KTIME_NS_PER_S / elapsed_ns : 0, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" bytes/s\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kprint("THRE interrupts: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(after.interrupts - before.interrupts, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("   bytes per interrupt: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(after.interrupts > before.interrupts ? bytes / (after.interrupts - before.interrupts) : 0,
+                     VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("   ring-full waits: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(after.full_waits - before.full_waits, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+}
+
+// --- Benchmark: bench_smp ---
+// Runs the same counting loop on every CPU at once (each CPU reports its own
+// result with a single kprint, so lines never interleave), then times the
+// wake-up round trip to each AP: IPI, run an empty function, see it finish.
+#define BENCH_SMP_LOOP   (1 << 22)
+#define BENCH_SMP_ROUNDS 1000
+
+static void smp_count_work(void* arg) {
+    (void)arg;
+    struct ksmp_cpu* cpu = ksmp_this_cpu();
+    uint64_t start = k_rdtsc();
+    volatile uint64_t sum = 0; // volatile: the loop is the point
+    for (uint64_t i = 0; i < BENCH_SMP_LOOP; i++) {
+        sum += i;
+    }
+    uint64_t cycles = k_rdtsc() - start;
+
+    char line[64];
+    char number[24];
+    k_strcpy(line, "  CPU ");
+    k_itoa((int)cpu->index, number, 10);
+    k_strcpy(line + k_strlen(line), number);
+    k_strcpy(line + k_strlen(line), " (APIC ");
+    k_itoa((int)cpu->apic_id, number, 10);
+    k_strcpy(line + k_strlen(line), number);
+    k_strcpy(line + k_strlen(line), "): loop took ");
+    k_itoa((int)(cycles / 1000), number, 10);
+    k_strcpy(line + k_strlen(line), number);
+    k_strcpy(line + k_strlen(line), "K cycles\n");
+    kprint(line, VGA_ATTRIB_WHITE_ON_BLACK);
+}
+
+static void smp_empty_work(void* arg) {
+    (void)arg;
+}
+
+static void bench_smp(void) {
+    kclear_screen();
+    kprint("--- CPUs ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    kprint("Online: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(ksmp_cpu_count(), VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" of ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(ksmp_cpus_found(), VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint(" listed in the MADT\n\nCounting loop on every CPU at once:\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    ksmp_run_all(smp_count_work, 0);
+
+    if (ksmp_cpu_count() < 2) {
+        kprint("\nNo application processors: nothing to wake up.\n", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+        return;
+    }
+    kprint("\nWake-up round trip (IPI, run, done), average of ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(BENCH_SMP_ROUNDS, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kprint(":\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    for (int i = 1; i < KSMP_MAX_CPUS; i++) {
+        if (!ksmp_cpu(i)->online) {
+            continue;
+        }
+        uint64_t start = k_rdtsc();
+        for (int round = 0; round < BENCH_SMP_ROUNDS; round++) {
+            ksmp_run_on(i, smp_empty_work, 0);
+            ksmp_wait(i);
+        }
+        uint64_t cycles = (k_rdtsc() - start) / BENCH_SMP_ROUNDS;
+        kprint("  CPU ", VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64(i, VGA_ATTRIB_WHITE_ON_BLACK);
+        kprint(": ", VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64(cycles, VGA_ATTRIB_GREEN_ON_BLACK);
+        kprint(" cycles (", VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64(ktime_cycles_to_ns(cycles), VGA_ATTRIB_GREEN_ON_BLACK);
+        kprint(" ns)\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+}
+
+// --- Benchmark: bench_jobs ---
+// Runs the parallel kernels over a 16MB array with the job pool limited to
+// 1, 2, ... N CPUs and prints each time with its speedup over one CPU (best
+// of a few runs, so a stray interrupt does not decide the result). Summing
+// and filling 16MB is bound by memory bandwidth, so the curve flattens once
+// the CPUs saturate it; under QEMU TCG it also depends on the host threads.
+#define BENCH_JOBS_COUNT (4 * 1024 * 1024) // ints
+#define BENCH_JOBS_RUNS  3
+
+static void print_speedup_cell(uint64_t base, uint64_t cycles) {
+    kbench_print_u64_padded(cycles / 1000, 9, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint("K x", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+    uint64_t ratio100 = cycles ? (base * 100) / cycles : 0;
+    kbench_print_u64(ratio100 / 100, VGA_ATTRIB_GREEN_ON_BLACK);
+    kprint(ratio100 % 100 < 10 ? ".0" : ".", VGA_ATTRIB_GREEN_ON_BLACK);
+    kbench_print_u64(ratio100 % 100, VGA_ATTRIB_GREEN_ON_BLACK);
+}
+
+// A plain fill through kjob_parallel_for, in 64-byte blocks so neighbouring
+// slices never share a cache line: one CPU reaches a good share of the
+// memory bandwidth, several keep more stores in flight.
+#define BENCH_FILL_GRAIN (256 * 1024) // Bytes per slice
+
+static void fill_range(uint64_t begin, uint64_t end, void* arg) {
+    k_memset((uint8_t*)arg + begin * 64, 0, (end - begin) * 64);
+}
+
+static void bench_jobs(void) {
+    kclear_screen();
+    kprint("--- Job pool: speedup over one CPU, 16MB array ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    int* numbers = kvmm_alloc_lazy((uint64_t)BENCH_JOBS_COUNT * sizeof(int), KVMM_WRITE);
+    if (!numbers) {
+        kprint("No memory for the test array.\n", VGA_ATTRIB_RED_ON_BLACK);
+        return;
+    }
+    for (int i = 0; i < BENCH_JOBS_COUNT; i++) {
+        numbers[i] = (i & 1) ? 1 : 3; // Faults every page in on this CPU first
+    }
+    int expected_sum = k_add_n(numbers, BENCH_JOBS_COUNT);
+
+    kprint("CPUs         k_add_n    k_multiply_n      clear 16MB\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    uint64_t base[3] = { 0, 0, 0 };
+    int consistent = 1;
+    for (int cpus = 1; cpus <= ksmp_cpu_count(); cpus++) {
+        kjob_set_max_cpus(cpus);
+        uint64_t best[3] = { ~0ULL, ~0ULL, ~0ULL };
+        for (int run = 0; run < BENCH_JOBS_RUNS; run++) {
+            uint64_t start = k_rdtsc();
+            if (k_add_n(numbers, BENCH_JOBS_COUNT) != expected_sum) {
+                consistent = 0;
+            }
+            uint64_t cycles = k_rdtsc() - start;
+            best[0] = cycles < best[0] ? cycles : best[0];
+
+            start = k_rdtsc();
+            (void)k_multiply_n(numbers, BENCH_JOBS_COUNT);
+            cycles = k_rdtsc() - start;
+            best[1] = cycles < best[1] ? cycles : best[1];
+
+            start = k_rdtsc();
+            kjob_parallel_for(0, (uint64_t)BENCH_JOBS_COUNT * sizeof(int) / 64, BENCH_FILL_GRAIN / 64, fill_range, numbers);
+            cycles = k_rdtsc() - start;
+            best[2] = cycles < best[2] ? cycles : best[2];
+            for (int i = 0; i < BENCH_JOBS_COUNT; i++) {
+                numbers[i] = (i & 1) ? 1 : 3; // Restore for the next run
+            }
+        }
+        if (cpus == 1) {
+            base[0] = best[0];
+            base[1] = best[1];
+            base[2] = best[2];
+        }
+        kbench_print_u64_padded(cpus, 4, VGA_ATTRIB_WHITE_ON_BLACK);
+        for (int kernel = 0; kernel < 3; kernel++) {
+            print_speedup_cell(base[kernel], best[kernel]);
+        }
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+    kjob_set_max_cpus(0);
+    kvmm_free_lazy(numbers);
+
+    kprint(consistent ? "\nSums match the one-CPU result.\n" : "\nSUM MISMATCH between CPU counts!\n",
+           consistent ? VGA_ATTRIB_GREEN_ON_BLACK : VGA_ATTRIB_RED_ON_BLACK);
+    kprint("Jobs run / stolen per CPU:", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    for (int cpu = 0; cpu < ksmp_cpu_count(); cpu++) {
+        struct kjob_stats stats;
+        kjob_get_stats(cpu, &stats);
+        kprint(" ", VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64(stats.executed, VGA_ATTRIB_WHITE_ON_BLACK);
+        kprint("/", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+        kbench_print_u64(stats.stolen, VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+    kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+}
+
+// --- Benchmark: bench_threads ---
+// Lists the threads with their CPU time, then measures switching with a
+// partner thread at the menu's priority:
+//   yield:      both threads call kthread_yield() in turn; one round is two
+//               switches, so half a round is the cost of one switch. Neither
+//               thread touches the FPU, so its state is never moved.
+//   block/wake: each thread wakes the other and blocks on its own wait
+//               queue, the path a thread woken by an interrupt goes through.
+//   yield, SSE: as yield, but both threads also clear a buffer with the SIMD
+//               k_memset, so every switch takes the #NM trap and saves and
+//               loads the FPU/SSE/AVX state: what every switch cost before
+//               the state was switched lazily.
+#define BENCH_THREAD_ROUNDS 10000
+#define BENCH_THREAD_LIST   16
+
+static volatile int thread_bench_mode = 0; // 0: stop, 1: yield, 2: block/wake, 3: yield using SSE
+static struct kthread_waitq thread_bench_ping = KTHREAD_WAITQ_INIT;
+static struct kthread_waitq thread_bench_pong = KTHREAD_WAITQ_INIT;
+
+static void thread_bench_partner(void* arg) {
+    (void)arg;
+    uint8_t buffer[64];
+    while (thread_bench_mode == 1) {
+        kthread_yield();
+    }
+    while (thread_bench_mode == 2) {
+        k_disable_interrupts();
+        kthread_wake_all(&thread_bench_ping);
+        kthread_wait(&thread_bench_pong);
+        k_enable_interrupts();
+    }
+    while (thread_bench_mode == 3) {
+        k_memset(buffer, 0, sizeof(buffer));
+        kthread_yield();
+    }
+}
+
+static void bench_threads(void) {
+    kclear_screen();
+    kprint("--- Threads ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    if (!kthread_running()) {
+        kprint("The scheduler is not running.\n", VGA_ATTRIB_RED_ON_BLACK);
+        return;
+    }
+
+    struct kthread_info threads[BENCH_THREAD_LIST];
+    int count = kthread_list(threads, BENCH_THREAD_LIST);
+    kprint("Thread          prio  state        CPU ms  switches  FPU loads\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    for (int i = 0; i < count; i++) {
+        kprint(threads[i].name, VGA_ATTRIB_WHITE_ON_BLACK);
+        for (int pad = k_strlen(threads[i].name); pad < 16; pad++) {
+            kprint(" ", VGA_ATTRIB_WHITE_ON_BLACK);
+        }
+        kbench_print_u64_padded(threads[i].priority, 4, VGA_ATTRIB_WHITE_ON_BLACK);
+        kprint("  ", VGA_ATTRIB_WHITE_ON_BLACK);
+        const char* state = kthread_state_name(threads[i].state);
+        kprint(state, VGA_ATTRIB_WHITE_ON_BLACK);
+        for (int pad = k_strlen(state); pad < 9; pad++) {
+            kprint(" ", VGA_ATTRIB_WHITE_ON_BLACK);
+        }
+        kbench_print_u64_padded(threads[i].runtime_ns / KTIME_NS_PER_MS, 9, VGA_ATTRIB_GREEN_ON_BLACK);
+        kbench_print_u64_padded(threads[i].switches, 10, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(threads[i].fpu_loads, 11, VGA_ATTRIB_WHITE_ON_BLACK);
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+
+    uint64_t cycles[3] = { 0, 0, 0 };
+    uint8_t buffer[64];
+    for (int mode = 1; mode <= 3; mode++) {
+        thread_bench_mode = mode;
+        struct kthread* partner = kthread_create("bench partner", thread_bench_partner, 0, KTHREAD_PRIO_HIGH);
+        if (!partner) {
+            thread_bench_mode = 0;
+            kprint("\nNo memory for the partner thread.\n", VGA_ATTRIB_RED_ON_BLACK);
+            return;
+        }
+        kthread_yield(); // Let the partner reach its loop
+        uint64_t start = k_rdtsc();
+        for (int round = 0; round < BENCH_THREAD_ROUNDS; round++) {
+            if (mode == 1) {
+                kthread_yield();
+            } else if (mode == 3) {
+                k_memset(buffer, 0, sizeof(buffer));
+                kthread_yield();
+            } else {
+                k_disable_interrupts();
+                kthread_wake_all(&thread_bench_pong);
+                kthread_wait(&thread_bench_ping);
+                k_enable_interrupts();
+            }
+        }
+        cycles[mode - 1] = (k_rdtsc() - start) / (2 * BENCH_THREAD_ROUNDS);
+        thread_bench_mode = 0;
+        kthread_wake_all(&thread_bench_pong); // Release it from its last wait
+        kthread_join(partner);
+    }
+
+    kprint("\nOne context switch, average of ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kbench_print_u64(2 * BENCH_THREAD_ROUNDS, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kprint(":\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    static const char* labels[3] = { "  kthread_yield:     ", "  block and wake:    ", "  yield, using SSE:  " };
+    for (int mode = 0; mode < 3; mode++) {
+        kprint(labels[mode], VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64(cycles[mode], VGA_ATTRIB_GREEN_ON_BLACK);
+        kprint(" cycles (", VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64(ktime_cycles_to_ns(cycles[mode]), VGA_ATTRIB_GREEN_ON_BLACK);
+        kprint(" ns)\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+}
+
+// --- Benchmark: bench_convert ---
+// The original int-only k_itoa/k_atoi against the table-driven 64-bit
+// conversions, on the same values: 1 to 10 digits, mixed signs.
+#define BENCH_CONVERT_VALUES 256
+#define BENCH_CONVERT_ROUNDS 200
+
+static int convert_values[BENCH_CONVERT_VALUES];
+static char convert_strings[BENCH_CONVERT_VALUES][12];
+
+static void bench_convert(void) {
+    kclear_screen();
+    kprint("--- Integer conversion: k_itoa/k_atoi vs 64-bit table-driven ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+
+    uint32_t seed = 12345;
+    for (int i = 0; i < BENCH_CONVERT_VALUES; i++) {
+        seed = seed * 1664525 + 1013904223; // LCG
+        int value = (int)((seed >> 1) >> (i % 31)); // Spread over every digit count
+        convert_values[i] = (i & 1) ? -value : value;
+        k_i64toa(convert_values[i], convert_strings[i], 10);
+    }
+
+    char buf[24];
+    volatile char char_sink = 0; // Keeps the compiler from discarding the conversions
+    volatile int64_t value_sink = 0;
+    const uint64_t ops = (uint64_t)BENCH_CONVERT_VALUES * BENCH_CONVERT_ROUNDS;
+
+    uint64_t start = k_rdtsc();
+    for (int r = 0; r < BENCH_CONVERT_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_CONVERT_VALUES; i++) {
+            k_itoa(convert_values[i], buf, 10);
+            char_sink = buf[0];
+        }
+    }
+    uint64_t itoa_cycles = (k_rdtsc() - start) / ops;
+
+    start = k_rdtsc();
+    for (int r = 0; r < BENCH_CONVERT_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_CONVERT_VALUES; i++) {
+            k_i64toa(convert_values[i], buf, 10);
+            char_sink = buf[0];
+        }
+    }
+    uint64_t i64toa_cycles = (k_rdtsc() - start) / ops;
+
+    start = k_rdtsc();
+    for (int r = 0; r < BENCH_CONVERT_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_CONVERT_VALUES; i++) {
+            value_sink = k_atoi(convert_strings[i]);
+        }
+    }
+    uint64_t atoi_cycles = (k_rdtsc() - start) / ops;
+
+    start = k_rdtsc();
+    for (int r = 0; r < BENCH_CONVERT_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_CONVERT_VALUES; i++) {
+            int64_t value;
+            k_parse_i64(convert_strings[i], 0, 10, &value);
+            value_sink = value;
+        }
+    }
+    uint64_t parse_cycles = (k_rdtsc() - start) / ops;
+
+    // Full-width 64-bit values, which k_itoa cannot convert at all.
+    start = k_rdtsc();
+    for (int r = 0; r < BENCH_CONVERT_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_CONVERT_VALUES; i++) {
+            k_u64toa(0xFFFFFFFF00000000ULL | (uint32_t)convert_values[i], buf, 10);
+            char_sink = buf[0];
+        }
+    }
+    uint64_t u64_dec_cycles = (k_rdtsc() - start) / ops;
+
+    start = k_rdtsc();
+    for (int r = 0; r < BENCH_CONVERT_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_CONVERT_VALUES; i++) {
+            k_u64toa(0xFFFFFFFF00000000ULL | (uint32_t)convert_values[i], buf, 16);
+            char_sink = buf[0];
+        }
+    }
+    uint64_t u64_hex_cycles = (k_rdtsc() - start) / ops;
+    (void)char_sink;
+    (void)value_sink;
+
+    print_result_row("k_itoa -> k_i64toa", itoa_cycles, i64toa_cycles);
+    print_result_row("k_atoi -> k_parse_i64", atoi_cycles, parse_cycles);
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "\n20-digit k_u64toa:       %k%llu%k cycles/op (base 10), %k%llu%k (base 16)\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)u64_dec_cycles, VGA_ATTRIB_DARK_GREY_ON_BLACK,
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)u64_hex_cycles, VGA_ATTRIB_DARK_GREY_ON_BLACK);
+}
+
+// --- Benchmark: bench_bignum ---
+// kbignum_mul with Karatsuba switched off (threshold beyond any size) and
+// at the default threshold, for operands around and above it; then the
+// calculator's big jobs: 200! and 500! and their decimal conversion.
+#define BENCH_BIGNUM_ROUNDS 20
+
+static struct kbignum bignum_a, bignum_b, bignum_r;
+static char bignum_text[KBIGNUM_STRING_SIZE];
+
+static uint64_t bignum_mul_cycles(void) {
+    uint64_t start = k_rdtsc();
+    for (int i = 0; i < BENCH_BIGNUM_ROUNDS; i++) {
+        kbignum_mul(&bignum_r, &bignum_a, &bignum_b);
+    }
+    return (k_rdtsc() - start) / BENCH_BIGNUM_ROUNDS;
+}
+
+static void bench_bignum(void) {
+    static const int sizes[3] = { 16, 32, 64 }; // Limbs per operand
+    static const char* labels[3] = { "mul 16 x 16 limbs", "mul 32 x 32 limbs", "mul 64 x 64 limbs" };
+
+    kclear_screen();
+    kprint("--- Bignum: schoolbook vs Karatsuba, factorials ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+
+    uint32_t seed = 2463534242u;
+    for (int s = 0; s < 3; s++) {
+        for (int i = 0; i < sizes[s]; i++) {
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5; // xorshift32
+            bignum_a.limb[i] = seed;
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            bignum_b.limb[i] = seed | 1;
+        }
+        bignum_a.limb[sizes[s] - 1] |= 1; // Keep the top limbs nonzero
+        bignum_b.limb[sizes[s] - 1] |= 1;
+        bignum_a.used = bignum_b.used = sizes[s];
+        bignum_a.negative = bignum_b.negative = 0;
+
+        kbignum_set_karatsuba_threshold(KBIGNUM_LIMBS + 1);
+        uint64_t schoolbook = bignum_mul_cycles();
+        kbignum_set_karatsuba_threshold(KBIGNUM_KARATSUBA_THRESHOLD);
+        uint64_t karatsuba = bignum_mul_cycles();
+        print_result_row(labels[s], schoolbook, karatsuba);
+    }
+
+    static const uint32_t factorials[2] = { 200, 500 };
+    kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    for (int f = 0; f < 2; f++) {
+        uint64_t start = k_rdtsc();
+        kbignum_factorial(&bignum_r, factorials[f]);
+        uint64_t compute = k_rdtsc() - start;
+        start = k_rdtsc();
+        int digits = kbignum_to_string(&bignum_r, bignum_text, sizeof(bignum_text));
+        uint64_t convert = k_rdtsc() - start;
+        kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "%u! (%k%d%k digits): %k%llu%k us, to decimal %k%llu%k us\n",
+                factorials[f], VGA_ATTRIB_WHITE_ON_BLACK, digits, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+                VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)(ktime_cycles_to_ns(compute) / 1000),
+                VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+                VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)(ktime_cycles_to_ns(convert) / 1000),
+                VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    }
+}
+
+// --- Benchmark: bench_expr ---
+// The calculator's expression VM on one polynomial: compiled without and
+// with constant folding, evaluated one call per x and in batch mode
+// (kexpr_eval_range), and exactly in kbignum as the calculator runs it.
+#define BENCH_EXPR_SOURCE "(2+3)*x^2 + 4*5*x - 7"
+#define BENCH_EXPR_COUNT 1024
+#define BENCH_EXPR_ROUNDS 20
+#define BENCH_EXPR_BIGNUM_COUNT 64
+
+static struct kexpr_program expr_plain, expr_folded;
+static int64_t expr_results[BENCH_EXPR_COUNT];
+
+// Cycles per evaluation of 'program' for x = 0 .. BENCH_EXPR_COUNT - 1, one call each.
+static uint64_t expr_call_cycles(const struct kexpr_program* program) {
+    uint64_t start = k_rdtsc();
+    for (int r = 0; r < BENCH_EXPR_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_EXPR_COUNT; i++) {
+            kexpr_eval(program, i, &expr_results[i]);
+        }
+    }
+    return (k_rdtsc() - start) / ((uint64_t)BENCH_EXPR_COUNT * BENCH_EXPR_ROUNDS);
+}
+
+static void bench_expr(void) {
+    kclear_screen();
+    kprint("--- Expressions: bytecode VM, constant folding, batch mode ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+
+    kexpr_set_folding(0);
+    int status = kexpr_compile(&expr_plain, BENCH_EXPR_SOURCE, 0);
+    kexpr_set_folding(1);
+    if (status != KEXPR_OK || kexpr_compile(&expr_folded, BENCH_EXPR_SOURCE, 0) != KEXPR_OK) {
+        kprint("Compiling the test expression failed.\n", VGA_ATTRIB_RED_ON_BLACK);
+        return;
+    }
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "%s%k: %k%d%k bytes of code unfolded, %k%d%k folded\n\n",
+            BENCH_EXPR_SOURCE, VGA_ATTRIB_DARK_GREY_ON_BLACK,
+            VGA_ATTRIB_WHITE_ON_BLACK, expr_plain.length, VGA_ATTRIB_DARK_GREY_ON_BLACK,
+            VGA_ATTRIB_WHITE_ON_BLACK, expr_folded.length, VGA_ATTRIB_DARK_GREY_ON_BLACK);
+
+    uint64_t plain = expr_call_cycles(&expr_plain);
+    uint64_t folded = expr_call_cycles(&expr_folded);
+
+    uint64_t start = k_rdtsc();
+    int failures = 0;
+    for (int r = 0; r < BENCH_EXPR_ROUNDS; r++) {
+        failures += kexpr_eval_range(&expr_folded, 0, BENCH_EXPR_COUNT, expr_results);
+    }
+    uint64_t batch_total = k_rdtsc() - start;
+    uint64_t batch = batch_total / ((uint64_t)BENCH_EXPR_COUNT * BENCH_EXPR_ROUNDS);
+
+    print_result_row("eval: unfolded -> folded", plain, folded);
+    print_result_row("eval: per call -> batch", folded, batch);
+
+    // Evaluations per second in batch mode, from the calibrated clock.
+    uint64_t batch_ns = ktime_cycles_to_ns(batch_total);
+    uint64_t per_second = batch_ns ? (uint64_t)BENCH_EXPR_COUNT * BENCH_EXPR_ROUNDS * 1000000000ULL / batch_ns : 0;
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "\nBatch: %k%llu%k evaluations/s%k (%d failed)\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)per_second, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+            VGA_ATTRIB_DARK_GREY_ON_BLACK, failures);
+
+    // The calculator's exact path: the same program, one kbignum per value.
+    static struct kbignum x, result;
+    start = k_rdtsc();
+    for (int i = 0; i < BENCH_EXPR_BIGNUM_COUNT; i++) {
+        kbignum_from_i64(&x, i);
+        kexpr_eval_bignum(&expr_folded, &x, &result);
+    }
+    uint64_t exact = (k_rdtsc() - start) / BENCH_EXPR_BIGNUM_COUNT;
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "Exact (kbignum, as the calculator): %k%llu%k cycles/op\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)exact, VGA_ATTRIB_DARK_GREY_ON_BLACK);
+}
+
+// --- Benchmark: bench_float ---
+// kfloat_format on random doubles over a wide range of exponents, then
+// kfloat_parse on short decimals ("123.456", where Clinger's fast path
+// applies) with the fast path off and on, and on the strings just printed,
+// which mostly need 16 or 17 digits and so take the exact path. The parsed strings must give back
+// the same bits. The doubles are built from their bits and only ever passed
+// by pointer: this file is compiled without SSE.
+#define BENCH_FLOAT_VALUES 256
+#define BENCH_FLOAT_ROUNDS 20
+
+static union { uint64_t bits; double value; } float_values[BENCH_FLOAT_VALUES], float_parsed[BENCH_FLOAT_VALUES];
+static char float_strings[BENCH_FLOAT_VALUES][KFLOAT_STRING_SIZE];
+static char float_short[BENCH_FLOAT_VALUES][KFLOAT_STRING_SIZE];
+
+// Cycles per kfloat_parse of strings[0 .. BENCH_FLOAT_VALUES).
+static uint64_t float_parse_cycles(char strings[][KFLOAT_STRING_SIZE]) {
+    uint64_t start = k_rdtsc();
+    for (int r = 0; r < BENCH_FLOAT_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_FLOAT_VALUES; i++) {
+            kfloat_parse(strings[i], 0, &float_parsed[i].value);
+        }
+    }
+    return (k_rdtsc() - start) / ((uint64_t)BENCH_FLOAT_VALUES * BENCH_FLOAT_ROUNDS);
+}
+
+static void bench_float(void) {
+    kclear_screen();
+    kprint("--- Floating point: Grisu2 formatting, Clinger parsing ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+
+    uint32_t seed = 88172645u;
+    for (int i = 0; i < BENCH_FLOAT_VALUES; i++) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5; // xorshift32
+        uint64_t mantissa = (uint64_t)seed << 20;
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        uint64_t exponent = 1023 - 100 + seed % 201; // About 1e-30 to 1e30
+        float_values[i].bits = ((uint64_t)(i & 1) << 63) | (exponent << 52) | (mantissa & 0xFFFFFFFFFFFFFULL);
+        ksnprintf(float_short[i], sizeof(float_short[i]), "%u.%03u", seed % 100000, (seed >> 8) % 1000);
+    }
+
+    const uint64_t ops = (uint64_t)BENCH_FLOAT_VALUES * BENCH_FLOAT_ROUNDS;
+    uint64_t start = k_rdtsc();
+    for (int r = 0; r < BENCH_FLOAT_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_FLOAT_VALUES; i++) {
+            kfloat_format(&float_values[i].value, float_strings[i], KFLOAT_STRING_SIZE);
+        }
+    }
+    uint64_t format_total = k_rdtsc() - start;
+    uint64_t format_cycles = format_total / ops;
+
+    kfloat_set_fast_path(0);
+    uint64_t short_exact = float_parse_cycles(float_short);
+    kfloat_set_fast_path(1);
+    uint64_t short_fast = float_parse_cycles(float_short);
+
+    uint64_t long_cycles = float_parse_cycles(float_strings);
+    int mismatches = 0;
+    for (int i = 0; i < BENCH_FLOAT_VALUES; i++) {
+        if (float_parsed[i].bits != float_values[i].bits) {
+            mismatches++;
+        }
+    }
+
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "e.g. %k%s%k and %k%s%k\n\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, float_strings[0], VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+            VGA_ATTRIB_WHITE_ON_BLACK, float_short[0], VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    print_result_row("parse short: exact -> fast", short_exact, short_fast);
+
+    uint64_t format_ns = ktime_cycles_to_ns(format_total);
+    uint64_t per_second = format_ns ? ops * 1000000000ULL / format_ns : 0;
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "\nkfloat_format:          %k%llu%k cycles/op, %k%llu%k conversions/s\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)format_cycles, VGA_ATTRIB_DARK_GREY_ON_BLACK,
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)per_second, VGA_ATTRIB_DARK_GREY_ON_BLACK);
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "parse shortest output:  %k%llu%k cycles/op, %k%d%k round-trip mismatches\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)long_cycles, VGA_ATTRIB_DARK_GREY_ON_BLACK,
+            mismatches ? VGA_ATTRIB_RED_ON_BLACK : VGA_ATTRIB_WHITE_ON_BLACK, mismatches, VGA_ATTRIB_DARK_GREY_ON_BLACK);
+}
+
+// --- Benchmark: bench_ui ---
+// A calculator-like screen (display label, 6x4 keypad) drawn with kui while
+// the highlight walks over every button: once with every frame a redraw_all
+// frame, which is what the screens did before kui (repaint everything on
+// each key), and once with damage tracking. Each step also changes the
+// display text by one character, like typing.
+#define BENCH_UI_ROUNDS 10
+
+static const char* ui_layout[6 * 4] = {
+    "7", "8", "9", "/",  "4", "5", "6", "*",  "1", "2", "3", "-",
+    "0", ".", "=", "+",  "(", ")", "^", "%",  "C", "Q", "!", "<",
+};
+static struct kui_label ui_display;
+static struct kui_grid ui_grid;
+
+// Walks the highlight BENCH_UI_ROUNDS times over the keypad.
+// Returns:
+//   Cycles per frame; *cells receives the cells written per frame.
+static uint64_t ui_walk(int redraw_all, uint64_t* cells) {
+    char text[8] = "0000000";
+    uint64_t written = 0;
+    int frames = 0;
+    uint64_t start = k_rdtsc();
+    for (int r = 0; r < BENCH_UI_ROUNDS; r++) {
+        for (int i = 0; i < 6 * 4; i++, frames++) {
+            text[frames % 7] = (char)('0' + (frames % 10));
+            kui_label_set(&ui_display, text);
+            kui_grid_select(&ui_grid, i % 4, i / 4);
+            kui_frame_begin(redraw_all);
+            kui_label_draw(&ui_display);
+            kui_grid_draw(&ui_grid);
+            written += (uint64_t)kui_frame_end();
+        }
+    }
+    uint64_t cycles = k_rdtsc() - start;
+    *cells = written / (uint64_t)frames;
+    return cycles / (uint64_t)frames;
+}
+
+static void bench_ui(void) {
+    kclear_screen();
+    kui_label_init(&ui_display, 20, 3, 31, VGA_ATTRIB_YELLOW_ON_BLACK);
+    kui_grid_init(&ui_grid, 20, 5, 6, 4, 3, 4, ui_layout, VGA_ATTRIB_WHITE_ON_BLACK, VGA_ATTRIB_BLACK_ON_WHITE);
+
+    uint64_t full_cells, tracked_cells;
+    uint64_t full = ui_walk(1, &full_cells);
+    uint64_t tracked = ui_walk(0, &tracked_cells);
+
+    struct kui_stats stats;
+    kui_get_stats(&stats);
+
+    kclear_screen();
+    kprint("--- UI: full redraw -> damage tracking ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    print_result_row("frame (key press)", full, tracked);
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "cells written per frame   %k%llu%k -> %k%llu\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)full_cells, VGA_ATTRIB_DARK_GREY_ON_BLACK,
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)tracked_cells);
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "\nSince boot: %k%llu%k frames, %k%llu%k cells written\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)stats.frames, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)stats.cells, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+}
+
+// --- Benchmark: bench_console ---
+// Characters per second through the console, in the two ways the kernel
+// prints: a stream of full lines, each of which scrolls the screen, and
+// repainting the screen in place with kprint_at (a batch per frame, like the
+// menus). On the framebuffer console both run without and with the glyph
+// cache; in VGA text mode there is only the one path.
+#define BENCH_CONSOLE_LINES  100
+#define BENCH_CONSOLE_FRAMES 20
+#define BENCH_CONSOLE_WIDTH  (VGA_WIDTH - 1) // A full line that does not wrap
+
+static char console_lines[2][BENCH_CONSOLE_WIDTH + 2];
+
+// Prints BENCH_CONSOLE_LINES lines from the bottom row.
+// Returns:
+//   Cycles per line.
+static uint64_t console_stream(void) {
+    kset_cursor_pos(0, kprint_rows() - 1);
+    uint64_t start = k_rdtsc();
+    for (int i = 0; i < BENCH_CONSOLE_LINES; i++) {
+        kprint(console_lines[i & 1], VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+    return (k_rdtsc() - start) / BENCH_CONSOLE_LINES;
+}
+
+// Repaints every row but the last BENCH_CONSOLE_FRAMES times, every cell
+// changing from one frame to the next.
+// Returns:
+//   Cycles per line.
+static uint64_t console_repaint(void) {
+    uint64_t start = k_rdtsc();
+    for (int frame = 0; frame < BENCH_CONSOLE_FRAMES; frame++) {
+        kprint_batch_begin();
+        for (int y = 0; y < kprint_rows() - 1; y++) {
+            // Four attributes (bright white, yellow, magenta, red), so the
+            // glyph cache serves more than one color.
+            kprint_at(console_lines[(frame + y) & 1], 0, y, (uint8_t)(VGA_ATTRIB_WHITE_ON_BLACK - (y & 3)));
+        }
+        kprint_batch_end();
+    }
+    return (k_rdtsc() - start) / (BENCH_CONSOLE_FRAMES * (kprint_rows() - 1));
+}
+
+// Prints a "name  N chars/s" row for a cost in cycles per line.
+static void print_chars_per_second(const char* name, uint64_t cycles_per_line) {
+    uint64_t ns = ktime_cycles_to_ns(cycles_per_line);
+    uint64_t chars = ns ? (uint64_t)BENCH_CONSOLE_WIDTH * 1000000000ULL / ns : 0;
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "%-26s%k%llu%k chars/s\n", name,
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)chars, VGA_ATTRIB_DARK_GREY_ON_BLACK);
+}
+
+// Ends both test lines with 'end': '\n' to stream them, '\0' to paint them.
+static void set_console_line_end(char end) {
+    console_lines[0][BENCH_CONSOLE_WIDTH] = end;
+    console_lines[1][BENCH_CONSOLE_WIDTH] = end;
+}
+
+static void bench_console(void) {
+    for (int i = 0; i < 2; i++) {
+        for (int x = 0; x < BENCH_CONSOLE_WIDTH; x++) {
+            console_lines[i][x] = (char)('!' + (x * 7 + i * 31) % 94);
+        }
+    }
+
+    struct kfb_mode mode;
+    int scale = kfb_get_mode(&mode);
+    uint64_t stream[2], repaint[2]; // [0]: glyph cache off, [1]: on
+    set_console_line_end('\n');
+    if (scale) {
+        kfb_set_glyph_cache(0);
+        stream[0] = console_stream();
+        kfb_set_glyph_cache(1);
+    }
+    stream[1] = console_stream();
+    set_console_line_end('\0');
+    if (scale) {
+        kfb_set_glyph_cache(0);
+        repaint[0] = console_repaint();
+        kfb_set_glyph_cache(1);
+    }
+    repaint[1] = console_repaint();
+
+    kclear_screen();
+    kprint("--- Console: characters per second ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+    if (scale) {
+        struct kfb_stats stats;
+        kfb_get_stats(&stats);
+        kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "Framebuffer %k%ux%u%k, %k%dx%d%k characters, font x%k%d%k (%dx%d cells)\n\n",
+                VGA_ATTRIB_WHITE_ON_BLACK, mode.width, mode.height, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+                VGA_ATTRIB_WHITE_ON_BLACK, kprint_columns(), kprint_rows(), VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+                VGA_ATTRIB_WHITE_ON_BLACK, scale, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+                KFONT_WIDTH * scale, KFONT_HEIGHT * scale);
+        kprint("Glyph cache off -> on, per line:\n", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+        print_result_row("line + scroll", stream[0], stream[1]);
+        print_result_row("kprint_at repaint", repaint[0], repaint[1]);
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+        print_chars_per_second("line + scroll", stream[1]);
+        print_chars_per_second("kprint_at repaint", repaint[1]);
+        kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+                "\nSince boot: %k%llu%k cells drawn, %k%llu%k scrolls, %k%llu%k attributes cached,\n"
+                "            %k%llu%k presents, %k%llu%k pixels presented\n",
+                VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)stats.cells_drawn, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+                VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)stats.scrolls, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+                VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)stats.cache_fills, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+                VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)stats.presents, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+                VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)stats.pixels_presented, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    } else {
+        kprint("VGA text mode (no framebuffer from GRUB)\n\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+        print_chars_per_second("line + scroll", stream[1]);
+        print_chars_per_second("kprint_at repaint", repaint[1]);
+    }
+}
+
+// --- Benchmark Registry ---
+// Each entry is shown as a lettered option in kbench_menu().
+struct kbench_entry {
+    const char* name;   // Label shown in the menu
+    void (*run)(void);  // Runs the benchmark and prints its results
+};
+
+static const struct kbench_entry bench_entries[] = {
+    { "Caching: legacy UC vs WB/WC (kprint, scroll, k_itoa)", bench_caching },
+    { "Scrolling: full-screen copy vs hardware scroll", bench_scrolling },
+    { "Memory: scalar vs SSE2 vs AVX2 memcpy/memset/strlen", bench_memory },
+    { "Physical memory: free blocks per order, alloc/free cost", bench_pmm },
+    { "Kernel heap: per-size-class counters, kmalloc/kfree cost", bench_heap },
+    { "Virtual memory: 4KB vs 2MB pages, demand-zero fault cost", bench_vmm },
+    { "Timer: TSC frequency and ksleep_ns accuracy", bench_timer },
+    { "Trace: hottest probes and latency histogram", bench_trace },
+    { "Serial: COM1 caller cost and throughput (bytes/s)", bench_serial },
+    { "SMP: work on every CPU, wake-up round trip", bench_smp },
+    { "Job pool: k_add_n/k_multiply_n/memset speedup, 1..N CPUs", bench_jobs },
+    { "Threads: CPU time per thread, context switch cost", bench_threads },
+    { "Integer conversion: k_itoa/k_atoi vs 64-bit table-driven", bench_convert },
+    { "Bignum: schoolbook vs Karatsuba multiply, 200! and 500!", bench_bignum },
+    { "Expressions: bytecode VM, constant folding, batch evals/s", bench_expr },
+    { "Floating point: Grisu2/Clinger conversions per second", bench_float },
+    { "UI: full redraw vs damage tracking, cells per frame", bench_ui },
+    { "TLB: RAM sweep with 4KB vs 2MB vs 1GB pages", bench_tlb },
+    { "Console: characters/s, framebuffer glyph cache off vs on", bench_console },
+};
+#define NUM_BENCH_ENTRIES (sizeof(bench_entries) / sizeof(bench_entries[0]))
+
+// Menu letters: 'a', 'b', ... skipping 'q', which quits.
+#define BENCH_KEY(index) ((char)('a' + (index) + ((index) >= 'q' - 'a')))
+
+// --- Public Function: kbench_menu ---
+// Lists the benchmarks as "a) ...", "b) ..." and runs the selected one.
+void kbench_menu(void) {
+    while (1) {
+        kclear_screen();
+        kprint("--- Benchmarks ---\n\n", VGA_ATTRIB_YELLOW_ON_BLACK);
+        for (int i = 0; i < (int)NUM_BENCH_ENTRIES; i++) {
+            char label[4] = { BENCH_KEY(i), ')', ' ', '\0' };
+            kprint(label, VGA_ATTRIB_LIGHT_CYAN_ON_BLACK);
+            kprint(bench_entries[i].name, VGA_ATTRIB_WHITE_ON_BLACK);
+            kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+        }
+        kprint("\nq) Back to menu\n", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+
+        char key = kgetc();
+        if (key == 'q' || key == 'Q') {
+            return;
+        }
+        int index = key - 'a' - (key > 'q');
+        if (index >= 0 && index < (int)NUM_BENCH_ENTRIES) {
+            bench_entries[index].run();
+            kprint("\nPress any key to continue...\n", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+            kgetc();
+        }
+    }
+}
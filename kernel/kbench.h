@@ -0,0 +1,23 @@
+#ifndef KBENCH_H // Standard header guard to prevent multiple inclusions
+#define KBENCH_H
+
+#include <stdint.h> // For uint64_t
+
+// --- Function Declarations ---
+
+// kbench_menu: Shows the list of in-kernel microbenchmarks and runs the one
+// the user picks. Returns when the user presses 'q'.
+void kbench_menu(void);
+
+// kbench_print_u64: Prints an unsigned 64-bit value in decimal at the current
+// cursor position. k_itoa only handles 'int', which is too small for cycle counts.
+// Parameters:
+//   value: The number to print.
+//   color_attribute: The attribute byte (foreground and background color).
+void kbench_print_u64(uint64_t value, uint8_t color_attribute);
+
+// kbench_print_u64_padded: Like kbench_print_u64, right-aligned in a column
+// of 'width' characters.
+void kbench_print_u64_padded(uint64_t value, int width, uint8_t color_attribute);
+
+#endif // KBENCH_H
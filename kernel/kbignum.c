@@ -0,0 +1,630 @@
+#include <stdint.h>
+#include "kbignum.h"   // Our own declarations
+#include "kutils.h"    // k_memcpy, k_memset, k_u64toa
+#include "kspinlock.h" // One-time setup of the power table
+
+// Size from which kbignum_mul switches to Karatsuba (see the setter).
+static int karatsuba_threshold = KBIGNUM_KARATSUBA_THRESHOLD;
+
+// Scratch space for one kbignum_mul. Karatsuba on n limbs needs about 4n
+// (two half-size sums and their product, then the same again one level
+// down, ...), an unbalanced product 2n more for the partial products.
+#define MUL_SCRATCH_LIMBS (8 * KBIGNUM_LIMBS + 64)
+
+// ============================================================================
+// Limb arrays
+// The helpers below work on plain little-endian uint32_t arrays with
+// explicit lengths; the kbignum functions wrap them with sign handling.
+// ============================================================================
+
+// --- Helper Function: limbs_normalize ---
+// Length of a[0..n) without its leading zero limbs.
+static inline int limbs_normalize(const uint32_t* a, int n) {
+    while (n > 0 && a[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+// --- Helper Function: limbs_cmp ---
+// Compares two normalized magnitudes.
+static int limbs_cmp(const uint32_t* a, int an, const uint32_t* b, int bn) {
+    if (an != bn) {
+        return an < bn ? -1 : 1;
+    }
+    for (int i = an - 1; i >= 0; i--) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// --- Helper Function: limbs_add ---
+// r[0..an) = a + b for an >= bn. r may be a or b.
+// Returns:
+//   The carry out of the top limb (0 or 1).
+static uint32_t limbs_add(uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn) {
+    uint64_t carry = 0;
+    int i = 0;
+    for (; i < bn; i++) {
+        carry += (uint64_t)a[i] + b[i];
+        r[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    for (; i < an; i++) {
+        carry += a[i];
+        r[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    return (uint32_t)carry;
+}
+
+// --- Helper Function: limbs_sub ---
+// r[0..an) = a - b for an >= bn. r may be a or b.
+// Returns:
+//   The borrow out of the top limb (1 if b > a).
+static uint32_t limbs_sub(uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn) {
+    uint32_t borrow = 0;
+    int i = 0;
+    for (; i < bn; i++) {
+        uint64_t diff = (uint64_t)a[i] - b[i] - borrow;
+        r[i] = (uint32_t)diff;
+        borrow = (uint32_t)(diff >> 63); // Wrapped below zero
+    }
+    for (; i < an; i++) {
+        uint64_t diff = (uint64_t)a[i] - borrow;
+        r[i] = (uint32_t)diff;
+        borrow = (uint32_t)(diff >> 63);
+    }
+    return borrow;
+}
+
+// --- Helper Function: limbs_mul_basecase ---
+// r[0..an+bn) = a * b, one row of the schoolbook method per limb of b.
+// a * b[j] + r + carry is at most 2^64 - 1, so one 64-bit accumulator is enough.
+static void limbs_mul_basecase(uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn) {
+    k_memset(r, 0, (size_t)(an + bn) * sizeof(uint32_t));
+    for (int j = 0; j < bn; j++) {
+        uint64_t bj = b[j];
+        if (bj == 0) {
+            continue; // The row adds nothing; r[j + an] is still 0
+        }
+        uint64_t carry = 0;
+        for (int i = 0; i < an; i++) {
+            carry += a[i] * bj + r[i + j];
+            r[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        r[j + an] = (uint32_t)carry;
+    }
+}
+
+static void limbs_mul(uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn, uint32_t* scratch);
+
+// --- Helper Function: limbs_karatsuba ---
+// r[0..2n) = a * b for two n-limb numbers. With a = a1 * B^h + a0 and the
+// same for b:
+//   a * b = z2 * B^2h + (z1 - z2 - z0) * B^h + z0
+// where z0 = a0 * b0, z2 = a1 * b1 and z1 = (a0 + a1) * (b0 + b1): three
+// half-size products instead of four.
+static void limbs_karatsuba(uint32_t* r, const uint32_t* a, const uint32_t* b, int n, uint32_t* scratch) {
+    int h = n / 2;  // Low half
+    int m = n - h;  // High half (m >= h)
+
+    // z0 and z2 go straight to their places in r.
+    limbs_mul(r, a, h, b, h, scratch);
+    limbs_mul(r + 2 * h, a + h, m, b + h, m, scratch);
+
+    uint32_t* sum_a = scratch;          // m + 1 limbs
+    uint32_t* sum_b = sum_a + m + 1;    // m + 1 limbs
+    uint32_t* z1 = sum_b + m + 1;       // 2m + 2 limbs
+    uint32_t* rest = z1 + 2 * m + 2;
+    sum_a[m] = limbs_add(sum_a, a + h, m, a, h);
+    sum_b[m] = limbs_add(sum_b, b + h, m, b, h);
+    limbs_mul(z1, sum_a, m + 1, sum_b, m + 1, rest);
+
+    // z1 - z0 - z2 = a0 * b1 + a1 * b0, which is never negative.
+    limbs_sub(z1, z1, 2 * m + 2, r, 2 * h);
+    limbs_sub(z1, z1, 2 * m + 2, r + 2 * h, 2 * m);
+
+    // Below 2 * B^n, so at most n + 1 limbs: fits in r + h without a carry out.
+    int z1_used = limbs_normalize(z1, 2 * m + 2);
+    limbs_add(r + h, r + h, 2 * n - h, z1, z1_used);
+}
+
+// --- Helper Function: limbs_mul ---
+// r[0..an+bn) = a * b. r must not overlap a or b.
+// Small operands use the schoolbook method, equal sizes Karatsuba. A long
+// a times a short b is cut into b-sized slices of a, so every product is
+// balanced, and the slices' products are added up.
+static void limbs_mul(uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn, uint32_t* scratch) {
+    if (an < bn) {
+        const uint32_t* t = a; a = b; b = t;
+        int tn = an; an = bn; bn = tn;
+    }
+    if (bn < karatsuba_threshold) {
+        limbs_mul_basecase(r, a, an, b, bn);
+        return;
+    }
+    if (an == bn) {
+        limbs_karatsuba(r, a, b, an, scratch);
+        return;
+    }
+
+    k_memset(r, 0, (size_t)(an + bn) * sizeof(uint32_t));
+    uint32_t* part = scratch; // 2 * bn limbs
+    for (int offset = 0; offset < an; offset += bn) {
+        int len = an - offset < bn ? an - offset : bn;
+        limbs_mul(part, a + offset, len, b, bn, part + 2 * bn);
+        limbs_add(r + offset, r + offset, an + bn - offset, part, len + bn);
+    }
+}
+
+// --- Helper Function: limbs_divmod_small ---
+// q[0..n) = a / d. q may be a.
+// Returns:
+//   a % d.
+static uint32_t limbs_divmod_small(uint32_t* q, const uint32_t* a, int n, uint32_t d) {
+    uint64_t rem = 0;
+    for (int i = n - 1; i >= 0; i--) {
+        uint64_t cur = (rem << 32) | a[i];
+        q[i] = (uint32_t)(cur / d); // 64-by-32 division: one DIV instruction
+        rem = cur % d;
+    }
+    return (uint32_t)rem;
+}
+
+// --- Helper Function: limbs_divmod ---
+// Knuth's algorithm D (TAOCP 4.3.1), as laid out in Hacker's Delight:
+// q[0..an-bn+1) = a / b and r[0..bn) = a % b, for an >= bn >= 2 and a
+// normalized b. Both are shifted left until b's top bit is set, which makes
+// each estimated quotient digit at most 2 too large.
+static void limbs_divmod(uint32_t* q, uint32_t* r, const uint32_t* a, int an, const uint32_t* b, int bn) {
+    uint32_t u[KBIGNUM_LIMBS + 1];
+    uint32_t v[KBIGNUM_LIMBS];
+    int shift = __builtin_clz(b[bn - 1]);
+
+    // 64-bit shifts so that a shift by 32 (when 'shift' is 0) yields 0.
+    for (int i = bn - 1; i > 0; i--) {
+        v[i] = (b[i] << shift) | (uint32_t)((uint64_t)b[i - 1] >> (32 - shift));
+    }
+    v[0] = b[0] << shift;
+    u[an] = (uint32_t)((uint64_t)a[an - 1] >> (32 - shift));
+    for (int i = an - 1; i > 0; i--) {
+        u[i] = (a[i] << shift) | (uint32_t)((uint64_t)a[i - 1] >> (32 - shift));
+    }
+    u[0] = a[0] << shift;
+
+    for (int j = an - bn; j >= 0; j--) {
+        // Estimate the quotient digit from the top two limbs, then refine it
+        // with the third.
+        uint64_t numerator = ((uint64_t)u[j + bn] << 32) | u[j + bn - 1];
+        uint64_t qhat = numerator / v[bn - 1];
+        uint64_t rhat = numerator - qhat * v[bn - 1];
+        while (qhat > 0xFFFFFFFFULL || qhat * v[bn - 2] > ((rhat << 32) | u[j + bn - 2])) {
+            qhat--;
+            rhat += v[bn - 1];
+            if (rhat > 0xFFFFFFFFULL) {
+                break;
+            }
+        }
+
+        // u[j..j+bn] -= qhat * v.
+        int64_t borrow = 0;
+        int64_t t;
+        for (int i = 0; i < bn; i++) {
+            uint64_t product = qhat * v[i];
+            t = (int64_t)u[i + j] - borrow - (int64_t)(product & 0xFFFFFFFFULL);
+            u[i + j] = (uint32_t)t;
+            borrow = (int64_t)(product >> 32) - (t >> 32);
+        }
+        t = (int64_t)u[j + bn] - borrow;
+        u[j + bn] = (uint32_t)t;
+
+        // Rarely, qhat was still one too large: add v back.
+        q[j] = (uint32_t)qhat;
+        if (t < 0) {
+            q[j]--;
+            uint64_t carry = 0;
+            for (int i = 0; i < bn; i++) {
+                carry += (uint64_t)u[i + j] + v[i];
+                u[i + j] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            u[j + bn] += (uint32_t)carry;
+        }
+    }
+
+    // The remainder is what is left of u, shifted back.
+    for (int i = 0; i < bn; i++) {
+        r[i] = (u[i] >> shift) | (uint32_t)(((uint64_t)u[i + 1] << (32 - shift)) & 0xFFFFFFFFULL);
+    }
+}
+
+// ============================================================================
+// Signed numbers
+// ============================================================================
+
+// --- Helper Function: set_result ---
+// Stores a magnitude (copied, so 'limbs' may be scratch space) and a sign.
+static void set_result(struct kbignum* r, const uint32_t* limbs, int n, int negative) {
+    n = limbs_normalize(limbs, n);
+    if (r->limb != limbs && n > 0) {
+        k_memcpy(r->limb, limbs, (size_t)n * sizeof(uint32_t));
+    }
+    r->used = n;
+    r->negative = n ? negative : 0; // No negative zero
+}
+
+// --- Function: kbignum_from_i64 ---
+void kbignum_from_i64(struct kbignum* r, int64_t value) {
+    // Negating in unsigned arithmetic also handles INT64_MIN.
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    r->limb[0] = (uint32_t)magnitude;
+    r->limb[1] = (uint32_t)(magnitude >> 32);
+    set_result(r, r->limb, 2, value < 0);
+}
+
+// --- Function: kbignum_copy ---
+void kbignum_copy(struct kbignum* r, const struct kbignum* a) {
+    set_result(r, a->limb, a->used, a->negative);
+}
+
+// --- Helper Function: mul_small_add ---
+// r = r * m + add, in place, for the callers' own temporaries.
+// Returns:
+//   KBIGNUM_OK, or KBIGNUM_OVERFLOW with r no longer meaningful.
+static int mul_small_add(struct kbignum* r, uint32_t m, uint32_t add) {
+    uint64_t carry = add;
+    for (int i = 0; i < r->used; i++) {
+        carry += (uint64_t)r->limb[i] * m;
+        r->limb[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    if (carry) {
+        if (r->used == KBIGNUM_LIMBS) {
+            return KBIGNUM_OVERFLOW;
+        }
+        r->limb[r->used++] = (uint32_t)carry;
+    }
+    return KBIGNUM_OK;
+}
+
+// --- Function: kbignum_from_string ---
+// Reads up to 9 digits at a time and folds them in with one r * 10^k + chunk.
+int kbignum_from_string(struct kbignum* r, const char* str, const char** end) {
+    static const uint32_t scales[10] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+    };
+    const char* p = str;
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+        p++;
+    }
+    int negative = 0;
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        p++;
+    }
+
+    struct kbignum value;
+    value.used = 0;
+    value.negative = 0;
+    int overflow = 0;
+    const char* digits = p;
+    while (*p >= '0' && *p <= '9') {
+        uint32_t chunk = 0;
+        int length = 0;
+        while (length < 9 && *p >= '0' && *p <= '9') {
+            chunk = chunk * 10 + (uint32_t)(*p - '0');
+            length++;
+            p++;
+        }
+        if (!overflow && mul_small_add(&value, scales[length], chunk) != KBIGNUM_OK) {
+            overflow = 1; // Keep consuming digits, so 'end' is right
+        }
+    }
+
+    if (p == digits) {
+        if (end) {
+            *end = str;
+        }
+        return KBIGNUM_NO_DIGITS;
+    }
+    if (end) {
+        *end = p;
+    }
+    if (overflow) {
+        return KBIGNUM_OVERFLOW;
+    }
+    set_result(r, value.limb, value.used, negative);
+    return KBIGNUM_OK;
+}
+
+// --- Function: kbignum_cmp ---
+int kbignum_cmp(const struct kbignum* a, const struct kbignum* b) {
+    if (a->negative != b->negative) {
+        return a->negative ? -1 : 1;
+    }
+    int c = limbs_cmp(a->limb, a->used, b->limb, b->used);
+    return a->negative ? -c : c;
+}
+
+// --- Helper Function: add_signed ---
+// r = a + (b with the sign 'b_negative'): the shared body of add and sub.
+static int add_signed(struct kbignum* r, const struct kbignum* a, const struct kbignum* b, int b_negative) {
+    uint32_t sum[KBIGNUM_LIMBS];
+    if (a->negative == b_negative) {
+        // Same signs: add the magnitudes.
+        const struct kbignum* longer = a->used >= b->used ? a : b;
+        const struct kbignum* shorter = a->used >= b->used ? b : a;
+        int n = longer->used;
+        uint32_t carry = limbs_add(sum, longer->limb, n, shorter->limb, shorter->used);
+        if (carry) {
+            if (n == KBIGNUM_LIMBS) {
+                return KBIGNUM_OVERFLOW;
+            }
+            sum[n++] = carry;
+        }
+        set_result(r, sum, n, b_negative);
+    } else if (limbs_cmp(a->limb, a->used, b->limb, b->used) >= 0) {
+        // Different signs: subtract the smaller magnitude from the larger.
+        limbs_sub(sum, a->limb, a->used, b->limb, b->used);
+        set_result(r, sum, a->used, a->negative);
+    } else {
+        limbs_sub(sum, b->limb, b->used, a->limb, a->used);
+        set_result(r, sum, b->used, b_negative);
+    }
+    return KBIGNUM_OK;
+}
+
+// --- Function: kbignum_add ---
+int kbignum_add(struct kbignum* r, const struct kbignum* a, const struct kbignum* b) {
+    return add_signed(r, a, b, b->negative);
+}
+
+// --- Function: kbignum_sub ---
+int kbignum_sub(struct kbignum* r, const struct kbignum* a, const struct kbignum* b) {
+    return add_signed(r, a, b, b->used ? !b->negative : 0);
+}
+
+// --- Function: kbignum_mul ---
+int kbignum_mul(struct kbignum* r, const struct kbignum* a, const struct kbignum* b) {
+    if (a->used == 0 || b->used == 0) {
+        r->used = 0;
+        r->negative = 0;
+        return KBIGNUM_OK;
+    }
+    // The product has used_a + used_b or one limb fewer: reject what cannot
+    // fit before doing the work.
+    int n = a->used + b->used;
+    if (n - 1 > KBIGNUM_LIMBS) {
+        return KBIGNUM_OVERFLOW;
+    }
+    uint32_t product[KBIGNUM_LIMBS + 1];
+    uint32_t scratch[MUL_SCRATCH_LIMBS];
+    limbs_mul(product, a->limb, a->used, b->limb, b->used, scratch);
+    n = limbs_normalize(product, n);
+    if (n > KBIGNUM_LIMBS) {
+        return KBIGNUM_OVERFLOW;
+    }
+    set_result(r, product, n, a->negative ^ b->negative);
+    return KBIGNUM_OK;
+}
+
+// --- Function: kbignum_divmod ---
+int kbignum_divmod(struct kbignum* quotient, struct kbignum* remainder,
+                   const struct kbignum* a, const struct kbignum* b) {
+    if (b->used == 0) {
+        return KBIGNUM_DIV_ZERO;
+    }
+    uint32_t q[KBIGNUM_LIMBS];
+    uint32_t r[KBIGNUM_LIMBS];
+    int q_used, r_used;
+    if (limbs_cmp(a->limb, a->used, b->limb, b->used) < 0) {
+        q_used = 0;
+        r_used = a->used;
+        if (r_used) {
+            k_memcpy(r, a->limb, (size_t)r_used * sizeof(uint32_t));
+        }
+    } else if (b->used == 1) {
+        r[0] = limbs_divmod_small(q, a->limb, a->used, b->limb[0]);
+        q_used = a->used;
+        r_used = 1;
+    } else {
+        limbs_divmod(q, r, a->limb, a->used, b->limb, b->used);
+        q_used = a->used - b->used + 1;
+        r_used = b->used;
+    }
+
+    // Read the signs before writing: the outputs may be the inputs.
+    int a_negative = a->negative;
+    int b_negative = b->negative;
+    if (quotient) {
+        set_result(quotient, q, q_used, a_negative ^ b_negative);
+    }
+    if (remainder) {
+        set_result(remainder, r, r_used, a_negative);
+    }
+    return KBIGNUM_OK;
+}
+
+// ============================================================================
+// Decimal output
+// ============================================================================
+
+// Powers 10^(9 * 2^k), k = 0..6: 10^9 up to 10^576 (60 limbs), enough to
+// split any KBIGNUM_LIMBS-limb number in half. Built once, by squaring.
+#define POWER_LEVELS 7
+#define TO_STRING_BASECASE_LIMBS 16 // At or below this size, divide by 10^9 repeatedly
+
+static struct kbignum powers[POWER_LEVELS];
+static volatile int powers_ready = 0;
+static struct kspinlock powers_lock = KSPINLOCK_INIT;
+
+// --- Helper Function: init_powers ---
+static void init_powers(void) {
+    if (powers_ready) {
+        return;
+    }
+    kspin_lock(&powers_lock);
+    if (!powers_ready) {
+        kbignum_from_i64(&powers[0], 1000000000);
+        for (int k = 1; k < POWER_LEVELS; k++) {
+            kbignum_mul(&powers[k], &powers[k - 1], &powers[k - 1]);
+        }
+        __atomic_store_n(&powers_ready, 1, __ATOMIC_RELEASE);
+    }
+    kspin_unlock(&powers_lock);
+}
+
+// --- Helper Function: write_chunk ---
+// Exactly 9 digits of 'value' (< 10^9), with leading zeros.
+static void write_chunk(char* out, uint32_t value) {
+    for (int i = 8; i >= 0; i--) {
+        out[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+}
+
+// --- Helper Function: digits_basecase ---
+// The digits of a[0..n): 9 at a time by dividing by 10^9, least significant
+// first, then written out most significant first.
+// Parameters:
+//   pad: If above 0, write exactly 'pad' digits (with leading zeros); used
+//        for the lower half of a split. 0 means no leading zeros.
+// Returns:
+//   The position after the last digit.
+static char* digits_basecase(const uint32_t* a, int n, int pad, char* out) {
+    uint32_t work[TO_STRING_BASECASE_LIMBS];
+    uint32_t chunks[TO_STRING_BASECASE_LIMBS * 32 / 29 + 2]; // 10^9 > 2^29
+    int count = 0;
+    if (n > 0) {
+        k_memcpy(work, a, (size_t)n * sizeof(uint32_t));
+    }
+    while (n > 0) {
+        chunks[count++] = limbs_divmod_small(work, work, n, 1000000000);
+        n = limbs_normalize(work, n);
+    }
+
+    int i = count - 1;
+    if (pad > 0) {
+        for (int zeros = pad - 9 * count; zeros > 0; zeros--) {
+            *out++ = '0';
+        }
+    } else if (count > 0) {
+        out += k_u64toa(chunks[i--], out, 10); // Top chunk without leading zeros
+    }
+    for (; i >= 0; i--) {
+        write_chunk(out, chunks[i]);
+        out += 9;
+    }
+    return out;
+}
+
+// --- Helper Function: digits_recursive ---
+// Divide and conquer: a = high * 10^d + low with 10^d the largest table
+// power of at most half a's size; 'high' gives the leading digits and 'low'
+// exactly d more. Parameters and result as for digits_basecase.
+static char* digits_recursive(const uint32_t* a, int n, int pad, char* out) {
+    n = limbs_normalize(a, n);
+    if (n <= TO_STRING_BASECASE_LIMBS) {
+        return digits_basecase(a, n, pad, out);
+    }
+
+    int k = POWER_LEVELS - 1;
+    while (k > 0 && powers[k].used > (n + 1) / 2) {
+        k--;
+    }
+    const struct kbignum* power = &powers[k];
+    int power_digits = 9 << k;
+
+    // n > 16 makes power at least 10^72 (8 limbs), so limbs_divmod applies,
+    // and a > power, so 'high' is never zero.
+    uint32_t high[KBIGNUM_LIMBS];
+    uint32_t low[KBIGNUM_LIMBS];
+    limbs_divmod(high, low, a, n, power->limb, power->used);
+    out = digits_recursive(high, n - power->used + 1, pad ? pad - power_digits : 0, out);
+    return digits_recursive(low, power->used, power_digits, out);
+}
+
+// --- Function: kbignum_to_string ---
+int kbignum_to_string(const struct kbignum* a, char* buf, int size) {
+    if (a->used == 0) {
+        if (size < 2) {
+            if (size > 0) buf[0] = '\0';
+            return -1;
+        }
+        buf[0] = '0';
+        buf[1] = '\0';
+        return 1;
+    }
+
+    // Upper bound on the digit count: bits * log10(2), rounded up.
+    int bits = 32 * (a->used - 1) + (32 - __builtin_clz(a->limb[a->used - 1]));
+    int needed = (bits * 1234) / 4096 + 1 + a->negative + 1;
+    if (size < needed) {
+        if (size > 0) buf[0] = '\0';
+        return -1;
+    }
+
+    init_powers();
+    char* out = buf;
+    if (a->negative) {
+        *out++ = '-';
+    }
+    out = digits_recursive(a->limb, a->used, 0, out);
+    *out = '\0';
+    return (int)(out - buf);
+}
+
+// ============================================================================
+// Factorial
+// ============================================================================
+
+// --- Helper Function: product_range ---
+// r = lo * (lo + 1) * ... * hi, split in the middle so both halves (and so
+// the final multiplication) are about the same size.
+static int product_range(struct kbignum* r, uint32_t lo, uint32_t hi) {
+    if (hi - lo < 16) {
+        kbignum_from_i64(r, lo);
+        for (uint32_t i = lo + 1; i <= hi; i++) {
+            if (mul_small_add(r, i, 0) != KBIGNUM_OK) {
+                return KBIGNUM_OVERFLOW;
+            }
+        }
+        return KBIGNUM_OK;
+    }
+    uint32_t mid = lo + (hi - lo) / 2;
+    struct kbignum right;
+    int status = product_range(r, lo, mid);
+    if (status == KBIGNUM_OK) {
+        status = product_range(&right, mid + 1, hi);
+    }
+    if (status == KBIGNUM_OK) {
+        status = kbignum_mul(r, r, &right);
+    }
+    return status;
+}
+
+// --- Function: kbignum_factorial ---
+int kbignum_factorial(struct kbignum* r, uint32_t n) {
+    if (n > 1000) {
+        return KBIGNUM_OVERFLOW; // Far beyond 4096 bits; do not even start
+    }
+    if (n < 2) {
+        kbignum_from_i64(r, 1);
+        return KBIGNUM_OK;
+    }
+    struct kbignum result;
+    int status = product_range(&result, 2, n);
+    if (status == KBIGNUM_OK) {
+        set_result(r, result.limb, result.used, 0);
+    }
+    return status;
+}
+
+// --- Function: kbignum_set_karatsuba_threshold ---
+void kbignum_set_karatsuba_threshold(int limbs) {
+    karatsuba_threshold = limbs < 4 ? 4 : limbs;
+}
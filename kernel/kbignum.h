@@ -0,0 +1,93 @@
+#ifndef KBIGNUM_H // Standard header guard to prevent multiple inclusions
+#define KBIGNUM_H
+
+#include <stdint.h> // For uint32_t, int64_t
+
+// --- Arbitrary-Precision Integers ---
+// Signed integers of up to KBIGNUM_LIMBS 32-bit limbs (4096 bits, about
+// 1233 decimal digits), stored least significant limb first with a separate
+// sign. The size is fixed so a number can live on the stack or in a static
+// variable without the heap; a result that does not fit is reported as
+// KBIGNUM_OVERFLOW instead of wrapping.
+//
+// Multiplication is schoolbook below the Karatsuba threshold and Karatsuba
+// above it (three half-size products instead of four). Division is Knuth's
+// algorithm D. Decimal output splits the number by powers 10^(9 * 2^k) and
+// converts both halves recursively, so it costs a few multiplications'
+// worth of work instead of one division by 10^9 per 9 digits of the whole
+// number.
+//
+// Limbs are 32 bits so every intermediate fits in 64 bits: the kernel has
+// no libgcc for 128-bit division.
+
+#define KBIGNUM_LIMBS       128  // 4096 bits
+#define KBIGNUM_STRING_SIZE 1240 // Enough for any value: sign, 1234 digits, null
+
+// Results.
+#define KBIGNUM_OK        0
+#define KBIGNUM_OVERFLOW  1 // The result needs more than KBIGNUM_LIMBS limbs
+#define KBIGNUM_DIV_ZERO  2 // Division by zero
+#define KBIGNUM_NO_DIGITS 3 // kbignum_from_string found no number
+
+// Default size (in limbs) from which kbignum_mul uses Karatsuba.
+#define KBIGNUM_KARATSUBA_THRESHOLD 24
+
+struct kbignum {
+    int negative;                   // 1 if the value is below zero (zero is never negative)
+    int used;                       // Significant limbs; 0 for zero
+    uint32_t limb[KBIGNUM_LIMBS];   // Magnitude, least significant limb first
+};
+
+// --- Function Declarations ---
+// Results may alias operands (kbignum_add(&a, &a, &b) is fine). On an error
+// the result is left unchanged.
+
+// kbignum_from_i64: Sets 'r' to 'value'.
+void kbignum_from_i64(struct kbignum* r, int64_t value);
+
+// kbignum_copy: r = a (only the used limbs are copied).
+void kbignum_copy(struct kbignum* r, const struct kbignum* a);
+
+// kbignum_from_string: Parses an optionally signed decimal number after
+// optional whitespace.
+// Parameters:
+//   end: If not 0, receives a pointer to the first character after the digits.
+// Returns:
+//   KBIGNUM_OK, KBIGNUM_NO_DIGITS or KBIGNUM_OVERFLOW.
+int kbignum_from_string(struct kbignum* r, const char* str, const char** end);
+
+// kbignum_to_string: Writes 'a' in decimal.
+// Parameters:
+//   buf, size: Output buffer; KBIGNUM_STRING_SIZE always suffices.
+// Returns:
+//   The length of the string, or -1 (with buf empty) if it does not fit.
+int kbignum_to_string(const struct kbignum* a, char* buf, int size);
+
+// kbignum_cmp: -1, 0 or 1 as a is less than, equal to or greater than b.
+int kbignum_cmp(const struct kbignum* a, const struct kbignum* b);
+
+// kbignum_add / kbignum_sub / kbignum_mul: r = a + b, a - b, a * b.
+// Returns:
+//   KBIGNUM_OK or KBIGNUM_OVERFLOW.
+int kbignum_add(struct kbignum* r, const struct kbignum* a, const struct kbignum* b);
+int kbignum_sub(struct kbignum* r, const struct kbignum* a, const struct kbignum* b);
+int kbignum_mul(struct kbignum* r, const struct kbignum* a, const struct kbignum* b);
+
+// kbignum_divmod: quotient = a / b rounded toward zero, remainder = a - b *
+// quotient (with the sign of a), as C does for int. Either output may be 0.
+// Returns:
+//   KBIGNUM_OK or KBIGNUM_DIV_ZERO.
+int kbignum_divmod(struct kbignum* quotient, struct kbignum* remainder,
+                   const struct kbignum* a, const struct kbignum* b);
+
+// kbignum_factorial: r = n!, multiplied as a balanced product tree so the
+// large multiplications at the top go through Karatsuba.
+// Returns:
+//   KBIGNUM_OK or KBIGNUM_OVERFLOW (from about 530! on).
+int kbignum_factorial(struct kbignum* r, uint32_t n);
+
+// kbignum_set_karatsuba_threshold: Changes the size from which Karatsuba is
+// used (for benchmarks; a huge value means schoolbook only). Minimum 4.
+void kbignum_set_karatsuba_threshold(int limbs);
+
+#endif // KBIGNUM_H
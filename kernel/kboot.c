@@ -0,0 +1,107 @@
+#include <stdint.h>
+#include "kboot.h"      // Our own declarations
+#include "kcpu.h"       // k_rdtsc
+#include "kinput.h"     // inb, outb
+#include "ktime.h"      // ktime_cycles_to_ns
+#include "kformat.h"    // ksnprintf
+#include "kmultiboot.h" // The kernel command line
+
+// TSC at the end of each phase, filled in by boot.asm (the first four) and
+// kboot_stamp(). It lives in boot.asm's .bss, so it is zero until stamped.
+extern uint64_t boot_tsc[16];
+
+// Names in the report, by phase.
+static const char* phase_names[KBOOT_PHASES] = {
+    "before_start", "page_tables", "long_mode", "cpu_setup", "memory",
+    "devices", "smp", "threads", "first_prompt"
+};
+
+// QEMU's debug console: bytes written to this port go to its -debugcon
+// target, and reading it returns 0xE9 when one is attached.
+#define DEBUGCON_PORT 0xE9
+
+static int reported = 0;
+
+// --- Public Function: kboot_stamp ---
+void kboot_stamp(int phase) {
+    if (phase > KBOOT_KERNEL_MAIN && phase < KBOOT_PHASES) {
+        boot_tsc[phase] = k_rdtsc();
+    }
+}
+
+// --- Public Function: kboot_phase_ns ---
+uint64_t kboot_phase_ns(int phase) {
+    if (phase < 0 || phase >= KBOOT_PHASES || boot_tsc[phase] == 0) {
+        return 0;
+    }
+    // A phase can be skipped (no threads without a memory map): its time
+    // then counts toward the next one.
+    int previous = phase - 1;
+    while (previous >= 0 && boot_tsc[previous] == 0) {
+        previous--;
+    }
+    return ktime_cycles_to_ns(boot_tsc[phase] - (previous >= 0 ? boot_tsc[previous] : 0));
+}
+
+// --- Helper Function: debugcon_puts ---
+static void debugcon_puts(const char* str) {
+    for (; *str; str++) {
+        outb(DEBUGCON_PORT, (uint8_t)*str);
+    }
+}
+
+// --- Helper Function: command_line_has ---
+// 1 if 'word' appears in the kernel command line GRUB passed.
+static int command_line_has(const char* word) {
+    const struct multiboot_tag_string* tag =
+        (const struct multiboot_tag_string*)kmultiboot_find_tag(MULTIBOOT_TAG_TYPE_CMDLINE);
+    if (!tag) {
+        return 0;
+    }
+    for (const char* start = tag->string; *start; start++) {
+        int i = 0;
+        while (word[i] && start[i] == word[i]) {
+            i++;
+        }
+        if (!word[i]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// --- Public Function: kboot_first_prompt ---
+void kboot_first_prompt(void) {
+    if (reported) {
+        return;
+    }
+    kboot_stamp(KBOOT_FIRST_PROMPT);
+    kboot_report();
+}
+
+// --- Public Function: kboot_report ---
+// One line per phase, then the total from _start to the last stamp.
+void kboot_report(void) {
+    reported = 1;
+    if (inb(DEBUGCON_PORT) != DEBUGCON_PORT) {
+        return; // No debug console: nobody to tell
+    }
+    char line[64];
+    int last = KBOOT_START;
+    for (int phase = KBOOT_START; phase < KBOOT_PHASES; phase++) {
+        if (boot_tsc[phase] == 0) {
+            continue;
+        }
+        ksnprintf(line, sizeof(line), "bootstat %s %llu\n", phase_names[phase],
+                  (unsigned long long)kboot_phase_ns(phase));
+        debugcon_puts(line);
+        last = phase;
+    }
+    ksnprintf(line, sizeof(line), "bootstat total %llu\n",
+              (unsigned long long)ktime_cycles_to_ns(boot_tsc[last] - boot_tsc[KBOOT_START]));
+    debugcon_puts(line);
+
+    if (command_line_has("bootbench")) {
+        outb(KBOOT_DEBUG_EXIT_PORT, KBOOT_DEBUG_EXIT_CODE);
+    }
+}
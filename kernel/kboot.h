@@ -0,0 +1,53 @@
+#ifndef KBOOT_H // Standard header guard to prevent multiple inclusions
+#define KBOOT_H
+
+#include <stdint.h> // For uint64_t
+
+// --- Boot-Phase Timing ---
+// The TSC is stamped at the end of each step from _start to the first
+// prompt: four times in boot.asm (BOOT_STAMP), the rest from C with
+// kboot_stamp(). At the first prompt kboot_report() converts the steps to
+// nanoseconds and writes them to QEMU's debug console (port 0xE9), one
+// "bootstat <phase> <ns>" line each, when one is attached
+// (-debugcon file:boot.log). 'make boot-bench' boots the kernel with
+// "bootbench" on its command line, which makes kboot_report() also power
+// QEMU off through the isa-debug-exit device, and collects the lines of
+// many boots (see tools/bootbench.sh).
+
+// Phases, in boot order. Each stamp ends the phase of the same name.
+#define KBOOT_START        0 // _start entered (GRUB handed over)
+#define KBOOT_PAGE_TABLES  1 // Direct map chosen (1GB pages or not), PAT programmed
+#define KBOOT_LONG_MODE    2 // CR3/PAE/EFER/GDT loaded, paging on, in 64-bit code
+#define KBOOT_KERNEL_MAIN  3 // SSE/AVX enabled, kernel_main called
+#define KBOOT_MEMORY       4 // Page frame allocator and heap ready
+#define KBOOT_DEVICES      5 // IDT, serial, VMM, ACPI, APIC, clock calibration, keyboard
+#define KBOOT_SMP          6 // Other CPU cores started
+#define KBOOT_THREADS      7 // Scheduler running, interrupts on
+#define KBOOT_FIRST_PROMPT 8 // First prompt on the screen
+#define KBOOT_PHASES       9 // boot.asm reserves room for 16
+
+// isa-debug-exit (-device isa-debug-exit,iobase=0xf4,iosize=0x01): writing
+// a value v to the port makes QEMU exit with status (v << 1) | 1.
+#define KBOOT_DEBUG_EXIT_PORT 0xF4
+#define KBOOT_DEBUG_EXIT_CODE 0x10 // QEMU exit status 33
+
+// --- Function Declarations ---
+
+// kboot_stamp: Records the TSC for 'phase' (KBOOT_MEMORY and later).
+void kboot_stamp(int phase);
+
+// kboot_phase_ns: Time spent in 'phase' (from the previous stamp taken to
+// its own), in nanoseconds; 0 for a phase not reached yet. For KBOOT_START it
+// is the time from CPU reset to _start (firmware and GRUB), as far as the
+// TSC tells. Needs ktime_init().
+uint64_t kboot_phase_ns(int phase);
+
+// kboot_first_prompt: Stamps KBOOT_FIRST_PROMPT and calls kboot_report(),
+// the first time only; called wherever the first prompt may appear.
+void kboot_first_prompt(void);
+
+// kboot_report: Writes every phase to the debug console, if present, and
+// exits QEMU if the command line asks for it ("bootbench").
+void kboot_report(void);
+
+#endif // KBOOT_H
@@ -0,0 +1,120 @@
+#ifndef KCPU_H // Standard header guard to prevent multiple inclusions
+#define KCPU_H
+
+#include <stdint.h> // For uint32_t, uint64_t
+
+// --- Small CPU helpers ---
+// Thin inline wrappers around privileged/special x86-64 instructions.
+// They are 'static inline' so each one compiles down to the single instruction
+// it wraps, with no call overhead.
+
+// k_rdtsc: Reads the Time Stamp Counter (cycles since reset).
+// Returns:
+//   The 64-bit TSC value.
+static inline uint64_t k_rdtsc(void) {
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// k_cpuid: Executes CPUID for the given leaf/subleaf.
+// Parameters:
+//   leaf, subleaf: The values loaded into EAX and ECX.
+//   a, b, c, d: Receive EAX, EBX, ECX and EDX.
+static inline void k_cpuid(uint32_t leaf, uint32_t subleaf,
+                           uint32_t* a, uint32_t* b, uint32_t* c, uint32_t* d) {
+    __asm__ volatile ("cpuid"
+                      : "=a"(*a), "=b"(*b), "=c"(*c), "=d"(*d)
+                      : "a"(leaf), "c"(subleaf));
+}
+
+// k_xgetbv: Reads an extended control register (XCR0 tells which register
+// state the OS saves, and so whether AVX code may run).
+// Only valid when CR4.OSXSAVE is set.
+static inline uint64_t k_xgetbv(uint32_t index) {
+    uint32_t lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(index));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// k_rdmsr / k_wrmsr: Read and write a Model Specific Register.
+static inline uint64_t k_rdmsr(uint32_t msr) {
+    uint32_t lo, hi;
+    __asm__ volatile ("rdmsr" : "=a"(lo), "=d"(hi) : "c"(msr));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void k_wrmsr(uint32_t msr, uint64_t value) {
+    __asm__ volatile ("wrmsr" : : "c"(msr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
+// k_read_cr3 / k_write_cr3: Access the page-table base register.
+// Writing CR3 (even with the same value) flushes all non-global TLB entries.
+static inline uint64_t k_read_cr3(void) {
+    uint64_t value;
+    __asm__ volatile ("mov %%cr3, %0" : "=r"(value));
+    return value;
+}
+
+static inline void k_write_cr3(uint64_t value) {
+    __asm__ volatile ("mov %0, %%cr3" : : "r"(value) : "memory");
+}
+
+// k_read_cr2: Returns the linear address that caused the last page fault.
+static inline uint64_t k_read_cr2(void) {
+    uint64_t value;
+    __asm__ volatile ("mov %%cr2, %0" : "=r"(value));
+    return value;
+}
+
+// k_read_cr0 / k_write_cr0: Access the main control register (paging,
+// protection, FPU control bits).
+static inline uint64_t k_read_cr0(void) {
+    uint64_t value;
+    __asm__ volatile ("mov %%cr0, %0" : "=r"(value));
+    return value;
+}
+
+static inline void k_write_cr0(uint64_t value) {
+    __asm__ volatile ("mov %0, %%cr0" : : "r"(value) : "memory");
+}
+
+// k_clts: Clears CR0.TS, so FPU/SSE instructions run without raising #NM.
+static inline void k_clts(void) {
+    __asm__ volatile ("clts" : : : "memory");
+}
+
+// k_invlpg: Drops the TLB entry (and cached paging structures) for one address.
+static inline void k_invlpg(uint64_t address) {
+    __asm__ volatile ("invlpg (%0)" : : "r"(address) : "memory");
+}
+
+// k_wbinvd: Writes back and invalidates all CPU caches.
+// Required after changing the memory type of pages that may already be cached.
+static inline void k_wbinvd(void) {
+    __asm__ volatile ("wbinvd" : : : "memory");
+}
+
+// k_enable_interrupts / k_disable_interrupts: Set or clear the IF flag (sti/cli).
+static inline void k_enable_interrupts(void) {
+    __asm__ volatile ("sti" : : : "memory");
+}
+
+static inline void k_disable_interrupts(void) {
+    __asm__ volatile ("cli" : : : "memory");
+}
+
+// k_interrupts_enabled: Returns 1 if the IF flag is set (interrupts enabled).
+static inline int k_interrupts_enabled(void) {
+    uint64_t flags;
+    __asm__ volatile ("pushfq; pop %0" : "=r"(flags));
+    return (flags >> 9) & 1;
+}
+
+// k_pause: Spin-loop hint; saves power and frees resources for the other
+// hyperthread while busy-waiting.
+static inline void k_pause(void) {
+    __asm__ volatile ("pause");
+}
+
+#endif // KCPU_H
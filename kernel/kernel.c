@@ -1,8 +1,28 @@
 #include <stdint.h>     // Standard integer types (e.g., int, uint8_t)
 #include "kprint.h"     // Our custom printing functions (kprint, kclear_screen, kset_cursor_pos, kprint_at)
 #include "kinput.h"     // Our custom keyboard input functions (kgets, kgetc)
-#include "kutils.h"     // Our new utility functions (k_atoi, k_itoa, k_strlen)
-#include "kmath.h"      // Our new math functions (k_add_n, k_subtract, k_multiply_n, k_divide)
+#include "kutils.h"     // Our new utility functions (k_atoi, k_itoa, k_strlen, k_strcpy, k_memcpy)
+#include "kbignum.h"    // Arbitrary-precision integers for the calculator and Do Math
+#include "kformat.h"     // ksnprintf for the calculator display
+#include "kexpr.h"       // Expression compiler and VM behind the calculator
+#include "kfloat.h"      // Decimal results of the calculator
+#include "kbench.h"     // In-kernel microbenchmarks (kbench_menu)
+#include "kui.h"        // Retained widgets for the menu and calculator screens
+#include "kidt.h"       // Interrupt descriptor table and PIC setup
+#include "kcpu.h"       // k_enable_interrupts
+#include "kmultiboot.h" // Boot information from GRUB
+#include "kpmm.h"       // Physical page frame allocator
+#include "kheap.h"      // kmalloc/kfree and the boot-time arena
+#include "kvmm.h"       // Run-time page mapping and demand paging
+#include "kapic.h"      // Local APIC (timer interrupts)
+#include "ktime.h"      // Calibrated clock and ksleep_ns
+#include "ktrace.h"     // Latency probes
+#include "kserial.h"    // COM1 mirror of kprint
+#include "kacpi.h"      // ACPI tables (MADT)
+#include "ksmp.h"       // Starting the other CPU cores
+#include "kthread.h"    // Menu, calculator and background threads
+#include "kboot.h"      // Boot-phase timing
+#include "kfb.h"        // Framebuffer console
 
 // --- Menu Option Definitions ---
 // Define the menu options as an array of constant strings.
@@ -11,7 +31,8 @@ const char* menu_options[] = {
     "2. About MyOS",
     "3. Reboot",
     "4. Shutdown",
-    "5. Calculator" // New calculator option
+    "5. Calculator", // New calculator option
+    "6. Benchmarks"  // TSC-timed microbenchmarks
 };
 // Calculate the number of options in the menu dynamically.
 #define NUM_MENU_OPTIONS (sizeof(menu_options) / sizeof(menu_options[0]))
@@ -20,44 +41,44 @@ const char* menu_options[] = {
 static int selected_option = 0; // Index of the currently highlighted option (0-based)
 static const int MENU_START_Y = 5; // Y-coordinate (row) where the menu will start printing
 
+// The menu's widgets: the title, and the options as a one-column grid of
+// full-width rows (so drawing the menu also blanks whatever was on those rows).
+static struct kui_label menu_title;
+static struct kui_grid menu_grid;
+static int menu_on_screen = 0; // 0 when other output has replaced the menu since it was drawn
+
 // --- Calculator State Variables ---
 // These are global so they persist across calls to calculator functions
 static int calculator_cursor_X = 0; // X-position of the highlighted button in the calculator grid
 static int calculator_cursor_Y = 0; // Y-position of the highlighted button in the calculator grid
 
-// Buffers for calculator display and input
-static char calculator_display_buffer[VGA_WIDTH + 1]; // Main display, can show current number or result
-static char calculator_input_buffer[32];              // Stores digits being typed for current number
+// Buffers for calculator display and input.
+// They live for the whole session, so they come from the boot arena (see kernel_main).
+#define CALC_DISPLAY_SIZE (VGA_WIDTH + 1)
+#define CALC_INPUT_SIZE 64 // Longest expression, in characters (plus null)
+#define CALC_DISPLAY_CHARS 31 // Characters that fit inside the display box
+#define NAME_BUFFER_SIZE 256 // Longest name accepted at the welcome prompt
+static char* calculator_display_buffer; // Main display: the expression, its result or an error
+static char* calculator_input_buffer;   // The expression being typed
+static char* calculator_result_text;    // Last result in full (KBIGNUM_STRING_SIZE), shown below the keypad if long
 static int calculator_input_buffer_idx = 0;           // Current index in calculator_input_buffer
 
 // Calculator logic variables
-static int calculator_operand1 = 0;       // First operand in a calculation
-static char calculator_operator = '\0';   // Stored operator (+, -, *, /)
-static int calculator_expecting_operand2 = 0; // Flag: 1 if we're expecting the second number, 0 otherwise
-static int calculator_just_calculated = 0; // Flag: 1 if '=' was just pressed, clears display on next digit
-
-// --- Helper Function: k_strcpy ---
-// Simple string copy for internal use. Moved here to be defined before use.
-static void k_strcpy(char* dest, const char* src) {
-    int i = 0;
-    while (src[i] != '\0') {
-        dest[i] = src[i];
-        i++;
-    }
-    dest[i] = '\0';
-}
-
-// --- Helper Function: k_strcat ---
-// Simple string concatenation for internal use. Moved here to be defined before use.
-static void k_strcat(char* dest, const char* src) {
-    int dest_len = k_strlen(dest); // k_strlen is now public from kutils.h
-    int i = 0;
-    while (src[i] != '\0') {
-        dest[dest_len + i] = src[i];
-        i++;
-    }
-    dest[dest_len + i] = '\0';
-}
+static struct kbignum calculator_answer;  // Last result: the value of "ans" (or x) in the next expression
+static double calculator_answer_float;    // The same when it is a decimal. This file is built without
+                                          // SSE, so it is only ever passed by pointer
+static int calculator_answer_is_float = 0; // 1 if the last result is calculator_answer_float
+static uint64_t calculator_last_ns = 0;   // Time the last calculation took, 0 if none
+static int calculator_just_calculated = 0; // Flag: 1 if '=' was just pressed, the next key starts a new expression
+
+// --- Background Threads ---
+// Trace records are folded into statistics every LOG_FLUSH_INTERVAL_NS by
+// the log flusher. The prime search only runs when nothing else wants the
+// CPU; its progress is shown on the About screen.
+#define LOG_FLUSH_INTERVAL_NS (100 * KTIME_NS_PER_MS)
+static volatile uint64_t primes_found = 0;
+static volatile uint64_t primes_checked_up_to = 1;
+static int have_memory_map = 0; // Whether GRUB handed over a memory map (for the welcome text)
 
 // --- Function Prototypes for Menu Actions ---
 // These functions perform the actions associated with each menu item.
@@ -67,65 +88,57 @@ void reboot_action();
 void shutdown_action();
 void run_calculator(); // Renamed from 'calculator' to 'run_calculator' for clarity
 
-// --- Helper Function: delay ---
-// Creates a simple busy-wait delay. Not accurate in real-time, but works for basic pauses.
-// Parameters:
-//   iterations: The number of times to loop. Higher value means longer delay.
-void delay(uint32_t iterations) {
-    for (uint32_t i = 0; i < iterations; i++) {
-        __asm__ volatile ("nop"); // No operation - prevents compiler from optimizing out the loop entirely
-    }
-}
+// --- Thread Functions ---
+void menu_thread(void* unused);
+void calculator_thread(void* unused);
+void log_flusher_thread(void* unused);
+void prime_search_thread(void* unused);
+
+// --- Trace Probes ---
+// Time per redraw of the two interactive screens (see Benchmarks -> Trace).
+KTRACE_DEFINE(menu_probe, "draw_menu");
+KTRACE_DEFINE(calculator_probe, "draw_calculator");
 
 // --- Function: draw_menu ---
-// Clears the menu area and redraws all menu options, highlighting the selected one.
+// Draws the menu with the selected option highlighted. Once the menu is on
+// the screen, moving the highlight rewrites just the two options involved.
 void draw_menu() {
-    // Clear the area where the menu will be displayed to remove old highlights.
-    // We print 80 spaces (VGA_WIDTH) on each line with the default color.
-    for (int i = 0; i < (int)NUM_MENU_OPTIONS + 2; i++) { // Cast NUM_MENU_OPTIONS to int
-        kprint_at("                                                                                ", 0, MENU_START_Y + i, VGA_ATTRIB_WHITE_ON_BLACK);
-    }
-
-    // Print the menu title, centered and in yellow.
-    kprint_at("--- Main Menu ---", (VGA_WIDTH - k_strlen("--- Main Menu ---")) / 2, MENU_START_Y - 2, VGA_ATTRIB_YELLOW_ON_BLACK);
-
-    // Loop through each menu option to print it.
-    for (int i = 0; i < (int)NUM_MENU_OPTIONS; i++) { // Cast NUM_MENU_OPTIONS to int
-        int current_y = MENU_START_Y + i; // Calculate the Y position for this option.
-        
-        uint8_t color_attribute; // Variable to hold the color for the current option.
-        if (i == selected_option) {
-            // If this option is selected, use black text on a white background for highlighting.
-            color_attribute = VGA_ATTRIB_BLACK_ON_WHITE; 
-        } else {
-            // Otherwise, use white text on a black background (default).
-            color_attribute = VGA_ATTRIB_WHITE_ON_BLACK;
-        }
-
-        const char* option_str = menu_options[i]; // Get the string for the current option.
-        
-        // Calculate X position to center the option on the screen.
-        int start_x = (VGA_WIDTH - k_strlen(option_str)) / 2;
-
-        // Print the option string at the calculated position with the determined color.
-        kprint_at(option_str, start_x, current_y, color_attribute);
+    KTRACE_BEGIN(menu_probe);
+    if (!menu_on_screen) {
+        const char* title = "--- Main Menu ---";
+        int title_length = k_strlen(title);
+        kui_label_init(&menu_title, (kprint_columns() - title_length) / 2, MENU_START_Y - 2, title_length,
+                       VGA_ATTRIB_YELLOW_ON_BLACK);
+        kui_label_set(&menu_title, title);
+        kui_grid_init(&menu_grid, 0, MENU_START_Y, (int)NUM_MENU_OPTIONS, 1, kprint_columns(), kprint_columns(),
+                      menu_options, VGA_ATTRIB_WHITE_ON_BLACK, VGA_ATTRIB_BLACK_ON_WHITE);
     }
+    kui_grid_select(&menu_grid, 0, selected_option);
+
+    kui_frame_begin(!menu_on_screen); // One screen update for the whole menu
+    kui_label_draw(&menu_title);
+    kui_grid_draw(&menu_grid);
+    kui_frame_end();
+    menu_on_screen = 1;
+    KTRACE_END(menu_probe);
 }
 
 // --- Function: handle_menu_input ---
-// Manages menu navigation based on user key presses ('w' for up, 's' for down, Enter to select).
+// Manages menu navigation based on user key presses (Up/Down arrows or 'w'/'s', Enter to select).
 // Returns:
 //   The index of the selected option if Enter is pressed, otherwise -1.
 int handle_menu_input() {
-    char key = kgetc(); // Get a single character from the keyboard.
+    struct kkey_event event;
+    kgetkey(&event); // Get the next key press from the keyboard.
+    uint16_t key = event.key;
 
-    if (key == 'w' || key == 'W') { // If 'w' or 'W' (Up arrow simulation)
+    if (key == KEY_UP || key == 'w' || key == 'W') { // Up arrow (or 'w')
         selected_option--; // Move selection up.
         if (selected_option < 0) {
             selected_option = (int)NUM_MENU_OPTIONS - 1; // Cast NUM_MENU_OPTIONS to int for wrap-around
         }
         draw_menu(); // Redraw the menu with the new highlight.
-    } else if (key == 's' || key == 'S') { // If 's' or 'S' (Down arrow simulation)
+    } else if (key == KEY_DOWN || key == 's' || key == 'S') { // Down arrow (or 's')
         selected_option++; // Move selection down.
         if (selected_option >= (int)NUM_MENU_OPTIONS) { // Cast NUM_MENU_OPTIONS to int for comparison
             selected_option = 0; // Wrap around to the top if at the bottom.
@@ -139,15 +152,16 @@ int handle_menu_input() {
 
 // --- Calculator UI Layout ---
 // Defines the text labels for each button on the calculator grid.
-const char* calculator_layout[5][4] = {
+const char* calculator_layout[6][4] = {
     { "7", "8", "9", "/" },
     { "4", "5", "6", "*" },
     { "1", "2", "3", "-" },
     { "0", ".", "=", "+" },
-    { "C", "Q", "", "" }  // C for Clear, Q for Quit (exit calculator)
+    { "(", ")", "^", "%" }, // Parentheses, power, remainder
+    { "C", "Q", "!", "<" }  // C for Clear, Q for Quit (exit calculator), n!, < deletes the last character
 };
 // Dimensions of the calculator grid
-#define CALC_GRID_ROWS 5
+#define CALC_GRID_ROWS 6
 #define CALC_GRID_COLS 4
 // Starting position for drawing the calculator grid on screen
 #define CALC_START_X 20
@@ -155,210 +169,375 @@ const char* calculator_layout[5][4] = {
 // Position for the calculator display area
 #define CALC_DISPLAY_X 15
 #define CALC_DISPLAY_Y 3
+// Area below the keypad for results longer than the display: the rest of
+// the screen, which is much taller on the framebuffer console
+#define CALC_RESULT_Y (CALC_START_Y + CALC_GRID_ROWS + 1)
+#define CALC_RESULT_LINES (kprint_rows() - CALC_RESULT_Y - 1)
+
+// The calculator's widgets. Only what changed is drawn on a key press: a
+// move of the highlight rewrites two buttons, typing a digit a cell or two
+// of the display.
+static struct kui_label calc_box[4];        // Top, bottom, left and right edges of the display box
+static struct kui_label calc_display;       // calculator_display_buffer, inside the box
+static struct kui_label calc_time;          // How long the last calculation took
+static struct kui_grid calc_grid;
+static struct kui_textbox calc_result_box;  // A result too long for the display, in full ...
+static struct kui_label calc_result_more;   // ... and its last line, or how many digits are left out
+static int calculator_on_screen = 0;        // 0 until the widgets are set up on a cleared screen
+
+// --- Function: init_calculator_ui ---
+// Sets up the calculator's widgets; the next draw_calculator() draws them all.
+void init_calculator_ui() {
+    static const char* edges[4] = {
+        "-----------------------------------", "-----------------------------------", "|", "|"
+    };
+    static const int edge_x[4] = { CALC_DISPLAY_X, CALC_DISPLAY_X, CALC_DISPLAY_X, CALC_DISPLAY_X + 34 };
+    static const int edge_y[4] = { CALC_DISPLAY_Y - 1, CALC_DISPLAY_Y + 1, CALC_DISPLAY_Y, CALC_DISPLAY_Y };
+    for (int i = 0; i < 4; i++) {
+        kui_label_init(&calc_box[i], edge_x[i], edge_y[i], k_strlen(edges[i]), VGA_ATTRIB_WHITE_ON_BLACK);
+        kui_label_set(&calc_box[i], edges[i]);
+    }
+    kui_label_init(&calc_display, CALC_DISPLAY_X + 2, CALC_DISPLAY_Y, CALC_DISPLAY_CHARS, VGA_ATTRIB_YELLOW_ON_BLACK);
+    kui_label_init(&calc_time, CALC_DISPLAY_X + 37, CALC_DISPLAY_Y, 20, VGA_ATTRIB_DARK_GREY_ON_BLACK);
+    // Buttons are 3 cells wide, one cell apart.
+    kui_grid_init(&calc_grid, CALC_START_X, CALC_START_Y, CALC_GRID_ROWS, CALC_GRID_COLS, 3, 4,
+                  &calculator_layout[0][0], VGA_ATTRIB_WHITE_ON_BLACK, VGA_ATTRIB_BLACK_ON_WHITE);
+    kui_textbox_init(&calc_result_box, 0, CALC_RESULT_Y, kprint_columns(), CALC_RESULT_LINES - 1,
+                     VGA_ATTRIB_WHITE_ON_BLACK);
+    kui_label_init(&calc_result_more, 0, CALC_RESULT_Y + CALC_RESULT_LINES - 1, kprint_columns(),
+                   VGA_ATTRIB_WHITE_ON_BLACK);
+}
 
 // --- Function: draw_calculator ---
-// Draws the calculator interface, including buttons and the display.
+// Brings the calculator screen up to date: the display, the timing, the
+// highlighted button and the long-result area.
 // Parameters:
 //   highlight_x: X-coordinate of the currently highlighted button.
 //   highlight_y: Y-coordinate of the currently highlighted button.
 void draw_calculator(int highlight_x, int highlight_y) {
-    kclear_screen(); // Clear the screen for the calculator
+    KTRACE_BEGIN(calculator_probe);
+    kui_label_set(&calc_display, calculator_display_buffer);
 
-    // Draw the display area
-    kprint_at("-----------------------------------", CALC_DISPLAY_X, CALC_DISPLAY_Y - 1, VGA_ATTRIB_WHITE_ON_BLACK);
-    kprint_at("|                                 |", CALC_DISPLAY_X, CALC_DISPLAY_Y, VGA_ATTRIB_WHITE_ON_BLACK);
-    kprint_at("-----------------------------------", CALC_DISPLAY_X, CALC_DISPLAY_Y + 1, VGA_ATTRIB_WHITE_ON_BLACK);
-    
-    // Print the current content of the display buffer
-    kprint_at(calculator_display_buffer, CALC_DISPLAY_X + 2, CALC_DISPLAY_Y, VGA_ATTRIB_YELLOW_ON_BLACK);
-
-    // Draw the calculator buttons
-    for (int y = 0; y < CALC_GRID_ROWS; y++) {
-        for (int x = 0; x < CALC_GRID_COLS; x++) {
-            const char* label = calculator_layout[y][x];
-
-            // Skip drawing if there's no label (e.g., empty slots in the layout)
-            if (label[0] == '\0') continue;
-
-            // Determine button color: highlighted or normal
-            uint8_t color = (x == highlight_x && y == highlight_y)
-                ? VGA_ATTRIB_BLACK_ON_WHITE // Highlighted color
-                : VGA_ATTRIB_WHITE_ON_BLACK; // Normal color
-
-            // Create a padded string for the button label to ensure uniform width
-            char padded[5]; // Max 3 chars for label + 1 space + null terminator
-            k_strcpy(padded, "   "); // Fill with spaces
-            padded[k_strlen(label)] = '\0'; // Null-terminate after label length
-            k_strcpy(padded, label); // Copy label over spaces (e.g., " 7 " or " + ")
-
-            // Draw button centered in 3 spaces (each button is 3 chars wide + 1 space between)
-            kprint_at(padded, CALC_START_X + x * 4, CALC_START_Y + y, color);
-        }
+    char text[24];
+    text[0] = '\0';
+    if (calculator_last_ns) {
+        ksnprintf(text, sizeof(text), "%llu us", (unsigned long long)(calculator_last_ns / 1000));
     }
+    kui_label_set(&calc_time, text);
+
+    kui_grid_select(&calc_grid, highlight_x, highlight_y);
+
+    // A result too long for the display is shown in full below the keypad,
+    // up to CALC_RESULT_LINES lines; beyond that, the last line says how
+    // many digits are left out.
+    int length = k_strlen(calculator_result_text);
+    if (length <= CALC_DISPLAY_CHARS) {
+        length = 0; // Fits in the display
+    }
+    int box_chars = (CALC_RESULT_LINES - 1) * kprint_columns();
+    kui_textbox_set(&calc_result_box, calculator_result_text, length);
+    if (length <= box_chars + calc_result_more.width) {
+        kui_label_set_color(&calc_result_more, VGA_ATTRIB_WHITE_ON_BLACK);
+        kui_label_set(&calc_result_more, length > box_chars ? calculator_result_text + box_chars : "");
+    } else {
+        char more[40];
+        ksnprintf(more, sizeof(more), "... %d more digits", length - box_chars);
+        kui_label_set_color(&calc_result_more, VGA_ATTRIB_DARK_GREY_ON_BLACK);
+        kui_label_set(&calc_result_more, more);
+    }
+
+    kui_frame_begin(!calculator_on_screen); // Build the frame in the shadow buffer, flush once at the end
+    for (int i = 0; i < 4; i++) {
+        kui_label_draw(&calc_box[i]);
+    }
+    kui_label_draw(&calc_display);
+    kui_label_draw(&calc_time);
+    kui_grid_draw(&calc_grid);
+    kui_textbox_draw(&calc_result_box);
+    kui_label_draw(&calc_result_more);
+    kui_frame_end();
+    calculator_on_screen = 1;
+    KTRACE_END(calculator_probe);
 }
 
 
+// --- Function: show_expression ---
+// Shows the expression being typed; if it is longer than the display, its
+// end (where the typing happens) is shown.
+void show_expression() {
+    int length = calculator_input_buffer_idx;
+    if (length == 0) {
+        k_strcpy(calculator_display_buffer, "0");
+    } else if (length <= CALC_DISPLAY_CHARS) {
+        k_strcpy(calculator_display_buffer, calculator_input_buffer);
+    } else {
+        ksnprintf(calculator_display_buffer, CALC_DISPLAY_SIZE, "...%s",
+                  calculator_input_buffer + length - (CALC_DISPLAY_CHARS - 3));
+    }
+}
+
+// --- Function: show_result ---
+// Makes 'value' the "ans" of the next expression and shows it: in the
+// display if it fits, else abbreviated there and in full below the keypad.
+void show_result(const struct kbignum* value) {
+    kbignum_copy(&calculator_answer, value);
+    calculator_answer_is_float = 0;
+    int length = kbignum_to_string(value, calculator_result_text, KBIGNUM_STRING_SIZE);
+    if (length <= CALC_DISPLAY_CHARS) {
+        k_strcpy(calculator_display_buffer, calculator_result_text);
+    } else {
+        ksnprintf(calculator_display_buffer, CALC_DISPLAY_SIZE, "%.14s... (%d digits)",
+                  calculator_result_text, length);
+    }
+}
+
+// --- Function: show_float_result ---
+// Shows the decimal result left in calculator_answer_float, which becomes
+// "ans". Its shortest form always fits the display.
+void show_float_result() {
+    kfloat_format(&calculator_answer_float, calculator_result_text, KBIGNUM_STRING_SIZE);
+    k_strcpy(calculator_display_buffer, calculator_result_text);
+    calculator_answer_is_float = 1;
+}
+
+// --- Function: show_error ---
+// Shows why an expression has no value instead of a result, and starts
+// over from 0.
+void show_error(int status) {
+    kbignum_from_i64(&calculator_answer, 0);
+    calculator_answer_is_float = 0;
+    calculator_result_text[0] = '\0';
+    ksnprintf(calculator_display_buffer, CALC_DISPLAY_SIZE, "Error: %s", kexpr_error_name(status));
+}
+
+// --- Function: clear_calculator ---
+// The "C" button, and the state the calculator starts in.
+void clear_calculator() {
+    calculator_input_buffer_idx = 0;
+    calculator_input_buffer[0] = '\0';
+    calculator_result_text[0] = '\0';
+    k_strcpy(calculator_display_buffer, "0");
+    kbignum_from_i64(&calculator_answer, 0);
+    calculator_answer_is_float = 0;
+    calculator_last_ns = 0;
+    calculator_just_calculated = 0;
+}
+
 // --- Function: calculate_result ---
-// Performs the calculation based on stored operands and operator.
-// Updates calculator_operand1 with the result.
+// The "=" button: compiles the expression typed so far and runs it, with
+// "ans" standing for the previous result: exactly (in kbignum) while only
+// whole numbers are involved, in doubles once a decimal point is.
 void calculate_result() {
-    if (calculator_operator == '\0' || calculator_input_buffer_idx == 0) {
+    if (calculator_input_buffer_idx == 0) {
         return; // Nothing to calculate yet
     }
 
-    int operand2 = k_atoi(calculator_input_buffer);
-    int result = 0;
-
-    switch (calculator_operator) {
-        case '+': result = k_add_n((const int[]){calculator_operand1, operand2}, 2); break;
-        case '-': result = k_subtract(calculator_operand1, operand2); break;
-        case '*': result = k_multiply_n((const int[]){calculator_operand1, operand2}, 2); break;
-        case '/': result = k_divide(calculator_operand1, operand2); break;
+    struct kexpr_program program;
+    int error_pos;
+    int status = kexpr_compile(&program, calculator_input_buffer, &error_pos);
+    if (status != KEXPR_OK) {
+        // Keep the expression so it can be corrected with "<", and say
+        // where it went wrong (counting from 1, as a person would).
+        ksnprintf(calculator_display_buffer, CALC_DISPLAY_SIZE, "Error: %s at %d",
+                  kexpr_error_name(status), error_pos + 1);
+        return;
     }
 
-    calculator_operand1 = result; // Store result as the new first operand
-    k_itoa(result, calculator_display_buffer, 10); // Update display with result
-    calculator_input_buffer_idx = 0; // Clear current input buffer
+    uint64_t start = ktime_ns();
+    if (program.is_float || (program.uses_x && calculator_answer_is_float)) {
+        // An exact "ans" is rounded to a double through its decimal text.
+        if (program.uses_x && !calculator_answer_is_float &&
+            kfloat_parse(calculator_result_text[0] ? calculator_result_text : "0", 0,
+                         &calculator_answer_float) != KFLOAT_OK) {
+            status = KEXPR_OVERFLOW;
+        } else {
+            status = kexpr_eval_float(&program, &calculator_answer_float, &calculator_answer_float);
+        }
+        calculator_last_ns = ktime_ns() - start;
+        if (status == KEXPR_OK) {
+            show_float_result();
+        } else {
+            show_error(status);
+        }
+    } else {
+        struct kbignum result;
+        status = kexpr_eval_bignum(&program, &calculator_answer, &result);
+        calculator_last_ns = ktime_ns() - start;
+        if (status == KEXPR_OK) {
+            show_result(&result); // Becomes "ans" for the next expression
+        } else {
+            show_error(status);
+        }
+    }
+    calculator_input_buffer_idx = 0; // Start the next expression
     calculator_input_buffer[0] = '\0';
-    calculator_operator = '\0'; // Clear operator
-    calculator_expecting_operand2 = 0; // Reset flag
     calculator_just_calculated = 1; // Mark that a calculation just happened
 }
 
+// --- Helper Function: is_one_of ---
+// 1 if 'c' is one of the characters of 'set'.
+static int is_one_of(char c, const char* set) {
+    for (; *set; set++) {
+        if (*set == c) return 1;
+    }
+    return 0;
+}
+
+// --- Function: calculator_press ---
+// Handles one key, whether chosen on the keypad or typed directly (digits,
+// operators, '=' and Backspace can be typed; the arrows or w/a/s/d move the highlight).
+// Returns:
+//   0 if the key quits the calculator, 1 otherwise.
+int calculator_press(char key) {
+    if (key == 'Q' || key == 'q') {
+        return 0;
+    } else if (key == 'C' || key == 'c') {
+        clear_calculator();
+    } else if (key == '=') {
+        calculate_result();
+    } else if (key == '<' || key == '\b') {
+        if (calculator_input_buffer_idx > 0) {
+            calculator_input_buffer[--calculator_input_buffer_idx] = '\0';
+        }
+        calculator_just_calculated = 0;
+        show_expression();
+    } else if ((key >= '0' && key <= '9') || is_one_of(key, ".+-*/%^!()")) {
+        if (calculator_just_calculated) {
+            // A new expression. Starting it with an operator continues from
+            // the last result: "* 2" after "= 21" means "ans*2".
+            calculator_just_calculated = 0;
+            if (is_one_of(key, "+-*/%^!")) {
+                k_strcpy(calculator_input_buffer, "ans");
+                calculator_input_buffer_idx = 3;
+            }
+        }
+        if (calculator_input_buffer_idx < CALC_INPUT_SIZE - 1) {
+            calculator_input_buffer[calculator_input_buffer_idx++] = key;
+            calculator_input_buffer[calculator_input_buffer_idx] = '\0';
+        }
+        show_expression();
+    }
+    return 1;
+}
+
 // --- Function: run_calculator ---
 // Main loop for the calculator application.
 void run_calculator() {
     kclear_screen(); // Clear screen initially for calculator
+    init_calculator_ui();
+    calculator_on_screen = 0; // The first frame draws every widget
 
     // Initialize calculator state
-    k_strcpy(calculator_display_buffer, "0"); // Default display
-    calculator_input_buffer[0] = '\0';
-    calculator_input_buffer_idx = 0;
-    calculator_operand1 = 0;
-    calculator_operator = '\0';
-    calculator_expecting_operand2 = 0;
-    calculator_just_calculated = 0;
+    clear_calculator();
     calculator_cursor_X = 0; // Reset cursor position for calculator grid
     calculator_cursor_Y = 0;
 
     draw_calculator(calculator_cursor_X, calculator_cursor_Y); // Draw initial calculator UI
 
     while (1) {
-        char key = kgetc(); // Get key input
+        struct kkey_event event;
+        kgetkey(&event); // Get key input
+        uint16_t key = event.key;
 
-        // --- Navigation ---
-        if (key == 'w' || key == 'W') { // Up
+        // --- Navigation (arrows, or w/a/s/d) ---
+        if (key == KEY_UP || key == 'w' || key == 'W') { // Up
             if (calculator_cursor_Y > 0) calculator_cursor_Y--;
-        } else if (key == 's' || key == 'S') { // Down
+        } else if (key == KEY_DOWN || key == 's' || key == 'S') { // Down
             if (calculator_cursor_Y < CALC_GRID_ROWS - 1) calculator_cursor_Y++;
-        } else if (key == 'a' || key == 'A') { // Left
+        } else if (key == KEY_LEFT || key == 'a' || key == 'A') { // Left
             if (calculator_cursor_X > 0) calculator_cursor_X--;
-        } else if (key == 'd' || key == 'D') { // Right
+        } else if (key == KEY_RIGHT || key == 'd' || key == 'D') { // Right
             if (calculator_cursor_X < CALC_GRID_COLS - 1) calculator_cursor_X++;
-        } 
+        }
         // --- Action (Enter Key) ---
-        else if (key == '\n') { // Enter key pressed
+        else if (key == '\n') { // Enter key pressed: the highlighted button
             const char* button_label = calculator_layout[calculator_cursor_Y][calculator_cursor_X];
-
-            if (button_label[0] == '\0') { // Handle empty button slots
-                // Do nothing for empty slots
-            } else if (button_label[0] >= '0' && button_label[0] <= '9') { // Digit button
-                if (calculator_just_calculated || (calculator_expecting_operand2 && calculator_input_buffer_idx == 0)) {
-                    // If just calculated or expecting new operand, clear display/input
-                    calculator_input_buffer_idx = 0;
-                    calculator_input_buffer[0] = '\0';
-                    k_strcpy(calculator_display_buffer, "0"); // Reset display
-                    calculator_just_calculated = 0;
-                }
-                if (calculator_input_buffer_idx < (int)sizeof(calculator_input_buffer) - 1) { // Cast sizeof to int
-                    calculator_input_buffer[calculator_input_buffer_idx++] = button_label[0];
-                    calculator_input_buffer[calculator_input_buffer_idx] = '\0';
-                    k_strcpy(calculator_display_buffer, calculator_input_buffer);
-                }
-            } else if (button_label[0] == '.') { // Decimal point (not fully supported for int math, but can be added)
-                // For now, we only support integer math.
-                // You would need to implement floating-point support for this.
-            } else if (button_label[0] == 'C') { // Clear button
-                calculator_input_buffer_idx = 0;
-                calculator_input_buffer[0] = '\0';
-                k_strcpy(calculator_display_buffer, "0");
-                calculator_operand1 = 0;
-                calculator_operator = '\0';
-                calculator_expecting_operand2 = 0;
-                calculator_just_calculated = 0;
-            } else if (button_label[0] == 'Q') { // Quit button
+            if (!calculator_press(button_label[0])) {
                 return; // Exit the calculator loop, return to main menu
-            } else if (button_label[0] == '=') { // Equals button
-                calculate_result();
-            } else { // Operator button (+, -, *, /)
-                if (calculator_input_buffer_idx > 0) { // If a number has been entered
-                    if (calculator_operator != '\0') { // If there's a pending operation, calculate it first
-                        calculate_result();
-                    }
-                    calculator_operand1 = k_atoi(calculator_input_buffer);
-                } else if (calculator_just_calculated) {
-                    // If we just calculated, the result is already in calculator_operand1
-                    calculator_just_calculated = 0;
-                }
-                
-                calculator_operator = button_label[0];
-                calculator_expecting_operand2 = 1;
-                calculator_input_buffer_idx = 0; // Clear input buffer for next operand
-                calculator_input_buffer[0] = '\0';
-                k_strcpy(calculator_display_buffer, button_label); // Show operator on display temporarily
             }
         }
+        // --- Typed keys ---
+        else if (key == KEY_DELETE) {
+            calculator_press('\b');
+        } else if (key < 0x80 && !calculator_press((char)key)) {
+            return;
+        }
         // Redraw calculator UI with updated position and display
         draw_calculator(calculator_cursor_X, calculator_cursor_Y);
     }
 }
 
+// --- Function: read_number ---
+// Prompts until the user types a whole number (of any length up to the
+// line). kbignum_from_string reports where the number ended, so "12abc" is
+// rejected instead of silently read as 12.
+// Parameters:
+//   prompt: Shown before each attempt.
+//   buffer, size: Scratch space for the typed line.
+//   value: Receives the number.
+static void read_number(const char* prompt, char* buffer, int size, struct kbignum* value) {
+    for (;;) {
+        kprint(prompt, VGA_ATTRIB_WHITE_ON_BLACK);
+        kgets(buffer, size); // Get string input.
+
+        const char* end;
+        int status = kbignum_from_string(value, buffer, &end);
+        while (*end == ' ') {
+            end++; // Trailing spaces are harmless
+        }
+        if (status == KBIGNUM_OK && *end == '\0') {
+            return;
+        }
+        kprint(status == KBIGNUM_OVERFLOW ? "Too large, try again.\n" : "Not a number, try again.\n",
+               VGA_ATTRIB_RED_ON_BLACK);
+    }
+}
+
+// --- Function: print_result ---
+// One "Label: value" line of the Do Math results, or the reason there is none.
+static void print_result(const char* label, const struct kbignum* value, int status) {
+    char text[KBIGNUM_STRING_SIZE];
+    const char* shown = text;
+    if (status == KBIGNUM_DIV_ZERO) {
+        shown = "undefined (division by zero)";
+    } else if (status != KBIGNUM_OK) {
+        shown = "too large";
+    } else {
+        kbignum_to_string(value, text, sizeof(text));
+    }
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "%s: %k%s\n", label,
+            status == KBIGNUM_OK ? VGA_ATTRIB_WHITE_ON_BLACK : VGA_ATTRIB_RED_ON_BLACK, shown);
+}
+
 // --- Menu Action Function: do_math_action ---
 // Handles the "Do Math" menu option. Prompts for two numbers, performs basic math, and displays results.
+// The numbers may have any number of digits: the math is done with kbignum.
 void do_math_action() {
     kclear_screen(); // Clear the screen for the math application.
-    char input_buffer[32]; // Buffer for string input from user.
-    int num1, num2;         // Variables to store the two integer inputs.
-    char result_str[32];    // Buffer to store string representation of math results.
-    int sum, difference, product, quotient; // Variables for math results.
+    char input_buffer[VGA_WIDTH]; // Buffer for string input from user (one screen line).
+    struct kbignum num1, num2;     // The two inputs.
+    struct kbignum sum, difference, product, quotient, remainder; // Math results.
 
     kprint("--- Do Math ---\n", VGA_ATTRIB_YELLOW_ON_BLACK); // Title for the math section.
     
-    kprint("Enter first number: ", VGA_ATTRIB_WHITE_ON_BLACK);
-    kgets(input_buffer, sizeof(input_buffer)); // Get string input.
-    num1 = k_atoi(input_buffer);               // Convert string to integer.
-
-    kprint("Enter second number: ", VGA_ATTRIB_WHITE_ON_BLACK);
-    kgets(input_buffer, sizeof(input_buffer)); // Get string input.
-    num2 = k_atoi(input_buffer);               // Convert string to integer.
-
-    // Perform math operations using kmath functions.
-    // Note: k_add_n and k_multiply_n take an array.
-    sum = k_add_n((const int[]){num1, num2}, 2); // Example: add 2 numbers
-    difference = k_subtract(num1, num2);
-    product = k_multiply_n((const int[]){num1, num2}, 2); // Example: multiply 2 numbers
-    quotient = k_divide(num1, num2); // k_divide handles division by zero internally.
-
-    // Print results with different colors for clarity.
-    kprint("Sum: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
-    k_itoa(sum, result_str, 10); // Convert sum to string.
-    kprint(result_str, VGA_ATTRIB_WHITE_ON_BLACK); // Print sum.
-    kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
-
-    kprint("Difference: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
-    k_itoa(difference, result_str, 10); // Convert difference to string.
-    kprint(result_str, VGA_ATTRIB_WHITE_ON_BLACK); // Print difference.
+    read_number("Enter first number: ", input_buffer, sizeof(input_buffer), &num1);
+    read_number("Enter second number: ", input_buffer, sizeof(input_buffer), &num2);
+
+    int sum_status = kbignum_add(&sum, &num1, &num2);
+    int difference_status = kbignum_sub(&difference, &num1, &num2);
+    int product_status = kbignum_mul(&product, &num1, &num2);
+    int divide_status = kbignum_divmod(&quotient, &remainder, &num1, &num2);
+
+    // Print results with different colors for clarity: labels in light blue,
+    // values in white, all in one screen update.
+    kprint_batch_begin();
+    print_result("Sum", &sum, sum_status);
+    print_result("Difference", &difference, difference_status);
+    print_result("Product", &product, product_status);
+    print_result("Quotient", &quotient, divide_status);
+    print_result("Remainder", &remainder, divide_status);
     kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
-
-    kprint("Product: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
-    k_itoa(product, result_str, 10); // Convert product to string.
-    kprint(result_str, VGA_ATTRIB_WHITE_ON_BLACK); // Print product.
-    kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
-
-    kprint("Quotient: ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
-    k_itoa(quotient, result_str, 10); // Convert quotient to string.
-    kprint(result_str, VGA_ATTRIB_WHITE_ON_BLACK); // Print quotient.
-    kprint("\n\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint_batch_end();
 
     kprint("Press any key to return to menu...\n", VGA_ATTRIB_DARK_GREY_ON_BLACK);
     kgetc(); // Wait for any key press before returning to the menu.
@@ -372,6 +551,11 @@ void about_myos_action() {
     kprint("MyOS is a simple 64-bit kernel built from scratch using assembly for boot and C for Kernel.\n", VGA_ATTRIB_WHITE_ON_BLACK);
     kprint("It offers basic VGA type display text output and keyboard input.\n", VGA_ATTRIB_WHITE_ON_BLACK);
     kprint("Developed by me as a learning project for OS development.\n", VGA_ATTRIB_WHITE_ON_BLACK);
+
+    // Proof that the background thread kept computing while the menu waited for keys.
+    kprintf(VGA_ATTRIB_LIGHT_BLUE_ON_BLACK, "\nBackground prime search: %k%llu%k primes up to %k%llu\n",
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)primes_found, VGA_ATTRIB_LIGHT_BLUE_ON_BLACK,
+            VGA_ATTRIB_WHITE_ON_BLACK, (unsigned long long)primes_checked_up_to);
     kprint("\nPress any key to return to menu...\n", VGA_ATTRIB_DARK_GREY_ON_BLACK);
     kgetc(); // Wait for a key press.
 }
@@ -384,8 +568,9 @@ void reboot_action() {
     // This is a common way to trigger a system reset using the PS/2 keyboard controller (8042).
     // Sending 0xFE to port 0x64 (command port) often initiates a CPU reset.
     outb(0x64, 0xFE); 
-    // If the reboot command doesn't work, enter an infinite halt loop.
-    while(1) { __asm__ volatile("hlt"); }
+    // If the reboot command doesn't work, enter an infinite halt loop. Interrupts
+    // go off first, or the timer would keep scheduling the background threads.
+    while(1) { __asm__ volatile("cli; hlt"); }
 }
 
 // --- Menu Action Function: shutdown_action ---
@@ -395,28 +580,77 @@ void shutdown_action() {
     kprint("Shutting down system...\n", VGA_ATTRIB_RED_ON_BLACK);
     // In a real OS, this would involve sending ACPI commands for a graceful shutdown.
     // For a simple kernel, halting the CPU indefinitely is the closest equivalent.
-    while(1) { __asm__ volatile("hlt"); }
+    // With interrupts disabled, so the background threads stop as well.
+    while(1) { __asm__ volatile("cli; hlt"); }
 }
 
-// --- Main Kernel Entry Point ---
-// This is the first C function executed after the assembly bootstrap.
-void kernel_main(void) {
-    kclear_screen(); // Clear the screen to ensure a clean start.
+// --- Thread: calculator_thread ---
+void calculator_thread(void* unused) {
+    (void)unused;
+    run_calculator();
+}
+
+// --- Thread: log_flusher_thread ---
+// Aggregates the trace probes' records in the background, so the rings do
+// not overflow while the UI is busy and a report is cheap to produce.
+void log_flusher_thread(void* unused) {
+    (void)unused;
+    while (1) {
+        ktrace_drain();
+        ksleep_ns(LOG_FLUSH_INTERVAL_NS);
+    }
+}
+
+// --- Thread: prime_search_thread ---
+// Counts primes by trial division, forever. It runs at the lowest priority,
+// so it only gets the CPU while the interactive threads wait for keys.
+void prime_search_thread(void* unused) {
+    (void)unused;
+    for (uint64_t n = 2; ; n++) {
+        int prime = 1;
+        for (uint64_t d = 2; d * d <= n; d++) {
+            if (n % d == 0) {
+                prime = 0;
+                break;
+            }
+        }
+        if (prime) {
+            primes_found++;
+        }
+        primes_checked_up_to = n;
+    }
+}
 
+// --- Thread: menu_thread ---
+// The welcome prompts and the main menu loop.
+void menu_thread(void* unused) {
+    (void)unused;
     // --- Initial Welcome and Name Input ---
     kprint("Welcome to MyOS!\n", VGA_ATTRIB_LIGHT_CYAN_ON_BLACK);
+    if (have_memory_map) {
+        kprintf(VGA_ATTRIB_DARK_GREY_ON_BLACK, "Memory: %llu MB free\n",
+                (unsigned long long)(kpmm_free_frames() * KPMM_PAGE_SIZE / (1024 * 1024)));
+    } else {
+        kprint("Warning: not booted by a Multiboot2 loader, no memory map.\n", VGA_ATTRIB_RED_ON_BLACK);
+    }
+    kprintf(VGA_ATTRIB_DARK_GREY_ON_BLACK, "CPUs: %d online\n", ksmp_cpu_count());
     
-    char name[256]; // Buffer for user's name.
-    kprint("Please enter your name: ", VGA_ATTRIB_WHITE_ON_BLACK);
-    kgets(name, sizeof(name)); 
-
-    kprint("\nHello, ", VGA_ATTRIB_GREEN_ON_BLACK);
-    kprint(name, VGA_ATTRIB_YELLOW_ON_BLACK); // Print name in yellow.
-    kprint("!\n", VGA_ATTRIB_GREEN_ON_BLACK);
+    char* name = kmalloc(NAME_BUFFER_SIZE); // Buffer for user's name; only needed for the greeting.
+    if (name) { // kmalloc fails only when there is no memory map to allocate from
+        kprint("Please enter your name: ", VGA_ATTRIB_WHITE_ON_BLACK);
+        kboot_first_prompt(); // Boot is over once the user is asked something
+        kgets(name, NAME_BUFFER_SIZE);
+
+        kprint("\nHello, ", VGA_ATTRIB_GREEN_ON_BLACK);
+        kprint(name, VGA_ATTRIB_YELLOW_ON_BLACK); // Print name in yellow.
+        kprint("!\n", VGA_ATTRIB_GREEN_ON_BLACK);
+        kfree(name);
+    }
 
     // --- "Do you want to do math?" Prompt ---
     char math_choice_str[10]; // Buffer for user's yes/no input.
     kprint("\nDo you want to do math? (yes/no): ", VGA_ATTRIB_MAGENTA_ON_BLACK);
+    kboot_first_prompt(); // Only the first call counts (no name prompt without kmalloc)
     kgets(math_choice_str, sizeof(math_choice_str));
 
     // Simple check for "yes" or "y". Case-insensitive for 'y'/'Y'.
@@ -444,8 +678,18 @@ void kernel_main(void) {
                     case 3: // "4. Shutdown"
                         shutdown_action();
                         break;
-                    case 4: // "5. Calculator"
-                        run_calculator(); // Call the new calculator function
+                    case 4: { // "5. Calculator"
+                        // The calculator gets its own thread; the menu waits for it to quit.
+                        struct kthread* calculator = kthread_create("calculator", calculator_thread, 0, KTHREAD_PRIO_HIGH);
+                        if (calculator) {
+                            kthread_join(calculator);
+                        } else {
+                            run_calculator();
+                        }
+                        break;
+                    }
+                    case 5: // "6. Benchmarks"
+                        kbench_menu();
                         break;
                     default:
                         kprint("Invalid option selected!\n", VGA_ATTRIB_RED_ON_BLACK);
@@ -453,6 +697,7 @@ void kernel_main(void) {
                 }
                 // After an action, clear the screen and prepare to return to the menu loop.
                 kclear_screen();
+                menu_on_screen = 0; // Draw the whole menu again
                 kprint("Returning to main menu...\n\n", VGA_ATTRIB_DARK_GREY_ON_BLACK);
                 selected_option = 0; // Reset selection to the first option when returning.
             }
@@ -462,13 +707,75 @@ void kernel_main(void) {
         kclear_screen();
         kprint("Ok then, time ends...\n", VGA_ATTRIB_RED_ON_BLACK);
         
-        // Simple 3-second delay (approximate)
-        delay(30000000); // Adjust this value for longer/shorter delay
+        // 3-second pause; the CPU halts until the timer fires.
+        ksleep_ns(3 * KTIME_NS_PER_S);
 
         kprint("CPU halting.\n", VGA_ATTRIB_RED_ON_BLACK);
-        // Halt the CPU indefinitely.
+        // Halt the CPU indefinitely; with interrupts off no other thread runs either.
+        k_disable_interrupts();
         while (1) {
             __asm__ volatile ("hlt"); 
         }
     }
 }
+
+// --- Main Kernel Entry Point ---
+// This is the first C function executed after the assembly bootstrap.
+// Parameters:
+//   multiboot_magic: EAX at boot; MULTIBOOT2_BOOTLOADER_MAGIC when loaded by GRUB.
+//   multiboot_info: EBX at boot; physical address of the boot information.
+void kernel_main(uint32_t multiboot_magic, uint64_t multiboot_info) {
+    // Per-CPU data first: trace probes and locks ask which CPU they run on.
+    ksmp_early_init();
+
+    // Pick the SSE2/AVX2 memcpy/memset/strlen variants before anything else,
+    // so even the first screen clear uses them.
+    k_simd_init();
+
+    // --- Physical Memory ---
+    // Read the memory map GRUB handed over and build the page frame allocator.
+    int have_boot_info = kmultiboot_init(multiboot_magic, multiboot_info);
+    kpmm_init();
+    kheap_init();
+
+    // Session-long buffers come from the arena: no per-object header, never freed.
+    calculator_display_buffer = karena_alloc(CALC_DISPLAY_SIZE, KHEAP_CACHE_LINE);
+    calculator_input_buffer = karena_alloc(CALC_INPUT_SIZE, 0);
+    calculator_result_text = karena_alloc(KBIGNUM_STRING_SIZE, 0);
+    kboot_stamp(KBOOT_MEMORY);
+
+    kclear_screen(); // Clear the screen to ensure a clean start.
+
+    // --- Interrupts ---
+    // Install the IDT and remap the PICs, bring up the serial console and
+    // the page fault handler, calibrate the clock and pick a timer, hook up
+    // the keyboard IRQ, start the other cores, then start accepting interrupts.
+    // The console moves to GRUB's framebuffer, if there is one, as soon as
+    // pages can be mapped.
+    kidt_init();
+    kserial_init();
+    kvmm_init();
+    kfb_init();
+    kacpi_init();
+    kapic_init();
+    ktime_init();
+    kinput_init();
+    kboot_stamp(KBOOT_DEVICES);
+    ksmp_init();
+    kboot_stamp(KBOOT_SMP);
+    kthread_init();
+    k_enable_interrupts();
+    kboot_stamp(KBOOT_THREADS);
+
+    // --- Threads ---
+    // The boot code becomes the idle thread; everything else runs in
+    // threads of its own. Without a memory map there are no thread stacks,
+    // and the menu simply runs here.
+    have_memory_map = have_boot_info;
+    if (!kthread_create("menu", menu_thread, 0, KTHREAD_PRIO_HIGH)) {
+        menu_thread(0);
+    }
+    kthread_create("log flusher", log_flusher_thread, 0, KTHREAD_PRIO_NORMAL);
+    kthread_create("prime search", prime_search_thread, 0, KTHREAD_PRIO_LOW);
+    kthread_idle();
+}
@@ -0,0 +1,699 @@
+#include <stdint.h>
+#include "kexpr.h"    // Our own declarations
+#include "kbignum.h"  // Exact interpreter
+#include "kheap.h"    // kmalloc for the exact interpreter's stack
+#include "kfloat.h"   // Decimal numbers in the source
+
+// --- Bytecode ---
+// One byte per instruction; OP_SMALL and OP_CONST are followed by a
+// one-byte operand. Every instruction works on the operand stack.
+enum {
+    OP_RET,   // Ends the program; the top of the stack is the result
+    OP_SMALL, // Push the next byte as a signed value (-128..127)
+    OP_CONST, // Push constants[next byte]
+    OP_FCONST, // Push constants[next byte], read as the bits of a double
+    OP_X,     // Push the variable
+    OP_ADD,   // a b -> a + b
+    OP_SUB,   // a b -> a - b
+    OP_MUL,   // a b -> a * b
+    OP_DIV,   // a b -> a / b
+    OP_MOD,   // a b -> a % b
+    OP_POW,   // a b -> a ^ b
+    OP_NEG,   // a -> -a
+    OP_FACT,  // a -> a!
+    OP_COUNT
+};
+
+static int folding_enabled = 1;
+
+// ============================================================================
+// 64-bit arithmetic, checked
+// Shared by constant folding and the interpreter, so both agree on every
+// overflow and error.
+// ============================================================================
+
+// 0! .. 20!: every factorial that fits in int64_t.
+static const int64_t factorials[21] = {
+    1LL, 1LL, 2LL, 6LL, 24LL, 120LL, 720LL, 5040LL, 40320LL, 362880LL, 3628800LL,
+    39916800LL, 479001600LL, 6227020800LL, 87178291200LL, 1307674368000LL,
+    20922789888000LL, 355687428096000LL, 6402373705728000LL, 121645100408832000LL,
+    2432902008176640000LL,
+};
+
+// --- Helper Function: checked_div ---
+static inline int checked_div(int64_t a, int64_t b, int64_t* r) {
+    if (b == 0) return KEXPR_DIV_ZERO;
+    if (a == INT64_MIN && b == -1) return KEXPR_OVERFLOW;
+    *r = a / b;
+    return KEXPR_OK;
+}
+
+// --- Helper Function: checked_mod ---
+static inline int checked_mod(int64_t a, int64_t b, int64_t* r) {
+    if (b == 0) return KEXPR_DIV_ZERO;
+    *r = (b == -1) ? 0 : a % b; // INT64_MIN % -1 traps on x86
+    return KEXPR_OK;
+}
+
+// --- Helper Function: checked_pow ---
+// Square and multiply: one multiplication per bit of the exponent.
+static int checked_pow(int64_t base, int64_t exponent, int64_t* r) {
+    if (exponent < 0) return KEXPR_DOMAIN;
+    int64_t result = 1;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            if (__builtin_mul_overflow(result, base, &result)) return KEXPR_OVERFLOW;
+        }
+        exponent >>= 1;
+        if (exponent > 0 && __builtin_mul_overflow(base, base, &base)) return KEXPR_OVERFLOW;
+    }
+    *r = result;
+    return KEXPR_OK;
+}
+
+// --- Helper Function: checked_fact ---
+static inline int checked_fact(int64_t a, int64_t* r) {
+    if (a < 0) return KEXPR_DOMAIN;
+    if (a > 20) return KEXPR_OVERFLOW;
+    *r = factorials[a];
+    return KEXPR_OK;
+}
+
+// --- Helper Function: apply_op ---
+// Any operator, for constant folding ('b' is ignored by the unary ones).
+static int apply_op(int op, int64_t a, int64_t b, int64_t* r) {
+    switch (op) {
+        case OP_ADD: return __builtin_add_overflow(a, b, r) ? KEXPR_OVERFLOW : KEXPR_OK;
+        case OP_SUB: return __builtin_sub_overflow(a, b, r) ? KEXPR_OVERFLOW : KEXPR_OK;
+        case OP_MUL: return __builtin_mul_overflow(a, b, r) ? KEXPR_OVERFLOW : KEXPR_OK;
+        case OP_DIV: return checked_div(a, b, r);
+        case OP_MOD: return checked_mod(a, b, r);
+        case OP_POW: return checked_pow(a, b, r);
+        case OP_NEG: return __builtin_sub_overflow((int64_t)0, a, r) ? KEXPR_OVERFLOW : KEXPR_OK;
+        case OP_FACT: return checked_fact(a, r);
+    }
+    return KEXPR_SYNTAX;
+}
+
+// ============================================================================
+// Compiler
+// ============================================================================
+
+// Binding powers: how tightly an operator holds its operands.
+#define POWER_ADD    10 // + -
+#define POWER_MUL    20 // * / %
+#define POWER_PREFIX 30 // unary -
+#define POWER_POW    40 // ^
+#define POWER_FACT   50 // !
+
+struct compiler {
+    const char* source;
+    const char* p;                  // Next character to read
+    struct kexpr_program* program;
+    int depth;                      // Operand stack depth after the code so far
+    int status;                     // First error, KEXPR_OK while there is none
+    const char* error_at;
+    int decimal;                    // The source has a decimal number (see emit_operator)
+};
+
+// What the compiler knows about the code of one subexpression.
+struct operand {
+    int start;           // Offset of its first instruction
+    int depth_before;    // Stack depth before it
+    int constants_before; // Constant pool size before it
+    int is_constant;     // 1 if it is the single push of 'value'
+    int64_t value;
+};
+
+// --- Helper Function: fail ---
+// Records the first error; later ones are consequences of it.
+static void fail(struct compiler* c, int status) {
+    if (c->status == KEXPR_OK) {
+        c->status = status;
+        c->error_at = c->p;
+    }
+}
+
+// --- Helper Function: peek ---
+// The next character that is not a space.
+static char peek(struct compiler* c) {
+    while (*c->p == ' ' || *c->p == '\t') {
+        c->p++;
+    }
+    return *c->p;
+}
+
+// --- Helper Function: emit ---
+static void emit(struct compiler* c, uint8_t byte) {
+    struct kexpr_program* program = c->program;
+    if (program->length >= KEXPR_CODE_SIZE) {
+        fail(c, KEXPR_TOO_BIG);
+        return;
+    }
+    program->code[program->length++] = byte;
+}
+
+// --- Helper Function: grow_stack ---
+// Accounts for one more value on the operand stack.
+static void grow_stack(struct compiler* c) {
+    c->depth++;
+    if (c->depth > c->program->max_depth) {
+        c->program->max_depth = c->depth;
+        if (c->depth > KEXPR_STACK_DEPTH) {
+            fail(c, KEXPR_TOO_BIG);
+        }
+    }
+}
+
+// --- Helper Function: emit_pooled ---
+// Emits 'op' with the index of 'value' in the constant pool, adding it
+// there if it is not already (once per distinct value).
+static void emit_pooled(struct compiler* c, uint8_t op, int64_t value) {
+    struct kexpr_program* program = c->program;
+    int index = 0;
+    while (index < program->constant_count && program->constants[index] != value) {
+        index++;
+    }
+    if (index == program->constant_count) {
+        if (index == KEXPR_CONSTANTS) {
+            fail(c, KEXPR_TOO_BIG);
+            return;
+        }
+        program->constants[program->constant_count++] = value;
+    }
+    emit(c, op);
+    emit(c, (uint8_t)index);
+}
+
+// --- Helper Function: emit_push ---
+// Pushes a constant: small ones are inline, others go to the constant pool.
+static void emit_push(struct compiler* c, int64_t value) {
+    if (value >= -128 && value <= 127) {
+        emit(c, OP_SMALL);
+        emit(c, (uint8_t)(int8_t)value);
+    } else {
+        emit_pooled(c, OP_CONST, value);
+    }
+    grow_stack(c);
+}
+
+// --- Helper Function: begin_operand ---
+static struct operand begin_operand(struct compiler* c) {
+    struct operand o = { c->program->length, c->depth, c->program->constant_count, 0, 0 };
+    return o;
+}
+
+// --- Helper Function: emit_constant_operand ---
+// Replaces the code emitted since 'o' began with a push of 'value'.
+static void emit_constant_operand(struct compiler* c, struct operand* o, int64_t value) {
+    c->program->length = o->start;
+    c->program->constant_count = o->constants_before;
+    c->depth = o->depth_before;
+    emit_push(c, value);
+    o->is_constant = 1;
+    o->value = value;
+}
+
+// --- Helper Function: emit_operator ---
+// Emits 'op' applied to 'left' (and 'right' for binary operators), or,
+// when all operands are constants and the result is defined, the folded
+// value instead. An operation that would fail is left in the code, so the
+// error is reported (or, in kbignum, the exact value computed) at run time.
+// A program with decimal numbers runs in doubles, where 7/2 is 3.5, so
+// there only + - * and negation are folded, and only while the result is
+// small enough (2^53) to be exact in a double too.
+static void emit_operator(struct compiler* c, struct operand* left, const struct operand* right, int op) {
+    if (folding_enabled && left->is_constant && (!right || right->is_constant)) {
+        int64_t value;
+        int same_in_double = op == OP_ADD || op == OP_SUB || op == OP_MUL || op == OP_NEG;
+        if (apply_op(op, left->value, right ? right->value : 0, &value) == KEXPR_OK &&
+            (!c->decimal || (same_in_double && value >= -(1LL << 53) && value <= (1LL << 53)))) {
+            emit_constant_operand(c, left, value);
+            return;
+        }
+    }
+    emit(c, (uint8_t)op);
+    if (right) {
+        c->depth--; // Two operands in, one result out
+    }
+    left->is_constant = 0;
+}
+
+// --- Helper Function: infix_operator ---
+// The opcode and left binding power of an infix or postfix operator.
+// Returns:
+//   The binding power, or 0 if 'ch' is not one.
+static int infix_operator(char ch, int* op) {
+    switch (ch) {
+        case '+': *op = OP_ADD; return POWER_ADD;
+        case '-': *op = OP_SUB; return POWER_ADD;
+        case '*': *op = OP_MUL; return POWER_MUL;
+        case '/': *op = OP_DIV; return POWER_MUL;
+        case '%': *op = OP_MOD; return POWER_MUL;
+        case '^': *op = OP_POW; return POWER_POW;
+        case '!': *op = OP_FACT; return POWER_FACT;
+    }
+    return 0;
+}
+
+static struct operand parse_expression(struct compiler* c, int min_power);
+
+// --- Helper Function: parse_primary ---
+// A number, the variable, a parenthesized expression or a unary minus.
+static struct operand parse_primary(struct compiler* c) {
+    char ch = peek(c);
+    struct operand o = begin_operand(c);
+
+    if ((ch >= '0' && ch <= '9') || ch == '.') {
+        const char* number = c->p;
+        const char* digits_end = number;
+        while (*digits_end >= '0' && *digits_end <= '9') {
+            digits_end++;
+        }
+        if (*digits_end == '.' || *digits_end == 'e' || *digits_end == 'E') {
+            // A decimal number: pooled as the bits of its double.
+            union { double d; int64_t bits; } decimal;
+            int status = kfloat_parse(number, &c->p, &decimal.d);
+            if (status != KFLOAT_OK) {
+                c->p = number;
+                fail(c, status == KFLOAT_RANGE ? KEXPR_RANGE : KEXPR_SYNTAX);
+                return o;
+            }
+            emit_pooled(c, OP_FCONST, decimal.bits);
+            grow_stack(c);
+            c->program->is_float = 1;
+            return o;
+        }
+        uint64_t value = 0;
+        while (*c->p >= '0' && *c->p <= '9') {
+            unsigned digit = (unsigned)(*c->p - '0');
+            if (value > ((uint64_t)INT64_MAX - digit) / 10) {
+                c->p = number; // Point the error at the number, not its middle
+                fail(c, KEXPR_RANGE);
+                return o;
+            }
+            value = value * 10 + digit;
+            c->p++;
+        }
+        emit_push(c, (int64_t)value);
+        o.is_constant = 1;
+        o.value = (int64_t)value;
+    } else if (ch == 'x') {
+        c->p++;
+        emit(c, OP_X);
+        grow_stack(c);
+        c->program->uses_x = 1;
+    } else if (ch == 'a' && c->p[1] == 'n' && c->p[2] == 's') {
+        c->p += 3;
+        emit(c, OP_X);
+        grow_stack(c);
+        c->program->uses_x = 1;
+    } else if (ch == '(') {
+        c->p++;
+        o = parse_expression(c, 0);
+        if (peek(c) != ')') {
+            fail(c, KEXPR_SYNTAX);
+            return o;
+        }
+        c->p++;
+    } else if (ch == '-') {
+        c->p++;
+        o = parse_expression(c, POWER_PREFIX);
+        emit_operator(c, &o, 0, OP_NEG);
+    } else if (ch == '+') {
+        c->p++;
+        o = parse_expression(c, POWER_PREFIX);
+    } else {
+        fail(c, KEXPR_SYNTAX);
+    }
+    return o;
+}
+
+// --- Helper Function: parse_expression ---
+// The Pratt loop: after an operand, keep absorbing operators that bind
+// more tightly than 'min_power'. A left-associative operator parses its
+// right side with its own power (so a-b-c stops before the second '-'),
+// a right-associative one with one less (so 2^3^2 takes the whole 3^2).
+static struct operand parse_expression(struct compiler* c, int min_power) {
+    struct operand left = parse_primary(c);
+    while (c->status == KEXPR_OK) {
+        int op = OP_RET; // Set by infix_operator when it finds one
+        int power = infix_operator(peek(c), &op);
+        if (power <= min_power) {
+            break;
+        }
+        c->p++;
+        if (op == OP_FACT) {
+            emit_operator(c, &left, 0, OP_FACT);
+            continue;
+        }
+        struct operand right = parse_expression(c, op == OP_POW ? power - 1 : power);
+        emit_operator(c, &left, &right, op);
+    }
+    return left;
+}
+
+// --- Function: kexpr_compile ---
+int kexpr_compile(struct kexpr_program* program, const char* source, int* error_pos) {
+    struct compiler c = { source, source, program, 0, KEXPR_OK, source, 0 };
+    program->length = 0;
+    program->max_depth = 0;
+    program->constant_count = 0;
+    program->is_float = 0;
+    program->uses_x = 0;
+
+    // Whether to fold as for doubles must be known before the first fold,
+    // which may come before the decimal number ("1/2 + 0.5").
+    for (const char* p = source; *p; p++) {
+        if (*p == '.' || ((*p == 'e' || *p == 'E') && p > source && p[-1] >= '0' && p[-1] <= '9')) {
+            c.decimal = 1;
+        }
+    }
+
+    parse_expression(&c, 0);
+    if (c.status == KEXPR_OK && peek(&c) != '\0') {
+        fail(&c, KEXPR_SYNTAX); // Something after a complete expression, e.g. "2 3" or "1)"
+    }
+    emit(&c, OP_RET);
+
+    if (error_pos) {
+        *error_pos = c.status == KEXPR_OK ? 0 : (int)(c.error_at - source);
+    }
+    return c.status;
+}
+
+// --- Function: kexpr_set_folding ---
+void kexpr_set_folding(int enable) {
+    folding_enabled = enable;
+}
+
+// ============================================================================
+// 64-bit interpreter
+// Direct threading with GCC's labels as values: each instruction ends with
+// its own indirect jump to the next one, which predicts better than the
+// single shared jump of a switch. The top of the stack lives in a local
+// ('top') so most instructions touch memory once.
+// ============================================================================
+
+// --- Helper Function: run ---
+// Evaluates the program for 'count' consecutive values of x, restarting at
+// the first instruction after each result, so batch mode has no call per
+// evaluation. Failed evaluations store 0.
+// Returns:
+//   The status of the last evaluation; *failures counts all failed ones.
+static int run(const struct kexpr_program* program, int64_t x, int count, int64_t* results, int* failures) {
+    static const void* const dispatch[OP_COUNT] = {
+        [OP_RET] = &&op_ret,   [OP_SMALL] = &&op_small, [OP_CONST] = &&op_const, [OP_FCONST] = &&op_fconst,
+        [OP_X] = &&op_x,       [OP_ADD] = &&op_add,     [OP_SUB] = &&op_sub,
+        [OP_MUL] = &&op_mul,   [OP_DIV] = &&op_div,     [OP_MOD] = &&op_mod,
+        [OP_POW] = &&op_pow,   [OP_NEG] = &&op_neg,     [OP_FACT] = &&op_fact,
+    };
+    int64_t stack[KEXPR_STACK_DEPTH + 1]; // +1: the first push saves an unused 'top'
+    const uint8_t* ip;
+    int64_t* sp;
+    int64_t top;
+    int status;
+    *failures = 0;
+
+#define NEXT goto *dispatch[*ip++]
+#define CHECK(expr) do { status = (expr); if (status != KEXPR_OK) goto done; } while (0)
+
+start:
+    ip = program->code;
+    sp = stack;
+    top = 0;
+    NEXT;
+
+op_small: *sp++ = top; top = (int8_t)*ip++; NEXT;
+op_const: *sp++ = top; top = program->constants[*ip++]; NEXT;
+op_x:     *sp++ = top; top = x; NEXT;
+op_add:   CHECK(__builtin_add_overflow(*--sp, top, &top) ? KEXPR_OVERFLOW : KEXPR_OK); NEXT;
+op_sub:   CHECK(__builtin_sub_overflow(*--sp, top, &top) ? KEXPR_OVERFLOW : KEXPR_OK); NEXT;
+op_mul:   CHECK(__builtin_mul_overflow(*--sp, top, &top) ? KEXPR_OVERFLOW : KEXPR_OK); NEXT;
+op_div:   CHECK(checked_div(*--sp, top, &top)); NEXT;
+op_mod:   CHECK(checked_mod(*--sp, top, &top)); NEXT;
+op_pow:   CHECK(checked_pow(*--sp, top, &top)); NEXT;
+op_neg:   CHECK(__builtin_sub_overflow((int64_t)0, top, &top) ? KEXPR_OVERFLOW : KEXPR_OK); NEXT;
+op_fact:  CHECK(checked_fact(top, &top)); NEXT;
+op_fconst: CHECK(KEXPR_DECIMAL); NEXT;
+op_ret:
+    status = KEXPR_OK;
+done:
+    if (status != KEXPR_OK) {
+        top = 0;
+        (*failures)++;
+    }
+    *results++ = top;
+    if (--count > 0) {
+        x++;
+        goto start;
+    }
+    return status;
+
+#undef NEXT
+#undef CHECK
+}
+
+// --- Function: kexpr_eval ---
+int kexpr_eval(const struct kexpr_program* program, int64_t x, int64_t* result) {
+    int failures;
+    return run(program, x, 1, result, &failures);
+}
+
+// --- Function: kexpr_eval_range ---
+int kexpr_eval_range(const struct kexpr_program* program, int64_t first, int count, int64_t* results) {
+    int failures = 0;
+    if (count > 0) {
+        run(program, first, count, results, &failures);
+    }
+    return failures;
+}
+
+// ============================================================================
+// Exact interpreter
+// ============================================================================
+
+// --- Helper Function: bignum_status ---
+static inline int bignum_status(int status) {
+    if (status == KBIGNUM_OK) return KEXPR_OK;
+    if (status == KBIGNUM_DIV_ZERO) return KEXPR_DIV_ZERO;
+    return KEXPR_OVERFLOW;
+}
+
+// --- Helper Function: bignum_pow ---
+// r = base ^ exponent by square and multiply. Any base other than -1, 0
+// and 1 overflows 4096 bits well before an exponent of 4096, which keeps
+// the exponent in one limb.
+static int bignum_pow(struct kbignum* r, const struct kbignum* base, const struct kbignum* exponent) {
+    if (exponent->negative) {
+        return KEXPR_DOMAIN;
+    }
+    int trivial_base = base->used == 0 || (base->used == 1 && base->limb[0] == 1);
+    uint32_t e = exponent->used ? exponent->limb[0] : 0;
+    if (!trivial_base && (exponent->used > 1 || e > 4096)) {
+        return KEXPR_OVERFLOW;
+    }
+    if (trivial_base && exponent->used > 1) {
+        e = (exponent->limb[0] & 1) | 2; // Only the parity matters for -1; nonzero for 0
+    }
+
+    struct kbignum result, square;
+    kbignum_from_i64(&result, 1);
+    kbignum_copy(&square, base);
+    while (e > 0) {
+        if ((e & 1) && kbignum_mul(&result, &result, &square) != KBIGNUM_OK) {
+            return KEXPR_OVERFLOW;
+        }
+        e >>= 1;
+        if (e > 0 && kbignum_mul(&square, &square, &square) != KBIGNUM_OK) {
+            return KEXPR_OVERFLOW;
+        }
+    }
+    kbignum_copy(r, &result);
+    return KEXPR_OK;
+}
+
+// --- Function: kexpr_eval_bignum ---
+// A plain switch loop: every instruction does kbignum work that dwarfs the
+// dispatch.
+int kexpr_eval_bignum(const struct kexpr_program* program, const struct kbignum* x, struct kbignum* result) {
+    struct kbignum* stack = kmalloc((size_t)(program->max_depth ? program->max_depth : 1) * sizeof(struct kbignum));
+    if (!stack) {
+        return KEXPR_NO_MEMORY;
+    }
+    int sp = 0; // Slots in use; the top is stack[sp - 1]
+    int status = KEXPR_OK;
+    const uint8_t* ip = program->code;
+
+    while (status == KEXPR_OK) {
+        uint8_t op = *ip++;
+        // Operands of a binary operator (b alone for a unary one). The
+        // compiler guarantees they exist when an operator needs them.
+        struct kbignum* a = sp > 1 ? &stack[sp - 2] : stack;
+        struct kbignum* b = sp > 0 ? &stack[sp - 1] : stack;
+        if (op == OP_RET) {
+            kbignum_copy(result, b);
+            break;
+        }
+        switch (op) {
+            case OP_SMALL: kbignum_from_i64(&stack[sp++], (int8_t)*ip++); break;
+            case OP_CONST: kbignum_from_i64(&stack[sp++], program->constants[*ip++]); break;
+            case OP_X:     kbignum_copy(&stack[sp++], x); break;
+            case OP_FCONST: status = KEXPR_DECIMAL; break;
+            case OP_ADD:   status = bignum_status(kbignum_add(a, a, b)); sp--; break;
+            case OP_SUB:   status = bignum_status(kbignum_sub(a, a, b)); sp--; break;
+            case OP_MUL:   status = bignum_status(kbignum_mul(a, a, b)); sp--; break;
+            case OP_DIV:   status = bignum_status(kbignum_divmod(a, 0, a, b)); sp--; break;
+            case OP_MOD:   status = bignum_status(kbignum_divmod(0, a, a, b)); sp--; break;
+            case OP_POW:   status = bignum_pow(a, a, b); sp--; break;
+            case OP_NEG:   b->negative = b->used ? !b->negative : 0; break;
+            case OP_FACT:
+                if (b->negative) {
+                    status = KEXPR_DOMAIN;
+                } else if (b->used > 1) {
+                    status = KEXPR_OVERFLOW;
+                } else {
+                    status = bignum_status(kbignum_factorial(b, b->used ? b->limb[0] : 0));
+                }
+                break;
+            default:
+                status = KEXPR_SYNTAX; // Not produced by kexpr_compile
+                break;
+        }
+    }
+
+    kfree(stack);
+    return status;
+}
+
+// ============================================================================
+// Double interpreter
+// ============================================================================
+
+// --- Helper Function: is_whole ---
+// 1 if 'value' is a whole number that fits in int64_t.
+static inline int is_whole(double value) {
+    return value > -9.2e18 && value < 9.2e18 && (double)(int64_t)value == value;
+}
+
+// --- Helper Function: float_pow ---
+// Square and multiply with a whole exponent; a negative one divides.
+static int float_pow(double base, double exponent, double* r) {
+    if (!is_whole(exponent)) {
+        return KEXPR_DOMAIN;
+    }
+    int64_t e = (int64_t)exponent;
+    if (e < 0 && base == 0.0) {
+        return KEXPR_DIV_ZERO;
+    }
+    uint64_t bits = e < 0 ? 0 - (uint64_t)e : (uint64_t)e;
+    double result = 1.0;
+    while (bits) {
+        if (bits & 1) {
+            result *= base;
+        }
+        bits >>= 1;
+        base *= base;
+    }
+    *r = e < 0 ? 1.0 / result : result;
+    return KEXPR_OK;
+}
+
+// --- Helper Function: float_op ---
+// One operator in doubles ('b' is ignored by the unary ones). Results that
+// leave the finite doubles are errors rather than inf or nan, so the
+// calculator never shows them.
+static int float_op(int op, double a, double b, double* r) {
+    int status = KEXPR_OK;
+    switch (op) {
+        case OP_ADD: *r = a + b; break;
+        case OP_SUB: *r = a - b; break;
+        case OP_MUL: *r = a * b; break;
+        case OP_DIV:
+            if (b == 0.0) return KEXPR_DIV_ZERO;
+            *r = a / b;
+            break;
+        case OP_MOD: {
+            if (b == 0.0) return KEXPR_DIV_ZERO;
+            double quotient = a / b;
+            if (!(quotient > -9.2e18 && quotient < 9.2e18)) {
+                return KEXPR_OVERFLOW; // Too large to truncate through int64_t
+            }
+            *r = a - b * (double)(int64_t)quotient;
+            break;
+        }
+        case OP_POW: status = float_pow(a, b, r); break;
+        case OP_NEG: *r = -a; break;
+        case OP_FACT: {
+            if (!is_whole(a) || a < 0) return KEXPR_DOMAIN;
+            if (a > 170) return KEXPR_OVERFLOW; // 171! is beyond the doubles
+            double result = 1.0;
+            for (int64_t i = 2; i <= (int64_t)a; i++) {
+                result *= (double)i;
+            }
+            *r = result;
+            break;
+        }
+        default:
+            return KEXPR_SYNTAX;
+    }
+    if (status == KEXPR_OK && !__builtin_isfinite(*r)) {
+        return KEXPR_OVERFLOW;
+    }
+    return status;
+}
+
+// --- Function: kexpr_eval_float ---
+// A switch loop, like the exact interpreter: the calculator runs a program
+// once per key press, so dispatch speed does not matter here.
+int kexpr_eval_float(const struct kexpr_program* program, const double* x, double* result) {
+    double stack[KEXPR_STACK_DEPTH];
+    int sp = 0; // Slots in use; the top is stack[sp - 1]
+    const uint8_t* ip = program->code;
+
+    for (;;) {
+        uint8_t op = *ip++;
+        int status = KEXPR_OK;
+        switch (op) {
+            case OP_RET:
+                *result = stack[sp - 1];
+                return KEXPR_OK;
+            case OP_SMALL: stack[sp++] = (double)(int8_t)*ip++; break;
+            case OP_CONST: stack[sp++] = (double)program->constants[*ip++]; break;
+            case OP_FCONST: {
+                union { int64_t bits; double d; } decimal;
+                decimal.bits = program->constants[*ip++];
+                stack[sp++] = decimal.d;
+                break;
+            }
+            case OP_X: stack[sp++] = *x; break;
+            case OP_NEG:
+            case OP_FACT:
+                status = float_op(op, stack[sp - 1], 0.0, &stack[sp - 1]);
+                break;
+            default:
+                status = float_op(op, stack[sp - 2], stack[sp - 1], &stack[sp - 2]);
+                sp--;
+                break;
+        }
+        if (status != KEXPR_OK) {
+            return status;
+        }
+    }
+}
+
+// --- Function: kexpr_error_name ---
+const char* kexpr_error_name(int status) {
+    switch (status) {
+        case KEXPR_OK:        return "ok";
+        case KEXPR_SYNTAX:    return "syntax error";
+        case KEXPR_TOO_BIG:   return "expression too long";
+        case KEXPR_RANGE:     return "number too large";
+        case KEXPR_OVERFLOW:  return "too large";
+        case KEXPR_DIV_ZERO:  return "division by zero";
+        case KEXPR_DOMAIN:    return "undefined";
+        case KEXPR_NO_MEMORY: return "out of memory";
+        case KEXPR_DECIMAL:   return "not an integer";
+    }
+    return "error";
+}
@@ -0,0 +1,95 @@
+#ifndef KEXPR_H // Standard header guard to prevent multiple inclusions
+#define KEXPR_H
+
+#include <stdint.h>   // For int64_t, uint8_t
+#include "kbignum.h"  // Exact evaluation for the calculator
+
+// --- Expression Compiler and Bytecode VM ---
+// kexpr_compile() parses an integer expression with a Pratt parser (one
+// function, driven by a binding power per operator) and emits bytecode
+// for a stack machine in the same pass. Subexpressions whose operands are
+// all constants are folded at compile time, so "(2+3)*x" runs as "5*x".
+//
+// Grammar, loosest binding first:
+//   a + b, a - b
+//   a * b, a / b, a % b     (division rounds toward zero, as in C)
+//   -a                      (so -x*2 is (-x)*2 and -2^2 is -4)
+//   a ^ b                   (power, right-associative: 2^3^2 = 2^9)
+//   a!                      (factorial)
+//   numbers, the variable x (also spelled ans), ( ... )
+//
+// The same program runs on three interpreters: kexpr_eval() in 64-bit
+// integers, checked for overflow (fast, and used by the batch mode),
+// kexpr_eval_bignum() exactly in kbignum (used by the calculator), and
+// kexpr_eval_float() in doubles, for programs with a decimal number such as
+// "2.5" or "1e-3" (is_float). Doubles are passed by pointer, as in kfloat.h.
+
+#define KEXPR_CODE_SIZE   128 // Bytes of bytecode per program
+#define KEXPR_CONSTANTS   32  // Constants that do not fit in a one-byte immediate
+#define KEXPR_STACK_DEPTH 16  // Deepest operand stack a program may need
+
+// Results.
+#define KEXPR_OK        0
+#define KEXPR_SYNTAX    1 // Not a valid expression (see error_pos)
+#define KEXPR_TOO_BIG   2 // Program exceeds KEXPR_CODE_SIZE, KEXPR_CONSTANTS or KEXPR_STACK_DEPTH
+#define KEXPR_RANGE     3 // A number in the source does not fit in 64 bits
+#define KEXPR_OVERFLOW  4 // A result does not fit (int64_t, or kbignum)
+#define KEXPR_DIV_ZERO  5 // Division or remainder by zero
+#define KEXPR_DOMAIN    6 // Negative exponent or factorial of a negative number
+#define KEXPR_NO_MEMORY 7 // kexpr_eval_bignum could not allocate its stack
+#define KEXPR_DECIMAL   8 // An integer interpreter met a decimal number (see is_float)
+
+// A compiled expression.
+struct kexpr_program {
+    uint8_t code[KEXPR_CODE_SIZE];
+    int length;                         // Bytes of code used
+    int max_depth;                      // Operand stack slots needed (at most; folding may lower it)
+    int constant_count;
+    int is_float;                       // 1 if it has a decimal number: run it with kexpr_eval_float
+    int uses_x;                         // 1 if it reads the variable
+    int64_t constants[KEXPR_CONSTANTS]; // Decimal numbers are stored as the bits of their double
+};
+
+// --- Function Declarations ---
+
+// kexpr_compile: Compiles 'source' into 'program'.
+// Parameters:
+//   error_pos: If not 0, receives the offset in 'source' where an error
+//              was found (0 on success).
+// Returns:
+//   KEXPR_OK, KEXPR_SYNTAX, KEXPR_TOO_BIG or KEXPR_RANGE.
+int kexpr_compile(struct kexpr_program* program, const char* source, int* error_pos);
+
+// kexpr_eval: Runs 'program' in 64-bit integers with x = 'x'.
+// Returns:
+//   KEXPR_OK (result in *result), KEXPR_OVERFLOW, KEXPR_DIV_ZERO or KEXPR_DOMAIN.
+int kexpr_eval(const struct kexpr_program* program, int64_t x, int64_t* result);
+
+// kexpr_eval_range: Batch mode: evaluates 'program' for x = first,
+// first + 1, ..., first + count - 1 into results[0..count).
+// Returns:
+//   The number of evaluations that failed (their results are 0).
+int kexpr_eval_range(const struct kexpr_program* program, int64_t first, int count, int64_t* results);
+
+// kexpr_eval_bignum: Runs 'program' exactly, with x = *x. The operand
+// stack (max_depth kbignums, about 0.5KB each) comes from kmalloc.
+// Returns:
+//   As kexpr_eval, or KEXPR_NO_MEMORY.
+int kexpr_eval_bignum(const struct kexpr_program* program, const struct kbignum* x, struct kbignum* result);
+
+// kexpr_eval_float: Runs 'program' in doubles with x = *x. '%' is
+// a - b * trunc(a / b); '^' and '!' need whole numbers (negative exponents
+// are fine). 'result' may point to the same double as 'x'.
+// Returns:
+//   KEXPR_OK, KEXPR_OVERFLOW (the result would be infinite), KEXPR_DIV_ZERO
+//   or KEXPR_DOMAIN.
+int kexpr_eval_float(const struct kexpr_program* program, const double* x, double* result);
+
+// kexpr_set_folding: Turns constant folding on (default) or off, to
+// measure what it saves.
+void kexpr_set_folding(int enable);
+
+// kexpr_error_name: "syntax error", "overflow", ... for messages.
+const char* kexpr_error_name(int status);
+
+#endif // KEXPR_H
@@ -0,0 +1,410 @@
+#include <stdint.h>
+#include "kfb.h"        // Our own declarations
+#include "kfont.h"      // The bitmap font
+#include "kprint.h"     // Grid limits, kprint_set_size
+#include "kutils.h"     // k_memcpy, k_memset
+#include "kmultiboot.h" // The framebuffer tag
+#include "kvmm.h"       // Mapping the framebuffer, lazily backed buffers
+
+#define KFB_MAX_SCALE  4   // Bounds the glyph cache (442KB per attribute at 4x)
+#define KFB_ATTRIBUTES 256 // Every (background << 4) | foreground combination
+
+// What a cell of the back buffer shows: the cell value, plus CELL_CURSOR if
+// the cursor is drawn over it, or CELL_UNKNOWN.
+#define CELL_CURSOR  0x10000u
+#define CELL_UNKNOWN 0xFFFFFFFFu
+// A space in the default colors: all background, and black is 0 in every
+// RGB format, so a zeroed cell shows it.
+#define CELL_BLANK   ((uint32_t)((VGA_ATTRIB_WHITE_ON_BLACK << 8) | ' '))
+
+// The 16 VGA text colors, as 0xRRGGBB.
+static const uint32_t vga_rgb[16] = {
+    0x000000, 0x0000AA, 0x00AA00, 0x00AAAA, 0xAA0000, 0xAA00AA, 0xAA5500, 0xAAAAAA,
+    0x555555, 0x5555FF, 0x55FF55, 0x55FFFF, 0xFF5555, 0xFF55FF, 0xFFFF55, 0xFFFFFF
+};
+
+// Two pixels, for copies with 8-byte stores. may_alias: the same memory is
+// written as uint32_t pixels elsewhere.
+typedef uint64_t __attribute__((may_alias)) pixel_pair;
+
+// --- Console State ---
+static struct kfb_mode mode;
+static int active = 0;
+static int scale = 0;
+static int cell_w, cell_h;      // Pixels per cell
+static int cell_pixels;         // cell_w * cell_h
+static int grid_columns, grid_rows; // Character cells on the screen
+static uint32_t* screen_origin; // Framebuffer pixel of the grid's top-left corner
+static uint32_t* back;          // The grid: grid_columns * cell_w by grid_rows * cell_h pixels
+static int back_pitch;          // Pixels per back buffer line
+static int back_top;            // Back buffer text row holding screen row 0
+static uint32_t palette[16];    // The VGA colors in the framebuffer's pixel format
+
+// Glyph cache: KFB_ATTRIBUTES blocks of KFONT_GLYPHS glyphs, each cell_h
+// lines of cell_w pixels. A block is rendered whole the first time its
+// attribute is drawn.
+static uint32_t* cache;
+static uint32_t cache_ready[KFB_ATTRIBUTES / 32]; // Bit a: block a is rendered
+static int cache_enabled = 1;
+
+// What each back buffer text row shows, indexed like the back buffer.
+static uint32_t shown[KPRINT_MAX_ROWS][KPRINT_MAX_COLUMNS];
+// Dirty rectangle of each text row: columns [dirty_x0, dirty_x1), empty
+// when dirty_x0 >= dirty_x1.
+static int dirty_x0[KPRINT_MAX_ROWS];
+static int dirty_x1[KPRINT_MAX_ROWS];
+static int cursor_x = -1, cursor_y = 0; // Cell with the cursor drawn (-1: none)
+static struct kfb_stats stats;
+
+// --- Helper Function: pack_color ---
+// Converts 0xRRGGBB into the framebuffer's pixel format.
+static uint32_t pack_color(uint32_t rgb) {
+    uint32_t r = (rgb >> 16) & 0xFF;
+    uint32_t g = (rgb >> 8) & 0xFF;
+    uint32_t b = rgb & 0xFF;
+    return ((r >> (8 - mode.red_bits)) << mode.red_shift) |
+           ((g >> (8 - mode.green_bits)) << mode.green_shift) |
+           ((b >> (8 - mode.blue_bits)) << mode.blue_shift);
+}
+
+// --- Helper Function: copy_pixels ---
+// Copies 'count' pixels (an even number) with aligned 8-byte stores.
+static inline void copy_pixels(uint32_t* dst, const uint32_t* src, int count) {
+    pixel_pair* d = (pixel_pair*)dst;
+    const pixel_pair* s = (const pixel_pair*)src;
+    for (int i = 0; i < count / 2; i++) {
+        d[i] = s[i];
+    }
+}
+
+// --- Helper Function: render_glyph ---
+// Expands a glyph of the font into pixels, bit by bit, at the current scale.
+// Parameters:
+//   dst: Top-left pixel of the cell.
+//   pitch: Pixels per line at dst.
+//   glyph: Index into kfont_glyphs.
+//   attribute: VGA attribute: foreground in the low 4 bits, background above.
+static void render_glyph(uint32_t* dst, int pitch, int glyph, uint8_t attribute) {
+    uint32_t fg = palette[attribute & 0x0F];
+    uint32_t bg = palette[attribute >> 4];
+    for (int row = 0; row < KFONT_HEIGHT; row++) {
+        uint8_t bits = kfont_glyphs[glyph][row];
+        uint32_t* pixel = dst;
+        for (int col = 0; col < KFONT_WIDTH; col++) {
+            uint32_t color = (bits & (0x20 >> col)) ? fg : bg;
+            for (int i = 0; i < scale; i++) {
+                *pixel++ = color;
+            }
+        }
+        // The other lines of a scaled font row repeat the first.
+        for (int i = 1; i < scale; i++) {
+            copy_pixels(dst + i * pitch, dst, cell_w);
+        }
+        dst += scale * pitch;
+    }
+}
+
+// --- Helper Function: fill_cache ---
+// Renders all glyphs in one attribute's colors into its cache block.
+static void fill_cache(uint8_t attribute) {
+    uint32_t* block = cache + (uint64_t)attribute * KFONT_GLYPHS * cell_pixels;
+    for (int glyph = 0; glyph < KFONT_GLYPHS; glyph++) {
+        render_glyph(block + glyph * cell_pixels, cell_w, glyph, attribute);
+    }
+    cache_ready[attribute / 32] |= 1u << (attribute % 32);
+    stats.cache_fills++;
+}
+
+// --- Helper Function: back_row ---
+// The back buffer is a ring of text rows, like kprint's shadow buffer:
+// screen row y lives in back buffer row (back_top + y) % grid_rows, so a
+// scroll moves no pixels.
+static inline int back_row(int y) {
+    int row = back_top + y;
+    return row >= grid_rows ? row - grid_rows : row;
+}
+
+// --- Helper Function: back_line ---
+// The first pixel of screen row y's cells in the back buffer.
+static inline uint32_t* back_line(int y) {
+    return back + (uint64_t)back_row(y) * cell_h * back_pitch;
+}
+
+// --- Helper Function: mark_all_dirty ---
+static void mark_all_dirty(void) {
+    for (int y = 0; y < grid_rows; y++) {
+        dirty_x0[y] = 0;
+        dirty_x1[y] = grid_columns;
+    }
+}
+
+// --- Public Function: kfb_scale ---
+// The smallest scale whose grid stays within KPRINT_MAX_COLUMNS x
+// KPRINT_MAX_ROWS, so the cells are as small as the font allows and only
+// very large modes get bigger letters. At KFB_MAX_SCALE the grid is cut to
+// the limits instead (and centered).
+int kfb_scale(const struct kfb_mode* m) {
+    int s = 1;
+    while (s < KFB_MAX_SCALE && (m->width / (KFONT_WIDTH * s) > KPRINT_MAX_COLUMNS ||
+                                 m->height / (KFONT_HEIGHT * s) > KPRINT_MAX_ROWS)) {
+        s++;
+    }
+    if (m->width / (KFONT_WIDTH * s) < VGA_WIDTH || m->height / (KFONT_HEIGHT * s) < VGA_HEIGHT) {
+        return 0;
+    }
+    return s;
+}
+
+// --- Public Function: kfb_grid ---
+void kfb_grid(const struct kfb_mode* m, int* columns, int* rows) {
+    int s = kfb_scale(m);
+    if (s == 0) {
+        *columns = *rows = 0;
+        return;
+    }
+    uint32_t c = m->width / (KFONT_WIDTH * s);
+    uint32_t r = m->height / (KFONT_HEIGHT * s);
+    *columns = (int)(c > KPRINT_MAX_COLUMNS ? KPRINT_MAX_COLUMNS : c);
+    *rows = (int)(r > KPRINT_MAX_ROWS ? KPRINT_MAX_ROWS : r);
+}
+
+// --- Public Function: kfb_back_buffer_bytes ---
+uint64_t kfb_back_buffer_bytes(const struct kfb_mode* m) {
+    uint64_t s = (uint64_t)kfb_scale(m);
+    int columns, rows;
+    kfb_grid(m, &columns, &rows);
+    return (columns * KFONT_WIDTH * s) * (rows * KFONT_HEIGHT * s) * sizeof(uint32_t);
+}
+
+// --- Public Function: kfb_glyph_cache_bytes ---
+uint64_t kfb_glyph_cache_bytes(const struct kfb_mode* m) {
+    uint64_t s = (uint64_t)kfb_scale(m);
+    return (uint64_t)KFB_ATTRIBUTES * KFONT_GLYPHS * (KFONT_WIDTH * s) * (KFONT_HEIGHT * s) * sizeof(uint32_t);
+}
+
+// --- Public Function: kfb_attach ---
+int kfb_attach(const struct kfb_mode* m, uint32_t* back_buffer, uint32_t* glyph_cache) {
+    int s = kfb_scale(m);
+    if (s == 0 || !back_buffer || !glyph_cache ||
+        m->red_bits > 8 || m->green_bits > 8 || m->blue_bits > 8) {
+        return 0;
+    }
+    mode = *m;
+    scale = s;
+    cell_w = KFONT_WIDTH * scale;
+    cell_h = KFONT_HEIGHT * scale;
+    cell_pixels = cell_w * cell_h;
+    kfb_grid(m, &grid_columns, &grid_rows);
+    back = back_buffer;
+    back_pitch = grid_columns * cell_w;
+    back_top = 0;
+    cache = glyph_cache;
+    for (int i = 0; i < KFB_ATTRIBUTES / 32; i++) {
+        cache_ready[i] = 0;
+    }
+    for (int i = 0; i < 16; i++) {
+        palette[i] = pack_color(vga_rgb[i]);
+    }
+
+    // Center the grid. The margins are cleared once and never drawn again
+    // (black is 0 in every RGB format).
+    uint32_t origin_x = (mode.width - grid_columns * cell_w) / 2;
+    uint32_t origin_y = (mode.height - grid_rows * cell_h) / 2;
+    screen_origin = (uint32_t*)((uint8_t*)mode.pixels + (uint64_t)origin_y * mode.pitch) + origin_x;
+    for (uint32_t line = 0; line < mode.height; line++) {
+        k_memset((uint8_t*)mode.pixels + (uint64_t)line * mode.pitch, 0, mode.width * sizeof(uint32_t));
+    }
+
+    for (int y = 0; y < grid_rows; y++) {
+        for (int x = 0; x < grid_columns; x++) {
+            shown[y][x] = CELL_UNKNOWN;
+        }
+        dirty_x0[y] = grid_columns;
+        dirty_x1[y] = 0;
+    }
+    cursor_x = -1;
+    cursor_y = 0;
+    stats = (struct kfb_stats){ 0 };
+    active = 1;
+    return 1;
+}
+
+// --- Public Function: kfb_init ---
+int kfb_init(void) {
+    const struct multiboot_tag_framebuffer* tag =
+        (const struct multiboot_tag_framebuffer*)kmultiboot_find_tag(MULTIBOOT_TAG_TYPE_FRAMEBUFFER);
+    if (!tag || tag->framebuffer_type != MULTIBOOT_FRAMEBUFFER_TYPE_RGB || tag->framebuffer_bpp != 32) {
+        return 0; // Text mode, or a pixel format the console does not draw
+    }
+    struct kfb_mode m = {
+        (uint32_t*)tag->framebuffer_addr, tag->framebuffer_width, tag->framebuffer_height,
+        tag->framebuffer_pitch, tag->red_field_position, tag->red_mask_size,
+        tag->green_field_position, tag->green_mask_size, tag->blue_field_position, tag->blue_mask_size
+    };
+    if (kfb_scale(&m) == 0) {
+        return 0;
+    }
+
+    // The framebuffer is PCI memory, normally above RAM: map it at its own
+    // address, write-combining, so kfb_present's stores go out in bursts.
+    uint64_t start = tag->framebuffer_addr & ~(KVMM_PAGE_4K - 1);
+    uint64_t end = (tag->framebuffer_addr + (uint64_t)m.pitch * m.height + KVMM_PAGE_4K - 1) & ~(KVMM_PAGE_4K - 1);
+    if (kvmm_map(start, start, end - start, KVMM_WRITE | KVMM_NOEXEC | KVMM_CACHE_WC) < 0) {
+        return 0;
+    }
+
+    // The back buffer and the glyph cache are demand-zero: only the glyph
+    // blocks of attributes that are actually used ever get frames.
+    uint32_t* back_buffer = kvmm_alloc_lazy(kfb_back_buffer_bytes(&m), KVMM_WRITE | KVMM_NOEXEC);
+    uint32_t* glyph_cache = kvmm_alloc_lazy(kfb_glyph_cache_bytes(&m), KVMM_WRITE | KVMM_NOEXEC);
+    if (!kfb_attach(&m, back_buffer, glyph_cache)) {
+        kvmm_free_lazy(back_buffer);
+        kvmm_free_lazy(glyph_cache);
+        return 0;
+    }
+    int columns, rows;
+    kfb_grid(&m, &columns, &rows);
+    kprint_set_size(columns, rows); // Redraws what was printed in text mode so far
+    return 1;
+}
+
+// --- Public Function: kfb_active ---
+int kfb_active(void) {
+    return active;
+}
+
+// --- Public Function: kfb_draw_cell ---
+void kfb_draw_cell(int x, int y, uint16_t cell) {
+    uint32_t value = cell | ((x == cursor_x && y == cursor_y) ? CELL_CURSOR : 0);
+    uint32_t* was = &shown[back_row(y)][x];
+    if (*was == value) {
+        return;
+    }
+    *was = value;
+
+    uint8_t attribute = (uint8_t)(cell >> 8);
+    int glyph = kfont_index((uint8_t)cell);
+    uint32_t* dst = back_line(y) + x * cell_w;
+    if (cache_enabled) {
+        if (!(cache_ready[attribute / 32] & (1u << (attribute % 32)))) {
+            fill_cache(attribute);
+        }
+        const uint32_t* src = cache + ((uint64_t)attribute * KFONT_GLYPHS + glyph) * cell_pixels;
+        for (int line = 0; line < cell_h; line++) {
+            copy_pixels(dst + line * back_pitch, src + line * cell_w, cell_w);
+        }
+    } else {
+        render_glyph(dst, back_pitch, glyph, attribute);
+    }
+
+    if (value & CELL_CURSOR) {
+        // An underline in the foreground color, on the font's empty bottom row.
+        uint32_t color = palette[attribute & 0x0F];
+        uint32_t* line = dst + KFONT_UNDERLINE_ROW * scale * back_pitch;
+        for (int i = 0; i < scale; i++, line += back_pitch) {
+            for (int px = 0; px < cell_w; px++) {
+                line[px] = color;
+            }
+        }
+    }
+
+    if (x < dirty_x0[y]) {
+        dirty_x0[y] = x;
+    }
+    if (x + 1 > dirty_x1[y]) {
+        dirty_x1[y] = x + 1;
+    }
+    stats.cells_drawn++;
+}
+
+// --- Public Function: kfb_scroll ---
+// The ring turns by one text row: the old top row becomes the bottom row
+// and is cleared to blanks, which is what kprint puts there, so drawing
+// the new line costs only its visible characters.
+// Every row of the screen now shows the wrong text, so the whole grid is
+// dirty; kfb_present() copies it from the back buffer once, however many
+// scrolls happened since the last present. The framebuffer is never read:
+// it is mapped write-combining, where reads are uncached.
+void kfb_scroll(void) {
+    int bottom = back_top;
+    back_top = back_row(1);
+    k_memset(back + (uint64_t)bottom * cell_h * back_pitch, 0, (uint64_t)cell_h * back_pitch * sizeof(uint32_t));
+    for (int x = 0; x < grid_columns; x++) {
+        shown[bottom][x] = CELL_BLANK;
+    }
+    mark_all_dirty();
+    // The drawn cursor moved up with the text.
+    if (cursor_x >= 0) {
+        if (cursor_y > 0) {
+            cursor_y--;
+        } else {
+            cursor_x = -1;
+        }
+    }
+    stats.scrolls++;
+}
+
+// --- Public Function: kfb_set_cursor ---
+// Redraws the cell the cursor leaves and the one it enters; kfb_draw_cell
+// sees that their CELL_CURSOR bit no longer matches. Cells not drawn yet get
+// the cursor when they are.
+void kfb_set_cursor(int x, int y) {
+    if (x == cursor_x && y == cursor_y) {
+        return;
+    }
+    int old_x = cursor_x;
+    int old_y = cursor_y;
+    cursor_x = x;
+    cursor_y = y;
+    uint32_t old_cell = old_x >= 0 ? shown[back_row(old_y)][old_x] : CELL_UNKNOWN;
+    if (old_cell != CELL_UNKNOWN) {
+        kfb_draw_cell(old_x, old_y, (uint16_t)old_cell);
+    }
+    uint32_t cell = shown[back_row(y)][x];
+    if (cell != CELL_UNKNOWN) {
+        kfb_draw_cell(x, y, (uint16_t)cell);
+    }
+}
+
+// --- Public Function: kfb_present ---
+void kfb_present(void) {
+    int copied = 0;
+    for (int y = 0; y < grid_rows; y++) {
+        if (dirty_x0[y] >= dirty_x1[y]) {
+            continue;
+        }
+        int x0 = dirty_x0[y] * cell_w;
+        int width = (dirty_x1[y] - dirty_x0[y]) * cell_w;
+        const uint32_t* src = back_line(y) + x0;
+        uint8_t* dst = (uint8_t*)(screen_origin + x0) + (uint64_t)y * cell_h * mode.pitch;
+        for (int line = 0; line < cell_h; line++) {
+            k_memcpy(dst + (uint64_t)line * mode.pitch, src + line * back_pitch, width * sizeof(uint32_t));
+        }
+        stats.pixels_presented += (uint64_t)width * cell_h;
+        dirty_x0[y] = grid_columns;
+        dirty_x1[y] = 0;
+        copied = 1;
+    }
+    if (copied) {
+        stats.presents++;
+    }
+}
+
+// --- Public Function: kfb_set_glyph_cache ---
+void kfb_set_glyph_cache(int enable) {
+    cache_enabled = enable ? 1 : 0;
+}
+
+// --- Public Function: kfb_get_stats ---
+void kfb_get_stats(struct kfb_stats* out) {
+    *out = stats;
+}
+
+// --- Public Function: kfb_get_mode ---
+int kfb_get_mode(struct kfb_mode* out) {
+    if (!active) {
+        return 0;
+    }
+    *out = mode;
+    return scale;
+}
@@ -0,0 +1,113 @@
+#ifndef KFB_H // Standard header guard to prevent multiple inclusions
+#define KFB_H
+
+#include <stdint.h> // For uint16_t, uint32_t, uint64_t
+
+// --- Framebuffer Console ---
+// When GRUB sets up a linear 32-bit framebuffer (boot.asm asks for
+// 1024x768x32), kprint.c draws its character grid there instead of in VGA
+// text memory; the kprint API and the color attributes stay the same. The
+// grid fills the mode: at 1024x768 the font's own 6x12-pixel cells give
+// 170x64 characters instead of text mode's 80x25 (kprint_columns() and
+// kprint_rows() tell layouts how much room there is). Only modes too large
+// for KPRINT_MAX_COLUMNS x KPRINT_MAX_ROWS get the font scaled up by a whole
+// factor; whatever does not fill a cell is left as a centered margin.
+//
+// Drawing happens in a back buffer in RAM:
+// - Glyph cache: the first time an attribute is used, all KFONT_GLYPHS
+//   glyphs are rendered in its two colors, so drawing a cell is a copy of
+//   ready-made pixel lines (8-byte aligned stores), never a bit-by-bit
+//   expansion of the font.
+// - The back buffer is a ring of text rows (like kprint's shadow buffer),
+//   so scrolling turns the ring and clears one row instead of moving pixels.
+// - Every changed cell widens its row's dirty rectangle; kfb_present()
+//   copies only those rectangles to the (write-combining) framebuffer. It
+//   only ever stores there: a scroll makes the whole grid dirty, so the
+//   scrolls between two presents cost one full copy.
+// Each cell remembers what it shows, so redrawing an unchanged cell is free.
+// All functions are called with kprint's lock held.
+
+// A framebuffer as kfb draws on it: 32 bits per pixel, direct color.
+struct kfb_mode {
+    uint32_t* pixels;          // Top-left pixel (already mapped)
+    uint32_t width, height;    // Pixels
+    uint32_t pitch;            // Bytes per line
+    uint8_t red_shift, red_bits; // Position and width of each color field
+    uint8_t green_shift, green_bits;
+    uint8_t blue_shift, blue_bits;
+};
+
+// Counters since kfb_attach().
+struct kfb_stats {
+    uint64_t cells_drawn;      // Cells rendered into the back buffer
+    uint64_t cache_fills;      // Attributes whose glyphs were rendered into the cache
+    uint64_t scrolls;
+    uint64_t presents;         // kfb_present() calls that copied anything
+    uint64_t pixels_presented; // Pixels copied to the framebuffer
+};
+
+// --- Function Declarations ---
+
+// kfb_init: Looks for a Multiboot2 framebuffer tag describing a usable
+// 32-bit RGB mode, maps the framebuffer write-combining, reserves the back
+// buffer and glyph cache and switches kprint over to the mode's grid
+// (kprint_set_size).
+// Must run after kvmm_init(), before other CPUs print.
+// Returns:
+//   1 if the console is now on the framebuffer, 0 if it stays in text mode.
+int kfb_init(void);
+
+// kfb_scale: The font scale kfb would use for 'mode'.
+// Returns:
+//   1 or more, or 0 if 80x25 cells do not fit (the mode is unusable).
+int kfb_scale(const struct kfb_mode* mode);
+
+// kfb_grid: The character grid kfb would draw on 'mode' (0 x 0 if unusable).
+void kfb_grid(const struct kfb_mode* mode, int* columns, int* rows);
+
+// kfb_back_buffer_bytes / kfb_glyph_cache_bytes: Memory kfb_attach needs
+// for 'mode'. The glyph cache has room for every attribute but is filled
+// (and, with lazily mapped memory, backed) only for the attributes used.
+uint64_t kfb_back_buffer_bytes(const struct kfb_mode* mode);
+uint64_t kfb_glyph_cache_bytes(const struct kfb_mode* mode);
+
+// kfb_attach: Starts drawing on 'mode'. Clears the framebuffer; every cell
+// counts as unknown until drawn. kprint's grid must then be set to
+// kfb_grid() with kprint_set_size().
+// Parameters:
+//   back_buffer, glyph_cache: Writable, 8-byte aligned memory of the sizes
+//                             above. Their contents do not matter.
+// Returns:
+//   1 on success, 0 if the mode is unusable.
+int kfb_attach(const struct kfb_mode* mode, uint32_t* back_buffer, uint32_t* glyph_cache);
+
+// kfb_active: 1 once kfb_attach() succeeded.
+int kfb_active(void);
+
+// kfb_draw_cell: Draws a VGA-style cell ((attribute << 8) | character) at
+// column x, row y of the back buffer, unless the cell already shows it.
+void kfb_draw_cell(int x, int y, uint16_t cell);
+
+// kfb_scroll: Moves the whole grid up one row. The bottom row is blank; the
+// next kfb_present() copies the whole grid.
+void kfb_scroll(void);
+
+// kfb_set_cursor: Moves the underline cursor to cell (x, y).
+void kfb_set_cursor(int x, int y);
+
+// kfb_present: Copies the dirty rectangles of the back buffer to the screen.
+void kfb_present(void);
+
+// kfb_set_glyph_cache: Turns the glyph cache off (0), so each cell is
+// expanded from the font bit by bit, or on (1, the default); for benchmarks.
+void kfb_set_glyph_cache(int enable);
+
+// kfb_get_stats: Copies the counters.
+void kfb_get_stats(struct kfb_stats* out);
+
+// kfb_get_mode: The mode in use and its font scale.
+// Returns:
+//   The scale, or 0 (and nothing copied) if no framebuffer is attached.
+int kfb_get_mode(struct kfb_mode* out);
+
+#endif // KFB_H
@@ -0,0 +1,559 @@
+#include <stdint.h>
+#include "kfloat.h"   // Our own declarations
+#include "kbignum.h"  // The exact path of kfloat_parse
+
+// IEEE 754 double: sign, 11-bit biased exponent, 52 stored significand bits.
+#define DP_SIGN_MASK        0x8000000000000000ULL
+#define DP_EXPONENT_MASK    0x7FF0000000000000ULL
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_HIDDEN_BIT       0x0010000000000000ULL
+#define DP_EXPONENT_BIAS    1075 // 1023, plus 52 because the significand is read as an integer
+
+static int fast_path_enabled = 1;
+
+// --- Helper Functions: double_bits / bits_double ---
+// Reinterpreting through a union is well defined in GCC.
+static inline uint64_t double_bits(double value) {
+    union { double d; uint64_t u; } v;
+    v.d = value;
+    return v.u;
+}
+
+static inline double bits_double(uint64_t bits) {
+    union { double d; uint64_t u; } v;
+    v.u = bits;
+    return v.d;
+}
+
+// ============================================================================
+// Double to string: Grisu2
+// The double and its two boundaries (halfway to the neighbouring doubles)
+// are scaled by a cached power of ten into 64-bit fixed point, and digits
+// are generated until they identify a number inside the boundaries.
+// ============================================================================
+
+// f x 2^e with a 64-bit significand ("do it yourself" floating point).
+struct diy_fp {
+    uint64_t f;
+    int e;
+};
+
+// 10^k for k = -348, -340, ..., 340: the normalized significand (rounded)
+// and binary exponent. Steps of 8 keep the table small while one entry is
+// always close enough for digit_gen's window.
+static const struct diy_fp cached_powers[87] = {
+    { 0xFA8FD5A0081C0288ULL, -1220 }, { 0xBAAEE17FA23EBF76ULL, -1193 }, { 0x8B16FB203055AC76ULL, -1166 },
+    { 0xCF42894A5DCE35EAULL, -1140 }, { 0x9A6BB0AA55653B2DULL, -1113 }, { 0xE61ACF033D1A45DFULL, -1087 },
+    { 0xAB70FE17C79AC6CAULL, -1060 }, { 0xFF77B1FCBEBCDC4FULL, -1034 }, { 0xBE5691EF416BD60CULL, -1007 },
+    { 0x8DD01FAD907FFC3CULL, -980 }, { 0xD3515C2831559A83ULL, -954 }, { 0x9D71AC8FADA6C9B5ULL, -927 },
+    { 0xEA9C227723EE8BCBULL, -901 }, { 0xAECC49914078536DULL, -874 }, { 0x823C12795DB6CE57ULL, -847 },
+    { 0xC21094364DFB5637ULL, -821 }, { 0x9096EA6F3848984FULL, -794 }, { 0xD77485CB25823AC7ULL, -768 },
+    { 0xA086CFCD97BF97F4ULL, -741 }, { 0xEF340A98172AACE5ULL, -715 }, { 0xB23867FB2A35B28EULL, -688 },
+    { 0x84C8D4DFD2C63F3BULL, -661 }, { 0xC5DD44271AD3CDBAULL, -635 }, { 0x936B9FCEBB25C996ULL, -608 },
+    { 0xDBAC6C247D62A584ULL, -582 }, { 0xA3AB66580D5FDAF6ULL, -555 }, { 0xF3E2F893DEC3F126ULL, -529 },
+    { 0xB5B5ADA8AAFF80B8ULL, -502 }, { 0x87625F056C7C4A8BULL, -475 }, { 0xC9BCFF6034C13053ULL, -449 },
+    { 0x964E858C91BA2655ULL, -422 }, { 0xDFF9772470297EBDULL, -396 }, { 0xA6DFBD9FB8E5B88FULL, -369 },
+    { 0xF8A95FCF88747D94ULL, -343 }, { 0xB94470938FA89BCFULL, -316 }, { 0x8A08F0F8BF0F156BULL, -289 },
+    { 0xCDB02555653131B6ULL, -263 }, { 0x993FE2C6D07B7FACULL, -236 }, { 0xE45C10C42A2B3B06ULL, -210 },
+    { 0xAA242499697392D3ULL, -183 }, { 0xFD87B5F28300CA0EULL, -157 }, { 0xBCE5086492111AEBULL, -130 },
+    { 0x8CBCCC096F5088CCULL, -103 }, { 0xD1B71758E219652CULL, -77 }, { 0x9C40000000000000ULL, -50 },
+    { 0xE8D4A51000000000ULL, -24 }, { 0xAD78EBC5AC620000ULL, 3 }, { 0x813F3978F8940984ULL, 30 },
+    { 0xC097CE7BC90715B3ULL, 56 }, { 0x8F7E32CE7BEA5C70ULL, 83 }, { 0xD5D238A4ABE98068ULL, 109 },
+    { 0x9F4F2726179A2245ULL, 136 }, { 0xED63A231D4C4FB27ULL, 162 }, { 0xB0DE65388CC8ADA8ULL, 189 },
+    { 0x83C7088E1AAB65DBULL, 216 }, { 0xC45D1DF942711D9AULL, 242 }, { 0x924D692CA61BE758ULL, 269 },
+    { 0xDA01EE641A708DEAULL, 295 }, { 0xA26DA3999AEF774AULL, 322 }, { 0xF209787BB47D6B85ULL, 348 },
+    { 0xB454E4A179DD1877ULL, 375 }, { 0x865B86925B9BC5C2ULL, 402 }, { 0xC83553C5C8965D3DULL, 428 },
+    { 0x952AB45CFA97A0B3ULL, 455 }, { 0xDE469FBD99A05FE3ULL, 481 }, { 0xA59BC234DB398C25ULL, 508 },
+    { 0xF6C69A72A3989F5CULL, 534 }, { 0xB7DCBF5354E9BECEULL, 561 }, { 0x88FCF317F22241E2ULL, 588 },
+    { 0xCC20CE9BD35C78A5ULL, 614 }, { 0x98165AF37B2153DFULL, 641 }, { 0xE2A0B5DC971F303AULL, 667 },
+    { 0xA8D9D1535CE3B396ULL, 694 }, { 0xFB9B7CD9A4A7443CULL, 720 }, { 0xBB764C4CA7A44410ULL, 747 },
+    { 0x8BAB8EEFB6409C1AULL, 774 }, { 0xD01FEF10A657842CULL, 800 }, { 0x9B10A4E5E9913129ULL, 827 },
+    { 0xE7109BFBA19C0C9DULL, 853 }, { 0xAC2820D9623BF429ULL, 880 }, { 0x80444B5E7AA7CF85ULL, 907 },
+    { 0xBF21E44003ACDD2DULL, 933 }, { 0x8E679C2F5E44FF8FULL, 960 }, { 0xD433179D9C8CB841ULL, 986 },
+    { 0x9E19DB92B4E31BA9ULL, 1013 }, { 0xEB96BF6EBADF77D9ULL, 1039 }, { 0xAF87023B9BF0EE6BULL, 1066 },
+};
+
+// 10^0 .. 10^19: every power of ten that fits in 64 bits.
+static const uint64_t powers_of_ten[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+// --- Helper Function: diy_make ---
+static inline struct diy_fp diy_make(uint64_t f, int e) {
+    struct diy_fp r = { f, e };
+    return r;
+}
+
+// --- Helper Function: diy_normalize ---
+// Shifts the significand up until its top bit is set.
+static inline struct diy_fp diy_normalize(struct diy_fp x) {
+    int shift = __builtin_clzll(x.f);
+    return diy_make(x.f << shift, x.e - shift);
+}
+
+// --- Helper Function: diy_mul ---
+// The upper 64 bits of the 128-bit product of the significands, rounded,
+// from four 32 x 32-bit products.
+static inline struct diy_fp diy_mul(struct diy_fp x, struct diy_fp y) {
+    uint64_t a = x.f >> 32, b = x.f & 0xFFFFFFFFu;
+    uint64_t c = y.f >> 32, d = y.f & 0xFFFFFFFFu;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & 0xFFFFFFFFu) + (bc & 0xFFFFFFFFu) + (1u << 31);
+    return diy_make(ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64);
+}
+
+// --- Helper Function: cached_power ---
+// Picks the cached power 10^-k that moves a number with binary exponent 'e'
+// to an exponent in [-60, -32]: small enough that the integer part fits in
+// 32 bits, large enough that the fraction keeps enough bits.
+static struct diy_fp cached_power(int e, int* k) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347; // log10(2); rounded up below
+    int ki = (int)dk;
+    if (dk - ki > 0.0) {
+        ki++;
+    }
+    int index = (ki >> 3) + 1;
+    *k = -(-348 + index * 8);
+    return cached_powers[index];
+}
+
+// --- Helper Function: grisu_round ---
+// The last digit may be lowered while the number stays inside the boundaries
+// and gets closer to the exact value.
+static void grisu_round(char* digits, int length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t distance) {
+    while (rest < distance && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < distance || distance - rest > rest + ten_kappa - distance)) {
+        digits[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+// --- Helper Function: digit_gen ---
+// Generates digits of the upper boundary 'high' until the rest is below
+// 'delta' (the width of the interval), first from its integer part, then
+// from its fraction. *k is adjusted so the value is digits x 10^k.
+static void digit_gen(struct diy_fp w, struct diy_fp high, uint64_t delta, char* digits, int* length, int* k) {
+    const int shift = -high.e;
+    const uint64_t one = 1ULL << shift;
+    const uint64_t distance = high.f - w.f;
+    uint32_t integral = (uint32_t)(high.f >> shift);
+    uint64_t fraction = high.f & (one - 1);
+
+    int kappa = 1;
+    while (kappa < 10 && integral >= powers_of_ten[kappa]) {
+        kappa++;
+    }
+    *length = 0;
+
+    while (kappa > 0) {
+        uint32_t power = (uint32_t)powers_of_ten[kappa - 1];
+        uint32_t digit = integral / power;
+        integral %= power;
+        if (digit || *length) {
+            digits[(*length)++] = (char)('0' + digit);
+        }
+        kappa--;
+        uint64_t rest = ((uint64_t)integral << shift) + fraction;
+        if (rest <= delta) {
+            *k += kappa;
+            grisu_round(digits, *length, delta, rest, powers_of_ten[kappa] << shift, distance);
+            return;
+        }
+    }
+
+    for (;;) {
+        fraction *= 10;
+        delta *= 10;
+        char digit = (char)(fraction >> shift);
+        if (digit || *length) {
+            digits[(*length)++] = (char)('0' + digit);
+        }
+        fraction &= one - 1;
+        kappa--;
+        if (fraction < delta) {
+            *k += kappa;
+            grisu_round(digits, *length, delta, fraction, one,
+                        -kappa < 20 ? distance * powers_of_ten[-kappa] : 0);
+            return;
+        }
+    }
+}
+
+// --- Helper Function: grisu2 ---
+// Digits and decimal exponent of a positive, finite, nonzero double.
+static void grisu2(uint64_t bits, char* digits, int* length, int* k) {
+    int biased = (int)((bits & DP_EXPONENT_MASK) >> 52);
+    uint64_t significand = bits & DP_SIGNIFICAND_MASK;
+    struct diy_fp v = biased ? diy_make(significand + DP_HIDDEN_BIT, biased - DP_EXPONENT_BIAS)
+                             : diy_make(significand, 1 - DP_EXPONENT_BIAS); // Subnormal
+
+    // The boundaries. Below a power of two the next lower double is only
+    // half as far away, so the lower boundary is closer.
+    struct diy_fp high = diy_normalize(diy_make((v.f << 1) + 1, v.e - 1));
+    struct diy_fp low = (v.f == DP_HIDDEN_BIT) ? diy_make((v.f << 2) - 1, v.e - 2)
+                                               : diy_make((v.f << 1) - 1, v.e - 1);
+    low.f <<= low.e - high.e;
+    low.e = high.e;
+
+    struct diy_fp power = cached_power(high.e, k);
+    struct diy_fp w = diy_mul(diy_normalize(v), power);
+    struct diy_fp w_high = diy_mul(high, power);
+    struct diy_fp w_low = diy_mul(low, power);
+    w_low.f++; // The products are rounded: stay strictly inside the interval
+    w_high.f--;
+    digit_gen(w, w_high, w_high.f - w_low.f, digits, length, k);
+}
+
+// --- Helper Function: write_digits ---
+// Lays out digits x 10^k the way a person would write it: plainly while the
+// number of digits before or after the point stays small, else as d.ddde±x.
+// Returns:
+//   A pointer past the last character written.
+static char* write_digits(char* out, const char* digits, int length, int k) {
+    int point = length + k; // Digits before the decimal point
+
+    if (k >= 0 && point <= 21) { // 1234e3 -> 1234000
+        for (int i = 0; i < length; i++) *out++ = digits[i];
+        for (int i = 0; i < k; i++) *out++ = '0';
+    } else if (point > 0 && point <= 21) { // 1234e-2 -> 12.34
+        for (int i = 0; i < point; i++) *out++ = digits[i];
+        *out++ = '.';
+        for (int i = point; i < length; i++) *out++ = digits[i];
+    } else if (point > -6 && point <= 0) { // 1234e-6 -> 0.001234
+        *out++ = '0';
+        *out++ = '.';
+        for (int i = point; i < 0; i++) *out++ = '0';
+        for (int i = 0; i < length; i++) *out++ = digits[i];
+    } else { // 1234e30 -> 1.234e33
+        *out++ = digits[0];
+        if (length > 1) {
+            *out++ = '.';
+            for (int i = 1; i < length; i++) *out++ = digits[i];
+        }
+        *out++ = 'e';
+        int exponent = point - 1;
+        if (exponent < 0) {
+            *out++ = '-';
+            exponent = -exponent;
+        }
+        if (exponent >= 100) {
+            *out++ = (char)('0' + exponent / 100);
+            exponent %= 100;
+            *out++ = (char)('0' + exponent / 10);
+        } else if (exponent >= 10) {
+            *out++ = (char)('0' + exponent / 10);
+        }
+        *out++ = (char)('0' + exponent % 10);
+    }
+    return out;
+}
+
+// --- Public Function: kfloat_format ---
+int kfloat_format(const double* value, char* buf, int size) {
+    char text[KFLOAT_STRING_SIZE];
+    char* p = text;
+    uint64_t bits = double_bits(*value);
+    uint64_t magnitude = bits & ~DP_SIGN_MASK;
+
+    if (magnitude > DP_EXPONENT_MASK) {
+        *p++ = 'n'; *p++ = 'a'; *p++ = 'n';
+    } else {
+        if (bits & DP_SIGN_MASK) {
+            *p++ = '-';
+        }
+        if (magnitude == DP_EXPONENT_MASK) {
+            *p++ = 'i'; *p++ = 'n'; *p++ = 'f';
+        } else if (magnitude == 0) {
+            *p++ = '0';
+        } else {
+            char digits[20];
+            int length, k;
+            grisu2(magnitude, digits, &length, &k);
+            p = write_digits(p, digits, length, k);
+        }
+    }
+
+    int length = (int)(p - text);
+    if (length >= size) {
+        if (size > 0) {
+            buf[0] = '\0';
+        }
+        return -1;
+    }
+    for (int i = 0; i < length; i++) {
+        buf[i] = text[i];
+    }
+    buf[length] = '\0';
+    return length;
+}
+
+// ============================================================================
+// String to double
+// ============================================================================
+
+// Significant digits kept by kfloat_parse. A decimal number halfway between
+// two doubles has at most 767 of them, so the digits after these can only
+// matter through whether any of them is nonzero.
+#define MAX_DIGITS 768
+
+// 10^0 .. 10^22: every power of ten that is exactly a double.
+static const double exact_powers[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// --- Helper Function: bit_length ---
+static int bit_length(const struct kbignum* n) {
+    return n->used ? n->used * 32 - __builtin_clz(n->limb[n->used - 1]) : 0;
+}
+
+// --- Helper Function: power_of_ten ---
+// r = 10^exponent, 10^18 at a time.
+static void power_of_ten(struct kbignum* r, int exponent) {
+    struct kbignum factor;
+    kbignum_from_i64(r, 1);
+    while (exponent > 0) {
+        int step = exponent < 18 ? exponent : 18;
+        int64_t chunk = 1;
+        for (int i = 0; i < step; i++) {
+            chunk *= 10;
+        }
+        kbignum_from_i64(&factor, chunk);
+        kbignum_mul(r, r, &factor); // Callers keep the result within KBIGNUM_LIMBS
+        exponent -= step;
+    }
+}
+
+// --- Helper Function: shift_left ---
+// n = n x 2^shift, by multiplying with a number that has that single bit set.
+static void shift_left(struct kbignum* n, int shift) {
+    struct kbignum power;
+    kbignum_from_i64(&power, 0);
+    int word = shift / 32;
+    for (int i = 0; i < word; i++) {
+        power.limb[i] = 0;
+    }
+    power.limb[word] = 1u << (shift % 32);
+    power.used = word + 1;
+    kbignum_mul(n, n, &power);
+}
+
+// --- Helper Function: top_bits ---
+// The 64 most significant bits of the nonzero 'n' (of 'length' bits),
+// left-aligned; *sticky is set if any bit below them is nonzero.
+static uint64_t top_bits(const struct kbignum* n, int length, int* sticky) {
+    int shift = length - 64; // Bits below the top 64
+    if (shift <= 0) {
+        uint64_t value = n->limb[0];
+        if (n->used > 1) {
+            value |= (uint64_t)n->limb[1] << 32;
+        }
+        return value << -shift;
+    }
+    int word = shift / 32, bit = shift % 32;
+    uint64_t w0 = n->limb[word];
+    uint64_t w1 = word + 1 < n->used ? n->limb[word + 1] : 0;
+    uint64_t w2 = word + 2 < n->used ? n->limb[word + 2] : 0;
+    uint64_t top = bit ? (w0 >> bit) | (w1 << (32 - bit)) | (w2 << (64 - bit)) : w0 | (w1 << 32);
+    if (w0 & ((1u << bit) - 1)) {
+        *sticky = 1;
+    }
+    for (int i = 0; i < word; i++) {
+        if (n->limb[i]) {
+            *sticky = 1;
+        }
+    }
+    return top;
+}
+
+// --- Helper Function: round_to_double ---
+// The double nearest to n x 2^exponent (plus a little more if 'sticky'),
+// ties to even, into *bits.
+// Returns:
+//   KFLOAT_OK, or KFLOAT_RANGE if it overflows to infinity or underflows to 0.
+static int round_to_double(const struct kbignum* n, int exponent, int sticky, uint64_t* bits) {
+    int length = bit_length(n);
+    uint64_t top = top_bits(n, length, &sticky);
+    int leading = exponent + length - 1; // Binary exponent of the leading bit
+
+    if (leading > 1023) {
+        *bits = DP_EXPONENT_MASK;
+        return KFLOAT_RANGE;
+    }
+    int drop = 11; // 64 bits in 'top', 53 in a double
+    if (leading < -1022) {
+        drop += -1022 - leading; // A subnormal keeps fewer bits
+    }
+    if (drop > 64) {
+        *bits = 0; // Below half the smallest subnormal
+        return KFLOAT_RANGE;
+    }
+
+    uint64_t m = drop == 64 ? 0 : top >> drop;
+    uint64_t rest = drop == 64 ? top : top & ((1ULL << drop) - 1);
+    uint64_t half = 1ULL << (drop - 1);
+    if (rest > half || (rest == half && (sticky || (m & 1)))) {
+        m++;
+    }
+
+    if (leading < -1022) {
+        *bits = m; // Subnormal; a carry into bit 52 gives the smallest normal
+        return m ? KFLOAT_OK : KFLOAT_RANGE;
+    }
+    int biased = leading + 1023;
+    if (m == (1ULL << 53)) { // Rounding carried into a new bit
+        m >>= 1;
+        biased++;
+    }
+    if (biased >= 2047) {
+        *bits = DP_EXPONENT_MASK;
+        return KFLOAT_RANGE;
+    }
+    *bits = ((uint64_t)biased << 52) | (m & DP_SIGNIFICAND_MASK);
+    return KFLOAT_OK;
+}
+
+// --- Helper Function: parse_exact ---
+// digits x 10^exponent, correctly rounded. A positive exponent makes an
+// integer; a negative one a quotient, computed with at least 64 significant
+// bits (the dividend is scaled by 2^shift first) and the remainder as a
+// sticky bit.
+static int parse_exact(const char* digits, int exponent, uint64_t* bits) {
+    struct kbignum n, power, remainder;
+    kbignum_from_string(&n, digits, 0);
+    if (exponent >= 0) {
+        power_of_ten(&power, exponent);
+        kbignum_mul(&n, &n, &power);
+        return round_to_double(&n, 0, 0, bits);
+    }
+    power_of_ten(&power, -exponent);
+    int shift = bit_length(&power) - bit_length(&n) + 65;
+    if (shift < 0) {
+        shift = 0;
+    }
+    shift_left(&n, shift);
+    kbignum_divmod(&n, &remainder, &n, &power);
+    return round_to_double(&n, -shift, remainder.used != 0, bits);
+}
+
+// --- Public Function: kfloat_parse ---
+// The digits are collected without leading zeros as an integer D, with the
+// value D x 10^exponent. The size checks before the exact path bound D and
+// the powers of ten it uses to a few thousand bits, within kbignum's range.
+int kfloat_parse(const char* str, const char** end, double* value) {
+    const char* p = str;
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    int negative = 0;
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        p++;
+    }
+
+    char digits[MAX_DIGITS + 2]; // Plus the sticky digit and the null
+    int count = 0;               // Digits in 'digits'
+    int exponent = 0;
+    int seen_digit = 0;
+    int dropped_nonzero = 0;     // A nonzero digit beyond MAX_DIGITS
+    uint64_t mantissa = 0;       // The first 19 digits, for the fast path
+
+    for (int fraction = 0; fraction < 2; fraction++) {
+        for (; *p >= '0' && *p <= '9'; p++) {
+            seen_digit = 1;
+            if (count == 0 && *p == '0') {
+                exponent -= fraction; // Leading zero
+            } else if (count < MAX_DIGITS) {
+                digits[count++] = *p;
+                if (count <= 19) {
+                    mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                }
+                exponent -= fraction;
+            } else {
+                dropped_nonzero |= (*p != '0');
+                exponent += 1 - fraction;
+            }
+        }
+        if (fraction == 0) {
+            if (*p != '.') {
+                break;
+            }
+            p++;
+        }
+    }
+    if (!seen_digit) {
+        if (end) {
+            *end = str;
+        }
+        *value = 0;
+        return KFLOAT_NO_DIGITS;
+    }
+    if (dropped_nonzero) {
+        digits[count++] = '1'; // Anything between D and D + 1 rounds the same
+        exponent--;
+    }
+    digits[count] = '\0';
+
+    // Exponent, only if digits follow ("2e" is the number 2 followed by "e").
+    if (*p == 'e' || *p == 'E') {
+        const char* q = p + 1;
+        int exponent_negative = 0;
+        if (*q == '-' || *q == '+') {
+            exponent_negative = (*q == '-');
+            q++;
+        }
+        if (*q >= '0' && *q <= '9') {
+            int written = 0;
+            for (; *q >= '0' && *q <= '9'; q++) {
+                if (written < 100000) { // Far beyond any double; saturate
+                    written = written * 10 + (*q - '0');
+                }
+            }
+            exponent += exponent_negative ? -written : written;
+            p = q;
+        }
+    }
+    if (end) {
+        *end = p;
+    }
+
+    int status = KFLOAT_OK;
+    uint64_t bits;
+    if (count == 0) {
+        bits = 0;
+    } else if (count + exponent > 309) { // At least 10^309
+        bits = DP_EXPONENT_MASK;
+        status = KFLOAT_RANGE;
+    } else if (count + exponent <= -324) { // Below 10^-324, under half the smallest subnormal
+        bits = 0;
+        status = KFLOAT_RANGE;
+    } else if (fast_path_enabled && count <= 15 && exponent >= -22 && exponent <= 22 + 15 - count) {
+        // Clinger: D and 10^|exponent| are both exact doubles, so one
+        // correctly rounded operation gives the correctly rounded result.
+        // An exponent a little above 22 is moved into D first while D
+        // stays below 10^15 (and so exact).
+        double d = (double)(int64_t)mantissa;
+        if (exponent > 22) {
+            d *= exact_powers[exponent - 22];
+            exponent = 22;
+        }
+        d = exponent < 0 ? d / exact_powers[-exponent] : d * exact_powers[exponent];
+        bits = double_bits(d);
+    } else {
+        status = parse_exact(digits, exponent, &bits);
+    }
+
+    if (negative) {
+        bits |= DP_SIGN_MASK;
+    }
+    *value = bits_double(bits);
+    return status;
+}
+
+// --- Public Function: kfloat_set_fast_path ---
+void kfloat_set_fast_path(int enable) {
+    fast_path_enabled = enable;
+}
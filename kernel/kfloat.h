@@ -0,0 +1,49 @@
+#ifndef KFLOAT_H // Standard header guard to prevent multiple inclusions
+#define KFLOAT_H
+
+#include <stdint.h> // For uint64_t
+
+// --- Double Precision Conversions ---
+// kfloat_format() prints the shortest decimal string that reads back as the
+// same double (Grisu2: 64-bit integer arithmetic on a cached power of ten;
+// a handful of values get one digit more than the shortest, never a wrong
+// one). kfloat_parse() is correctly rounded: Clinger's fast path handles
+// the common short inputs with a single exact multiplication or division,
+// and everything else is settled exactly with kbignum.
+//
+// Doubles are passed by pointer, never by value: most of the kernel is built
+// with -mno-sse, and such code cannot pass or return a double in the SSE
+// registers the ABI uses for them. kfloat.c itself is built with SSE2.
+// Like every FPU user, it must only run in threads, not in interrupt
+// handlers (kthread.c switches the FPU state lazily on first use).
+
+#define KFLOAT_STRING_SIZE 32 // Enough for any value: "-2.2250738585072014e-308" and null
+
+// Results of kfloat_parse.
+#define KFLOAT_OK        0
+#define KFLOAT_NO_DIGITS 1 // No number at the start of the string
+#define KFLOAT_RANGE     2 // Too large (the value is +-inf) or too small (+-0) for a double
+
+// --- Function Declarations ---
+
+// kfloat_format: Writes *value as the shortest string that reads back the
+// same: "0.1", "123", "1.5e300", "-2.5e-7", "inf", "nan". Integers up to 21
+// digits are written out in full, with no decimal point.
+// Returns:
+//   The length of the string, or -1 (with buf empty) if 'size' is too small.
+int kfloat_format(const double* value, char* buf, int size);
+
+// kfloat_parse: Reads an optionally signed decimal number, with optional
+// fraction and exponent ("12", "-0.5", ".25", "6.02e23"), after optional
+// whitespace, and rounds it to the nearest double.
+// Parameters:
+//   end: If not 0, receives a pointer to the first character after the number.
+// Returns:
+//   KFLOAT_OK, KFLOAT_NO_DIGITS or KFLOAT_RANGE.
+int kfloat_parse(const char* str, const char** end, double* value);
+
+// kfloat_set_fast_path: Turns Clinger's fast path off (0) or on (1, the
+// default), so benchmarks can measure it against the exact path.
+void kfloat_set_fast_path(int enable);
+
+#endif // KFLOAT_H
@@ -0,0 +1,28 @@
+#ifndef KFONT_H // Standard header guard to prevent multiple inclusions
+#define KFONT_H
+
+#include <stdint.h> // For uint8_t
+
+// --- Console Font ---
+// The bitmap font of the framebuffer console (kfb.c): printable ASCII drawn
+// by hand on a 5x7 grid with two rows for descenders, in a 6x12 cell that
+// leaves one column and three rows of spacing. kfb.c draws it unscaled
+// (170x64 cells at 1024x768) and scales it by a whole factor only on modes
+// too large for kprint's grid limits.
+// Row r of a glyph is kfont_glyphs[index][r]; bit 5 is the leftmost pixel.
+
+#define KFONT_WIDTH    6
+#define KFONT_HEIGHT   12
+#define KFONT_GLYPHS   96 // ' ' .. '~', then the fallback box
+#define KFONT_FALLBACK 95 // Drawn for every character outside ' ' .. '~'
+#define KFONT_UNDERLINE_ROW 11 // Always blank in the glyphs; the cursor goes here
+
+extern const uint8_t kfont_glyphs[KFONT_GLYPHS][KFONT_HEIGHT];
+
+// --- Function: kfont_index ---
+// Index of the glyph that draws character c.
+static inline int kfont_index(uint8_t c) {
+    return (c >= ' ' && c <= '~') ? c - ' ' : KFONT_FALLBACK;
+}
+
+#endif // KFONT_H
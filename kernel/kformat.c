@@ -0,0 +1,327 @@
+#include <stdint.h>
+#include "kformat.h" // Our own declarations
+
+// Padding is emitted from these in chunks rather than a character at a time.
+static const char spaces[16] = "                ";
+static const char zeros[16] = "0000000000000000";
+
+static const char digits_lower[16] = "0123456789abcdef";
+static const char digits_upper[16] = "0123456789ABCDEF";
+
+// 10^0 .. 10^19: every power of ten that fits in 64 bits.
+static const uint64_t powers_of_ten[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+// Flags of one conversion.
+#define FLAG_LEFT  0x01 // '-'
+#define FLAG_ZERO  0x02 // '0'
+#define FLAG_PLUS  0x04 // '+'
+#define FLAG_SPACE 0x08 // ' '
+#define FLAG_ALT   0x10 // '#'
+
+// State of one kformat() call.
+struct format_state {
+    struct kformat_sink* sink;
+    uint8_t color;
+    int count; // Characters produced so far
+};
+
+// --- Helper Function: emit ---
+static inline void emit(struct format_state* state, const char* text, int len) {
+    if (len > 0) {
+        state->sink->write(state->sink, text, len, state->color);
+        state->count += len;
+    }
+}
+
+// --- Helper Function: emit_fill ---
+// 'count' copies of the padding character, 16 per sink call.
+static void emit_fill(struct format_state* state, const char* fill, int count) {
+    while (count > 0) {
+        int chunk = count < 16 ? count : 16;
+        emit(state, fill, chunk);
+        count -= chunk;
+    }
+}
+
+// --- Helper Function: decimal_length ---
+static inline int decimal_length(uint64_t value) {
+    int length = 1;
+    while (length < 20 && value >= powers_of_ten[length]) {
+        length++;
+    }
+    return length;
+}
+
+// --- Helper Function: emit_decimal ---
+// Most significant digit first: each digit is how many times its power of
+// ten can be subtracted (at most 9 times), so no division and no buffer to
+// reverse are needed.
+static void emit_decimal(struct format_state* state, uint64_t value, int length) {
+    for (int position = length - 1; position >= 0; position--) {
+        uint64_t power = powers_of_ten[position];
+        char digit = '0';
+        while (value >= power) {
+            value -= power;
+            digit++;
+        }
+        emit(state, &digit, 1);
+    }
+}
+
+// --- Helper Function: emit_hex ---
+static void emit_hex(struct format_state* state, uint64_t value, int length, int upper) {
+    const char* digits = upper ? digits_upper : digits_lower;
+    for (int position = length - 1; position >= 0; position--) {
+        emit(state, &digits[(value >> (position * 4)) & 0xF], 1);
+    }
+}
+
+// --- Helper Function: emit_number ---
+// Lays out [padding][sign or 0x][zeros][digits][padding] the way printf
+// does: the precision is a minimum digit count, and '0' pads up to the
+// width only when no precision is given. '+' and ' ' only affect signed
+// conversions, as in C.
+static void emit_number(struct format_state* state, uint64_t value, int negative, int is_signed, int hex,
+                        int upper, int flags, int width, int precision) {
+    int length = hex ? (value ? (67 - __builtin_clzll(value)) / 4 : 1) : decimal_length(value);
+    if (precision == 0 && value == 0) {
+        length = 0; // printf: "%.0d" of zero prints no digits
+    }
+
+    const char* prefix = "";
+    int prefix_length = 0;
+    if (negative) {
+        prefix = "-";
+        prefix_length = 1;
+    } else if (is_signed && (flags & FLAG_PLUS)) {
+        prefix = "+";
+        prefix_length = 1;
+    } else if (is_signed && (flags & FLAG_SPACE)) {
+        prefix = " ";
+        prefix_length = 1;
+    } else if (hex && (flags & FLAG_ALT) && value != 0) {
+        prefix = upper ? "0X" : "0x";
+        prefix_length = 2;
+    }
+
+    int leading_zeros = precision > length ? precision - length : 0;
+    int total = prefix_length + leading_zeros + length;
+    int padding = width > total ? width - total : 0;
+    if ((flags & FLAG_ZERO) && !(flags & FLAG_LEFT) && precision < 0) {
+        leading_zeros += padding;
+        padding = 0;
+    }
+
+    if (!(flags & FLAG_LEFT)) {
+        emit_fill(state, spaces, padding);
+    }
+    emit(state, prefix, prefix_length);
+    emit_fill(state, zeros, leading_zeros);
+    if (hex) {
+        emit_hex(state, value, length, upper);
+    } else {
+        emit_decimal(state, value, length);
+    }
+    if (flags & FLAG_LEFT) {
+        emit_fill(state, spaces, padding);
+    }
+}
+
+// --- Helper Function: emit_text ---
+// A %s or %c argument: at most 'precision' characters, padded to 'width'.
+static void emit_text(struct format_state* state, const char* text, int length, int flags, int width) {
+    int padding = width > length ? width - length : 0;
+    if (!(flags & FLAG_LEFT)) {
+        emit_fill(state, spaces, padding);
+    }
+    emit(state, text, length);
+    if (flags & FLAG_LEFT) {
+        emit_fill(state, spaces, padding);
+    }
+}
+
+// --- Public Function: kformat ---
+// Literal text between conversions is passed to the sink as one span.
+int kformat(struct kformat_sink* sink, uint8_t color, const char* format, va_list args) {
+    struct format_state state = { sink, color, 0 };
+    const char* p = format;
+
+    while (*p) {
+        const char* literal = p;
+        while (*p && *p != '%') {
+            p++;
+        }
+        emit(&state, literal, (int)(p - literal));
+        if (!*p) {
+            break;
+        }
+        p++; // Skip '%'
+
+        // Flags.
+        int flags = 0;
+        for (;; p++) {
+            if (*p == '-') flags |= FLAG_LEFT;
+            else if (*p == '0') flags |= FLAG_ZERO;
+            else if (*p == '+') flags |= FLAG_PLUS;
+            else if (*p == ' ') flags |= FLAG_SPACE;
+            else if (*p == '#') flags |= FLAG_ALT;
+            else break;
+        }
+
+        // Width.
+        int width = 0;
+        if (*p == '*') {
+            width = va_arg(args, int);
+            if (width < 0) {
+                flags |= FLAG_LEFT;
+                width = -width;
+            }
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') {
+                width = width * 10 + (*p++ - '0');
+            }
+        }
+
+        // Precision (-1: none given).
+        int precision = -1;
+        if (*p == '.') {
+            p++;
+            precision = 0;
+            if (*p == '*') {
+                precision = va_arg(args, int);
+                if (precision < 0) {
+                    precision = -1;
+                }
+                p++;
+            } else {
+                while (*p >= '0' && *p <= '9') {
+                    precision = precision * 10 + (*p++ - '0');
+                }
+            }
+        }
+
+        // Length: 0 = int, 1 = long, 2 = long long, 3 = size_t.
+        int size = 0;
+        if (*p == 'l') {
+            size = 1;
+            if (*++p == 'l') {
+                size = 2;
+                p++;
+            }
+        } else if (*p == 'z') {
+            size = 3;
+            p++;
+        } else {
+            while (*p == 'h') {
+                p++; // Promoted to int anyway
+            }
+        }
+
+        char conversion = *p;
+        if (!conversion) {
+            break; // Format ends inside a conversion
+        }
+        p++;
+
+        switch (conversion) {
+            case 'd':
+            case 'i': {
+                int64_t value;
+                if (size == 0) value = va_arg(args, int);
+                else if (size == 1) value = va_arg(args, long);
+                else if (size == 2) value = va_arg(args, long long);
+                else value = (int64_t)va_arg(args, size_t);
+                // Negating in unsigned arithmetic also handles INT64_MIN.
+                uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+                emit_number(&state, magnitude, value < 0, 1, 0, 0, flags, width, precision);
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X': {
+                uint64_t value;
+                if (size == 0) value = va_arg(args, unsigned int);
+                else if (size == 1) value = va_arg(args, unsigned long);
+                else if (size == 2) value = va_arg(args, unsigned long long);
+                else value = va_arg(args, size_t);
+                emit_number(&state, value, 0, 0, conversion != 'u', conversion == 'X', flags, width, precision);
+                break;
+            }
+            case 'p': {
+                uint64_t value = (uint64_t)va_arg(args, void*);
+                emit_number(&state, value, 0, 0, 1, 0, flags | FLAG_ALT, width, 16);
+                break;
+            }
+            case 's': {
+                const char* text = va_arg(args, const char*);
+                if (!text) {
+                    text = "(null)";
+                }
+                int length = 0;
+                while (text[length] && (precision < 0 || length < precision)) {
+                    length++;
+                }
+                emit_text(&state, text, length, flags, width);
+                break;
+            }
+            case 'c': {
+                char c = (char)va_arg(args, int);
+                emit_text(&state, &c, 1, flags, width);
+                break;
+            }
+            case 'k':
+                state.color = (uint8_t)va_arg(args, int);
+                break;
+            case '%':
+                emit(&state, "%", 1);
+                break;
+            default:
+                // Unknown conversion: show it as written, so the mistake is visible.
+                emit(&state, p - 2, 2);
+                break;
+        }
+    }
+    return state.count;
+}
+
+// --- Buffer Sink ---
+// Copies as much as fits and counts the rest.
+struct buffer_sink {
+    struct kformat_sink base;
+    char* buf;
+    size_t size;   // Capacity, including the null terminator
+    size_t length; // Characters stored so far
+};
+
+static void buffer_write(struct kformat_sink* sink, const char* text, int len, uint8_t color) {
+    (void)color;
+    struct buffer_sink* buffer = (struct buffer_sink*)sink;
+    for (int i = 0; i < len && buffer->length + 1 < buffer->size; i++) {
+        buffer->buf[buffer->length++] = text[i];
+    }
+}
+
+// --- Public Function: kvsnprintf ---
+int kvsnprintf(char* buf, size_t size, const char* format, va_list args) {
+    struct buffer_sink sink = { { buffer_write }, buf, size, 0 };
+    int total = kformat(&sink.base, 0, format, args);
+    if (size > 0) {
+        buf[sink.length] = '\0';
+    }
+    return total;
+}
+
+// --- Public Function: ksnprintf ---
+int ksnprintf(char* buf, size_t size, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int total = kvsnprintf(buf, size, format, args);
+    va_end(args);
+    return total;
+}
@@ -0,0 +1,50 @@
+#ifndef KFORMAT_H // Standard header guard to prevent multiple inclusions
+#define KFORMAT_H
+
+#include <stdint.h> // For uint8_t
+#include <stddef.h> // For size_t
+#include <stdarg.h> // For va_list
+
+// --- Formatted Output ---
+// One formatting engine for every destination: kformat() walks the format
+// string once and hands the output to a sink in spans (runs of literal text,
+// padding, digits), each with the color it should be drawn in. The sink
+// decides where the characters go: ksnprintf() writes them straight into
+// the caller's buffer, kprintf() (kprint.h) straight into the screen.
+// Nothing is staged on the heap or in temporary strings; numbers are
+// produced most significant digit first, so they need no reversal either.
+//
+// Conversions (C99 subset):
+//   %d %i %u %x %X   integers; length modifiers l, ll, z (and h, hh, ignored)
+//   %p               pointer as 0x followed by 16 hex digits
+//   %s %c %%         string ("(null)" for 0), character, literal '%'
+//   %k               takes an int VGA attribute: the text after it is drawn
+//                    in that color (sinks without colors ignore it)
+// Flags '-' (left-justify), '0' (zero-pad), '+', ' ' and '#' (0x prefix),
+// field width and precision (also as '*') work as in printf.
+
+// A destination for formatted text.
+struct kformat_sink {
+    // Receives 'len' characters (not null-terminated) to be drawn in 'color'.
+    void (*write)(struct kformat_sink* sink, const char* text, int len, uint8_t color);
+};
+
+// --- Function Declarations ---
+
+// kformat: Formats into a sink.
+// Parameters:
+//   sink: Where the output goes.
+//   color: Color of the text until the first %k.
+//   format, args: printf-style format and its arguments.
+// Returns:
+//   The number of characters produced.
+int kformat(struct kformat_sink* sink, uint8_t color, const char* format, va_list args);
+
+// ksnprintf / kvsnprintf: Format into buf, writing at most size - 1
+// characters plus a terminating null (nothing at all if size is 0).
+// Returns:
+//   The length the full output has, even if it was cut short.
+int ksnprintf(char* buf, size_t size, const char* format, ...) __attribute__((format(printf, 3, 4)));
+int kvsnprintf(char* buf, size_t size, const char* format, va_list args);
+
+#endif // KFORMAT_H
@@ -0,0 +1,362 @@
+#include <stdint.h>
+#include "kheap.h"   // Our own declarations
+#include "kpmm.h"    // Frames backing the slabs, large blocks and arena chunks
+#include "kprint.h"  // Reporting bad kfree pointers
+#include "kutils.h"  // k_memset
+#include "kspinlock.h" // Allocations from several CPUs
+
+#define SLAB_MAGIC  0x51AB51ABu // Header of a slab
+#define LARGE_MAGIC 0x1A26E000u // Header of a large (> KHEAP_MAX_CLASS) block
+#define SLAB_ORDER  2           // KHEAP_SLAB_SIZE == KPMM_PAGE_SIZE << SLAB_ORDER
+
+#define ARENA_CHUNK_ORDER 4     // The arena grows in 64KB chunks
+#define MAX_BLOCK_BYTES ((uint64_t)KPMM_PAGE_SIZE << KPMM_MAX_ORDER) // Largest frame allocator block
+
+// --- Slab Header ---
+// Sits in the first cache line of every slab. Free objects are chained through
+// their first 8 bytes. Objects past 'carved' have never been handed out, so a
+// new slab does not have to be threaded into a free list up front.
+struct slab {
+    uint32_t magic;
+    uint16_t class_index;
+    uint16_t in_use;    // Objects currently allocated from this slab
+    uint16_t capacity;  // Objects that fit after the header
+    uint16_t carved;    // Objects handed out at least once
+    uint8_t on_partial; // 1 while the slab is on its cache's partial list
+    void* free_list;
+    struct slab* next;
+    struct slab* prev;
+} __attribute__((aligned(KHEAP_CACHE_LINE)));
+
+_Static_assert(sizeof(struct slab) == KHEAP_CACHE_LINE, "slab header must be one cache line");
+
+// Header of a large block; padded so the returned pointer is cache-line aligned.
+struct large_header {
+    uint32_t magic;
+    int32_t order;
+    uint64_t size;
+} __attribute__((aligned(KHEAP_CACHE_LINE)));
+
+// --- Size-Class Caches ---
+// 'partial' lists slabs with at least one free object; full slabs are not
+// tracked and rejoin the list when an object in them is freed. At most one
+// completely empty slab is kept per class so an alloc/free pair at a slab
+// boundary does not go to the frame allocator every time.
+struct kheap_cache {
+    struct slab* partial;
+    int empty_slabs;
+    struct kheap_class_stats stats;
+};
+
+static struct kheap_cache caches[KHEAP_NUM_CLASSES];
+static struct kheap_class_stats large_stats;
+
+// One lock for the caches and the arena, taken with interrupts disabled so
+// a holder is never interrupted in the middle of a list update.
+static struct kspinlock heap_lock = KSPINLOCK_INIT;
+
+// --- Arena State ---
+// The arena starts in a small .bss buffer so early boot code can allocate even
+// before (or without) a usable memory map; later chunks come from kpmm.
+#define ARENA_SEED_SIZE 8192
+static uint8_t arena_seed[ARENA_SEED_SIZE] __attribute__((aligned(KHEAP_CACHE_LINE)));
+static uint8_t* arena_next = 0; // Next free byte in the current chunk
+static uint8_t* arena_end = 0;  // End of the current chunk
+static uint64_t arena_used_bytes = 0;
+static uint64_t arena_reserved_bytes = 0;
+
+// --- Helper Function: size_to_class ---
+// Maps a request size (1 .. KHEAP_MAX_CLASS) to its class index:
+// 1-16 -> 0, 17-32 -> 1, ..., 1025-2048 -> 7.
+static inline int size_to_class(size_t size) {
+    if (size <= KHEAP_MIN_CLASS) {
+        return 0;
+    }
+    // Index of the highest set bit of (size - 1), plus one, gives the
+    // power of two that holds 'size'; 16 == 2^4 is class 0.
+    return (64 - __builtin_clzll((uint64_t)(size - 1))) - 4;
+}
+
+// --- Helper Function: order_for_bytes ---
+// Smallest frame allocator order whose block holds 'bytes'.
+static int order_for_bytes(uint64_t bytes) {
+    int order = 0;
+    while (((uint64_t)KPMM_PAGE_SIZE << order) < bytes) {
+        order++;
+    }
+    return order;
+}
+
+// --- Partial List Helpers ---
+static void partial_push(struct kheap_cache* cache, struct slab* slab) {
+    slab->prev = 0;
+    slab->next = cache->partial;
+    if (slab->next) {
+        slab->next->prev = slab;
+    }
+    cache->partial = slab;
+    slab->on_partial = 1;
+}
+
+static void partial_remove(struct kheap_cache* cache, struct slab* slab) {
+    if (slab->prev) {
+        slab->prev->next = slab->next;
+    } else {
+        cache->partial = slab->next;
+    }
+    if (slab->next) {
+        slab->next->prev = slab->prev;
+    }
+    slab->on_partial = 0;
+}
+
+// --- Helper Function: slab_create ---
+// Takes a fresh slab from the frame allocator and puts it on the partial list.
+static struct slab* slab_create(int class_index) {
+    uint64_t phys = kpmm_alloc(SLAB_ORDER, KPMM_DIRECT_ONLY);
+    if (!phys) {
+        return 0;
+    }
+    struct slab* slab = (struct slab*)phys; // Identity mapped
+    uint64_t object_size = caches[class_index].stats.size;
+    slab->magic = SLAB_MAGIC;
+    slab->class_index = (uint16_t)class_index;
+    slab->in_use = 0;
+    slab->capacity = (uint16_t)((KHEAP_SLAB_SIZE - sizeof(struct slab)) / object_size);
+    slab->carved = 0;
+    slab->free_list = 0;
+    partial_push(&caches[class_index], slab);
+    caches[class_index].empty_slabs++;
+    caches[class_index].stats.slabs++;
+    return slab;
+}
+
+// --- Public Function: kheap_init ---
+void kheap_init(void) {
+    for (int i = 0; i < KHEAP_NUM_CLASSES; i++) {
+        k_memset(&caches[i], 0, sizeof(caches[i]));
+        caches[i].stats.size = (uint64_t)KHEAP_MIN_CLASS << i;
+    }
+    k_memset(&large_stats, 0, sizeof(large_stats));
+    arena_next = arena_seed;
+    arena_end = arena_seed + ARENA_SEED_SIZE;
+    arena_used_bytes = 0;
+    arena_reserved_bytes = ARENA_SEED_SIZE;
+}
+
+// --- Helper Function: large_alloc ---
+// Serves a request above KHEAP_MAX_CLASS with its own block. The block is at
+// least KHEAP_SLAB_SIZE so kfree can find the header by rounding the pointer
+// down to a slab boundary, exactly as for slab objects.
+static void* large_alloc(size_t size) {
+    // Checked before adding the header, which would wrap for sizes near
+    // SIZE_MAX and turn a huge request into a small block.
+    if (size > MAX_BLOCK_BYTES - sizeof(struct large_header)) {
+        return 0;
+    }
+    int order = order_for_bytes(size + sizeof(struct large_header));
+    if (order < SLAB_ORDER) {
+        order = SLAB_ORDER;
+    }
+    uint64_t phys = kpmm_alloc(order, KPMM_DIRECT_ONLY);
+    if (!phys) {
+        return 0;
+    }
+    struct large_header* header = (struct large_header*)phys;
+    header->magic = LARGE_MAGIC;
+    header->order = order;
+    header->size = size;
+
+    large_stats.allocs++;
+    large_stats.live++;
+    large_stats.slabs++;
+    if (large_stats.live > large_stats.peak) {
+        large_stats.peak = large_stats.live;
+    }
+    return header + 1;
+}
+
+// --- Helper Function: kmalloc_locked ---
+// The body of kmalloc; heap_lock is held.
+static void* kmalloc_locked(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    if (size > KHEAP_MAX_CLASS) {
+        return large_alloc(size);
+    }
+
+    int class_index = size_to_class(size);
+    struct kheap_cache* cache = &caches[class_index];
+    struct slab* slab = cache->partial;
+    if (!slab) {
+        slab = slab_create(class_index);
+        if (!slab) {
+            return 0;
+        }
+    }
+
+    // Reuse a freed object if there is one, otherwise carve the next fresh one.
+    void* object = slab->free_list;
+    if (object) {
+        slab->free_list = *(void**)object;
+    } else {
+        object = (uint8_t*)(slab + 1) + (uint64_t)slab->carved * cache->stats.size;
+        slab->carved++;
+    }
+
+    if (slab->in_use == 0) {
+        cache->empty_slabs--;
+    }
+    slab->in_use++;
+    if (slab->in_use == slab->capacity) {
+        partial_remove(cache, slab);
+    }
+
+    cache->stats.allocs++;
+    cache->stats.live++;
+    if (cache->stats.live > cache->stats.peak) {
+        cache->stats.peak = cache->stats.live;
+    }
+    return object;
+}
+
+// --- Public Function: kmalloc ---
+void* kmalloc(size_t size) {
+    int interrupts_were_on = kspin_lock_irqsave(&heap_lock);
+    void* object = kmalloc_locked(size);
+    kspin_unlock_irqrestore(&heap_lock, interrupts_were_on);
+    return object;
+}
+
+// --- Helper Function: kfree_locked ---
+// The body of kfree; heap_lock is held.
+// Returns:
+//   0, or -1 if the pointer did not come from kmalloc.
+static int kfree_locked(void* ptr) {
+    // Slabs and large blocks both start on a KHEAP_SLAB_SIZE boundary.
+    uint64_t base = (uint64_t)ptr & ~(uint64_t)(KHEAP_SLAB_SIZE - 1);
+
+    if (*(uint32_t*)base == LARGE_MAGIC) {
+        struct large_header* header = (struct large_header*)base;
+        header->magic = 0; // Catch a second kfree of the same block
+        kpmm_free(base, header->order);
+        large_stats.frees++;
+        large_stats.live--;
+        large_stats.slabs--;
+        return 0;
+    }
+
+    struct slab* slab = (struct slab*)base;
+    if (slab->magic != SLAB_MAGIC) {
+        return -1;
+    }
+
+    struct kheap_cache* cache = &caches[slab->class_index];
+    *(void**)ptr = slab->free_list;
+    slab->free_list = ptr;
+    slab->in_use--;
+    cache->stats.frees++;
+    cache->stats.live--;
+
+    if (!slab->on_partial) {
+        partial_push(cache, slab); // Was full, has room again
+    }
+    if (slab->in_use == 0) {
+        if (cache->empty_slabs > 0) {
+            // Already holding a spare empty slab: give this one back.
+            partial_remove(cache, slab);
+            slab->magic = 0;
+            kpmm_free(base, SLAB_ORDER);
+            cache->stats.slabs--;
+        } else {
+            cache->empty_slabs++;
+        }
+    }
+    return 0;
+}
+
+// --- Public Function: kfree ---
+// The error is reported after the lock is released.
+void kfree(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    int interrupts_were_on = kspin_lock_irqsave(&heap_lock);
+    int result = kfree_locked(ptr);
+    kspin_unlock_irqrestore(&heap_lock, interrupts_were_on);
+    if (result < 0) {
+        kprint("kfree: pointer not from kmalloc\n", VGA_ATTRIB_RED_ON_BLACK);
+    }
+}
+
+// --- Helper Function: arena_alloc_locked ---
+// The body of karena_alloc; heap_lock is held.
+static void* arena_alloc_locked(size_t size, size_t align) {
+    if (align == 0) {
+        align = 8;
+    }
+    if (size > MAX_BLOCK_BYTES || align > MAX_BLOCK_BYTES) {
+        return 0; // Could never fit a block, and size + align could wrap
+    }
+    uint64_t start = ((uint64_t)arena_next + align - 1) & ~(uint64_t)(align - 1);
+
+    if (start + size > (uint64_t)arena_end) {
+        // Start a new chunk. Requests too big for a chunk get a block of their
+        // own and the current chunk stays in use for later small requests.
+        int order = order_for_bytes(size + align);
+        if (order > KPMM_MAX_ORDER) {
+            return 0;
+        }
+        int own_block = order > ARENA_CHUNK_ORDER;
+        if (!own_block) {
+            order = ARENA_CHUNK_ORDER;
+        }
+        uint64_t phys = kpmm_alloc(order, KPMM_DIRECT_ONLY);
+        if (!phys) {
+            return 0;
+        }
+        uint64_t bytes = (uint64_t)KPMM_PAGE_SIZE << order;
+        k_memset((void*)phys, 0, bytes);
+        arena_reserved_bytes += bytes;
+
+        start = (phys + align - 1) & ~(uint64_t)(align - 1);
+        if (!own_block) {
+            arena_next = (uint8_t*)phys;
+            arena_end = (uint8_t*)(phys + bytes);
+        } else {
+            arena_used_bytes += size;
+            return (void*)start;
+        }
+    }
+
+    arena_next = (uint8_t*)(start + size);
+    arena_used_bytes += size;
+    return (void*)start;
+}
+
+// --- Public Function: karena_alloc ---
+void* karena_alloc(size_t size, size_t align) {
+    int interrupts_were_on = kspin_lock_irqsave(&heap_lock);
+    void* block = arena_alloc_locked(size, align);
+    kspin_unlock_irqrestore(&heap_lock, interrupts_were_on);
+    return block;
+}
+
+// --- Public Function: kheap_class_stats ---
+void kheap_class_stats(int class_index, struct kheap_class_stats* out) {
+    if (class_index >= 0 && class_index < KHEAP_NUM_CLASSES) {
+        *out = caches[class_index].stats;
+    } else {
+        *out = large_stats;
+    }
+}
+
+// --- Public Functions: karena_used / karena_reserved ---
+uint64_t karena_used(void) {
+    return arena_used_bytes;
+}
+
+uint64_t karena_reserved(void) {
+    return arena_reserved_bytes;
+}
@@ -0,0 +1,75 @@
+#ifndef KHEAP_H // Standard header guard to prevent multiple inclusions
+#define KHEAP_H
+
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint64_t
+
+// --- Kernel Heap ---
+// kmalloc/kfree serve small requests from power-of-two size-class caches
+// (16 .. 2048 bytes). Each cache owns "slabs": KHEAP_SLAB_SIZE blocks taken
+// from the physical frame allocator, with a 64-byte header followed by
+// equally sized objects. A slab keeps its free objects on its own free list,
+// so kmalloc and kfree are a handful of pointer operations.
+// Because the header is one cache line and every size is a power of two,
+// objects of 64 bytes or more start on a cache line and smaller objects never
+// straddle one.
+// Requests larger than KHEAP_MAX_CLASS go straight to the frame allocator.
+//
+// karena_alloc is a bump allocator for data that lives until reboot (tables
+// built at boot, UI buffers). It never frees, so it has no per-object
+// overhead and no fragmentation.
+
+#define KHEAP_MIN_CLASS   16
+#define KHEAP_MAX_CLASS   2048
+#define KHEAP_NUM_CLASSES 8      // 16, 32, 64, 128, 256, 512, 1024, 2048
+#define KHEAP_SLAB_SIZE   16384  // Bytes per slab (4 frames, naturally aligned)
+#define KHEAP_CACHE_LINE  64
+
+// --- Statistics ---
+// Counters for one size class. The large-allocation path is reported as an
+// extra class with size 0.
+struct kheap_class_stats {
+    uint64_t size;   // Object size in bytes
+    uint64_t allocs; // Successful kmalloc calls served by this class
+    uint64_t frees;  // kfree calls returning an object of this class
+    uint64_t live;   // Objects currently allocated (allocs - frees)
+    uint64_t peak;   // Highest value 'live' has reached
+    uint64_t slabs;  // Slabs currently owned by the class (or large blocks)
+};
+
+// --- Function Declarations ---
+
+// kheap_init: Resets the caches and the arena. kpmm_init() must have run.
+void kheap_init(void);
+
+// kmalloc: Allocates 'size' bytes of uninitialized memory.
+// Parameters:
+//   size: Number of bytes; 0 is treated as 1.
+// Returns:
+//   A pointer aligned to min(size class, KHEAP_CACHE_LINE) bytes, or 0 if
+//   memory is exhausted.
+void* kmalloc(size_t size);
+
+// kfree: Returns memory obtained from kmalloc. kfree(0) does nothing.
+void kfree(void* ptr);
+
+// karena_alloc: Allocates zeroed memory that is never freed.
+// Parameters:
+//   size: Number of bytes.
+//   align: Required alignment, a power of two (0 means 8).
+// Returns:
+//   The memory, or 0 if the frame allocator is exhausted.
+void* karena_alloc(size_t size, size_t align);
+
+// kheap_class_stats: Copies the counters of one size class.
+// Parameters:
+//   class_index: 0 .. KHEAP_NUM_CLASSES-1, or KHEAP_NUM_CLASSES for large allocations.
+//   out: Receives the counters.
+void kheap_class_stats(int class_index, struct kheap_class_stats* out);
+
+// karena_used / karena_reserved: Bytes handed out by the arena and bytes of
+// frames it has taken from the frame allocator.
+uint64_t karena_used(void);
+uint64_t karena_reserved(void);
+
+#endif // KHEAP_H
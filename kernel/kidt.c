@@ -0,0 +1,207 @@
+#include <stdint.h>
+#include "kidt.h"     // Our own declarations
+#include "kinput.h"   // For inb/outb (defined in boot.asm)
+#include "kprint.h"   // For reporting unhandled exceptions
+#include "kcpu.h"     // k_read_cr2 for the page fault report
+#include "kthread.h"  // Preemption on the way out of hardware interrupts
+
+// --- 8259 PIC I/O Ports and Commands ---
+#define PIC1_COMMAND 0x20 // Master PIC command port
+#define PIC1_DATA    0x21 // Master PIC data (mask) port
+#define PIC2_COMMAND 0xA0 // Slave PIC command port
+#define PIC2_DATA    0xA1 // Slave PIC data (mask) port
+#define PIC_EOI      0x20 // End Of Interrupt command
+#define PIC_READ_ISR 0x0B // OCW3: next read of the command port returns the In-Service Register
+
+// --- IDT Gate Descriptor ---
+// One 16-byte entry of the 64-bit IDT.
+struct idt_entry {
+    uint16_t offset_low;  // Handler address bits 0-15
+    uint16_t selector;    // Code segment selector (CODE_SEL in boot.asm)
+    uint8_t  ist;         // Interrupt Stack Table index (0 = use current stack)
+    uint8_t  type_attr;   // Gate type, DPL and Present bit
+    uint16_t offset_mid;  // Handler address bits 16-31
+    uint32_t offset_high; // Handler address bits 32-63
+    uint32_t reserved;
+} __attribute__((packed));
+
+// Operand of the LIDT instruction.
+struct idt_pointer {
+    uint16_t limit;
+    uint64_t base;
+} __attribute__((packed));
+
+#define KERNEL_CODE_SELECTOR 0x08 // CODE_SEL in boot.asm
+#define IDT_INTERRUPT_GATE   0x8E // Present, DPL=0, 64-bit interrupt gate (clears IF on entry)
+
+// Addresses of the 256 entry stubs (defined in isr.asm).
+extern uint64_t isr_stub_table[256];
+
+static struct idt_entry idt[256] __attribute__((aligned(16)));
+static interrupt_handler_t handlers[256];
+
+// Human readable names for the CPU exceptions, used in the panic message.
+static const char* exception_names[32] = {
+    "Divide Error", "Debug", "NMI", "Breakpoint", "Overflow", "BOUND Range Exceeded",
+    "Invalid Opcode", "Device Not Available", "Double Fault", "Coprocessor Segment Overrun",
+    "Invalid TSS", "Segment Not Present", "Stack-Segment Fault", "General Protection Fault",
+    "Page Fault", "Reserved", "x87 Floating-Point", "Alignment Check", "Machine Check",
+    "SIMD Floating-Point", "Virtualization", "Control Protection", "Reserved", "Reserved",
+    "Reserved", "Reserved", "Reserved", "Reserved", "Hypervisor Injection",
+    "VMM Communication", "Security", "Reserved"
+};
+
+// --- Helper Function: print_hex64 ---
+// Prints a 64-bit value as 16 hex digits (k_itoa only handles 'int').
+static void print_hex64(uint64_t value, uint8_t color_attribute) {
+    char buf[19];
+    buf[0] = '0';
+    buf[1] = 'x';
+    for (int i = 0; i < 16; i++) {
+        uint8_t nibble = (value >> (60 - i * 4)) & 0xF;
+        buf[2 + i] = (char)(nibble < 10 ? '0' + nibble : 'a' + nibble - 10);
+    }
+    buf[18] = '\0';
+    kprint_panic(buf, color_attribute);
+}
+
+// --- Helper Function: idt_set_gate ---
+// Fills one IDT entry so that 'vector' jumps to 'handler_address'.
+static void idt_set_gate(int vector, uint64_t handler_address) {
+    idt[vector].offset_low = handler_address & 0xFFFF;
+    idt[vector].selector = KERNEL_CODE_SELECTOR;
+    idt[vector].ist = 0;
+    idt[vector].type_attr = IDT_INTERRUPT_GATE;
+    idt[vector].offset_mid = (handler_address >> 16) & 0xFFFF;
+    idt[vector].offset_high = (uint32_t)(handler_address >> 32);
+    idt[vector].reserved = 0;
+}
+
+// --- Helper Function: pic_remap ---
+// Re-initializes both PICs so IRQ 0-7 use vectors 32-39 and IRQ 8-15 use 40-47,
+// then masks every line except the cascade (IRQ2).
+static void pic_remap(void) {
+    outb(PIC1_COMMAND, 0x11);            // ICW1: start initialization, expect ICW4
+    outb(PIC2_COMMAND, 0x11);
+    outb(PIC1_DATA, IRQ_BASE_VECTOR);     // ICW2: master vector offset (32)
+    outb(PIC2_DATA, IRQ_BASE_VECTOR + 8); // ICW2: slave vector offset (40)
+    outb(PIC1_DATA, 0x04);                // ICW3: slave is attached to master IRQ2
+    outb(PIC2_DATA, 0x02);                // ICW3: slave cascade identity
+    outb(PIC1_DATA, 0x01);                // ICW4: 8086/88 mode
+    outb(PIC2_DATA, 0x01);
+
+    outb(PIC1_DATA, 0xFB);                // Mask everything except IRQ2 (cascade)
+    outb(PIC2_DATA, 0xFF);
+}
+
+// --- Helper Function: pic_is_spurious ---
+// IRQ7/IRQ15 may be raised spuriously (e.g. when a line drops before it is
+// acknowledged). A real interrupt has its bit set in the PIC's In-Service Register.
+static int pic_is_spurious(uint8_t irq) {
+    if (irq == 7) {
+        outb(PIC1_COMMAND, PIC_READ_ISR);
+        return !(inb(PIC1_COMMAND) & 0x80);
+    }
+    if (irq == 15) {
+        outb(PIC2_COMMAND, PIC_READ_ISR);
+        if (!(inb(PIC2_COMMAND) & 0x80)) {
+            outb(PIC1_COMMAND, PIC_EOI); // The master still saw a real cascade interrupt
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// --- Public Function: kidt_init ---
+// Fills all 256 gates from isr_stub_table, loads the IDT and remaps the PICs.
+void kidt_init(void) {
+    for (int i = 0; i < 256; i++) {
+        idt_set_gate(i, isr_stub_table[i]);
+        handlers[i] = 0;
+    }
+    kidt_load();
+    pic_remap();
+}
+
+// --- Public Function: kidt_load ---
+void kidt_load(void) {
+    struct idt_pointer idtr;
+    idtr.limit = sizeof(idt) - 1;
+    idtr.base = (uint64_t)idt;
+    __asm__ volatile ("lidt %0" : : "m"(idtr));
+}
+
+// --- Public Function: kidt_register_handler ---
+void kidt_register_handler(uint8_t vector, interrupt_handler_t handler) {
+    handlers[vector] = handler;
+}
+
+// --- Public Function: kpic_unmask ---
+void kpic_unmask(uint8_t irq) {
+    uint16_t port = (irq < 8) ? PIC1_DATA : PIC2_DATA;
+    outb(port, inb(port) & ~(1 << (irq & 7)));
+}
+
+// --- Public Function: kpic_mask ---
+void kpic_mask(uint8_t irq) {
+    uint16_t port = (irq < 8) ? PIC1_DATA : PIC2_DATA;
+    outb(port, inb(port) | (1 << (irq & 7)));
+}
+
+// --- Public Function: kidt_panic ---
+// Everything goes through kprint_panic, which never waits on print_lock or
+// the serial locks for good: the fault may have hit while this CPU held
+// them, or another CPU holding them may be the one that died.
+void kidt_panic(struct interrupt_frame* frame) {
+    kprint_panic("\n*** KERNEL PANIC: ", VGA_ATTRIB_RED_ON_BLACK);
+    kprint_panic(exception_names[frame->vector & 31], VGA_ATTRIB_RED_ON_BLACK);
+    kprint_panic(" ***\nRIP=", VGA_ATTRIB_RED_ON_BLACK);
+    print_hex64(frame->rip, VGA_ATTRIB_WHITE_ON_BLACK);
+    kprint_panic(" ERR=", VGA_ATTRIB_RED_ON_BLACK);
+    print_hex64(frame->error_code, VGA_ATTRIB_WHITE_ON_BLACK);
+    if (frame->vector == 14) {
+        kprint_panic(" CR2=", VGA_ATTRIB_RED_ON_BLACK);
+        print_hex64(k_read_cr2(), VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+    kprint_panic("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    while (1) {
+        __asm__ volatile ("cli; hlt");
+    }
+}
+
+// --- Function: isr_dispatch ---
+// Called from isr_common (isr.asm) for every interrupt and exception, with
+// interrupts disabled. Hardware IRQs are acknowledged before their handler
+// runs so that a handler is free to never return to this frame directly
+// (for example, when it switches to another task).
+// Parameters:
+//   frame: The saved register state of the interrupted code.
+void isr_dispatch(struct interrupt_frame* frame) {
+    uint64_t vector = frame->vector;
+
+    if (vector >= IRQ_BASE_VECTOR && vector < IRQ_BASE_VECTOR + 16) {
+        uint8_t irq = (uint8_t)(vector - IRQ_BASE_VECTOR);
+        if (pic_is_spurious(irq)) {
+            return;
+        }
+        // Acknowledge the interrupt: the slave needs its own EOI for IRQ 8-15.
+        if (irq >= 8) {
+            outb(PIC2_COMMAND, PIC_EOI);
+        }
+        outb(PIC1_COMMAND, PIC_EOI);
+    }
+
+    if (handlers[vector]) {
+        handlers[vector](frame);
+        if (vector >= IRQ_BASE_VECTOR) {
+            kthread_preempt(); // The tick or a wake-up may have made another thread due
+        }
+        return;
+    }
+
+    if (vector < 32) {
+        // An exception nobody handles is fatal: report it and stop the CPU.
+        kidt_panic(frame);
+    }
+    // Unhandled IRQs and software vectors are ignored.
+}
@@ -0,0 +1,57 @@
+#ifndef KIDT_H // Standard header guard to prevent multiple inclusions
+#define KIDT_H
+
+#include <stdint.h> // For uint8_t, uint64_t
+
+// --- Interrupt Vector Layout ---
+// Vectors 0-31 are CPU exceptions. The two 8259 PICs are remapped so that
+// hardware IRQ 0-15 arrive on vectors 32-47 instead of clashing with them.
+#define IRQ_BASE_VECTOR 32
+#define IRQ_VECTOR(irq) (IRQ_BASE_VECTOR + (irq))
+
+// Legacy ISA IRQ lines used by the kernel.
+#define IRQ_TIMER     0 // PIT channel 0
+#define IRQ_KEYBOARD  1 // PS/2 keyboard
+#define IRQ_COM1      4 // First serial port
+
+// --- Saved CPU State ---
+// Layout of the stack built by isr_common in isr.asm. The general purpose
+// registers come first (pushed last), then the vector and error code pushed
+// by the stub, then the frame pushed by the CPU itself.
+struct interrupt_frame {
+    uint64_t r15, r14, r13, r12, r11, r10, r9, r8;
+    uint64_t rbp, rdi, rsi, rdx, rcx, rbx, rax;
+    uint64_t vector, error_code;
+    uint64_t rip, cs, rflags, rsp, ss;
+};
+
+// Signature of a C interrupt handler.
+typedef void (*interrupt_handler_t)(struct interrupt_frame* frame);
+
+// --- Function Declarations ---
+
+// kidt_init: Builds the 256-entry IDT, loads it with LIDT and remaps the PICs.
+// All IRQ lines start masked; drivers unmask the lines they handle.
+// Interrupts are NOT enabled here; the caller executes 'sti' when ready.
+void kidt_init(void);
+
+// kidt_load: Loads the IDT on the calling CPU. kidt_init() does this for the
+// BSP; the other CPUs call it while starting up (the table is shared).
+void kidt_load(void);
+
+// kidt_register_handler: Installs a C handler for an interrupt vector.
+// Parameters:
+//   vector: The IDT vector (0-255). Use IRQ_VECTOR(n) for hardware IRQs.
+//   handler: The function to call, or 0 to remove the handler.
+void kidt_register_handler(uint8_t vector, interrupt_handler_t handler);
+
+// kidt_panic: Reports a fatal exception (name, RIP, error code and, for page
+// faults, CR2) and halts the CPU. Exception handlers call it for faults they
+// cannot resolve.
+void kidt_panic(struct interrupt_frame* frame);
+
+// kpic_unmask / kpic_mask: Enable or disable delivery of a legacy IRQ line (0-15).
+void kpic_unmask(uint8_t irq);
+void kpic_mask(uint8_t irq);
+
+#endif // KIDT_H
@@ -1,139 +1,202 @@
 #include <stdint.h>   // For standard integer types like uint8_t, uint16_t
 #include "kinput.h"   // Include our own header for kgetc and outb declarations
 #include "kprint.h"   // Required for kprint to echo characters back to the screen (now with color support)
+#include "kidt.h"     // For registering the IRQ1 handler
+#include "kcpu.h"     // For k_disable_interrupts
+#include "ktrace.h"   // IRQ latency probe; trace records are folded in while idle
+#include "kthread.h"  // Blocking the reading thread until a key arrives
+#include "kkbd.h"     // Scancode decoder: key events with modifiers
 
 // --- PS/2 Keyboard Controller I/O Ports ---
 // These are standard I/O port addresses for the PS/2 keyboard controller.
 #define KBD_DATA_PORT   0x60 // Data port: used to read scan codes from the keyboard.
 #define KBD_STATUS_PORT 0x64 // Status/Command port: used to check keyboard status or send commands.
 
-// --- Scan Code to ASCII Mapping ---
-// This is a highly simplified lookup table to convert raw keyboard scan codes
-// (which are hardware-specific codes sent by the keyboard) into ASCII characters.
-// This table is for a US QWERTY keyboard, non-shifted, and covers only basic keys.
-// A full keyboard driver would be much more complex, handling:
-// - Shift states (uppercase letters, symbols like !, @, #)
-// - Caps Lock, Num Lock, Scroll Lock
-// - Special keys (F-keys, arrow keys, Home, End, Page Up/Down, Insert, Delete)
-// - Different keyboard layouts (e.g., QWERTZ, AZERTY)
-// - Key release events (scan code with MSB set, e.g., 0x80 + key_scan_code)
-static const unsigned char kbd_us[128] =
-{
-    0,  27, '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', '-', '=', '\b', /* 0x0E: Backspace */
-    '\t', /* 0x0F: Tab */
-    'q', 'w', 'e', 'r', 't', 'y', 'u', 'i', 'o', 'p', '[', ']', '\n',     /* 0x1C: Enter key */
-    0, /* 0x1D: Left Control */
-    'a', 's', 'd', 'f', 'g', 'h', 'j', 'k', 'l', ';', '\'', '`',   0, /* 0x2A: Left Shift */
-    '\\', 'z', 'x', 'c', 'v', 'b', 'n', 'm', ',', '.', '/',   0, /* 0x36: Right Shift */
-    '*', /* 0x37: Keypad * */
-    0,  /* 0x38: Left Alt */
-    ' ',  /* 0x39: Space bar */
-    0,  /* 0x3A: Caps lock */
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x3B-0x44: F1-F10 */
-    0,  /* 0x45: Num lock*/
-    0,  /* 0x46: Scroll Lock */
-    0,  /* 0x47: Home key */
-    0,  /* 0x48: Up Arrow */
-    0,  /* 0x49: Page Up */
-    '-', /* 0x4A: Keypad - */
-    0,  /* 0x4B: Left Arrow */
-    0,  /* 0x4C: Keypad 5 */
-    0,  /* 0x4D: Right Arrow */
-    '+', /* 0x4E: Keypad + */
-    0,  /* 0x4F: End key */
-    0,  /* 0x50: Down Arrow */
-    0,  /* 0x51: Page Down */
-    0,  /* 0x52: Insert Key */
-    0,  /* 0x53: Delete Key */
-    0, 0, 0,
-    0,  /* 0x57: F11 Key */
-    0,  /* 0x58: F12 Key */
-    0,  /* All other keys are undefined or special */
-};
+// --- Key Event Ring Buffer ---
+// Single-producer/single-consumer ring between the IRQ1 handler (producer)
+// and kgetkey/kgets (consumer). The handler runs the scancodes through the
+// decoder and queues only complete key presses, so releases, prefixes and
+// modifier keys take no room: typeahead is counted in keys, not bytes.
+// head is only written by the interrupt handler and tail only by the reader,
+// so no lock is needed: each side publishes its index with a release store
+// and reads the other side's index with an acquire load.
+// The indices run freely and are masked on access; the size must be a power of two.
+#define KBD_RING_SIZE 256
+static struct kkey_event kbd_ring[KBD_RING_SIZE];
+static uint32_t kbd_ring_head = 0;    // Next slot the IRQ handler writes
+static uint32_t kbd_ring_tail = 0;    // Next slot the reader takes
+static uint32_t kbd_ring_dropped = 0; // Key presses lost because the ring was full
+static struct kkbd_decoder kbd_decoder = KKBD_DECODER_INIT; // Only the IRQ handler touches it
+static struct kthread_waitq kbd_waiters = KTHREAD_WAITQ_INIT; // Threads blocked waiting for a key
+
+KTRACE_DEFINE(keyboard_probe, "keyboard IRQ");
+
+// --- Interrupt Handler: keyboard_irq_handler ---
+// Runs on IRQ1. Decodes every byte the controller has ready and queues the
+// resulting key presses. The decoder sees every byte, even when the ring is
+// full, so a dropped key never leaves a modifier stuck.
+static void keyboard_irq_handler(struct interrupt_frame* frame) {
+    (void)frame;
+    KTRACE_BEGIN(keyboard_probe);
+    while (inb(KBD_STATUS_PORT) & 0x01) {
+        struct kkey_event event;
+        if (!kkbd_decode(&kbd_decoder, inb(KBD_DATA_PORT), &event)) {
+            continue;
+        }
+        uint32_t head = kbd_ring_head;
+        uint32_t tail = __atomic_load_n(&kbd_ring_tail, __ATOMIC_ACQUIRE);
+        if (head - tail >= KBD_RING_SIZE) {
+            kbd_ring_dropped++; // Ring full: the consumer is far behind
+            continue;
+        }
+        kbd_ring[head & (KBD_RING_SIZE - 1)] = event;
+        __atomic_store_n(&kbd_ring_head, head + 1, __ATOMIC_RELEASE);
+    }
+    kthread_wake_all(&kbd_waiters); // The reader preempts background threads on the way out
+    KTRACE_END(keyboard_probe);
+}
+
+// --- Helper Function: kbd_ring_pop ---
+// Takes the oldest key press out of the ring.
+// Returns:
+//   1 and stores the event in *event, or 0 if the ring is empty.
+static int kbd_ring_pop(struct kkey_event* event) {
+    uint32_t tail = kbd_ring_tail;
+    if (__atomic_load_n(&kbd_ring_head, __ATOMIC_ACQUIRE) == tail) {
+        return 0;
+    }
+    *event = kbd_ring[tail & (KBD_RING_SIZE - 1)];
+    __atomic_store_n(&kbd_ring_tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// --- Helper Function: kbd_wait_for_data ---
+// Halts the CPU until the ring is non-empty. Interrupts are disabled while the
+// ring is checked; 'sti' only takes effect after the following instruction,
+// so an IRQ that arrives between the check and 'hlt' still wakes the CPU.
+// With threads running, only the reading thread blocks (the log flusher
+// thread takes over draining the trace records).
+static void kbd_wait_for_data(void) {
+    if (kthread_running()) {
+        k_disable_interrupts();
+        if (__atomic_load_n(&kbd_ring_head, __ATOMIC_ACQUIRE) == kbd_ring_tail) {
+            kthread_wait(&kbd_waiters);
+        }
+        k_enable_interrupts();
+        return;
+    }
+    ktrace_drain(); // About to idle anyway: a good moment to aggregate trace records
+    k_disable_interrupts();
+    if (__atomic_load_n(&kbd_ring_head, __ATOMIC_ACQUIRE) == kbd_ring_tail) {
+        __asm__ volatile ("sti; hlt" : : : "memory");
+    } else {
+        __asm__ volatile ("sti" : : : "memory");
+    }
+}
+
+// --- Public Function: kinput_init ---
+// Discards anything left in the controller's output buffer, installs the
+// IRQ1 handler and unmasks the keyboard line on the PIC.
+void kinput_init(void) {
+    while (inb(KBD_STATUS_PORT) & 0x01) {
+        inb(KBD_DATA_PORT);
+    }
+    kidt_register_handler(IRQ_VECTOR(IRQ_KEYBOARD), keyboard_irq_handler);
+    kpic_unmask(IRQ_KEYBOARD);
+}
+
+// --- Public Function: kgetkey ---
+// Reads the next key press. Key presses are queued by the IRQ1 handler;
+// while the queue is empty the calling thread blocks (or, before threads
+// run, the CPU sleeps with 'hlt').
+void kgetkey(struct kkey_event* event) {
+    while (!kbd_ring_pop(event)) {
+        kbd_wait_for_data(); // Nothing queued: sleep until the next interrupt
+    }
+}
 
 // --- Public Function: kgetc ---
-// Reads a single character from the keyboard. This function uses polling,
-// meaning it continuously checks the keyboard status until a key press is detected.
-// Parameters: None.
+// Reads a single character from the keyboard.
 // Returns:
-//   The ASCII character corresponding to the pressed key.
-//   Returns 0 if the scan code is not mapped in the kbd_us table.
+//   The ASCII character of the next key press, or 0 for a key without one
+//   (arrows, function keys, ...).
 char kgetc() {
-    uint8_t status;      // Variable to store the keyboard status register value
-    uint8_t scan_code;   // Variable to store the raw scan code from the keyboard
+    struct kkey_event event;
+    kgetkey(&event);
+    return event.key < 0x80 ? (char)event.key : 0;
+}
 
-    // Loop indefinitely until data is available in the keyboard buffer.
-    while (1) {
-        // 1. Read the status register of the keyboard controller.
-        status = inb(KBD_STATUS_PORT);
+// --- Line Discipline ---
+// kgets edits the line in its buffer and collects the echo in a local
+// string, which goes to the console in one kprint (one screen update) once
+// every queued key has been taken: a burst of pasted or fast typed keys is
+// drawn once, not once per character. Keys after Enter stay queued for the
+// next reader.
+#define KGETS_ECHO_SIZE 128
 
-        // 2. Check if the output buffer (bit 0 of the status register) is full.
-        //    If bit 0 is set (0x01), it means there's data ready to be read from the data port.
-        if (status & 0x01) {
-            // 3. Read the scan code from the keyboard data port.
-            scan_code = inb(KBD_DATA_PORT);
+// --- Helper Function: echo_flush ---
+// Prints and empties the collected echo.
+static void echo_flush(char* echo, int* echo_len) {
+    if (*echo_len > 0) {
+        echo[*echo_len] = '\0';
+        kprint(echo, VGA_ATTRIB_WHITE_ON_BLACK);
+        *echo_len = 0;
+    }
+}
 
-            // 4. Check for key release events.
-            //    Key release scan codes have the most significant bit (MSB, 0x80) set.
-            //    We only care about key press events, so we check if MSB is NOT set.
-            if (!(scan_code & 0x80)) {
-                // It's a key press. Convert the scan code to an ASCII character
-                // using our lookup table and return it.
-                // Ensure the scan_code is within the bounds of our kbd_us array.
-                if (scan_code < 128) {
-                    return kbd_us[scan_code];
-                }
-            }
-        }
+// --- Helper Function: echo_erase ---
+// Adds the echo that erases the character before the cursor ("\b \b").
+static void echo_erase(char* echo, int* echo_len) {
+    if (*echo_len > KGETS_ECHO_SIZE - 4) {
+        echo_flush(echo, echo_len);
     }
+    echo[(*echo_len)++] = '\b';
+    echo[(*echo_len)++] = ' ';
+    echo[(*echo_len)++] = '\b';
 }
 
 // --- Public Function: kgets ---
-// Reads a string from the keyboard into a provided buffer.
-// It reads characters one by one using kgetc, echoes them to the screen,
-// and handles backspace and the Enter key.
+// Reads a line from the keyboard into a provided buffer, echoing it.
+// Editing keys: Backspace deletes the last character, Ctrl+U the whole
+// line; Enter ends the line. Characters beyond the buffer are dropped.
 // Parameters:
 //   buffer: A pointer to a character array where the input string will be stored.
-//   max_len: The maximum number of characters to read (including space for null terminator).
+//   max_len: The size of the buffer (including space for the null terminator).
 void kgets(char* buffer, int max_len) {
-    int i = 0;   // Index for the buffer
-    char c;      // Variable to store the character read from keyboard
+    char echo[KGETS_ECHO_SIZE];
+    int echo_len = 0;
+    int i = 0; // Index for the buffer
 
-    // Loop until the buffer is almost full (leaving space for the null terminator)
-    // or the Enter key is pressed.
-    while (i < max_len - 1) {
-        c = kgetc(); // Get a single character from the keyboard
-
-        // Handle Enter key (newline or carriage return)
-        if (c == '\n' || c == '\r') {
-            break; // Exit the loop if Enter is pressed
+    while (1) {
+        struct kkey_event event;
+        if (!kbd_ring_pop(&event)) {
+            // The burst is drained: show it, then wait for more.
+            echo_flush(echo, &echo_len);
+            kbd_wait_for_data();
+            continue;
         }
 
-        // Handle Backspace key
-        if (c == '\b') {
-            if (i > 0) { // Only backspace if there are characters already in the buffer
-                i--; // Decrement buffer index
-                // Erase character from screen:
-                // Move cursor back, print a space to overwrite the character, then move cursor back again.
-                // Now passing the default color attribute.
-                kprint("\b \b", VGA_ATTRIB_WHITE_ON_BLACK); 
+        uint16_t c = event.key;
+        if (c == '\n') {
+            break;
+        } else if (c == '\b') {
+            if (i > 0) {
+                i--;
+                echo_erase(echo, &echo_len);
             }
-            continue; // Don't add backspace to the buffer; continue to the next key press
-        }
-
-        // Only process valid characters (non-zero, as 0 indicates unmapped scan codes in kbd_us)
-        if (c != 0) {
-            buffer[i++] = c; // Store the character in the buffer and then increment the index
-            
-            // Echo character to screen:
-            // Create a temporary string with the single character and print it
-            // so the user can see what they are typing.
-            // Now passing the default color attribute.
-            char temp_str[2];
-            temp_str[0] = c;
-            temp_str[1] = '\0'; // Null-terminate the temporary string
-            kprint(temp_str, VGA_ATTRIB_WHITE_ON_BLACK);
+        } else if (c == ('u' & 0x1F)) { // Ctrl+U: erase the line
+            for (; i > 0; i--) {
+                echo_erase(echo, &echo_len);
+            }
+        } else if (c >= ' ' && c < 0x7F && i < max_len - 1) {
+            buffer[i++] = (char)c;
+            if (echo_len > KGETS_ECHO_SIZE - 2) {
+                echo_flush(echo, &echo_len);
+            }
+            echo[echo_len++] = (char)c;
         }
+        // Other keys (arrows, function keys, control codes) do nothing here.
     }
+    echo_flush(echo, &echo_len);
     buffer[i] = '\0'; // Null-terminate the string after input is complete
 }
@@ -1,6 +1,9 @@
 #ifndef KINPUT_H
 #define KINPUT_H
 
+#include <stdint.h> // For uint8_t, uint16_t
+#include "kkbd.h"   // struct kkey_event, KEY_* and KMOD_* codes
+
 // Declares an external assembly function to read a byte from an I/O port.
 // This function will be defined in boot.asm.
 extern uint8_t inb(uint16_t port);
@@ -9,13 +12,23 @@ extern uint8_t inb(uint16_t port);
 // This function will be defined in boot.asm.
 extern void outb(uint16_t port, uint8_t data);
 
+// Function to set up interrupt-driven keyboard input.
+// Installs the IRQ1 handler; must be called after kidt_init().
+void kinput_init(void);
+
+// Function to get the next key press, with its modifiers.
+// It sleeps until the keyboard interrupt queues a key press.
+void kgetkey(struct kkey_event* event);
+
 // Function to get a single character from the keyboard.
-// It polls the keyboard controller until a key press is detected.
+// Like kgetkey, but returns the ASCII character, or 0 for keys without one
+// (arrows, function keys, ...).
 char kgetc();
 
-// Function to read a string from the keyboard.
-// It reads characters until Enter is pressed or max_len is reached.
-// It also handles backspace and echoes characters to the screen.
+// Function to read a line from the keyboard, echoing it.
+// It reads characters until Enter is pressed; Backspace and Ctrl+U edit the
+// line and characters that do not fit in max_len - 1 are dropped. The echo
+// of all the keys already queued is drawn in one screen update.
 void kgets(char* buffer, int max_len);
 
 #endif // KINPUT_H
@@ -0,0 +1,280 @@
+#include <stdint.h>
+#include "kjob.h"   // Our own declarations
+#include "ksmp.h"   // CPU indices, waking the APs
+#include "kcpu.h"   // k_pause, k_rdtsc
+
+#define DEQUE_MASK (KJOB_DEQUE_SIZE - 1)
+
+_Static_assert((KJOB_DEQUE_SIZE & DEQUE_MASK) == 0, "KJOB_DEQUE_SIZE must be a power of two");
+
+// --- Chase-Lev Deque ---
+// 'bottom' is only written by the owner; 'top' only moves forward, by a
+// compare-and-swap from a thief or from the owner taking the last job. Both
+// grow without wrapping (64 bits never run out); the slot is index & mask.
+// 'top' sits on its own cache line because the thieves hammer it.
+// The memory orders follow Le, Pop, Cohen and Zappa Nardelli, "Correct and
+// Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+struct kjob_deque {
+    volatile int64_t top __attribute__((aligned(64)));
+    volatile int64_t bottom __attribute__((aligned(64)));
+    struct kjob* volatile slots[KJOB_DEQUE_SIZE];
+    uint64_t rng;            // Victim selection state (xorshift)
+    struct kjob_stats stats;
+} __attribute__((aligned(64)));
+
+static struct kjob_deque deques[KSMP_MAX_CPUS];
+static volatile int region_active = 0;
+static int region_cpus = 1; // CPUs 0 .. region_cpus-1 take part in the current region
+static int max_cpus = 0;    // kjob_set_max_cpus() limit, 0 for none
+
+// --- Helper Function: deque_push ---
+// Owner only. Publishes the job with the release fence before 'bottom'
+// moves, so a thief that sees the new bottom also sees the slot.
+// Returns:
+//   0 on success, -1 if the deque is full.
+static int deque_push(struct kjob_deque* d, struct kjob* job) {
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    if (b - t >= KJOB_DEQUE_SIZE) {
+        return -1;
+    }
+    __atomic_store_n(&d->slots[b & DEQUE_MASK], job, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// --- Helper Function: deque_take ---
+// Owner only. Claims the bottom slot first, then checks for a thief; only
+// when a single job is left do the owner and the thieves race for it on 'top'.
+// Returns:
+//   The newest job, or 0 if the deque is empty.
+static struct kjob* deque_take(struct kjob_deque* d) {
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&d->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST); // The store to 'bottom' before the load of 'top'
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+    if (t > b) {
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED); // Was empty
+        return 0;
+    }
+    struct kjob* job = __atomic_load_n(&d->slots[b & DEQUE_MASK], __ATOMIC_RELAXED);
+    if (t == b) {
+        // Last job: whoever moves 'top' first gets it.
+        if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            job = 0;
+        }
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return job;
+}
+
+// --- Helper Function: deque_steal ---
+// Any CPU. Reads the oldest slot and claims it by moving 'top'; a failed
+// compare-and-swap means another CPU got it first.
+// Returns:
+//   The oldest job, or 0 if the deque was empty or the race was lost.
+static struct kjob* deque_steal(struct kjob_deque* d) {
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+    if (t >= b) {
+        return 0;
+    }
+    struct kjob* job = __atomic_load_n(&d->slots[t & DEQUE_MASK], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+    return job;
+}
+
+// --- Helper Function: run_job ---
+// The group pointer is read before the job runs: once 'pending' drops, the
+// spawner may return and its stack, which holds the job, is reused.
+static void run_job(struct kjob_deque* self, struct kjob* job) {
+    struct kjob_group* group = job->group;
+    job->fn(job->arg);
+    self->stats.executed++;
+    __atomic_fetch_sub(&group->pending, 1, __ATOMIC_RELEASE);
+}
+
+// --- Helper Function: find_work ---
+// Own deque first (newest job, warm in the cache), then one steal attempt
+// from each other CPU of the region, starting at a random victim so the
+// thieves spread out instead of all hitting CPU 0.
+static struct kjob* find_work(struct kjob_deque* self, int cpu) {
+    struct kjob* job = deque_take(self);
+    if (job) {
+        return job;
+    }
+    int count = region_cpus;
+    if (count < 2) {
+        return 0;
+    }
+    self->rng ^= self->rng << 13;
+    self->rng ^= self->rng >> 7;
+    self->rng ^= self->rng << 17;
+    int victim = (int)(self->rng % (uint64_t)count);
+    for (int i = 0; i < count; i++, victim = (victim + 1 == count) ? 0 : victim + 1) {
+        if (victim == cpu) {
+            continue;
+        }
+        self->stats.steal_attempts++;
+        job = deque_steal(&deques[victim]);
+        if (job) {
+            self->stats.stolen++;
+            return job;
+        }
+    }
+    return 0;
+}
+
+// --- Helper Function: this_deque ---
+static struct kjob_deque* this_deque(int cpu) {
+    struct kjob_deque* d = &deques[cpu];
+    if (d->rng == 0) {
+        d->rng = k_rdtsc() | 1; // xorshift must not start at 0
+    }
+    return d;
+}
+
+// --- Helper Function: worker_loop ---
+// What the APs run (through ksmp_run_on) for the length of a region.
+static void worker_loop(void* unused) {
+    (void)unused;
+    int cpu = (int)ksmp_cpu_index();
+    struct kjob_deque* self = this_deque(cpu);
+    while (__atomic_load_n(&region_active, __ATOMIC_ACQUIRE)) {
+        struct kjob* job = find_work(self, cpu);
+        if (job) {
+            run_job(self, job);
+        } else {
+            k_pause();
+        }
+    }
+}
+
+// --- Public Function: kjob_run ---
+// The APs are only woken for the region and halt again afterwards, so a
+// region costs one IPI round trip per AP; an idle kernel burns no cycles on
+// spinning workers.
+// Preemption stays off for the whole call: a CPU's deque has a single owner,
+// and another thread switched in on the same CPU would push onto it too.
+void kjob_run(kjob_fn fn, void* arg) {
+    ksmp_preempt_disable();
+    if (ksmp_cpu_index() != 0 || __atomic_load_n(&region_active, __ATOMIC_ACQUIRE)) {
+        fn(arg); // Nested call, or not the BSP: the caller is already a participant or runs alone
+        ksmp_preempt_enable();
+        return;
+    }
+    int cpus = ksmp_cpu_count();
+    if (max_cpus > 0 && max_cpus < cpus) {
+        cpus = max_cpus;
+    }
+    if (cpus < 2) {
+        fn(arg);
+        ksmp_preempt_enable();
+        return;
+    }
+
+    region_cpus = cpus;
+    __atomic_store_n(&region_active, 1, __ATOMIC_RELEASE);
+    uint32_t joined = 0;
+    for (int i = 1; i < cpus; i++) {
+        if (ksmp_run_on(i, worker_loop, 0) == 0) { // A busy AP just does not take part
+            joined |= 1u << i;
+        }
+    }
+    this_deque(0);
+    fn(arg);
+    __atomic_store_n(&region_active, 0, __ATOMIC_RELEASE);
+    for (int i = 1; i < cpus; i++) {
+        if (joined & (1u << i)) {
+            ksmp_wait(i);
+        }
+    }
+    region_cpus = 1;
+    ksmp_preempt_enable();
+}
+
+// --- Public Function: kjob_spawn ---
+void kjob_spawn(struct kjob_group* group, struct kjob* job, kjob_fn fn, void* arg) {
+    job->fn = fn;
+    job->arg = arg;
+    job->group = group;
+    __atomic_fetch_add(&group->pending, 1, __ATOMIC_RELAXED);
+    struct kjob_deque* self = this_deque((int)ksmp_cpu_index());
+    if (deque_push(self, job) < 0) {
+        run_job(self, job);
+    }
+}
+
+// --- Public Function: kjob_sync ---
+// Runs jobs while it waits ("help first"). The jobs it runs are either its
+// own, which it would have to run anyway, or stolen ones, which finish
+// without depending on this frame, so the wait always makes progress.
+void kjob_sync(struct kjob_group* group) {
+    int cpu = (int)ksmp_cpu_index();
+    struct kjob_deque* self = this_deque(cpu);
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) > 0) {
+        struct kjob* job = find_work(self, cpu);
+        if (job) {
+            run_job(self, job);
+        } else {
+            k_pause();
+        }
+    }
+}
+
+// One half of a kjob_parallel_for range.
+struct range_job {
+    kjob_range_fn fn;
+    void* arg;
+    uint64_t begin;
+    uint64_t end;
+    uint64_t grain;
+};
+
+// --- Helper Function: range_split ---
+// Splits until a piece fits the grain, spawning the upper halves and
+// carrying on with the lower ones. The recursion depth is log2(range/grain).
+static void range_split(void* data) {
+    struct range_job* range = (struct range_job*)data;
+    if (range->end - range->begin <= range->grain) {
+        range->fn(range->begin, range->end, range->arg);
+        return;
+    }
+    uint64_t mid = range->begin + (range->end - range->begin) / 2;
+    struct range_job upper = *range;
+    struct range_job lower = *range;
+    upper.begin = mid;
+    lower.end = mid;
+
+    struct kjob_group group = KJOB_GROUP_INIT;
+    struct kjob job;
+    kjob_spawn(&group, &job, range_split, &upper);
+    range_split(&lower);
+    kjob_sync(&group);
+}
+
+// --- Public Function: kjob_parallel_for ---
+void kjob_parallel_for(uint64_t begin, uint64_t end, uint64_t grain, kjob_range_fn fn, void* arg) {
+    if (end <= begin) {
+        return;
+    }
+    struct range_job range = { fn, arg, begin, end, grain ? grain : 1 };
+    kjob_run(range_split, &range);
+}
+
+// --- Public Functions: kjob_set_max_cpus / kjob_get_stats ---
+void kjob_set_max_cpus(int n) {
+    max_cpus = n < 0 ? 0 : n;
+}
+
+void kjob_get_stats(int cpu, struct kjob_stats* out) {
+    if (cpu < 0 || cpu >= KSMP_MAX_CPUS) {
+        out->executed = out->stolen = out->steal_attempts = 0;
+        return;
+    }
+    *out = deques[cpu].stats;
+}
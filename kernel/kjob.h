@@ -0,0 +1,82 @@
+#ifndef KJOB_H // Standard header guard to prevent multiple inclusions
+#define KJOB_H
+
+#include <stdint.h> // For uint64_t
+
+// --- Work-Stealing Job Pool ---
+// Splits compute work across all CPUs. Every CPU owns a Chase-Lev deque of
+// jobs: it pushes and pops at the bottom (LIFO, so it keeps working on the
+// freshest, cache-warm data) while idle CPUs steal from the top (FIFO, so a
+// thief takes the oldest and usually largest piece of work). The owner's
+// operations need no locked instruction except when the deque is down to
+// its last job.
+//
+// Parallel work runs inside a region started by kjob_run() on the BSP: the
+// APs are woken (ksmp_run_on) and steal until the region's root function
+// returns. Jobs are fork/join: kjob_spawn() makes a job stealable,
+// kjob_sync() waits for a group of jobs and runs other jobs meanwhile, so a
+// waiting CPU is never idle while there is work.
+//
+// Job structures belong to the caller (normally on its stack) and must stay
+// valid until kjob_sync() on their group returns. kjob_spawn() and
+// kjob_sync() are meant for code running under kjob_run(), which keeps
+// other threads off the CPU's deque.
+
+#define KJOB_DEQUE_SIZE 256 // Jobs per CPU deque; must be a power of two
+
+typedef void (*kjob_fn)(void* arg);
+typedef void (*kjob_range_fn)(uint64_t begin, uint64_t end, void* arg);
+
+// A set of spawned jobs that kjob_sync() waits for.
+struct kjob_group {
+    volatile int pending; // Spawned jobs that have not finished yet
+};
+
+#define KJOB_GROUP_INIT { 0 }
+
+// One unit of work.
+struct kjob {
+    kjob_fn fn;
+    void* arg;
+    struct kjob_group* group;
+};
+
+// Per-CPU counters.
+struct kjob_stats {
+    uint64_t executed;       // Jobs run by this CPU (its own and stolen)
+    uint64_t stolen;         // Jobs taken from another CPU's deque
+    uint64_t steal_attempts; // Steal attempts, successful or not
+};
+
+// --- Function Declarations ---
+
+// kjob_run: Runs fn(arg) on the calling CPU with every other CPU stealing
+// the jobs it spawns, and returns when fn has returned. Only the BSP starts
+// regions; anywhere else (or inside a region) fn simply runs.
+void kjob_run(kjob_fn fn, void* arg);
+
+// kjob_spawn: Makes fn(arg) available to other CPUs. If the deque is full the
+// job runs immediately instead.
+// Parameters:
+//   group: Group that kjob_sync() will wait on.
+//   job: Storage for the job, valid until that kjob_sync() returns.
+void kjob_spawn(struct kjob_group* group, struct kjob* job, kjob_fn fn, void* arg);
+
+// kjob_sync: Waits until every job spawned into 'group' has finished,
+// running queued or stolen jobs meanwhile.
+void kjob_sync(struct kjob_group* group);
+
+// kjob_parallel_for: Calls fn(b, e, arg) for sub-ranges [b, e) covering
+// [begin, end), each at most 'grain' long, spread over all CPUs. The range is
+// halved recursively, so the first steals take the largest pieces. Starts a
+// region with kjob_run() if none is active.
+void kjob_parallel_for(uint64_t begin, uint64_t end, uint64_t grain, kjob_range_fn fn, void* arg);
+
+// kjob_set_max_cpus: Limits regions to CPUs 0 .. n-1 (for scaling
+// measurements); 0 removes the limit.
+void kjob_set_max_cpus(int n);
+
+// kjob_get_stats: Copies the counters of CPU 'cpu'.
+void kjob_get_stats(int cpu, struct kjob_stats* out);
+
+#endif // KJOB_H
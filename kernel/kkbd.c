@@ -0,0 +1,156 @@
+#include <stdint.h>
+#include "kkbd.h" // Our own declarations
+
+// --- Key Kinds ---
+// How an entry of the tables below turns into a key code.
+#define KIND_NONE     0 // Not a key we know: ignored
+#define KIND_CHAR     1 // 'normal', or 'shifted' with Shift held
+#define KIND_LETTER   2 // As KIND_CHAR, but Caps Lock inverts Shift
+#define KIND_KEYPAD   3 // 'shifted' (the digit) when Num Lock xor Shift, else 'normal'
+#define KIND_MODIFIER 4 // Held: 'normal' is its KMOD_* bit
+#define KIND_LOCK     5 // Toggled on press: 'normal' is its KMOD_* bit
+
+struct kkbd_keydef {
+    uint16_t normal;
+    uint16_t shifted;
+    uint8_t kind;
+};
+
+#define CHAR(n, s)         { (n), (s), KIND_CHAR }
+#define LETTER(c)          { (c), (c) - 'a' + 'A', KIND_LETTER }
+#define KEY(k)             { (k), (k), KIND_CHAR }
+#define KEYPAD(nav, digit) { (nav), (digit), KIND_KEYPAD }
+#define MODIFIER(bit)      { (bit), (bit), KIND_MODIFIER }
+#define LOCK(bit)          { (bit), (bit), KIND_LOCK }
+
+// --- Scancode Set 1, US Layout ---
+// Indexed by the scancode without its release bit (0x80). Entries left
+// out are zero, which is KIND_NONE.
+static const struct kkbd_keydef set1_keys[128] = {
+    [0x01] = KEY(KEY_ESCAPE),
+    [0x02] = CHAR('1', '!'),  [0x03] = CHAR('2', '@'),  [0x04] = CHAR('3', '#'),
+    [0x05] = CHAR('4', '$'),  [0x06] = CHAR('5', '%'),  [0x07] = CHAR('6', '^'),
+    [0x08] = CHAR('7', '&'),  [0x09] = CHAR('8', '*'),  [0x0A] = CHAR('9', '('),
+    [0x0B] = CHAR('0', ')'),  [0x0C] = CHAR('-', '_'),  [0x0D] = CHAR('=', '+'),
+    [0x0E] = KEY('\b'),       [0x0F] = KEY('\t'),
+    [0x10] = LETTER('q'), [0x11] = LETTER('w'), [0x12] = LETTER('e'), [0x13] = LETTER('r'),
+    [0x14] = LETTER('t'), [0x15] = LETTER('y'), [0x16] = LETTER('u'), [0x17] = LETTER('i'),
+    [0x18] = LETTER('o'), [0x19] = LETTER('p'),
+    [0x1A] = CHAR('[', '{'),  [0x1B] = CHAR(']', '}'),  [0x1C] = KEY('\n'),
+    [0x1D] = MODIFIER(KMOD_LCTRL),
+    [0x1E] = LETTER('a'), [0x1F] = LETTER('s'), [0x20] = LETTER('d'), [0x21] = LETTER('f'),
+    [0x22] = LETTER('g'), [0x23] = LETTER('h'), [0x24] = LETTER('j'), [0x25] = LETTER('k'),
+    [0x26] = LETTER('l'),
+    [0x27] = CHAR(';', ':'),  [0x28] = CHAR('\'', '"'), [0x29] = CHAR('`', '~'),
+    [0x2A] = MODIFIER(KMOD_LSHIFT),
+    [0x2B] = CHAR('\\', '|'),
+    [0x2C] = LETTER('z'), [0x2D] = LETTER('x'), [0x2E] = LETTER('c'), [0x2F] = LETTER('v'),
+    [0x30] = LETTER('b'), [0x31] = LETTER('n'), [0x32] = LETTER('m'),
+    [0x33] = CHAR(',', '<'),  [0x34] = CHAR('.', '>'),  [0x35] = CHAR('/', '?'),
+    [0x36] = MODIFIER(KMOD_RSHIFT),
+    [0x37] = KEY('*'),        // Keypad *
+    [0x38] = MODIFIER(KMOD_LALT),
+    [0x39] = KEY(' '),
+    [0x3A] = LOCK(KMOD_CAPS_LOCK),
+    [0x3B] = KEY(KEY_F1),     [0x3C] = KEY(KEY_F1 + 1), [0x3D] = KEY(KEY_F1 + 2),
+    [0x3E] = KEY(KEY_F1 + 3), [0x3F] = KEY(KEY_F1 + 4), [0x40] = KEY(KEY_F1 + 5),
+    [0x41] = KEY(KEY_F1 + 6), [0x42] = KEY(KEY_F1 + 7), [0x43] = KEY(KEY_F1 + 8),
+    [0x44] = KEY(KEY_F1 + 9),
+    [0x45] = LOCK(KMOD_NUM_LOCK),
+    [0x46] = LOCK(KMOD_SCROLL_LOCK),
+    [0x47] = KEYPAD(KEY_HOME, '7'),    [0x48] = KEYPAD(KEY_UP, '8'),
+    [0x49] = KEYPAD(KEY_PAGE_UP, '9'), [0x4A] = KEY('-'),
+    [0x4B] = KEYPAD(KEY_LEFT, '4'),    [0x4C] = KEYPAD(0, '5'),
+    [0x4D] = KEYPAD(KEY_RIGHT, '6'),   [0x4E] = KEY('+'),
+    [0x4F] = KEYPAD(KEY_END, '1'),     [0x50] = KEYPAD(KEY_DOWN, '2'),
+    [0x51] = KEYPAD(KEY_PAGE_DOWN, '3'),
+    [0x52] = KEYPAD(KEY_INSERT, '0'),  [0x53] = KEYPAD(KEY_DELETE, '.'),
+    [0x57] = KEY(KEY_F1 + 10), [0x58] = KEY(KEY_F12),
+};
+
+// Scancodes after 0xE0: the gray keys, right Ctrl/Alt and the keypad's
+// Enter and '/'. 0xE0 0x2A / 0xE0 0x36 (the "fake shifts" around Print
+// Screen and the gray keys) are left out, so they are ignored.
+static const struct kkbd_keydef set1_e0_keys[128] = {
+    [0x1C] = KEY('\n'),       // Keypad Enter
+    [0x1D] = MODIFIER(KMOD_RCTRL),
+    [0x35] = KEY('/'),        // Keypad /
+    [0x37] = KEY(KEY_PRINT_SCREEN),
+    [0x38] = MODIFIER(KMOD_RALT),
+    [0x46] = KEY(KEY_PAUSE),  // Ctrl+Pause (Break)
+    [0x47] = KEY(KEY_HOME),   [0x48] = KEY(KEY_UP),    [0x49] = KEY(KEY_PAGE_UP),
+    [0x4B] = KEY(KEY_LEFT),   [0x4D] = KEY(KEY_RIGHT),
+    [0x4F] = KEY(KEY_END),    [0x50] = KEY(KEY_DOWN),  [0x51] = KEY(KEY_PAGE_DOWN),
+    [0x52] = KEY(KEY_INSERT), [0x53] = KEY(KEY_DELETE),
+};
+
+// Pause sends 0xE1 0x1D 0x45 0xE1 0x9D 0xC5 on press and nothing on release.
+#define PAUSE_SEQUENCE_TAIL 5
+
+// --- Public Function: kkbd_decode ---
+int kkbd_decode(struct kkbd_decoder* decoder, uint8_t scan_code, struct kkey_event* out) {
+    if (decoder->skip) {
+        if (--decoder->skip) {
+            return 0;
+        }
+        out->key = KEY_PAUSE;
+        out->modifiers = decoder->modifiers;
+        return 1;
+    }
+    if (scan_code == 0xE0) {
+        decoder->extended = 1;
+        return 0;
+    }
+    if (scan_code == 0xE1) {
+        decoder->skip = PAUSE_SEQUENCE_TAIL;
+        return 0;
+    }
+
+    int released = scan_code & 0x80;
+    const struct kkbd_keydef* def = decoder->extended ? &set1_e0_keys[scan_code & 0x7F]
+                                                      : &set1_keys[scan_code & 0x7F];
+    decoder->extended = 0;
+
+    uint16_t mods = decoder->modifiers;
+    int shift = (mods & KMOD_SHIFT) != 0;
+    uint16_t key;
+    switch (def->kind) {
+    case KIND_MODIFIER:
+        if (released) {
+            decoder->modifiers &= (uint16_t)~def->normal;
+        } else {
+            decoder->modifiers |= def->normal;
+        }
+        return 0;
+    case KIND_LOCK:
+        if (released) {
+            decoder->locks_down &= (uint16_t)~def->normal;
+        } else if (!(decoder->locks_down & def->normal)) {
+            decoder->locks_down |= def->normal;
+            decoder->modifiers ^= def->normal;
+        }
+        return 0;
+    case KIND_CHAR:
+        key = shift ? def->shifted : def->normal;
+        break;
+    case KIND_LETTER:
+        key = (shift ^ ((mods & KMOD_CAPS_LOCK) != 0)) ? def->shifted : def->normal;
+        break;
+    case KIND_KEYPAD:
+        key = (shift ^ ((mods & KMOD_NUM_LOCK) != 0)) ? def->shifted : def->normal;
+        break;
+    default:
+        return 0;
+    }
+    if (released || key == 0) {
+        return 0;
+    }
+
+    // Ctrl turns a letter into its control code, as terminals do.
+    if ((mods & KMOD_CTRL) && def->kind == KIND_LETTER) {
+        key &= 0x1F;
+    }
+    out->key = key;
+    out->modifiers = mods;
+    return 1;
+}
@@ -0,0 +1,78 @@
+#ifndef KKBD_H // Standard header guard to prevent multiple inclusions
+#define KKBD_H
+
+#include <stdint.h> // For uint8_t, uint16_t
+
+// --- PS/2 Scancode Decoder ---
+// Turns the bytes a PS/2 keyboard sends (scancode set 1, US layout) into key
+// events. It is a small state machine driven by two constant tables in
+// kkbd.c, one for plain scancodes and one for those after an 0xE0 prefix;
+// each entry says what kind of key it is (character, letter, keypad,
+// modifier, lock) and what it produces. The decoder tracks Shift, Ctrl and
+// Alt on both sides and the Caps/Num/Scroll Lock toggles, skips the 0xE1
+// Pause sequence and drops releases, so one event is one key press
+// (including typematic repeats). It touches no hardware; kinput.c feeds it
+// from the IRQ1 handler.
+
+// Key codes. Printable keys, Enter ('\n'), Tab, Backspace ('\b') and Escape
+// (27) are ASCII; Ctrl with a letter gives its control code (Ctrl+A = 1).
+// Everything else is above the ASCII range.
+#define KEY_ESCAPE       27
+#define KEY_UP           0x100
+#define KEY_DOWN         0x101
+#define KEY_LEFT         0x102
+#define KEY_RIGHT        0x103
+#define KEY_HOME         0x104
+#define KEY_END          0x105
+#define KEY_PAGE_UP      0x106
+#define KEY_PAGE_DOWN    0x107
+#define KEY_INSERT       0x108
+#define KEY_DELETE       0x109
+#define KEY_PRINT_SCREEN 0x10A
+#define KEY_PAUSE        0x10B
+#define KEY_F1           0x111 // KEY_F1 + n - 1 is Fn, up to KEY_F12
+#define KEY_F12          0x11C
+
+// Modifier bits of an event: keys held (left and right apart) and lock
+// states, as they were when the key was pressed.
+#define KMOD_LSHIFT      0x001
+#define KMOD_RSHIFT      0x002
+#define KMOD_LCTRL       0x004
+#define KMOD_RCTRL       0x008
+#define KMOD_LALT        0x010
+#define KMOD_RALT        0x020
+#define KMOD_CAPS_LOCK   0x040
+#define KMOD_NUM_LOCK    0x080
+#define KMOD_SCROLL_LOCK 0x100
+#define KMOD_SHIFT (KMOD_LSHIFT | KMOD_RSHIFT)
+#define KMOD_CTRL  (KMOD_LCTRL | KMOD_RCTRL)
+#define KMOD_ALT   (KMOD_LALT | KMOD_RALT)
+
+// One key press.
+struct kkey_event {
+    uint16_t key;       // ASCII or KEY_*
+    uint16_t modifiers; // KMOD_* bits
+};
+
+// Decoder state; start from KKBD_DECODER_INIT.
+struct kkbd_decoder {
+    uint16_t modifiers;  // KMOD_* bits now
+    uint16_t locks_down; // Lock keys held (a held key repeats, but toggles once)
+    uint8_t extended;    // The previous byte was 0xE0
+    uint8_t skip;        // Bytes of the Pause sequence still to come
+};
+#define KKBD_DECODER_INIT { 0, 0, 0, 0 }
+
+// --- Function Declarations ---
+
+// kkbd_decode: Feeds one byte from the keyboard to the decoder.
+// Parameters:
+//   decoder: The keyboard's state.
+//   scan_code: The byte read from port 0x60.
+//   out: Receives the event, if any.
+// Returns:
+//   1 if the byte completed a key press (stored in *out), 0 otherwise
+//   (prefixes, releases, modifiers and lock keys, unknown codes).
+int kkbd_decode(struct kkbd_decoder* decoder, uint8_t scan_code, struct kkey_event* out);
+
+#endif // KKBD_H
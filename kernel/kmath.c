@@ -1,5 +1,46 @@
 #include "kmath.h"  // Include the header for our math functions' declarations
 #include "kprint.h" // For kprint to display error messages (e.g., division by zero)
+#include "kjob.h"   // For splitting large arrays across CPUs
+#include "ksmp.h"   // For the per-CPU partial results
+
+// Arrays shorter than this are summed or multiplied on the calling CPU alone:
+// waking the other CPUs costs a few microseconds, more than the loop itself.
+#define KMATH_PARALLEL_MIN 65536
+#define KMATH_GRAIN        16384 // Elements per parallel piece
+
+// --- Parallel Reduction State ---
+// Each CPU folds the pieces it runs into its own slot, one cache line apart
+// so the CPUs never write the same line. The slots are combined at the end;
+// because wrapping addition and multiplication are associative and
+// commutative, the result does not depend on which CPU ran which piece and
+// matches the sequential loop bit for bit. The arithmetic is unsigned so the
+// wrap-around is well defined.
+struct kmath_reduce {
+    const int* numbers;
+    struct {
+        uint32_t value;
+    } __attribute__((aligned(64))) partial[KSMP_MAX_CPUS];
+};
+
+// --- Helper Function: add_range ---
+static void add_range(uint64_t begin, uint64_t end, void* arg) {
+    struct kmath_reduce* reduce = (struct kmath_reduce*)arg;
+    uint32_t sum = 0;
+    for (uint64_t i = begin; i < end; i++) {
+        sum += (uint32_t)reduce->numbers[i];
+    }
+    reduce->partial[ksmp_cpu_index()].value += sum;
+}
+
+// --- Helper Function: multiply_range ---
+static void multiply_range(uint64_t begin, uint64_t end, void* arg) {
+    struct kmath_reduce* reduce = (struct kmath_reduce*)arg;
+    uint32_t product = 1;
+    for (uint64_t i = begin; i < end; i++) {
+        product *= (uint32_t)reduce->numbers[i];
+    }
+    reduce->partial[ksmp_cpu_index()].value *= product;
+}
 
 // --- Function: k_add_n ---
 // Performs integer addition for an array of numbers.
@@ -9,12 +50,26 @@
 // Returns:
 //   The sum of all integers in the 'numbers' array.
 //   Returns 0 if count is 0 (additive identity).
+//   Large arrays (KMATH_PARALLEL_MIN elements and up) are split across CPUs.
 int k_add_n(const int* numbers, int count) {
     int sum = 0; // Initialize sum to 0 (additive identity)
     // If no numbers are provided, return 0.
     if (count <= 0 || numbers == 0) {
         return 0;
     }
+    if (count >= KMATH_PARALLEL_MIN) {
+        struct kmath_reduce reduce;
+        reduce.numbers = numbers;
+        for (int cpu = 0; cpu < KSMP_MAX_CPUS; cpu++) {
+            reduce.partial[cpu].value = 0;
+        }
+        kjob_parallel_for(0, (uint64_t)count, KMATH_GRAIN, add_range, &reduce);
+        uint32_t total = 0;
+        for (int cpu = 0; cpu < KSMP_MAX_CPUS; cpu++) {
+            total += reduce.partial[cpu].value;
+        }
+        return (int)total;
+    }
     // Loop through the array and add each number to the sum.
     for (int i = 0; i < count; i++) {
         sum += numbers[i];
@@ -41,12 +96,26 @@ int k_subtract(int a, int b) {
 // Returns:
 //   The product of all integers in the 'numbers' array.
 //   Returns 1 if count is 0 (multiplicative identity).
+//   Large arrays (KMATH_PARALLEL_MIN elements and up) are split across CPUs.
 int k_multiply_n(const int* numbers, int count) {
     int product = 1; // Initialize product to 1 (multiplicative identity)
     // If no numbers are provided, return 1.
     if (count <= 0 || numbers == 0) {
         return 1;
     }
+    if (count >= KMATH_PARALLEL_MIN) {
+        struct kmath_reduce reduce;
+        reduce.numbers = numbers;
+        for (int cpu = 0; cpu < KSMP_MAX_CPUS; cpu++) {
+            reduce.partial[cpu].value = 1;
+        }
+        kjob_parallel_for(0, (uint64_t)count, KMATH_GRAIN, multiply_range, &reduce);
+        uint32_t total = 1;
+        for (int cpu = 0; cpu < KSMP_MAX_CPUS; cpu++) {
+            total *= reduce.partial[cpu].value;
+        }
+        return (int)total;
+    }
     // Loop through the array and multiply each number into the product.
     for (int i = 0; i < count; i++) {
         product *= numbers[i];
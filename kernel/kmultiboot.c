@@ -0,0 +1,48 @@
+#include <stdint.h>
+#include "kmultiboot.h" // Our own declarations
+
+// Address of the boot information structure (identity mapped), or 0.
+static const struct multiboot_info_header* boot_info = 0;
+
+// --- Public Function: kmultiboot_init ---
+int kmultiboot_init(uint32_t magic, uint64_t info_addr) {
+    if (magic != MULTIBOOT2_BOOTLOADER_MAGIC || info_addr == 0) {
+        boot_info = 0;
+        return 0;
+    }
+    boot_info = (const struct multiboot_info_header*)info_addr;
+    return 1;
+}
+
+// --- Public Function: kmultiboot_find_tag ---
+// Walks the tag list: the first tag follows the 8-byte header and each tag's
+// size is rounded up to a multiple of 8 to reach the next one.
+const struct multiboot_tag* kmultiboot_find_tag(uint32_t type) {
+    if (!boot_info) {
+        return 0;
+    }
+    const uint8_t* cursor = (const uint8_t*)boot_info + sizeof(struct multiboot_info_header);
+    const uint8_t* end = (const uint8_t*)boot_info + boot_info->total_size;
+    while (cursor + sizeof(struct multiboot_tag) <= end) {
+        const struct multiboot_tag* tag = (const struct multiboot_tag*)cursor;
+        if (tag->type == MULTIBOOT_TAG_TYPE_END) {
+            break;
+        }
+        if (tag->type == type) {
+            return tag;
+        }
+        cursor += (tag->size + 7) & ~7u;
+    }
+    return 0;
+}
+
+// --- Public Function: kmultiboot_info_range ---
+void kmultiboot_info_range(uint64_t* start, uint64_t* end) {
+    if (!boot_info) {
+        *start = 0;
+        *end = 0;
+        return;
+    }
+    *start = (uint64_t)boot_info;
+    *end = (uint64_t)boot_info + boot_info->total_size;
+}
@@ -0,0 +1,118 @@
+#ifndef KMULTIBOOT_H // Standard header guard to prevent multiple inclusions
+#define KMULTIBOOT_H
+
+#include <stdint.h> // For uint32_t, uint64_t
+
+// --- Multiboot2 Boot Information ---
+// GRUB hands the kernel a list of tags describing the machine (memory map,
+// command line, framebuffer, ...). boot.asm passes its address to kernel_main.
+
+#define MULTIBOOT2_BOOTLOADER_MAGIC 0x36d76289 // Value of EAX at _start
+
+// Tag types used by the kernel.
+#define MULTIBOOT_TAG_TYPE_END  0
+#define MULTIBOOT_TAG_TYPE_CMDLINE 1 // Arguments after the kernel on GRUB's multiboot2 line
+#define MULTIBOOT_TAG_TYPE_MMAP 6
+#define MULTIBOOT_TAG_TYPE_FRAMEBUFFER 8
+#define MULTIBOOT_TAG_TYPE_ACPI_OLD 14 // Copy of the ACPI 1.0 RSDP
+#define MULTIBOOT_TAG_TYPE_ACPI_NEW 15 // Copy of the ACPI 2.0+ RSDP
+
+// Memory map entry types.
+#define MULTIBOOT_MEMORY_AVAILABLE        1 // Usable RAM
+#define MULTIBOOT_MEMORY_RESERVED         2
+#define MULTIBOOT_MEMORY_ACPI_RECLAIMABLE 3
+#define MULTIBOOT_MEMORY_NVS              4
+#define MULTIBOOT_MEMORY_BADRAM           5
+
+// Framebuffer types.
+#define MULTIBOOT_FRAMEBUFFER_TYPE_INDEXED  0 // Palette colors
+#define MULTIBOOT_FRAMEBUFFER_TYPE_RGB      1 // Direct color, fields described in the tag
+#define MULTIBOOT_FRAMEBUFFER_TYPE_EGA_TEXT 2 // VGA text mode (no graphics mode was set)
+
+// Header of the whole boot information structure.
+struct multiboot_info_header {
+    uint32_t total_size; // Size in bytes, including this header
+    uint32_t reserved;
+};
+
+// Common header of every tag. Tags start on 8-byte boundaries.
+struct multiboot_tag {
+    uint32_t type;
+    uint32_t size; // Size of the tag in bytes, not including the padding to 8
+};
+
+// One entry of the memory map.
+struct multiboot_mmap_entry {
+    uint64_t base_addr;
+    uint64_t length;
+    uint32_t type;
+    uint32_t reserved;
+};
+
+// Memory map tag (type 6).
+struct multiboot_tag_mmap {
+    uint32_t type;
+    uint32_t size;
+    uint32_t entry_size;    // Size of one entry; may be larger than the struct above
+    uint32_t entry_version;
+    // Followed by the entries.
+};
+
+// Command line tag (type 1): a null-terminated string follows the header.
+struct multiboot_tag_string {
+    uint32_t type;
+    uint32_t size;
+    char string[];
+};
+
+// Framebuffer tag (type 8). The color fields are only meaningful for
+// MULTIBOOT_FRAMEBUFFER_TYPE_RGB.
+struct multiboot_tag_framebuffer {
+    uint32_t type;
+    uint32_t size;
+    uint64_t framebuffer_addr;   // Physical address of the top-left pixel
+    uint32_t framebuffer_pitch;  // Bytes per line
+    uint32_t framebuffer_width;  // Pixels (or characters in text mode)
+    uint32_t framebuffer_height;
+    uint8_t framebuffer_bpp;     // Bits per pixel
+    uint8_t framebuffer_type;
+    uint16_t reserved;
+    uint8_t red_field_position;  // Bit position and width of each color component
+    uint8_t red_mask_size;
+    uint8_t green_field_position;
+    uint8_t green_mask_size;
+    uint8_t blue_field_position;
+    uint8_t blue_mask_size;
+};
+
+// ACPI tags (types 14 and 15): the RSDP structure follows the header.
+struct multiboot_tag_acpi {
+    uint32_t type;
+    uint32_t size;
+    uint8_t rsdp[];
+};
+
+// --- Function Declarations ---
+
+// kmultiboot_init: Records the boot information handed over by the bootloader.
+// Parameters:
+//   magic: The value GRUB left in EAX.
+//   info_addr: The physical address GRUB left in EBX.
+// Returns:
+//   1 if the magic value identifies a Multiboot2 loader, 0 otherwise
+//   (in which case no tags are reported).
+int kmultiboot_init(uint32_t magic, uint64_t info_addr);
+
+// kmultiboot_find_tag: Finds the first tag of the given type.
+// Returns:
+//   A pointer to the tag, or 0 if there is no such tag.
+const struct multiboot_tag* kmultiboot_find_tag(uint32_t type);
+
+// kmultiboot_info_range: Reports where the boot information structure lives,
+// so it can be protected from the page allocator.
+// Parameters:
+//   start, end: Receive the physical address range [start, end). Both are 0
+//               if no boot information is available.
+void kmultiboot_info_range(uint64_t* start, uint64_t* end);
+
+#endif // KMULTIBOOT_H
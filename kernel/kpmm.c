@@ -0,0 +1,411 @@
+#include <stdint.h>
+#include "kpmm.h"       // Our own declarations
+#include "kmultiboot.h" // Memory map and boot information location
+#include "kutils.h"     // k_memset
+#include "kspinlock.h"  // Allocations from several CPUs
+
+// Physical extent of the kernel image (defined in linker.ld).
+extern char _kernel_start[];
+extern char _kernel_end[];
+
+// End of the identity map boot.asm built: 512GB with 1GB pages, 32GB in 2MB
+// pages without.
+extern uint64_t boot_direct_map_end;
+
+#define PAGE_SHIFT 12
+#define LOW_MEMORY_END 0x100000ULL // Real-mode IVT, BIOS data, VGA and ROMs
+#define GB_SIZE 0x40000000ULL
+
+// --- Buddy Allocator State ---
+// A free block stores its list links in its own first bytes.
+struct free_block {
+    struct free_block* next;
+    struct free_block* prev;
+};
+
+static struct free_block* free_lists[KPMM_MAX_ORDER + 1];
+static uint64_t free_counts[KPMM_MAX_ORDER + 1];
+// buddy_bitmaps[k] has bit (pfn >> k) set when a free block of order k starts
+// at frame pfn. Merging checks the buddy's bit instead of walking the list.
+static uint64_t* buddy_bitmaps[KPMM_MAX_ORDER + 1];
+static uint64_t buddy_frames = 0; // Frames 0 .. buddy_frames-1 belong to the buddy allocator
+
+// --- Bitmap Allocator State (memory above the direct map) ---
+static uint64_t* high_bitmap = 0;  // Bit i set: frame high_base_pfn + i is free
+static uint64_t high_base_pfn = 0;
+static uint64_t high_frames = 0;
+static uint64_t high_free = 0;
+static uint64_t high_hint = 0;     // Word index where the next search starts (next-fit)
+
+// Guards the free lists and both bitmaps. Taken with interrupts disabled:
+// the page fault handler allocates frames too.
+static struct kspinlock pmm_lock = KSPINLOCK_INIT;
+
+static uint64_t total_frames = 0;
+static uint64_t max_phys = 0;
+static uint64_t direct_map_end = KPMM_DIRECT_MAP_MIN;
+
+// --- Reserved Ranges ---
+// Physical ranges that must never be handed out even if the memory map says
+// they are available.
+#define MAX_RESERVED 8
+static struct { uint64_t start, end; } reserved[MAX_RESERVED];
+static int num_reserved = 0;
+
+static void reserve_range(uint64_t start, uint64_t end) {
+    if (num_reserved < MAX_RESERVED && end > start) {
+        reserved[num_reserved].start = start;
+        reserved[num_reserved].end = end;
+        num_reserved++;
+    }
+}
+
+// --- Bit Helpers ---
+static inline int bit_test(const uint64_t* map, uint64_t bit) {
+    return (map[bit >> 6] >> (bit & 63)) & 1;
+}
+static inline void bit_set(uint64_t* map, uint64_t bit) {
+    map[bit >> 6] |= 1ULL << (bit & 63);
+}
+static inline void bit_clear(uint64_t* map, uint64_t bit) {
+    map[bit >> 6] &= ~(1ULL << (bit & 63));
+}
+static inline uint64_t bitmap_words(uint64_t bits) {
+    return (bits + 63) / 64;
+}
+
+// --- Buddy Helpers ---
+
+// Puts a free block of the given order on its list.
+static void buddy_push(uint64_t pfn, int order) {
+    struct free_block* block = (struct free_block*)(pfn << PAGE_SHIFT);
+    block->prev = 0;
+    block->next = free_lists[order];
+    if (block->next) {
+        block->next->prev = block;
+    }
+    free_lists[order] = block;
+    bit_set(buddy_bitmaps[order], pfn >> order);
+    free_counts[order]++;
+}
+
+// Takes a specific free block off its list (O(1) thanks to the prev link).
+static void buddy_remove(uint64_t pfn, int order) {
+    struct free_block* block = (struct free_block*)(pfn << PAGE_SHIFT);
+    if (block->prev) {
+        block->prev->next = block->next;
+    } else {
+        free_lists[order] = block->next;
+    }
+    if (block->next) {
+        block->next->prev = block->prev;
+    }
+    bit_clear(buddy_bitmaps[order], pfn >> order);
+    free_counts[order]--;
+}
+
+// Frees a block, merging it with its buddy for as long as the buddy is free.
+static void buddy_free(uint64_t pfn, int order) {
+    while (order < KPMM_MAX_ORDER) {
+        uint64_t buddy = pfn ^ (1ULL << order);
+        if (buddy + (1ULL << order) > buddy_frames ||
+            !bit_test(buddy_bitmaps[order], buddy >> order)) {
+            break;
+        }
+        buddy_remove(buddy, order);
+        pfn &= ~(1ULL << order); // The merged block starts at the lower buddy
+        order++;
+    }
+    buddy_push(pfn, order);
+}
+
+// Allocates a block, splitting a larger one when the exact order is empty.
+static uint64_t buddy_alloc(int order) {
+    int k = order;
+    while (k <= KPMM_MAX_ORDER && !free_lists[k]) {
+        k++;
+    }
+    if (k > KPMM_MAX_ORDER) {
+        return 0;
+    }
+    uint64_t pfn = (uint64_t)free_lists[k] >> PAGE_SHIFT;
+    buddy_remove(pfn, k);
+    // Give back the upper half at each level until the block is the right size.
+    while (k > order) {
+        k--;
+        buddy_push(pfn + (1ULL << k), k);
+    }
+    return pfn << PAGE_SHIFT;
+}
+
+// --- Bitmap Helpers ---
+
+// Finds 2^order free, aligned frames in the high bitmap. The search resumes
+// where the last one stopped, so repeated allocations are O(1) amortized.
+static uint64_t bitmap_alloc(int order) {
+    uint64_t words = bitmap_words(high_frames);
+    uint64_t count = 1ULL << order;
+    if (words == 0 || high_free < count) {
+        return 0;
+    }
+
+    if (order >= 6) {
+        // Whole words: look for 2^(order-6) consecutive all-ones words.
+        uint64_t group = count / 64;
+        uint64_t start = high_hint & ~(group - 1);
+        for (uint64_t scanned = 0; scanned < words; scanned += group) {
+            uint64_t w = (start + scanned) % words;
+            w &= ~(group - 1);
+            if (w + group > words) {
+                continue;
+            }
+            uint64_t i = 0;
+            while (i < group && high_bitmap[w + i] == ~0ULL) {
+                i++;
+            }
+            if (i == group) {
+                for (i = 0; i < group; i++) {
+                    high_bitmap[w + i] = 0;
+                }
+                high_free -= count;
+                high_hint = w + group;
+                return (high_base_pfn + w * 64) << PAGE_SHIFT;
+            }
+        }
+        return 0;
+    }
+
+    // Within a word: look for an aligned run of 'count' set bits.
+    uint64_t mask = (count == 64) ? ~0ULL : ((1ULL << count) - 1);
+    for (uint64_t scanned = 0; scanned < words; scanned++) {
+        uint64_t w = (high_hint + scanned) % words;
+        uint64_t bits = high_bitmap[w];
+        if (!bits) {
+            continue;
+        }
+        for (uint64_t shift = 0; shift < 64; shift += count) {
+            if (((bits >> shift) & mask) == mask) {
+                high_bitmap[w] &= ~(mask << shift);
+                high_free -= count;
+                high_hint = w;
+                return (high_base_pfn + w * 64 + shift) << PAGE_SHIFT;
+            }
+        }
+    }
+    return 0;
+}
+
+static void bitmap_free(uint64_t pfn, int order) {
+    for (uint64_t i = 0; i < (1ULL << order); i++) {
+        bit_set(high_bitmap, pfn - high_base_pfn + i);
+    }
+    high_free += 1ULL << order;
+}
+
+// --- Helper Function: add_free_frames ---
+// Hands the whole frames in [start, end) to the buddy allocator or the bitmap.
+static void add_free_frames(uint64_t start, uint64_t end) {
+    uint64_t pfn = (start + KPMM_PAGE_SIZE - 1) >> PAGE_SHIFT;
+    uint64_t end_pfn = end >> PAGE_SHIFT;
+
+    // Buddy part: free the largest naturally aligned blocks that fit.
+    while (pfn < end_pfn && pfn < buddy_frames) {
+        uint64_t limit = end_pfn < buddy_frames ? end_pfn : buddy_frames;
+        int order = pfn ? __builtin_ctzll(pfn) : KPMM_MAX_ORDER;
+        if (order > KPMM_MAX_ORDER) {
+            order = KPMM_MAX_ORDER;
+        }
+        while (pfn + (1ULL << order) > limit) {
+            order--;
+        }
+        buddy_free(pfn, order);
+        total_frames += 1ULL << order;
+        pfn += 1ULL << order;
+    }
+
+    // Bitmap part.
+    for (; pfn < end_pfn; pfn++) {
+        if (pfn >= high_base_pfn && pfn < high_base_pfn + high_frames) {
+            bit_set(high_bitmap, pfn - high_base_pfn);
+            high_free++;
+            total_frames++;
+        }
+    }
+}
+
+// --- Helper Function: add_usable_range ---
+// Adds [start, end) minus every reserved range (from index 'first' on).
+static void add_usable_range(uint64_t start, uint64_t end, int first) {
+    for (int i = first; i < num_reserved; i++) {
+        if (reserved[i].end <= start || reserved[i].start >= end) {
+            continue; // No overlap with this reserved range
+        }
+        if (reserved[i].start > start) {
+            add_usable_range(start, reserved[i].start, i + 1);
+        }
+        if (reserved[i].end < end) {
+            add_usable_range(reserved[i].end, end, i + 1);
+        }
+        return;
+    }
+    add_free_frames(start, end);
+}
+
+// --- Helper Function: place_metadata ---
+// Finds 'size' bytes of usable, identity-mapped RAM that overlap no reserved
+// range, for the allocator's own bitmaps.
+// Returns:
+//   The physical address, or 0 if nothing fits.
+static uint64_t place_metadata(const struct multiboot_tag_mmap* mmap, uint64_t size) {
+    const uint8_t* entry = (const uint8_t*)mmap + sizeof(*mmap);
+    const uint8_t* end = (const uint8_t*)mmap + mmap->size;
+    for (; entry < end; entry += mmap->entry_size) {
+        const struct multiboot_mmap_entry* e = (const struct multiboot_mmap_entry*)entry;
+        if (e->type != MULTIBOOT_MEMORY_AVAILABLE) {
+            continue;
+        }
+        uint64_t region_end = e->base_addr + e->length;
+        if (region_end > direct_map_end) {
+            region_end = direct_map_end;
+        }
+        uint64_t candidate = (e->base_addr + KPMM_PAGE_SIZE - 1) & ~(uint64_t)(KPMM_PAGE_SIZE - 1);
+        // Slide the candidate past any reserved range it overlaps, until it settles.
+        int moved = 1;
+        while (moved) {
+            moved = 0;
+            for (int i = 0; i < num_reserved; i++) {
+                if (candidate < reserved[i].end && candidate + size > reserved[i].start) {
+                    candidate = (reserved[i].end + KPMM_PAGE_SIZE - 1) & ~(uint64_t)(KPMM_PAGE_SIZE - 1);
+                    moved = 1;
+                }
+            }
+        }
+        if (candidate + size <= region_end) {
+            return candidate;
+        }
+    }
+    return 0;
+}
+
+// --- Public Function: kpmm_init ---
+void kpmm_init(void) {
+    const struct multiboot_tag_mmap* mmap =
+        (const struct multiboot_tag_mmap*)kmultiboot_find_tag(MULTIBOOT_TAG_TYPE_MMAP);
+    if (!mmap) {
+        return; // No memory map: the allocator stays empty
+    }
+
+    // 1. Find the end of usable RAM to size the bitmaps.
+    const uint8_t* entry;
+    const uint8_t* end = (const uint8_t*)mmap + mmap->size;
+    for (entry = (const uint8_t*)mmap + sizeof(*mmap); entry < end; entry += mmap->entry_size) {
+        const struct multiboot_mmap_entry* e = (const struct multiboot_mmap_entry*)entry;
+        if (e->type == MULTIBOOT_MEMORY_AVAILABLE && e->base_addr + e->length > max_phys) {
+            max_phys = e->base_addr + e->length;
+        }
+    }
+    // With 1GB pages the boot map reaches 512GB; only the gigabytes that
+    // hold RAM count (kvmm_init() removes the others).
+    uint64_t ram_end = (max_phys + GB_SIZE - 1) & ~(GB_SIZE - 1);
+    direct_map_end = ram_end < boot_direct_map_end ? ram_end : boot_direct_map_end;
+    if (direct_map_end < KPMM_DIRECT_MAP_MIN) {
+        direct_map_end = KPMM_DIRECT_MAP_MIN;
+    }
+    uint64_t direct_end = max_phys < direct_map_end ? max_phys : direct_map_end;
+    buddy_frames = direct_end >> PAGE_SHIFT;
+    high_base_pfn = direct_map_end >> PAGE_SHIFT;
+    high_frames = max_phys > direct_map_end ? (max_phys - direct_map_end) >> PAGE_SHIFT : 0;
+
+    // 2. Protect low memory, the kernel and the boot information.
+    uint64_t info_start, info_end;
+    kmultiboot_info_range(&info_start, &info_end);
+    reserve_range(0, LOW_MEMORY_END);
+    reserve_range((uint64_t)_kernel_start, (uint64_t)_kernel_end);
+    reserve_range(info_start, info_end);
+
+    // 3. Carve out space for the bitmaps themselves.
+    uint64_t metadata_size = bitmap_words(high_frames) * 8;
+    for (int k = 0; k <= KPMM_MAX_ORDER; k++) {
+        metadata_size += bitmap_words((buddy_frames >> k) + 1) * 8;
+    }
+    uint64_t metadata = place_metadata(mmap, metadata_size);
+    if (!metadata) {
+        return;
+    }
+    k_memset((void*)metadata, 0, metadata_size);
+    reserve_range(metadata, metadata + metadata_size);
+
+    uint64_t* cursor = (uint64_t*)metadata;
+    for (int k = 0; k <= KPMM_MAX_ORDER; k++) {
+        buddy_bitmaps[k] = cursor;
+        cursor += bitmap_words((buddy_frames >> k) + 1);
+    }
+    high_bitmap = cursor;
+
+    // 4. Hand every available range to the allocators.
+    for (entry = (const uint8_t*)mmap + sizeof(*mmap); entry < end; entry += mmap->entry_size) {
+        const struct multiboot_mmap_entry* e = (const struct multiboot_mmap_entry*)entry;
+        if (e->type == MULTIBOOT_MEMORY_AVAILABLE) {
+            add_usable_range(e->base_addr, e->base_addr + e->length, 0);
+        }
+    }
+}
+
+// --- Public Function: kpmm_alloc ---
+uint64_t kpmm_alloc(int order, int flags) {
+    if (order < 0 || order > KPMM_MAX_ORDER) {
+        return 0;
+    }
+    int interrupts_were_on = kspin_lock_irqsave(&pmm_lock);
+    uint64_t addr = buddy_alloc(order);
+    if (!addr && !(flags & KPMM_DIRECT_ONLY)) {
+        addr = bitmap_alloc(order); // Fallback: memory above the direct map
+    }
+    kspin_unlock_irqrestore(&pmm_lock, interrupts_were_on);
+    return addr;
+}
+
+// --- Public Function: kpmm_free ---
+void kpmm_free(uint64_t phys_addr, int order) {
+    uint64_t pfn = phys_addr >> PAGE_SHIFT;
+    int interrupts_were_on = kspin_lock_irqsave(&pmm_lock);
+    if (pfn < buddy_frames) {
+        buddy_free(pfn, order);
+    } else {
+        bitmap_free(pfn, order);
+    }
+    kspin_unlock_irqrestore(&pmm_lock, interrupts_were_on);
+}
+
+// --- Statistics ---
+
+uint64_t kpmm_free_blocks(int order) {
+    if (order < 0 || order > KPMM_MAX_ORDER) {
+        return 0;
+    }
+    return free_counts[order];
+}
+
+uint64_t kpmm_bitmap_free_frames(void) {
+    return high_free;
+}
+
+uint64_t kpmm_free_frames(void) {
+    uint64_t frames = high_free;
+    for (int k = 0; k <= KPMM_MAX_ORDER; k++) {
+        frames += free_counts[k] << k;
+    }
+    return frames;
+}
+
+uint64_t kpmm_total_frames(void) {
+    return total_frames;
+}
+
+uint64_t kpmm_max_phys(void) {
+    return max_phys;
+}
+
+uint64_t kpmm_direct_map_end(void) {
+    return direct_map_end;
+}
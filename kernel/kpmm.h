@@ -0,0 +1,66 @@
+#ifndef KPMM_H // Standard header guard to prevent multiple inclusions
+#define KPMM_H
+
+#include <stdint.h> // For uint64_t
+
+// --- Physical Memory Manager ---
+// Hands out physical page frames described by the Multiboot2 memory map.
+// RAM inside the boot direct map (identity mapped by boot.asm: all RAM with
+// 1GB pages, or the first 32GB in 2MB pages on CPUs without them) is managed
+// by a buddy allocator: blocks of 2^order contiguous 4KB frames, kept on one
+// free list per order, so allocating and freeing are O(1) apart from
+// splitting/merging at most KPMM_MAX_ORDER times. The free lists live inside the free frames themselves,
+// which is only possible for memory the kernel can address.
+// RAM above the direct map is tracked by a bitmap (one bit per frame) and
+// is used as a fallback once the buddy allocator runs dry; such frames must
+// be mapped before the kernel can touch them.
+
+#define KPMM_PAGE_SIZE 4096
+#define KPMM_ORDER_4K  0  // One 4KB frame
+#define KPMM_ORDER_2M  9  // 512 frames = one 2MB large page
+#define KPMM_MAX_ORDER 10 // Largest buddy block: 4MB
+
+// RAM below this address is identity mapped by boot.asm (virtual == physical)
+// on every CPU; kpmm_direct_map_end() tells how far the map really reaches.
+#define KPMM_DIRECT_MAP_MIN 0x40000000ULL
+
+// Allocation flags.
+#define KPMM_DIRECT_ONLY 0x1 // The frames must be inside the direct map
+
+// --- Function Declarations ---
+
+// kpmm_init: Builds the allocator from the Multiboot2 memory map, leaving out
+// the first 1MB, the kernel image and the boot information structure.
+// kmultiboot_init() must have been called first.
+void kpmm_init(void);
+
+// kpmm_alloc: Allocates 2^order contiguous, naturally aligned frames.
+// Parameters:
+//   order: KPMM_ORDER_4K .. KPMM_MAX_ORDER.
+//   flags: 0 to allow frames outside the direct map, or KPMM_DIRECT_ONLY.
+// Returns:
+//   The physical address of the first frame, or 0 if no block is available.
+uint64_t kpmm_alloc(int order, int flags);
+
+// kpmm_free: Returns a block obtained from kpmm_alloc with the same order.
+void kpmm_free(uint64_t phys_addr, int order);
+
+// kpmm_free_blocks: Number of free buddy blocks of exactly this order.
+uint64_t kpmm_free_blocks(int order);
+
+// kpmm_bitmap_free_frames: Number of free frames in the bitmap (high memory) region.
+uint64_t kpmm_bitmap_free_frames(void);
+
+// kpmm_free_frames / kpmm_total_frames: Free and total usable 4KB frames.
+uint64_t kpmm_free_frames(void);
+uint64_t kpmm_total_frames(void);
+
+// kpmm_max_phys: One past the highest usable RAM address in the memory map.
+uint64_t kpmm_max_phys(void);
+
+// kpmm_direct_map_end: One past the end of the direct map: the end of RAM
+// rounded up to 1GB, but at most 32GB when boot.asm could not use 1GB pages,
+// and at least KPMM_DIRECT_MAP_MIN. Valid after kpmm_init().
+uint64_t kpmm_direct_map_end(void);
+
+#endif // KPMM_H
@@ -1,24 +1,82 @@
 #include <stdint.h>
 #include "kprint.h"   // Include our own header for kprint function declaration
 #include "kinput.h"   // Required for 'outb' function declaration (for hardware cursor control)
+#include "kutils.h"   // k_memcpy/k_memset16 (SIMD-accelerated) for row copies and clears
+#include "ktrace.h"   // Latency probes
+#include "kserial.h"  // Serial mirror of the text stream
+#include "kspinlock.h" // Serializing output from several CPUs
+#include "kformat.h"   // kprintf formatting engine
+#include "kfb.h"       // Framebuffer console, when GRUB set up a pixel mode
 
 // VGA text mode buffer address and dimensions
 #define VGA_ADDRESS 0xb8000
 #define VGA_WIDTH   80
 #define VGA_HEIGHT  25
 
+// A blank cell: a space with the default VGA_ATTRIB_WHITE_ON_BLACK attribute.
+#define VGA_BLANK_CELL ((uint16_t)((VGA_ATTRIB_WHITE_ON_BLACK << 8) | ' '))
+
 // Pointer to the VGA text buffer
 static uint16_t* vga_buffer = (uint16_t*) VGA_ADDRESS;
 
+// --- Shadow Buffer ---
+// All drawing goes to this RAM copy of the screen. kprint_flush() copies the
+// rows whose bit is set in dirty_rows to VGA memory, so text is written to the
+// (slow, uncached or write-combining) MMIO window once per flush rather than
+// once per character.
+// The shadow buffer is a ring of screen_rows rows, KPRINT_MAX_COLUMNS cells
+// apart: screen row y lives in shadow row (shadow_top + y) % screen_rows, so
+// scrolling just advances shadow_top.
+static uint16_t shadow_buffer[KPRINT_MAX_COLUMNS * KPRINT_MAX_ROWS];
+static int shadow_top = 0;
+static uint64_t dirty_rows = 0; // Bit y set: screen row y differs from VGA memory
+
+// The character grid: VGA_WIDTH x VGA_HEIGHT in text mode, larger on a
+// framebuffer (kprint_set_size).
+static int screen_columns = VGA_WIDTH;
+static int screen_rows = VGA_HEIGHT;
+
+// --- Hardware Scrolling ---
+// VGA text memory at 0xB8000 is 32KB, room for VGA_RING_ROWS rows of 80 cells,
+// while only VGA_HEIGHT rows are visible. The CRTC start address registers
+// (0x0C/0x0D) select the cell shown in the top-left corner, so with hardware
+// scrolling on, screen row y is stored at VGA memory row vga_top + y and a
+// scroll is just "vga_top++" plus writing the one new bottom row. When the
+// visible window would run past the end of VGA memory, the screen is compacted
+// back to row 0 (one full-screen copy every VGA_RING_ROWS - VGA_HEIGHT lines).
+#define VGA_MEMORY_CELLS (32768 / 2)
+#define VGA_RING_ROWS    (VGA_MEMORY_CELLS / VGA_WIDTH) // 204 rows
+static int hw_scroll_enabled = 1;
+static int vga_top = 0;          // VGA memory row shown at the top of the screen
+static int start_address_dirty = 1; // CRTC start address needs rewriting (also at boot)
+
 // Global variables to keep track of the current software cursor position
 static int cursor_x = 0;
 static int cursor_y = 0;
 
+// Last cursor location written to the VGA controller (-1: never written).
+// The cursor registers hold an offset into VGA memory, not into the visible window.
+static int hw_cursor_pos = -1;
+
+// Nesting depth of kprint_batch_begin(); flushing is deferred while > 0.
+static int batch_depth = 0;
+
+// --- Locking ---
+// Every public function runs under print_lock, so several CPUs can print at
+// once without corrupting the cursor or the shadow buffer, and one kprint
+// call is never split by another CPU's. It is a plain spinlock (interrupts
+// stay enabled), so interrupt handlers must not print.
+static struct kspinlock print_lock = KSPINLOCK_INIT;
+
 // --- Internal Helper Function: update_hardware_cursor ---
 // Moves the physical blinking cursor on the screen to the current cursor_x, cursor_y.
-// This interacts directly with the VGA controller's I/O ports.
+// This interacts directly with the VGA controller's I/O ports, so it is skipped
+// when the cursor has not moved since the last update.
 static void update_hardware_cursor() {
-    uint16_t cursor_pos = cursor_y * VGA_WIDTH + cursor_x;
+    uint16_t cursor_pos = (vga_top + cursor_y) * VGA_WIDTH + cursor_x;
+    if (cursor_pos == hw_cursor_pos) {
+        return; // Already there: save the four port writes
+    }
 
     // Send the high byte of the cursor position to VGA controller register 0x0E
     outb(0x3D4, 0x0E); // Command port: select Cursor Location High Register
@@ -27,131 +85,414 @@ static void update_hardware_cursor() {
     // Send the low byte of the cursor position to VGA controller register 0x0F
     outb(0x3D4, 0x0F); // Command port: select Cursor Location Low Register
     outb(0x3D5, (uint8_t)(cursor_pos & 0xFF)); // Data port: send low byte
+
+    hw_cursor_pos = cursor_pos;
+}
+
+// --- Internal Helper Function: update_start_address ---
+// Points the CRTC at VGA memory row vga_top (registers 0x0C high, 0x0D low).
+// In text mode the start address counts character cells.
+static void update_start_address(void) {
+    uint16_t start = (uint16_t)(vga_top * VGA_WIDTH);
+    outb(0x3D4, 0x0C); // Command port: select Start Address High Register
+    outb(0x3D5, (uint8_t)(start >> 8));
+    outb(0x3D4, 0x0D); // Command port: select Start Address Low Register
+    outb(0x3D5, (uint8_t)(start & 0xFF));
+    start_address_dirty = 0;
+}
+
+// --- Internal Helper Function: shadow_row ---
+// Returns the shadow buffer storage of screen row y.
+static inline uint16_t* shadow_row(int y) {
+    int row = shadow_top + y;
+    if (row >= screen_rows) {
+        row -= screen_rows;
+    }
+    return &shadow_buffer[row * KPRINT_MAX_COLUMNS];
+}
+
+// --- Internal Helper Function: all_rows ---
+// The dirty_rows mask with every screen row set.
+static inline uint64_t all_rows(void) {
+    return screen_rows >= 64 ? ~0ULL : (1ULL << screen_rows) - 1;
+}
+
+// --- Internal Helper Function: put_cell ---
+// Writes one character cell into the shadow buffer and marks its row dirty.
+static inline void put_cell(int x, int y, uint16_t cell) {
+    shadow_row(y)[x] = cell;
+    dirty_rows |= 1ULL << y;
 }
 
 // --- Internal Helper Function: scroll_screen ---
 // Scrolls the entire screen content up by one line.
 // The top line disappears, and a new blank line appears at the bottom.
+// Nothing is copied: the shadow ring and (with hardware scrolling) the VGA
+// window both advance by one row, so the cost is one row of writes.
 static void scroll_screen() {
-    // Copy each line from (n+1) to n, effectively moving everything up.
-    // This loop starts from the second line (y=1) and copies it to the first line (y=0),
-    // then the third to the second, and so on.
-    for (int y = 1; y < VGA_HEIGHT; y++) {
-        for (int x = 0; x < VGA_WIDTH; x++) {
-            // Copy the 16-bit character (char + attribute)
-            vga_buffer[(y - 1) * VGA_WIDTH + x] = vga_buffer[y * VGA_WIDTH + x];
+    // The old top row becomes the new bottom row of the ring.
+    shadow_top = (shadow_top + 1) % screen_rows;
+    // Clear the last line with spaces.
+    // Use the default VGA_ATTRIB_WHITE_ON_BLACK attribute for the cleared line.
+    k_memset16(shadow_row(screen_rows - 1), VGA_BLANK_CELL, screen_columns);
+
+    if (kfb_active()) {
+        // The framebuffer console turns its back buffer ring, so only the
+        // new bottom row (and rows that were dirty anyway) is drawn; the
+        // next present copies the whole grid once.
+        kfb_scroll();
+        dirty_rows = (dirty_rows >> 1) | (1ULL << (screen_rows - 1));
+        return;
+    }
+
+    if (!hw_scroll_enabled) {
+        dirty_rows = all_rows(); // Every visible cell moved
+        return;
+    }
+
+    // Screen row y+1 is now row y and still lives at the same VGA memory row,
+    // so the dirty bits move up with it; only the new bottom row is dirty.
+    dirty_rows = (dirty_rows >> 1) | (1ULL << (VGA_HEIGHT - 1));
+    vga_top++;
+    if (vga_top + VGA_HEIGHT > VGA_RING_ROWS) {
+        // Out of VGA memory: compact the window back to row 0 by rewriting
+        // the whole screen there on the next flush.
+        vga_top = 0;
+        dirty_rows = all_rows();
+    }
+    start_address_dirty = 1;
+}
+
+// --- Internal Helper Function: put_char_to_shadow ---
+// Interprets one character into the shadow buffer and moves the software
+// cursor, but does not touch the hardware.
+static inline void put_char_to_shadow(char c, uint8_t color_attribute) {
+    if (c == '\n') { // Handle newline character
+        cursor_x = 0; // Move cursor to the beginning of the current line
+        cursor_y++;   // Move cursor to the next line
+    } else if (c == '\r') { // Handle carriage return character
+        cursor_x = 0; // Move cursor to the beginning of the current line (without changing row)
+    } else if (c == '\b') { // Handle backspace character
+        if (cursor_x > 0) { // If not at the beginning of a line
+            cursor_x--; // Move cursor back one position
+            // Clear the character at the new cursor position by writing a space
+            put_cell(cursor_x, cursor_y, VGA_BLANK_CELL);
+        } else if (cursor_y > 0) { // If at beginning of line, move to end of previous line
+            cursor_y--; // Move up one line
+            cursor_x = screen_columns - 1; // Move to the last column
+            put_cell(cursor_x, cursor_y, VGA_BLANK_CELL);
         }
+    } else { // Handle regular printable characters
+        // Write the character and its provided color attribute to the shadow buffer
+        put_cell(cursor_x, cursor_y, (uint16_t)((color_attribute << 8) | (uint8_t)c));
+        cursor_x++; // Move cursor to the next character position
     }
-    // Clear the last line (now the old second-to-last line) with spaces.
-    // Use the default VGA_ATTRIB_WHITE_ON_BLACK attribute for the cleared line.
-    for (int x = 0; x < VGA_WIDTH; x++) {
-        vga_buffer[(VGA_HEIGHT - 1) * VGA_WIDTH + x] = (VGA_ATTRIB_WHITE_ON_BLACK << 8) | ' ';
+
+    // Check if the cursor has gone past the right edge of the screen
+    if (cursor_x >= screen_columns) {
+        cursor_x = 0; // Reset to the beginning of the line
+        cursor_y++;   // Move to the next line
+    }
+
+    // Check if the cursor has gone past the bottom edge of the screen
+    if (cursor_y >= screen_rows) {
+        scroll_screen(); // Scroll the entire screen content up
+        cursor_y = screen_rows - 1; // Keep the cursor on the last line
+    }
+}
+
+// --- Internal Helper Function: kprint_to_shadow ---
+// The body of kprint: the string, character by character, into the shadow buffer.
+static void kprint_to_shadow(const char* str, uint8_t color_attribute) {
+    for (int i = 0; str[i]; i++) { // Loop until the null terminator is found
+        put_char_to_shadow(str[i], color_attribute);
+    }
+}
+
+KTRACE_DEFINE(flush_probe, "kprint_flush");
+KTRACE_DEFINE(clear_probe, "kclear_screen");
+
+// --- Internal Helper Function: flush_locked ---
+// The body of kprint_flush, for callers that already hold print_lock.
+// Copies every dirty row of the shadow buffer to VGA memory with k_memcpy
+// (16/32-byte stores on SSE2/AVX2 CPUs), then moves the display window and
+// the hardware cursor if they changed. Clean rows are not touched.
+// The rows are written before the start address changes, so the newly
+// exposed row never shows stale contents.
+// On the framebuffer console the dirty rows are drawn cell by cell into its
+// back buffer (unchanged cells cost nothing) and then presented.
+static void flush_locked(void) {
+    KTRACE_BEGIN(flush_probe);
+    uint64_t rows = dirty_rows;
+    dirty_rows = 0;
+    if (kfb_active()) {
+        while (rows) {
+            int y = __builtin_ctzll(rows);
+            rows &= rows - 1;
+            const uint16_t* row = shadow_row(y);
+            for (int x = 0; x < screen_columns; x++) {
+                kfb_draw_cell(x, y, row[x]);
+            }
+        }
+        kfb_set_cursor(cursor_x, cursor_y);
+        kfb_present();
+        KTRACE_END(flush_probe);
+        return;
+    }
+    while (rows) {
+        int y = __builtin_ctzll(rows); // Lowest dirty row
+        rows &= rows - 1;            // Clear that bit
+
+        k_memcpy(&vga_buffer[(vga_top + y) * VGA_WIDTH], shadow_row(y), VGA_WIDTH * sizeof(uint16_t));
     }
+    if (start_address_dirty) {
+        update_start_address();
+    }
+    update_hardware_cursor();
+    KTRACE_END(flush_probe);
+}
+
+// --- Internal Helper Function: flush_if_unbatched ---
+// Flushes now unless a kprint_batch_begin() block is open.
+static void flush_if_unbatched(void) {
+    if (batch_depth == 0) {
+        flush_locked();
+    }
+}
+
+// --- Public Function: kprint_flush ---
+void kprint_flush(void) {
+    kspin_lock(&print_lock);
+    flush_locked();
+    kspin_unlock(&print_lock);
+}
+
+// --- Public Function: kprint_set_hw_scroll ---
+// Switches between CRTC start-address scrolling and copying the whole screen
+// on every scroll. Turning it off moves the window back to VGA memory row 0.
+// Parameters:
+//   enable: 1 for hardware scrolling (the default), 0 for full redraws.
+void kprint_set_hw_scroll(int enable) {
+    kspin_lock(&print_lock);
+    hw_scroll_enabled = enable ? 1 : 0;
+    if (!hw_scroll_enabled && vga_top != 0) {
+        vga_top = 0;
+        start_address_dirty = 1;
+        dirty_rows = all_rows();
+    }
+    flush_if_unbatched();
+    kspin_unlock(&print_lock);
+}
+
+// --- Public Function: kprint_batch_begin ---
+// Starts a block of drawing calls that should reach the screen as one update.
+void kprint_batch_begin(void) {
+    kspin_lock(&print_lock);
+    batch_depth++;
+    kspin_unlock(&print_lock);
+}
+
+// --- Public Function: kprint_batch_end ---
+// Ends a block started by kprint_batch_begin(); the outermost end flushes.
+void kprint_batch_end(void) {
+    kspin_lock(&print_lock);
+    if (batch_depth > 0) {
+        batch_depth--;
+    }
+    flush_if_unbatched();
+    kspin_unlock(&print_lock);
+}
+
+// --- Public Function: kprint_redraw ---
+void kprint_redraw(void) {
+    kspin_lock(&print_lock);
+    dirty_rows = all_rows();
+    flush_if_unbatched();
+    kspin_unlock(&print_lock);
+}
+
+// --- Public Function: kprint_set_size ---
+// The ring is first turned so that screen row y is shadow row y again (one
+// row at a time; this only happens at boot), then the new cells are blanked.
+void kprint_set_size(int columns, int rows) {
+    if (columns < 1) columns = 1;
+    if (columns > KPRINT_MAX_COLUMNS) columns = KPRINT_MAX_COLUMNS;
+    if (rows < 1) rows = 1;
+    if (rows > KPRINT_MAX_ROWS) rows = KPRINT_MAX_ROWS;
+
+    kspin_lock(&print_lock);
+    uint16_t first[KPRINT_MAX_COLUMNS];
+    for (; shadow_top > 0; shadow_top--) {
+        k_memcpy(first, shadow_buffer, sizeof(first));
+        k_memmove(shadow_buffer, shadow_buffer + KPRINT_MAX_COLUMNS,
+                  (uint64_t)(screen_rows - 1) * KPRINT_MAX_COLUMNS * sizeof(uint16_t));
+        k_memcpy(shadow_buffer + (screen_rows - 1) * KPRINT_MAX_COLUMNS, first, sizeof(first));
+    }
+    for (int y = 0; y < rows; y++) {
+        int keep = y < screen_rows ? (screen_columns < columns ? screen_columns : columns) : 0;
+        k_memset16(&shadow_buffer[y * KPRINT_MAX_COLUMNS + keep], VGA_BLANK_CELL, columns - keep);
+    }
+    screen_columns = columns;
+    screen_rows = rows;
+    if (cursor_x >= columns) cursor_x = columns - 1;
+    if (cursor_y >= rows) cursor_y = rows - 1;
+    dirty_rows = all_rows();
+    flush_if_unbatched();
+    kspin_unlock(&print_lock);
+}
+
+// --- Public Functions: kprint_columns / kprint_rows ---
+int kprint_columns(void) {
+    return screen_columns;
+}
+
+int kprint_rows(void) {
+    return screen_rows;
 }
 
 // --- Public Function: kprint ---
 // Prints a null-terminated string to the VGA text buffer at the current cursor position.
 // Handles cursor movement, newlines, carriage returns, backspace, and scrolling.
+// The text is drawn into the shadow buffer and reaches the screen in one flush.
+// The same text is queued on the serial console (positioned output from
+// kprint_at is screen-only, as it has no meaning in a character stream).
 // Parameters:
 //   str: A pointer to the constant character string to print.
 //   color_attribute: The attribute byte (foreground and background color).
 void kprint(const char* str, uint8_t color_attribute) {
-    int i = 0; // Index for iterating through the input string
-    while (str[i]) { // Loop until the null terminator is found
-        char c = str[i]; // Get the current character
-
-        if (c == '\n') { // Handle newline character
-            cursor_x = 0; // Move cursor to the beginning of the current line
-            cursor_y++;   // Move cursor to the next line
-        } else if (c == '\r') { // Handle carriage return character
-            cursor_x = 0; // Move cursor to the beginning of the current line (without changing row)
-        } else if (c == '\b') { // Handle backspace character
-            if (cursor_x > 0) { // If not at the beginning of a line
-                cursor_x--; // Move cursor back one position
-                // Clear the character at the new cursor position by writing a space
-                vga_buffer[cursor_y * VGA_WIDTH + cursor_x] = (VGA_ATTRIB_WHITE_ON_BLACK << 8) | ' ';
-            } else if (cursor_y > 0) { // If at beginning of line, move to end of previous line
-                cursor_y--; // Move up one line
-                cursor_x = VGA_WIDTH - 1; // Move to the last column
-                vga_buffer[cursor_y * VGA_WIDTH + cursor_x] = (VGA_ATTRIB_WHITE_ON_BLACK << 8) | ' ';
-            }
-        } else { // Handle regular printable characters
-            // Write the character and its provided color attribute to the VGA buffer
-            vga_buffer[cursor_y * VGA_WIDTH + cursor_x] = (color_attribute << 8) | c;
-            cursor_x++; // Move cursor to the next character position
-        }
+    kspin_lock(&print_lock);
+    kprint_to_shadow(str, color_attribute);
+    flush_if_unbatched();
+    kserial_puts(str);
+    kspin_unlock(&print_lock);
+}
 
-        // Check if the cursor has gone past the right edge of the screen
-        if (cursor_x >= VGA_WIDTH) {
-            cursor_x = 0; // Reset to the beginning of the line
-            cursor_y++;   // Move to the next line
-        }
+// --- Public Function: kprint_panic ---
+#define PANIC_LOCK_SPINS 10000000 // Well beyond any normal hold of print_lock
+static volatile int panic_drawing_cpu = -1; // CPU drawing a panic message, or -1
+static volatile int panic_lock_stuck = 0;   // A panic already waited for print_lock in vain
 
-        // Check if the cursor has gone past the bottom edge of the screen
-        if (cursor_y >= VGA_HEIGHT) {
-            scroll_screen(); // Scroll the entire screen content up
-            cursor_y = VGA_HEIGHT - 1; // Keep the cursor on the last line
-        }
-        
-        // Update the hardware cursor's position to match our software cursor
-        update_hardware_cursor();
+void kprint_panic(const char* str, uint8_t color_attribute) {
+    int cpu = (int)ksmp_cpu_index();
+    int locked = kspin_trylock(&print_lock);
+    for (int i = 0; i < PANIC_LOCK_SPINS && !locked && !panic_lock_stuck; i++) {
+        k_pause();
+        locked = kspin_trylock(&print_lock);
+    }
+    if (!locked) {
+        panic_lock_stuck = 1; // The rest of the message does not wait again
+    }
+    // A fault in the drawing below comes back here through kidt_panic; the
+    // screen is then what faults, so that message goes to serial only.
+    if (panic_drawing_cpu != cpu) {
+        int previous = panic_drawing_cpu;
+        panic_drawing_cpu = cpu;
+        kprint_to_shadow(str, color_attribute);
+        flush_locked(); // Even inside a batch: nothing will end it
+        panic_drawing_cpu = previous;
+    }
+    kserial_panic_write(str);
+    if (locked) {
+        kspin_unlock(&print_lock);
+    }
+}
 
-        i++; // Move to the next character in the input string
+// --- Console Sink for kprintf ---
+// kformat() hands over spans of text; each goes straight into the shadow
+// buffer and onto the serial queue. The caller holds print_lock.
+static void console_write(struct kformat_sink* sink, const char* text, int len, uint8_t color) {
+    (void)sink;
+    for (int i = 0; i < len; i++) {
+        put_char_to_shadow(text[i], color);
     }
+    kserial_write(text, len);
+}
+
+// --- Public Function: kvprintf ---
+// The whole output is formatted under one hold of print_lock, so it cannot
+// interleave with other CPUs' output, and reaches the screen in one flush.
+int kvprintf(uint8_t color_attribute, const char* format, va_list args) {
+    struct kformat_sink sink = { console_write };
+    kspin_lock(&print_lock);
+    int count = kformat(&sink, color_attribute, format, args);
+    flush_if_unbatched();
+    kspin_unlock(&print_lock);
+    return count;
+}
+
+// --- Public Function: kprintf ---
+int kprintf(uint8_t color_attribute, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int count = kvprintf(color_attribute, format, args);
+    va_end(args);
+    return count;
 }
 
 // --- Public Function: kclear_screen ---
 // Clears the entire VGA text buffer by filling it with spaces and resets the cursor to top-left.
 void kclear_screen() {
-    // Loop through all character positions on the screen
-    for (int y = 0; y < VGA_HEIGHT; y++) {
-        for (int x = 0; x < VGA_WIDTH; x++) {
-            // Write a space character with the default VGA_ATTRIB_WHITE_ON_BLACK color attribute
-            vga_buffer[y * VGA_WIDTH + x] = (VGA_ATTRIB_WHITE_ON_BLACK << 8) | ' ';
-        }
+    KTRACE_BEGIN(clear_probe);
+    kspin_lock(&print_lock);
+    // Fill every character position with a space in the default VGA_ATTRIB_WHITE_ON_BLACK color
+    for (int y = 0; y < screen_rows; y++) {
+        k_memset16(shadow_row(y), VGA_BLANK_CELL, screen_columns);
     }
+    dirty_rows = all_rows();
     cursor_x = 0; // Reset software cursor X to 0
     cursor_y = 0; // Reset software cursor Y to 0
-    update_hardware_cursor(); // Update hardware cursor to top-left (0,0)
+    flush_if_unbatched(); // Push the blank screen and move the cursor to top-left (0,0)
+    kspin_unlock(&print_lock);
+    KTRACE_END(clear_probe);
 }
 
-// --- Public Function: kset_cursor_pos ---
-// Sets the software cursor position and updates the hardware cursor.
-// This allows direct control over where the next character will be printed.
-// Parameters:
-//   x: The target column (0 to VGA_WIDTH - 1).
-//   y: The target row (0 to VGA_HEIGHT - 1).
-void kset_cursor_pos(int x, int y) {
-    // Ensure coordinates are within bounds
+// --- Internal Helper Function: clamp_cursor ---
+// Sets the software cursor, keeping the coordinates within the screen.
+static void clamp_cursor(int x, int y) {
     if (x < 0) x = 0;
-    if (x >= VGA_WIDTH) x = VGA_WIDTH - 1;
+    if (x >= screen_columns) x = screen_columns - 1;
     if (y < 0) y = 0;
-    if (y >= VGA_HEIGHT) y = VGA_HEIGHT - 1;
+    if (y >= screen_rows) y = screen_rows - 1;
 
     cursor_x = x; // Update software cursor X
     cursor_y = y; // Update software cursor Y
-    update_hardware_cursor(); // Update the physical cursor on screen
+}
+
+// --- Public Function: kset_cursor_pos ---
+// Sets the software cursor position and updates the hardware cursor.
+// This allows direct control over where the next character will be printed.
+// Parameters:
+//   x: The target column (0 to kprint_columns() - 1).
+//   y: The target row (0 to kprint_rows() - 1).
+void kset_cursor_pos(int x, int y) {
+    kspin_lock(&print_lock);
+    clamp_cursor(x, y);
+    flush_if_unbatched(); // Update the physical cursor on screen
+    kspin_unlock(&print_lock);
 }
 
 // --- Public Function: kprint_at ---
 // Prints a null-terminated string at a specific X, Y coordinate with a given color.
 // This function temporarily moves the cursor, prints, and then restores the cursor
-// to the position *after* printing the string.
+// to its original position. Only the final position reaches the hardware cursor.
 // Parameters:
 //   str: The string to print.
 //   x: The column to start printing at.
 //   y: The row to start printing at.
 //   color_attribute: The attribute byte (foreground and background color).
 void kprint_at(const char* str, int x, int y, uint8_t color_attribute) {
+    kspin_lock(&print_lock);
     // Save the current cursor position before changing it
     int original_x = cursor_x;
     int original_y = cursor_y;
 
-    kset_cursor_pos(x, y); // Move the cursor to the desired (x, y)
-    kprint(str, color_attribute); // Print the string using the color-aware kprint
+    clamp_cursor(x, y); // Move the software cursor to the desired (x, y)
+    kprint_to_shadow(str, color_attribute); // Print the string using the color-aware kprint
 
     // After printing, restore the cursor to its original position
     // This is important if you mix kprint_at with regular kprint calls
     // and want the subsequent kprint calls to continue from where they left off.
-    kset_cursor_pos(original_x, original_y);
+    clamp_cursor(original_x, original_y);
+    flush_if_unbatched();
+    kspin_unlock(&print_lock);
 }
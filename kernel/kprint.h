@@ -2,12 +2,21 @@
 #define KPRINT_H
 
 #include <stdint.h> // For uint16_t, uint8_t
+#include <stdarg.h> // For va_list
 
 // VGA Dimensions
 
 #define VGA_WIDTH   80
 #define VGA_HEIGHT  25
 
+// Largest character grid the console can have. VGA text mode is always
+// VGA_WIDTH x VGA_HEIGHT; the framebuffer console (kfb.h) sizes its grid from
+// the video mode, up to these limits, and at least VGA_WIDTH x VGA_HEIGHT,
+// so layouts made for text mode always fit. kprint_columns()/kprint_rows()
+// tell the size in use.
+#define KPRINT_MAX_COLUMNS 240
+#define KPRINT_MAX_ROWS    64 // The dirty rows are tracked in a 64-bit mask
+
 // --- VGA Color Constants ---
 // These are standard VGA text mode color codes.
 // Each color is represented by a 4-bit value (0-15).
@@ -49,13 +58,26 @@
 //   color_attribute: The attribute byte (foreground and background color).
 void kprint(const char* str, uint8_t color_attribute);
 
+// kprintf: Formatted kprint (conversions and the %k color escape are listed
+// in kformat.h). The text is drawn as it is formatted, without an
+// intermediate string, and reaches the screen in a single flush, so a whole
+// multi-line, multi-color screen costs one call.
+// Parameters:
+//   color_attribute: Color of the text until the first %k.
+//   format, ...: printf-style format and arguments.
+// Returns:
+//   The number of characters printed.
+// (No format(printf) attribute: GCC's checker would reject %k.)
+int kprintf(uint8_t color_attribute, const char* format, ...);
+int kvprintf(uint8_t color_attribute, const char* format, va_list args);
+
 // kclear_screen: Clears the entire VGA text buffer and resets cursor.
 void kclear_screen();
 
 // kset_cursor_pos: Sets the hardware cursor position.
 // Parameters:
-//   x: The column (0-79).
-//   y: The row (0-24).
+//   x: The column (0 .. kprint_columns() - 1).
+//   y: The row (0 .. kprint_rows() - 1).
 void kset_cursor_pos(int x, int y);
 
 // kprint_at: Prints a null-terminated string at a specific X, Y coordinate.
@@ -67,4 +89,42 @@ void kset_cursor_pos(int x, int y);
 //   color_attribute: The attribute byte (foreground and background color).
 void kprint_at(const char* str, int x, int y, uint8_t color_attribute);
 
+// kprint_flush: Copies the changed rows of the RAM shadow buffer to VGA memory
+// and updates the hardware cursor if it moved. kprint, kprint_at, kclear_screen
+// and kset_cursor_pos flush automatically unless a batch is open.
+void kprint_flush(void);
+
+// kprint_set_hw_scroll: Chooses how the screen scrolls.
+// Parameters:
+//   enable: 1 (default) moves the CRTC start address through a ring of rows in
+//           VGA memory, so a scroll writes one row; 0 rewrites the whole screen.
+void kprint_set_hw_scroll(int enable);
+
+// kprint_batch_begin / kprint_batch_end: Group several drawing calls into a
+// single screen update. Calls may nest; the outermost kprint_batch_end flushes.
+void kprint_batch_begin(void);
+void kprint_batch_end(void);
+
+// kprint_redraw: Draws the whole screen again from the shadow buffer (after
+// the output device changed, see kfb_init) unless a batch is open.
+void kprint_redraw(void);
+
+// kprint_panic: Prints 'str' like kprint(), for the panic path. It waits for
+// print_lock only a bounded time and then writes the shadow buffer and the
+// screen without it, since the panicking CPU may itself hold the lock (a
+// fault inside kprint) or another CPU may never release it. Serial output
+// goes out by polling (kserial_panic_write). A fault while drawing the
+// panic message leaves the screen alone and sends only the serial copy.
+void kprint_panic(const char* str, uint8_t color_attribute);
+
+// kprint_set_size: Changes the character grid to 'columns' x 'rows' (clamped
+// to KPRINT_MAX_COLUMNS x KPRINT_MAX_ROWS) and redraws. What the screen shows
+// stays in the top-left corner; new cells are blank. For kfb_init, once the
+// framebuffer console has taken over the output.
+void kprint_set_size(int columns, int rows);
+
+// kprint_columns / kprint_rows: Size of the character grid in use.
+int kprint_columns(void);
+int kprint_rows(void);
+
 #endif
@@ -0,0 +1,275 @@
+#include <stdint.h>
+#include "kserial.h"  // Our own declarations
+#include "kinput.h"   // For inb/outb (defined in boot.asm)
+#include "kidt.h"     // IRQ4 registration
+#include "kcpu.h"     // Interrupt flag helpers
+#include "kutils.h"   // k_strlen
+#include "kspinlock.h" // Writers and the transmitter may run on different CPUs
+#include "ksmp.h"     // Which CPU receives IRQ4
+
+// --- 16550 UART Registers (offsets from the base port) ---
+#define COM1_PORT     0x3F8
+#define UART_DATA     0 // THR on write, RBR on read; divisor low byte when DLAB=1
+#define UART_IER      1 // Interrupt enable; divisor high byte when DLAB=1
+#define UART_IIR_FCR  2 // Interrupt identification (read) / FIFO control (write)
+#define UART_LCR      3 // Line control
+#define UART_MCR      4 // Modem control
+#define UART_LSR      5 // Line status
+
+#define IER_THRE      0x02 // Interrupt when the transmit holding register empties
+#define LCR_8N1       0x03
+#define LCR_DLAB      0x80 // Divisor latch access
+#define FCR_ENABLE    0xC7 // Enable and clear both FIFOs, 14-byte RX trigger
+#define MCR_NORMAL    0x0B // DTR, RTS and OUT2 (OUT2 gates the IRQ line on PCs)
+#define MCR_LOOPBACK  0x1E // Loopback mode for the presence test
+#define LSR_THRE      0x20 // Transmit holding register (and FIFO) empty
+#define IIR_NO_IRQ    0x01
+#define IIR_ID_MASK   0x0E
+#define IIR_THRE      0x02
+
+#define UART_FIFO_SIZE 16
+#define BAUD_DIVISOR   1    // 115200 / 1 = 115200 baud
+#define PANIC_THRE_POLLS 100000 // About 100ms of port reads; a byte takes 87us
+
+// --- TX Ring ---
+// One producer at a time (kserial_write holds write_lock) and one consumer
+// at a time (the THRE interrupt or the polling path hold tx_lock, which also
+// covers the UART registers). Indices run freely.
+static char tx_ring[KSERIAL_RING_SIZE];
+static volatile uint32_t tx_head = 0; // Next slot a writer fills
+static volatile uint32_t tx_tail = 0; // Next byte to send
+static volatile int tx_running = 0;   // 1 while THRE interrupts are enabled
+static struct kspinlock write_lock = KSPINLOCK_INIT;
+static struct kspinlock tx_lock = KSPINLOCK_INIT;
+
+static int uart_present = 0;
+static struct kserial_stats stats;
+
+// --- Helper Function: fill_fifo ---
+// Moves up to one FIFO's worth of bytes from the ring into the UART if the
+// FIFO is empty. The check matters with several CPUs: another one may have
+// refilled the FIFO by polling since the THRE interrupt was raised.
+// Called with tx_lock held and interrupts disabled.
+// Returns:
+//   The number of bytes still queued afterwards.
+static uint32_t fill_fifo(void) {
+    uint32_t tail = tx_tail;
+    uint32_t head = tx_head;
+    if (!(inb(COM1_PORT + UART_LSR) & LSR_THRE)) {
+        return head - tail;
+    }
+    for (int i = 0; i < UART_FIFO_SIZE && tail != head; i++, tail++) {
+        outb(COM1_PORT + UART_DATA, (uint8_t)tx_ring[tail & (KSERIAL_RING_SIZE - 1)]);
+        stats.bytes_sent++;
+    }
+    tx_tail = tail;
+    return head - tail;
+}
+
+// --- Interrupt Handler: serial_irq_handler ---
+// Refills the FIFO on every THRE interrupt and turns the interrupt off once
+// the ring is empty (THRE would otherwise fire again immediately).
+static void serial_irq_handler(struct interrupt_frame* frame) {
+    (void)frame;
+    kspin_lock(&tx_lock);
+    uint8_t iir;
+    while (!((iir = inb(COM1_PORT + UART_IIR_FCR)) & IIR_NO_IRQ)) {
+        if ((iir & IIR_ID_MASK) != IIR_THRE) {
+            inb(COM1_PORT + UART_LSR); // Line status or other causes: just acknowledge
+            inb(COM1_PORT + UART_DATA);
+            continue;
+        }
+        stats.interrupts++;
+        if (fill_fifo() == 0) {
+            outb(COM1_PORT + UART_IER, 0);
+            tx_running = 0;
+            break;
+        }
+    }
+    kspin_unlock(&tx_lock);
+}
+
+// --- Helper Function: kick_transmitter ---
+// Starts interrupt-driven transmission if it is not already running.
+// Must be called with interrupts disabled.
+static void kick_transmitter(void) {
+    kspin_lock(&tx_lock);
+    if (!tx_running && tx_head != tx_tail) {
+        fill_fifo();
+        tx_running = 1;
+        outb(COM1_PORT + UART_IER, IER_THRE); // Fires as soon as the FIFO drains
+    }
+    kspin_unlock(&tx_lock);
+}
+
+// --- Helper Function: poll_once ---
+// Refills the FIFO if it has drained, without waiting for an interrupt.
+static void poll_once(void) {
+    int interrupts_were_on = kspin_lock_irqsave(&tx_lock);
+    fill_fifo();
+    kspin_unlock_irqrestore(&tx_lock, interrupts_were_on);
+    k_pause();
+}
+
+// --- Helper Function: poll_drain ---
+// Sends queued bytes by polling the line status. Used where the THRE
+// interrupt cannot make progress for us.
+static void poll_drain(void) {
+    while (tx_head != tx_tail) {
+        poll_once();
+    }
+}
+
+// --- Helper Function: can_sleep ---
+// The PICs deliver IRQ4 to the BSP only, so only the BSP with interrupts
+// enabled can halt until the THRE interrupt makes room.
+static int can_sleep(void) {
+    return k_interrupts_enabled() && ksmp_cpu_index() == 0;
+}
+
+// --- Helper Function: wait_for_space ---
+// Called with write_lock held when the ring is full.
+static void wait_for_space(void) {
+    stats.full_waits++;
+    while (tx_head - tx_tail >= KSERIAL_RING_SIZE) {
+        if (!can_sleep()) {
+            poll_once();
+            continue;
+        }
+        // Sleep until the next interrupt (normally THRE); 'sti' takes effect
+        // only after 'hlt' has started, so no wake-up is lost.
+        k_disable_interrupts();
+        kick_transmitter();
+        if (tx_head - tx_tail >= KSERIAL_RING_SIZE) {
+            __asm__ volatile ("sti; hlt" : : : "memory");
+        } else {
+            k_enable_interrupts();
+        }
+    }
+}
+
+// --- Public Function: kserial_init ---
+int kserial_init(void) {
+    outb(COM1_PORT + UART_IER, 0);                // No interrupts while configuring
+    outb(COM1_PORT + UART_LCR, LCR_DLAB);
+    outb(COM1_PORT + UART_DATA, BAUD_DIVISOR & 0xFF);
+    outb(COM1_PORT + UART_IER, BAUD_DIVISOR >> 8);
+    outb(COM1_PORT + UART_LCR, LCR_8N1);
+    outb(COM1_PORT + UART_IIR_FCR, FCR_ENABLE);
+
+    // A UART in loopback mode returns what it sends; no UART returns 0xFF.
+    outb(COM1_PORT + UART_MCR, MCR_LOOPBACK);
+    outb(COM1_PORT + UART_DATA, 0xAE);
+    if (inb(COM1_PORT + UART_DATA) != 0xAE) {
+        uart_present = 0;
+        return 0;
+    }
+    outb(COM1_PORT + UART_MCR, MCR_NORMAL);
+
+    uart_present = 1;
+    kidt_register_handler(IRQ_VECTOR(IRQ_COM1), serial_irq_handler);
+    kpic_unmask(IRQ_COM1);
+    return 1;
+}
+
+// --- Public Function: kserial_present ---
+int kserial_present(void) {
+    return uart_present;
+}
+
+// --- Public Function: kserial_write ---
+// The copy into the ring runs with interrupts enabled; they are only turned
+// off to wait for space and to start the transmitter, so a long string does
+// not hold off other interrupts.
+void kserial_write(const char* data, int len) {
+    if (!uart_present) {
+        return;
+    }
+    int interrupts_were_on = k_interrupts_enabled();
+    kspin_lock(&write_lock);
+
+    for (int i = 0; i < len; i++) {
+        char c = data[i];
+        int copies = (c == '\n') ? 2 : 1; // Terminals expect CR LF
+        for (int n = 0; n < copies; n++) {
+            if (tx_head - tx_tail >= KSERIAL_RING_SIZE) {
+                wait_for_space();
+            }
+            tx_ring[tx_head & (KSERIAL_RING_SIZE - 1)] = (copies == 2 && n == 0) ? '\r' : c;
+            __atomic_store_n(&tx_head, tx_head + 1, __ATOMIC_RELEASE);
+            stats.bytes_queued++;
+        }
+    }
+
+    // With interrupts off the bytes wait in the ring until the next write
+    // with interrupts on (or a kserial_flush, as in the panic path).
+    if (interrupts_were_on) {
+        k_disable_interrupts();
+        kick_transmitter();
+        k_enable_interrupts();
+    }
+    kspin_unlock(&write_lock);
+}
+
+// --- Public Function: kserial_puts ---
+void kserial_puts(const char* str) {
+    kserial_write(str, k_strlen(str));
+}
+
+// --- Public Function: kserial_flush ---
+void kserial_flush(void) {
+    if (!uart_present) {
+        return;
+    }
+    if (!can_sleep()) {
+        poll_drain();
+        return;
+    }
+    while (1) {
+        k_disable_interrupts();
+        if (tx_head == tx_tail) {
+            k_enable_interrupts();
+            return;
+        }
+        kick_transmitter();
+        __asm__ volatile ("sti; hlt" : : : "memory");
+    }
+}
+
+// --- Helper Function: panic_put ---
+// Sends one byte once the UART can take it, or drops it if the UART never
+// becomes ready (a dead UART must not hang the panic path).
+static void panic_put(char c) {
+    for (int i = 0; i < PANIC_THRE_POLLS; i++) {
+        if (inb(COM1_PORT + UART_LSR) & LSR_THRE) {
+            outb(COM1_PORT + UART_DATA, (uint8_t)c);
+            stats.bytes_sent++;
+            return;
+        }
+    }
+}
+
+// --- Public Function: kserial_panic_write ---
+// The ring is drained first so the panic message follows the output that
+// led up to it. A THRE interrupt on another CPU can still take bytes from
+// the ring at the same time; at worst a few of them are sent twice.
+void kserial_panic_write(const char* str) {
+    if (!uart_present) {
+        return;
+    }
+    while (tx_tail != tx_head) {
+        panic_put(tx_ring[tx_tail & (KSERIAL_RING_SIZE - 1)]);
+        tx_tail++;
+    }
+    for (; *str; str++) {
+        if (*str == '\n') {
+            panic_put('\r');
+        }
+        panic_put(*str);
+    }
+}
+
+// --- Public Function: kserial_get_stats ---
+void kserial_get_stats(struct kserial_stats* out) {
+    *out = stats;
+}
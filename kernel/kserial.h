@@ -0,0 +1,52 @@
+#ifndef KSERIAL_H // Standard header guard to prevent multiple inclusions
+#define KSERIAL_H
+
+#include <stdint.h> // For uint64_t
+
+// --- Serial Console (COM1) ---
+// Mirrors kprint output to the first 16550 UART so the kernel can be run
+// headless (e.g. 'qemu -serial stdio'). Writers only copy into a TX ring;
+// the UART's "transmitter holding register empty" (THRE) interrupt refills
+// its 16-byte FIFO from the ring, 16 bytes per interrupt. A writer only
+// waits when the ring is full. With interrupts disabled (early boot, panics)
+// the ring is drained by polling instead.
+
+#define KSERIAL_RING_SIZE 4096 // Must be a power of two
+
+// Counters for diagnostics and the throughput benchmark.
+struct kserial_stats {
+    uint64_t bytes_queued;  // Bytes accepted by kserial_write
+    uint64_t bytes_sent;    // Bytes handed to the UART FIFO
+    uint64_t interrupts;    // THRE interrupts serviced
+    uint64_t full_waits;    // Times a writer had to wait for ring space
+};
+
+// --- Function Declarations ---
+
+// kserial_init: Probes COM1 (loopback test), sets 115200 8N1 with FIFOs and
+// installs the IRQ4 handler. Must run after kidt_init().
+// Returns:
+//   1 if a UART was found, 0 otherwise (serial output is then discarded).
+int kserial_init(void);
+
+// kserial_present: 1 once kserial_init() found a UART.
+int kserial_present(void);
+
+// kserial_write: Queues 'len' bytes for transmission. '\n' is sent as "\r\n".
+void kserial_write(const char* data, int len);
+
+// kserial_puts: Queues a null-terminated string.
+void kserial_puts(const char* str);
+
+// kserial_flush: Waits until everything queued has been handed to the UART.
+void kserial_flush(void);
+
+// kserial_panic_write: Sends what is still queued, then 'str', by polling
+// the UART without taking any lock. For the panic path only: the CPU may
+// have died holding the serial locks, or another CPU may never release them.
+void kserial_panic_write(const char* str);
+
+// kserial_get_stats: Copies the counters.
+void kserial_get_stats(struct kserial_stats* out);
+
+#endif // KSERIAL_H
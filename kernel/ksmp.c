@@ -0,0 +1,274 @@
+#include <stdint.h>
+#include "ksmp.h"       // Our own declarations
+#include "kacpi.h"      // MADT
+#include "kapic.h"      // INIT/STARTUP IPIs, per-CPU APIC setup
+#include "kidt.h"       // Loading the IDT on the APs, wake-up vector
+#include "kcpu.h"       // MSRs and control registers
+#include "kpmm.h"       // Per-CPU stacks
+#include "ktime.h"      // INIT/SIPI delays
+#include "kmultiboot.h" // Keeping the trampoline off the boot information
+#include "kutils.h"     // k_memcpy
+
+#define IA32_GS_BASE_MSR 0xC0000101
+#define IA32_PAT_MSR     0x277
+#define EFER_MSR         0xC0000080
+#define EFER_LMA         (1ULL << 10) // Read-only "long mode active" bit
+#define CR0_TS           (1ULL << 3)
+
+// Delays of the INIT-SIPI-SIPI sequence (Intel SDM, "MP Initialization").
+#define INIT_DELAY_NS   (10 * KTIME_NS_PER_MS)
+#define SIPI_DELAY_NS   200000ULL              // 200 microseconds
+#define ONLINE_TIMEOUT_NS (100 * KTIME_NS_PER_MS)
+
+// Code and parameter block of boot/trampoline.asm (linked in .rodata).
+extern char trampoline_start[];
+extern char trampoline_end[];
+extern char trampoline_params[];
+
+// Mirror of the parameter block at the end of the trampoline.
+struct ksmp_trampoline_params {
+    uint64_t cr3;
+    uint64_t cr4;
+    uint64_t cr0;
+    uint64_t efer;
+    uint64_t pat;
+    uint64_t xcr0;
+    struct {
+        uint16_t limit;
+        uint64_t base;
+    } __attribute__((packed)) gdtr;
+    uint8_t gdtr_padding[6];
+    uint64_t stack;
+    uint64_t entry;
+    uint64_t cpu;
+};
+
+_Static_assert(__builtin_offsetof(struct ksmp_trampoline_params, stack) == 64, "must match trampoline.asm");
+_Static_assert(__builtin_offsetof(struct ksmp_cpu, self) == 0, "ksmp_this_cpu reads %gs:0");
+_Static_assert(__builtin_offsetof(struct ksmp_cpu, index) == 8, "ksmp_cpu_index reads %gs:8");
+
+static struct ksmp_cpu cpus[KSMP_MAX_CPUS];
+static int cpu_slots = 1;    // Indices handed out (started or not), the BSP included
+static int cpus_online = 1;
+static int cpus_found = 1;
+
+// --- Public Function: ksmp_early_init ---
+void ksmp_early_init(void) {
+    cpus[0].self = &cpus[0];
+    cpus[0].index = 0;
+    cpus[0].online = 1;
+    k_wrmsr(IA32_GS_BASE_MSR, (uint64_t)&cpus[0]);
+}
+
+// --- Interrupt Handler: wake_handler ---
+// The wake-up IPI only has to end the 'hlt' of an idle AP.
+static void wake_handler(struct interrupt_frame* frame) {
+    (void)frame;
+    kapic_eoi();
+}
+
+// --- Helper Function: ap_idle ---
+// An AP's main loop: run the work in its mailbox, otherwise halt. The check
+// runs with interrupts disabled and 'sti; hlt' re-enables them only once the
+// halt has begun, so a wake-up IPI cannot be missed in between.
+static void __attribute__((noreturn)) ap_idle(struct ksmp_cpu* cpu) {
+    while (1) {
+        k_disable_interrupts();
+        ksmp_work_fn fn = __atomic_load_n(&cpu->work, __ATOMIC_ACQUIRE);
+        if (!fn) {
+            __asm__ volatile ("sti; hlt" : : : "memory");
+            continue;
+        }
+        k_enable_interrupts();
+        fn(cpu->work_arg);
+        cpu->work_done++;
+        __atomic_store_n(&cpu->work, 0, __ATOMIC_RELEASE);
+    }
+}
+
+// --- Function: ap_entry ---
+// First C code an AP runs, called by the trampoline on the AP's own stack.
+static void __attribute__((noreturn)) ap_entry(uint32_t index) {
+    struct ksmp_cpu* cpu = &cpus[index];
+    k_wrmsr(IA32_GS_BASE_MSR, (uint64_t)cpu);
+    kidt_load();
+    kapic_init_ap();
+    __atomic_store_n(&cpu->online, 1, __ATOMIC_RELEASE);
+    ap_idle(cpu);
+}
+
+// --- Helper Function: wait_online ---
+static int wait_online(struct ksmp_cpu* cpu, uint64_t timeout_ns) {
+    uint64_t deadline = ktime_ns() + timeout_ns;
+    while (!__atomic_load_n(&cpu->online, __ATOMIC_ACQUIRE)) {
+        if (ktime_ns() >= deadline) {
+            return 0;
+        }
+        k_pause();
+    }
+    return 1;
+}
+
+// --- Helper Function: start_ap ---
+// Gives the AP a stack and sends INIT, then up to two STARTUP IPIs (the
+// second only matters if the first was lost; a running CPU ignores it).
+// Returns:
+//   1 once the AP reports itself online.
+static int start_ap(struct ksmp_trampoline_params* params, uint32_t apic_id) {
+    uint64_t stack = kpmm_alloc(KSMP_STACK_ORDER, KPMM_DIRECT_ONLY);
+    if (!stack) {
+        return 0;
+    }
+    struct ksmp_cpu* cpu = &cpus[cpu_slots];
+    cpu->self = cpu;
+    cpu->index = cpu_slots++;
+    cpu->apic_id = apic_id;
+    cpu->stack_top = stack + ((uint64_t)KPMM_PAGE_SIZE << KSMP_STACK_ORDER);
+
+    params->stack = cpu->stack_top;
+    params->cpu = cpu->index;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST); // Parameters visible before the IPI
+
+    kapic_send_ipi(apic_id, LAPIC_ICR_INIT | LAPIC_ICR_LEVEL_ASSERT);
+    ksleep_ns(INIT_DELAY_NS);
+    for (int attempt = 0; attempt < 2; attempt++) {
+        kapic_send_ipi(apic_id, LAPIC_ICR_STARTUP | (KSMP_TRAMPOLINE_BASE >> 12));
+        if (wait_online(cpu, attempt == 0 ? SIPI_DELAY_NS : ONLINE_TIMEOUT_NS)) {
+            return 1;
+        }
+    }
+    // The index and stack stay reserved: the AP might still start late.
+    return 0;
+}
+
+// --- Public Function: ksmp_init ---
+int ksmp_init(void) {
+    if (!kapic_present()) {
+        return cpus_online;
+    }
+    cpus[0].apic_id = kapic_id();
+
+    const struct acpi_madt* madt = (const struct acpi_madt*)kacpi_find_table("APIC");
+    if (!madt) {
+        return cpus_online;
+    }
+
+    // Collect the APIC IDs of the other usable cores.
+    uint8_t ap_ids[KSMP_MAX_CPUS];
+    int ap_count = 0;
+    int found = 0;
+    const uint8_t* cursor = (const uint8_t*)(madt + 1);
+    const uint8_t* end = (const uint8_t*)madt + madt->header.length;
+    while (cursor + sizeof(struct acpi_madt_entry) <= end) {
+        const struct acpi_madt_entry* entry = (const struct acpi_madt_entry*)cursor;
+        if (entry->length < sizeof(struct acpi_madt_entry)) {
+            break; // Malformed table
+        }
+        if (entry->type == ACPI_MADT_LOCAL_APIC) {
+            const struct acpi_madt_local_apic* lapic = (const struct acpi_madt_local_apic*)entry;
+            if (lapic->flags & ACPI_MADT_CPU_ENABLED) {
+                found++;
+                if (lapic->apic_id != cpus[0].apic_id && ap_count < KSMP_MAX_CPUS - 1) {
+                    ap_ids[ap_count++] = lapic->apic_id;
+                }
+            }
+        }
+        cursor += entry->length;
+    }
+    if (found > 0) {
+        cpus_found = found;
+    }
+    if (ap_count == 0) {
+        return cpus_online;
+    }
+
+    // The trampoline page must not hold the boot information, which is
+    // still read later.
+    uint64_t info_start, info_end;
+    kmultiboot_info_range(&info_start, &info_end);
+    if (info_start < KSMP_TRAMPOLINE_BASE + KPMM_PAGE_SIZE && info_end > KSMP_TRAMPOLINE_BASE) {
+        return cpus_online;
+    }
+
+    // Copy the trampoline and give it the BSP's processor state.
+    k_memcpy((void*)KSMP_TRAMPOLINE_BASE, trampoline_start, trampoline_end - trampoline_start);
+    struct ksmp_trampoline_params* params =
+        (struct ksmp_trampoline_params*)(KSMP_TRAMPOLINE_BASE + (trampoline_params - trampoline_start));
+    uint64_t value;
+    __asm__ volatile ("mov %%cr4, %0" : "=r"(value));
+    params->cr4 = value;
+    __asm__ volatile ("mov %%cr0, %0" : "=r"(value));
+    params->cr0 = value & ~CR0_TS; // The AP's own FPU state starts out valid
+    params->cr3 = k_read_cr3();
+    params->efer = k_rdmsr(EFER_MSR) & ~EFER_LMA;
+    params->pat = k_rdmsr(IA32_PAT_MSR);
+    params->xcr0 = (params->cr4 & (1ULL << 18)) ? k_xgetbv(0) : 0; // CR4.OSXSAVE
+    __asm__ volatile ("sgdt %0" : "=m"(params->gdtr));
+    params->entry = (uint64_t)ap_entry;
+
+    kidt_register_handler(KSMP_WAKE_VECTOR, wake_handler);
+    for (int i = 0; i < ap_count; i++) {
+        if (start_ap(params, ap_ids[i])) {
+            cpus_online++;
+        }
+    }
+    return cpus_online;
+}
+
+// --- Public Functions: ksmp_cpu_count / ksmp_cpus_found / ksmp_cpu ---
+int ksmp_cpu_count(void) {
+    return cpus_online;
+}
+
+int ksmp_cpus_found(void) {
+    return cpus_found;
+}
+
+struct ksmp_cpu* ksmp_cpu(int index) {
+    return &cpus[index];
+}
+
+// --- Public Function: ksmp_run_on ---
+// The argument is stored before the function pointer is published with a
+// release store, so the AP never sees a new function with an old argument.
+// Work for one CPU must be handed out by one CPU at a time.
+int ksmp_run_on(int cpu, ksmp_work_fn fn, void* arg) {
+    if (cpu <= 0 || cpu >= cpu_slots || !cpus[cpu].online) {
+        return -1;
+    }
+    struct ksmp_cpu* target = &cpus[cpu];
+    if (__atomic_load_n(&target->work, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+    target->work_arg = arg;
+    __atomic_store_n(&target->work, fn, __ATOMIC_RELEASE);
+    kapic_send_ipi(target->apic_id, KSMP_WAKE_VECTOR);
+    return 0;
+}
+
+// --- Public Function: ksmp_wait ---
+void ksmp_wait(int cpu) {
+    if (cpu <= 0 || cpu >= cpu_slots) {
+        return;
+    }
+    while (__atomic_load_n(&cpus[cpu].work, __ATOMIC_ACQUIRE)) {
+        k_pause();
+    }
+}
+
+// --- Public Function: ksmp_run_all ---
+void ksmp_run_all(ksmp_work_fn fn, void* arg) {
+    int self = (int)ksmp_cpu_index();
+    for (int i = 1; i < cpu_slots; i++) {
+        if (i != self && cpus[i].online) {
+            ksmp_wait(i);
+            ksmp_run_on(i, fn, arg);
+        }
+    }
+    fn(arg);
+    for (int i = 1; i < cpu_slots; i++) {
+        if (i != self) {
+            ksmp_wait(i);
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef KSMP_H // Standard header guard to prevent multiple inclusions
+#define KSMP_H
+
+#include <stdint.h> // For uint32_t, uint64_t
+
+// --- Multiprocessor Support ---
+// The boot CPU (BSP) finds the other cores (APs) in the ACPI MADT and starts
+// each one with the INIT-SIPI-SIPI sequence. An AP runs the real-mode
+// trampoline (boot/trampoline.asm) up to long mode, loads the shared IDT,
+// enables its local APIC and then idles until it is given work with
+// ksmp_run_on(). Every CPU has its own stack and a struct ksmp_cpu that it
+// reaches through the GS segment base, so "which CPU am I?" is one load.
+
+#define KSMP_MAX_CPUS          16
+#define KSMP_TRAMPOLINE_BASE   0x8000 // Physical page the APs start in (TRAMPOLINE_BASE in trampoline.asm)
+#define KSMP_STACK_ORDER       2      // Per-CPU stacks of 16KB (2^2 frames)
+#define KSMP_WAKE_VECTOR       0xF0   // IPI that wakes an idle AP
+
+// Work handed to another CPU.
+typedef void (*ksmp_work_fn)(void* arg);
+
+// --- Per-CPU Data ---
+// One cache line per CPU, so CPUs never write the same line by accident.
+// 'self' must stay first and 'index' second: ksmp_this_cpu() and
+// ksmp_cpu_index() read them at fixed offsets from the GS base.
+struct ksmp_cpu {
+    struct ksmp_cpu* self;        // Offset 0: this structure's own address
+    uint32_t index;               // Offset 8: 0 for the BSP, then 1, 2, ...
+    uint32_t apic_id;
+    uint64_t stack_top;
+    volatile int online;          // Set by the CPU itself once it is ready for work
+    volatile ksmp_work_fn work;   // Pending or running work; 0 when idle
+    void* work_arg;
+    uint64_t work_done;           // Number of work items completed
+    volatile uint32_t preempt_count; // > 0 while the running thread must not be switched out
+    volatile int need_resched;    // A thread switch is due at the next preemption point
+} __attribute__((aligned(64)));
+
+// --- Function Declarations ---
+
+// ksmp_early_init: Points the BSP's GS base at its per-CPU data. Called first
+// thing in kernel_main, before anything asks for the current CPU.
+void ksmp_early_init(void);
+
+// ksmp_init: Reads the MADT and starts every enabled AP. Needs kacpi_init(),
+// kapic_init() and ktime_init() (for the INIT/SIPI delays).
+// Returns:
+//   The number of CPUs online, the BSP included.
+int ksmp_init(void);
+
+// ksmp_cpu_count: Number of CPUs online, the BSP included.
+int ksmp_cpu_count(void);
+
+// ksmp_cpus_found: Number of usable CPUs the MADT lists (1 without ACPI).
+int ksmp_cpus_found(void);
+
+// ksmp_cpu: Per-CPU data of CPU 'index' (0 .. KSMP_MAX_CPUS-1).
+struct ksmp_cpu* ksmp_cpu(int index);
+
+// ksmp_this_cpu: Per-CPU data of the calling CPU.
+static inline struct ksmp_cpu* ksmp_this_cpu(void) {
+    struct ksmp_cpu* cpu;
+    __asm__ volatile ("mov %%gs:0, %0" : "=r"(cpu));
+    return cpu;
+}
+
+// ksmp_cpu_index: Index of the calling CPU (0 on the BSP).
+static inline uint32_t ksmp_cpu_index(void) {
+    uint32_t index;
+    __asm__ volatile ("movl %%gs:8, %0" : "=r"(index));
+    return index;
+}
+
+// kthread_resched (kthread.c): Makes the switch a tick or wake-up asked for
+// while preemption was disabled.
+void kthread_resched(void);
+
+// ksmp_preempt_disable / ksmp_preempt_enable: Nestable; while the count is
+// non-zero the scheduler does not switch the calling thread out from an
+// interrupt (it still may block or yield on its own). Spinlock holders and
+// code that owns per-CPU state across several steps use them. A switch that
+// became due in the meantime happens as soon as the count drops back to 0,
+// not a whole time slice later.
+static inline void ksmp_preempt_disable(void) {
+    ksmp_this_cpu()->preempt_count++;
+    __asm__ volatile ("" : : : "memory"); // Count raised before the critical section
+}
+
+static inline void ksmp_preempt_enable(void) {
+    __asm__ volatile ("" : : : "memory");
+    struct ksmp_cpu* cpu = ksmp_this_cpu();
+    if (--cpu->preempt_count == 0 && cpu->need_resched) {
+        kthread_resched();
+    }
+}
+
+// ksmp_run_on: Hands fn(arg) to an idle AP and returns without waiting.
+// Returns:
+//   0 on success, -1 if the CPU is not an online AP or is still busy.
+int ksmp_run_on(int cpu, ksmp_work_fn fn, void* arg);
+
+// ksmp_wait: Waits until the work given to 'cpu' has finished.
+void ksmp_wait(int cpu);
+
+// ksmp_run_all: Called on the BSP. Runs fn(arg) on every online CPU, the BSP
+// included, and returns once all of them are done.
+void ksmp_run_all(ksmp_work_fn fn, void* arg);
+
+#endif // KSMP_H
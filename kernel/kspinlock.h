@@ -0,0 +1,80 @@
+#ifndef KSPINLOCK_H // Standard header guard to prevent multiple inclusions
+#define KSPINLOCK_H
+
+#include <stdint.h> // For uint32_t
+#include "kcpu.h"   // k_pause and the interrupt flag helpers
+#include "ksmp.h"   // Preemption count of the current CPU
+
+// --- Ticket Spinlock ---
+// Protects data shared between CPUs. A CPU draws a ticket with one atomic
+// increment of 'next' and waits until 'owner' reaches it, so the lock is
+// granted in arrival order and no CPU can starve (with a plain test-and-set
+// lock the CPU that just released it tends to win again). Waiters only read
+// 'owner', which stays in their caches until the holder releases the lock.
+//
+// The lock does not disable interrupts by itself. Data that an interrupt
+// handler also touches must be locked with kspin_lock_irqsave, otherwise the
+// handler could interrupt the holder on the same CPU and spin forever.
+// Holding a lock disables preemption: a thread switched out with the lock
+// held would leave a higher-priority thread spinning on it forever.
+
+struct kspinlock {
+    volatile uint32_t next;  // Next ticket to hand out
+    volatile uint32_t owner; // Ticket now allowed to hold the lock
+};
+
+#define KSPINLOCK_INIT { 0, 0 }
+
+// kspin_lock: Waits for the lock.
+static inline void kspin_lock(struct kspinlock* lock) {
+    ksmp_preempt_disable();
+    uint32_t ticket = __atomic_fetch_add(&lock->next, 1, __ATOMIC_RELAXED);
+    while (__atomic_load_n(&lock->owner, __ATOMIC_ACQUIRE) != ticket) {
+        k_pause();
+    }
+}
+
+// kspin_trylock: Takes the lock only if it is free right now (no ticket is
+// drawn otherwise, so giving up leaves the queue untouched).
+// Returns:
+//   1 if the lock is now held, 0 if another holder has it.
+static inline int kspin_trylock(struct kspinlock* lock) {
+    ksmp_preempt_disable();
+    uint32_t owner = __atomic_load_n(&lock->owner, __ATOMIC_RELAXED);
+    uint32_t expected = owner;
+    if (__atomic_compare_exchange_n(&lock->next, &expected, owner + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return 1;
+    }
+    ksmp_preempt_enable();
+    return 0;
+}
+
+// kspin_unlock: Releases the lock to the next ticket. Only the holder writes
+// 'owner', so a plain increment with a release store is enough.
+static inline void kspin_unlock(struct kspinlock* lock) {
+    __atomic_store_n(&lock->owner, lock->owner + 1, __ATOMIC_RELEASE);
+    ksmp_preempt_enable();
+}
+
+// kspin_lock_irqsave: Disables interrupts on this CPU, then takes the lock.
+// Returns:
+//   Whether interrupts were enabled, for kspin_unlock_irqrestore.
+static inline int kspin_lock_irqsave(struct kspinlock* lock) {
+    int interrupts_were_on = k_interrupts_enabled();
+    k_disable_interrupts();
+    kspin_lock(lock);
+    return interrupts_were_on;
+}
+
+// kspin_unlock_irqrestore: Releases the lock and re-enables interrupts if
+// they were enabled before kspin_lock_irqsave. Preemption comes back last,
+// with interrupts on, so a switch that became due can happen right away.
+static inline void kspin_unlock_irqrestore(struct kspinlock* lock, int interrupts_were_on) {
+    __atomic_store_n(&lock->owner, lock->owner + 1, __ATOMIC_RELEASE);
+    if (interrupts_were_on) {
+        k_enable_interrupts();
+    }
+    ksmp_preempt_enable();
+}
+
+#endif // KSPINLOCK_H
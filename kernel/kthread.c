@@ -0,0 +1,481 @@
+#include <stdint.h>
+#include "kthread.h" // Our own declarations
+#include "kpmm.h"    // Thread stacks
+#include "ktime.h"   // Tick and sleep deadlines
+#include "kcpu.h"    // Interrupt flag, CPUID, TSC
+#include "ksmp.h"    // Preemption count, BSP check
+#include "kutils.h"  // k_memset
+#include "kidt.h"    // The #NM handler for lazy FPU switching
+
+#define CR0_TS        (1ULL << 3)  // Task switched: the next FPU/SSE instruction raises #NM
+#define CR4_OSXSAVE   (1ULL << 18)
+#define VECTOR_NM     7            // #NM, device not available
+#define FCW_DEFAULT   0x037F // x87 control word after FNINIT
+#define MXCSR_DEFAULT 0x1F80 // All SSE exceptions masked, round to nearest
+#define FPU_ALIGN     64     // XSAVE needs a 64-byte aligned area
+
+// --- Thread Control Block ---
+// Lives at the bottom of the thread's stack frames, followed by the FPU
+// save area; the stack grows down from the top of the same allocation.
+struct kthread {
+    uint64_t rsp;                // Saved stack pointer while switched out
+    const char* name;
+    int priority;
+    enum kthread_state state;
+    struct kthread* next;        // Link in a run queue, wait queue or the sleep list
+    struct kthread* all_next;    // Link in the list of every thread
+    uint64_t wake_ns;            // Deadline while on the sleep list
+    struct kthread_waitq joiners;
+    kthread_fn fn;
+    void* arg;
+    uint64_t frames;             // Physical address of the allocation
+    int order;                   // Its size as a kpmm order
+    uint64_t runtime_cycles;
+    uint64_t switched_in;        // TSC when the thread last got the CPU
+    uint64_t switches;
+    uint64_t fpu_loads;          // Times its FPU state was loaded after a switch
+    uint8_t* fpu;                // FPU/SSE/AVX save area
+};
+
+// boot/switch.asm: saves the callee-saved registers on the current stack,
+// stores the stack pointer in *save_rsp, then resumes the thread whose
+// stack pointer is next_rsp.
+extern void kthread_switch(uint64_t* save_rsp, uint64_t next_rsp);
+
+// --- Scheduler State ---
+// Only the BSP schedules threads, so disabling interrupts is all the
+// locking it needs.
+static struct kthread* current = 0;
+static struct kthread_waitq run_queues[KTHREAD_PRIORITIES];
+static struct kthread* sleepers = 0;    // Sorted by wake_ns
+static struct kthread* all_threads = 0;
+static struct ksmp_cpu* sched_cpu = 0; // The BSP; its need_resched is set by the tick and by wake-ups
+static int scheduler_on = 0;
+static uint64_t slice_start = 0;        // TSC when the current thread got the CPU
+static int use_xsave = 0;
+static uint32_t fpu_size = 512;         // FXSAVE area; XSAVE asks CPUID
+static struct kthread* fpu_owner = 0;   // Thread whose FPU state is in the registers
+static int fpu_trapping = 0;            // 1 while CR0.TS is set
+
+// --- Helper Functions: irq_save / irq_restore ---
+static inline int irq_save(void) {
+    int were_on = k_interrupts_enabled();
+    k_disable_interrupts();
+    return were_on;
+}
+
+static inline void irq_restore(int were_on) {
+    if (were_on) {
+        k_enable_interrupts();
+    }
+}
+
+// --- Helper Functions: fpu_save / fpu_restore ---
+// XSAVE with every bit of the mask set stores whatever XCR0 enables (x87,
+// SSE and, if present, AVX).
+static inline void fpu_save(struct kthread* thread) {
+    if (use_xsave) {
+        __asm__ volatile ("xsave64 (%0)" : : "r"(thread->fpu), "a"(~0u), "d"(~0u) : "memory");
+    } else {
+        __asm__ volatile ("fxsave64 (%0)" : : "r"(thread->fpu) : "memory");
+    }
+}
+
+static inline void fpu_restore(struct kthread* thread) {
+    if (use_xsave) {
+        __asm__ volatile ("xrstor64 (%0)" : : "r"(thread->fpu), "a"(~0u), "d"(~0u) : "memory");
+    } else {
+        __asm__ volatile ("fxrstor64 (%0)" : : "r"(thread->fpu) : "memory");
+    }
+}
+
+// --- Helper Function: fpu_switch ---
+// Lazy FPU switching: a context switch leaves the registers alone and only
+// sets CR0.TS unless the incoming thread owns them. A thread that then uses
+// the FPU (or SSE, or the SIMD memory primitives) traps once into
+// fpu_trap(), which moves the state; a thread that does not, such as the
+// idle thread or an integer-only loop, never pays for the FPU at all, and
+// switching back to the owner costs nothing either.
+static inline void fpu_switch(struct kthread* next) {
+    int trap = (next != fpu_owner);
+    if (trap != fpu_trapping) {
+        if (trap) {
+            k_write_cr0(k_read_cr0() | CR0_TS);
+        } else {
+            k_clts();
+        }
+        fpu_trapping = trap;
+    }
+}
+
+// --- Exception Handler: fpu_trap ---
+// #NM: the running thread used the FPU while CR0.TS was set. Saves the
+// owner's registers to its own area, loads the running thread's, and lets
+// the faulting instruction run again.
+static void fpu_trap(struct interrupt_frame* frame) {
+    (void)frame;
+    k_clts();
+    fpu_trapping = 0;
+    if (fpu_owner != current) {
+        if (fpu_owner) {
+            fpu_save(fpu_owner);
+        }
+        fpu_restore(current);
+        fpu_owner = current;
+        current->fpu_loads++;
+    }
+}
+
+// --- Helper Functions: queue_push / queue_pop ---
+static void queue_push(struct kthread_waitq* queue, struct kthread* thread) {
+    thread->next = 0;
+    if (queue->tail) {
+        queue->tail->next = thread;
+    } else {
+        queue->head = thread;
+    }
+    queue->tail = thread;
+}
+
+static struct kthread* queue_pop(struct kthread_waitq* queue) {
+    struct kthread* thread = queue->head;
+    if (thread) {
+        queue->head = thread->next;
+        if (!queue->head) {
+            queue->tail = 0;
+        }
+        thread->next = 0;
+    }
+    return thread;
+}
+
+// --- Helper Function: highest_ready ---
+// Returns:
+//   The highest priority with a ready thread, or -1 if none is ready.
+static int highest_ready(void) {
+    for (int priority = KTHREAD_PRIORITIES - 1; priority >= 0; priority--) {
+        if (run_queues[priority].head) {
+            return priority;
+        }
+    }
+    return -1;
+}
+
+// --- Helper Function: make_ready ---
+// A thread more important than the running one takes over at the next
+// preemption point (the end of the current interrupt, or right away for
+// a thread that yields).
+static void make_ready(struct kthread* thread) {
+    thread->state = KTHREAD_READY;
+    queue_push(&run_queues[thread->priority], thread);
+    if (current && thread->priority > current->priority) {
+        sched_cpu->need_resched = 1;
+    }
+}
+
+// --- Helper Function: schedule ---
+// Puts the current thread back on its run queue (if it is still runnable)
+// and switches to the first thread of the highest non-empty queue. Called
+// with interrupts disabled; the switched-in thread restores its own
+// interrupt flag when its own call to schedule() returns.
+static void schedule(void) {
+    sched_cpu->need_resched = 0;
+    struct kthread* prev = current;
+    if (prev->state == KTHREAD_RUNNING) {
+        make_ready(prev);
+    }
+    struct kthread* next = queue_pop(&run_queues[highest_ready()]);
+    next->state = KTHREAD_RUNNING;
+    if (next == prev) {
+        return;
+    }
+
+    uint64_t now = k_rdtsc();
+    prev->runtime_cycles += now - prev->switched_in;
+    next->switched_in = now;
+    next->switches++;
+    slice_start = now;
+    current = next;
+
+    fpu_switch(next);
+    kthread_switch(&prev->rsp, next->rsp);
+}
+
+// --- Helper Function: arm_timer ---
+// Next interrupt: the end of the time slice or the earliest sleeper.
+static void tick(void);
+static void arm_timer(uint64_t now) {
+    uint64_t deadline = now + KTHREAD_TICK_NS;
+    if (sleepers && sleepers->wake_ns < deadline) {
+        deadline = sleepers->wake_ns;
+    }
+    ktimer_set_deadline(deadline, tick);
+}
+
+// --- Interrupt Handler: tick ---
+// Timer callback. Wakes the sleepers whose time has come and, once the
+// running thread has used up its slice, lets other threads of the same
+// priority have a turn. The switch itself happens in kthread_preempt().
+static void tick(void) {
+    uint64_t now = ktime_ns();
+    while (sleepers && sleepers->wake_ns <= now) {
+        struct kthread* thread = sleepers;
+        sleepers = thread->next;
+        make_ready(thread);
+    }
+    if (ktime_cycles_to_ns(k_rdtsc() - slice_start) >= KTHREAD_TICK_NS &&
+        highest_ready() >= current->priority) {
+        sched_cpu->need_resched = 1;
+    }
+    arm_timer(now);
+}
+
+// --- Helper Function: thread_setup ---
+// Fills in the control block at the bottom of a fresh allocation and gives
+// the thread a clean FPU state: zeros, except the two control words. In an
+// XSAVE area the zeroed header means "every component in its initial state".
+static struct kthread* thread_setup(uint64_t frames, int order, const char* name, int priority) {
+    struct kthread* thread = (struct kthread*)frames;
+    k_memset(thread, 0, sizeof(struct kthread));
+    thread->name = name;
+    thread->priority = priority;
+    thread->frames = frames;
+    thread->order = order;
+    thread->fpu = (uint8_t*)(((uint64_t)(thread + 1) + FPU_ALIGN - 1) & ~(uint64_t)(FPU_ALIGN - 1));
+    k_memset(thread->fpu, 0, fpu_size);
+    *(uint16_t*)(thread->fpu + 0) = FCW_DEFAULT;
+    *(uint32_t*)(thread->fpu + 24) = MXCSR_DEFAULT;
+    return thread;
+}
+
+// --- Helper Function: thread_start ---
+// First code of every new thread: schedule() switched to it with
+// interrupts disabled.
+static void __attribute__((noreturn)) thread_start(void) {
+    k_enable_interrupts();
+    current->fn(current->arg);
+    kthread_exit();
+}
+
+// --- Public Function: kthread_init ---
+void kthread_init(void) {
+    uint64_t cr4;
+    __asm__ volatile ("mov %%cr4, %0" : "=r"(cr4));
+    if (cr4 & CR4_OSXSAVE) {
+        uint32_t a, b, c, d;
+        k_cpuid(0xD, 0, &a, &b, &c, &d); // EBX: XSAVE area size for the components XCR0 enables
+        use_xsave = 1;
+        fpu_size = b;
+    }
+
+    // The idle thread runs on the boot stack; its allocation only holds the
+    // control block and FPU area.
+    uint64_t needed = sizeof(struct kthread) + FPU_ALIGN + fpu_size;
+    int order = 0;
+    while (((uint64_t)KPMM_PAGE_SIZE << order) < needed) {
+        order++;
+    }
+    uint64_t frames = kpmm_alloc(order, KPMM_DIRECT_ONLY);
+    if (!frames) {
+        return; // No memory map: everything keeps running on the boot stack
+    }
+    struct kthread* idle = thread_setup(frames, order, "idle", KTHREAD_PRIO_IDLE);
+    idle->state = KTHREAD_RUNNING;
+    idle->switched_in = k_rdtsc();
+    idle->switches = 1;
+
+    int were_on = irq_save();
+    sched_cpu = ksmp_this_cpu();
+    all_threads = idle;
+    current = idle;
+    fpu_owner = idle; // The registers hold what the boot code left there
+    kidt_register_handler(VECTOR_NM, fpu_trap);
+    slice_start = idle->switched_in;
+    scheduler_on = 1;
+    arm_timer(ktime_ns());
+    irq_restore(were_on);
+}
+
+// --- Public Function: kthread_idle ---
+// The check and the halt are separated by 'sti', which only takes effect
+// after the following 'hlt' has started, so a wake-up cannot be missed.
+// An interrupt that readies a thread switches to it in kthread_preempt()
+// before this loop even resumes.
+void kthread_idle(void) {
+    while (1) {
+        k_disable_interrupts();
+        if (sched_cpu->need_resched) {
+            schedule();
+        }
+        __asm__ volatile ("sti; hlt" : : : "memory");
+    }
+}
+
+// --- Public Function: kthread_create ---
+// The new stack is laid out as if the thread had called kthread_switch()
+// from just before thread_start: six zeroed callee-saved registers, then
+// thread_start as the return address, then a dummy return address for
+// thread_start itself so its stack is aligned as the ABI expects.
+struct kthread* kthread_create(const char* name, kthread_fn fn, void* arg, int priority) {
+    if (!scheduler_on || priority <= KTHREAD_PRIO_IDLE || priority >= KTHREAD_PRIORITIES) {
+        return 0;
+    }
+    uint64_t frames = kpmm_alloc(KTHREAD_STACK_ORDER, KPMM_DIRECT_ONLY);
+    if (!frames) {
+        return 0;
+    }
+    struct kthread* thread = thread_setup(frames, KTHREAD_STACK_ORDER, name, priority);
+    thread->fn = fn;
+    thread->arg = arg;
+
+    uint64_t* sp = (uint64_t*)(frames + ((uint64_t)KPMM_PAGE_SIZE << KTHREAD_STACK_ORDER));
+    *--sp = 0;                       // Return address of thread_start (never used)
+    *--sp = (uint64_t)thread_start;  // Where kthread_switch's 'ret' goes
+    for (int i = 0; i < 6; i++) {
+        *--sp = 0;                   // rbp, rbx, r12-r15
+    }
+    thread->rsp = (uint64_t)sp;
+
+    int were_on = irq_save();
+    thread->all_next = all_threads;
+    all_threads = thread;
+    make_ready(thread);
+    irq_restore(were_on);
+    return thread;
+}
+
+// --- Public Function: kthread_exit ---
+// The thread's memory is still in use until schedule() has switched away,
+// so it is freed by kthread_join() in the joining thread.
+void kthread_exit(void) {
+    k_disable_interrupts();
+    current->state = KTHREAD_EXITED;
+    if (fpu_owner == current) {
+        fpu_owner = 0; // Its save area goes with it; nothing to save
+    }
+    kthread_wake_all(&current->joiners);
+    schedule();
+    while (1) {
+        __asm__ volatile ("hlt"); // Not reached: nothing switches back to an exited thread
+    }
+}
+
+// --- Public Function: kthread_join ---
+void kthread_join(struct kthread* thread) {
+    int were_on = irq_save();
+    while (thread->state != KTHREAD_EXITED) {
+        kthread_wait(&thread->joiners);
+    }
+    for (struct kthread** link = &all_threads; *link; link = &(*link)->all_next) {
+        if (*link == thread) {
+            *link = thread->all_next;
+            break;
+        }
+    }
+    irq_restore(were_on);
+    kpmm_free(thread->frames, thread->order);
+}
+
+// --- Public Function: kthread_yield ---
+void kthread_yield(void) {
+    if (!scheduler_on) {
+        return;
+    }
+    int were_on = irq_save();
+    schedule();
+    irq_restore(were_on);
+}
+
+// --- Public Function: kthread_sleep_ns ---
+// Sleepers are kept sorted by deadline; a new earliest one re-arms the timer.
+void kthread_sleep_ns(uint64_t ns) {
+    int were_on = irq_save();
+    uint64_t now = ktime_ns();
+    current->wake_ns = now + ns;
+    current->state = KTHREAD_SLEEPING;
+    struct kthread** link = &sleepers;
+    while (*link && (*link)->wake_ns <= current->wake_ns) {
+        link = &(*link)->next;
+    }
+    current->next = *link;
+    *link = current;
+    if (sleepers == current) {
+        arm_timer(now);
+    }
+    schedule();
+    irq_restore(were_on);
+}
+
+// --- Public Function: kthread_wait ---
+void kthread_wait(struct kthread_waitq* queue) {
+    current->state = KTHREAD_BLOCKED;
+    queue_push(queue, current);
+    schedule();
+}
+
+// --- Public Function: kthread_wake_all ---
+void kthread_wake_all(struct kthread_waitq* queue) {
+    int were_on = irq_save();
+    struct kthread* thread;
+    while ((thread = queue_pop(queue))) {
+        make_ready(thread);
+    }
+    irq_restore(were_on);
+}
+
+// --- Public Function: kthread_running ---
+// With preemption disabled (a spinlock held, a job pool region open) the
+// caller must not block either, so it is treated like the pre-thread world.
+int kthread_running(void) {
+    return scheduler_on && ksmp_cpu_index() == 0 && ksmp_this_cpu()->preempt_count == 0;
+}
+
+// --- Public Function: kthread_preempt ---
+void kthread_preempt(void) {
+    if (!scheduler_on || ksmp_cpu_index() != 0 || !sched_cpu->need_resched || sched_cpu->preempt_count) {
+        return; // Nothing to do, or not now: the next interrupt or ksmp_preempt_enable() tries again
+    }
+    schedule();
+}
+
+// --- Public Function: kthread_resched ---
+// With interrupts off the caller is an interrupt handler (kthread_preempt()
+// runs on its way out) or a section that turns them back on before it
+// re-enables preemption (kspin_unlock_irqrestore), so only the interrupts-on
+// case switches here.
+void kthread_resched(void) {
+    if (!k_interrupts_enabled()) {
+        return;
+    }
+    k_disable_interrupts();
+    kthread_preempt();
+    k_enable_interrupts();
+}
+
+// --- Public Function: kthread_list ---
+int kthread_list(struct kthread_info* out, int max) {
+    int count = 0;
+    int were_on = irq_save();
+    uint64_t now = k_rdtsc();
+    for (struct kthread* thread = all_threads; thread && count < max; thread = thread->all_next) {
+        uint64_t cycles = thread->runtime_cycles;
+        if (thread == current) {
+            cycles += now - thread->switched_in;
+        }
+        out[count].name = thread->name;
+        out[count].priority = thread->priority;
+        out[count].state = thread->state;
+        out[count].runtime_ns = ktime_cycles_to_ns(cycles);
+        out[count].switches = thread->switches;
+        out[count].fpu_loads = thread->fpu_loads;
+        count++;
+    }
+    irq_restore(were_on);
+    return count;
+}
+
+// --- Public Function: kthread_state_name ---
+const char* kthread_state_name(enum kthread_state state) {
+    static const char* names[] = { "ready", "running", "blocked", "sleeping", "exited" };
+    return (unsigned)state < sizeof(names) / sizeof(names[0]) ? names[state] : "?";
+}
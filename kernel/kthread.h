@@ -0,0 +1,122 @@
+#ifndef KTHREAD_H // Standard header guard to prevent multiple inclusions
+#define KTHREAD_H
+
+#include <stdint.h> // For uint64_t
+
+// --- Kernel Threads ---
+// Preemptive threads on the boot CPU. Each thread has its own stack and its
+// own copy of the FPU/SSE/AVX registers (saved with XSAVE, or FXSAVE on
+// CPUs without it), switched lazily: only when another thread actually
+// uses them. The scheduler keeps one FIFO run queue per priority and
+// always runs the highest-priority ready thread; threads of equal priority
+// share the CPU round-robin, one KTHREAD_TICK_NS slice at a time. The timer
+// tick and any interrupt that wakes a more important thread switch threads
+// on the way out of the interrupt (see isr_dispatch).
+//
+// The application processors are not scheduled here: they stay compute
+// workers for ksmp_run_on() and the job pool. All functions below are for
+// the BSP.
+
+#define KTHREAD_STACK_ORDER 3                       // 32KB per thread (2^3 frames)
+#define KTHREAD_TICK_NS     (10 * 1000000ULL)       // Time slice: 10ms
+
+// Priorities, lowest first. The idle thread is the only one at IDLE.
+#define KTHREAD_PRIO_IDLE   0
+#define KTHREAD_PRIO_LOW    1 // Background computation
+#define KTHREAD_PRIO_NORMAL 2 // Housekeeping
+#define KTHREAD_PRIO_HIGH   3 // Interactive: woken by key presses
+#define KTHREAD_PRIORITIES  4
+
+enum kthread_state {
+    KTHREAD_READY,    // On a run queue
+    KTHREAD_RUNNING,  // On the CPU
+    KTHREAD_BLOCKED,  // On a wait queue
+    KTHREAD_SLEEPING, // On the sleep list until its deadline
+    KTHREAD_EXITED    // Finished; its memory goes once kthread_join() collects it
+};
+
+typedef void (*kthread_fn)(void* arg);
+
+struct kthread;
+
+// A list of blocked threads, woken by kthread_wake_all().
+struct kthread_waitq {
+    struct kthread* head;
+    struct kthread* tail;
+};
+
+#define KTHREAD_WAITQ_INIT { 0, 0 }
+
+// Snapshot of one thread, for diagnostics.
+struct kthread_info {
+    const char* name;
+    int priority;
+    enum kthread_state state;
+    uint64_t runtime_ns; // CPU time so far
+    uint64_t switches;   // Times the thread was switched in
+    uint64_t fpu_loads;  // Times its FPU state had to be loaded (lazily, on first use)
+};
+
+// --- Function Declarations ---
+
+// kthread_init: Turns the calling code (kernel_main on the boot stack) into
+// the idle thread and starts the scheduler tick. Needs kpmm_init() and
+// ktime_init(); from then on the scheduler owns the one-shot timer.
+void kthread_init(void);
+
+// kthread_idle: The rest of the idle thread: halts until an interrupt makes
+// another thread ready. Never returns.
+void kthread_idle(void) __attribute__((noreturn));
+
+// kthread_create: Starts fn(arg) in a new thread.
+// Parameters:
+//   name: Shown in diagnostics; must stay valid for the thread's lifetime.
+//   priority: KTHREAD_PRIO_LOW .. KTHREAD_PRIO_HIGH.
+// Returns:
+//   The thread, or 0 if there is no memory for its stack.
+struct kthread* kthread_create(const char* name, kthread_fn fn, void* arg, int priority);
+
+// kthread_exit: Ends the calling thread (returning from its function does
+// the same). Never returns.
+void kthread_exit(void) __attribute__((noreturn));
+
+// kthread_join: Waits until 'thread' has exited and frees it.
+void kthread_join(struct kthread* thread);
+
+// kthread_yield: Lets the other ready threads of the same priority run.
+void kthread_yield(void);
+
+// kthread_sleep_ns: Blocks the calling thread for at least 'ns' nanoseconds.
+void kthread_sleep_ns(uint64_t ns);
+
+// kthread_wait: Blocks the calling thread on 'queue' until it is woken.
+// Must be called with interrupts disabled, right after checking the
+// condition being waited for, so a wake-up from an interrupt handler cannot
+// slip in between; returns with interrupts still disabled.
+void kthread_wait(struct kthread_waitq* queue);
+
+// kthread_wake_all: Makes every thread on 'queue' ready. Safe in interrupt
+// handlers.
+void kthread_wake_all(struct kthread_waitq* queue);
+
+// kthread_running: 1 once kthread_init() has run and the calling CPU is the
+// one threads are scheduled on, i.e. blocking is possible.
+int kthread_running(void);
+
+// kthread_preempt: Called by isr_dispatch on the way out of a hardware
+// interrupt; switches threads if the tick or a wake-up asked for it.
+void kthread_preempt(void);
+
+// kthread_resched: Called by ksmp_preempt_enable() when the count drops to 0
+// with a switch pending; switches threads if interrupts are enabled.
+void kthread_resched(void);
+
+// kthread_list: Fills up to 'max' entries of 'out'.
+// Returns:
+//   The number of entries written.
+int kthread_list(struct kthread_info* out, int max);
+
+// kthread_state_name: "ready", "running", ... for diagnostics.
+const char* kthread_state_name(enum kthread_state state);
+
+#endif // KTHREAD_H
@@ -0,0 +1,273 @@
+#include <stdint.h>
+#include "ktime.h"    // Our own declarations
+#include "kcpu.h"     // k_rdtsc, CPUID, MSRs, interrupt flag helpers
+#include "kapic.h"    // Local APIC timer
+#include "kidt.h"     // Timer interrupt registration
+#include "kinput.h"   // For inb/outb (defined in boot.asm)
+#include "ksmp.h"     // Only the BSP has a timer interrupt
+#include "kthread.h"  // Sleeping threads instead of the whole CPU
+
+// --- PIT (8253/8254) ---
+#define PIT_HZ          1193182ULL // Input clock of every PIT counter
+#define PIT_CHANNEL0    0x40
+#define PIT_CHANNEL2    0x42
+#define PIT_COMMAND     0x43
+#define PIT_GATE_PORT   0x61       // Bit 0: channel 2 gate, bit 1: speaker, bit 5: channel 2 output
+#define PIT_MAX_TICKS   0xFFFF
+
+// Calibration runs the PIT for CALIBRATE_MS and counts TSC (and APIC timer)
+// ticks meanwhile. The shortest of several runs is used: anything that
+// delays the loop (SMIs, a host preempting the VM) only makes a run longer.
+#define CALIBRATE_MS    10
+#define CALIBRATE_LATCH (PIT_HZ * CALIBRATE_MS / 1000)
+#define CALIBRATE_RUNS  3
+
+#define IA32_TSC_DEADLINE_MSR 0x6E0
+#define LAPIC_DIVIDE_BY_16    0x3
+
+// Fixed-point shifts of the conversion multipliers (see ktime_init).
+#define NS_SHIFT    32
+#define TICKS_SHIFT 24
+
+enum timer_backend { TIMER_PIT, TIMER_LAPIC, TIMER_TSC_DEADLINE };
+static const char* timer_names[] = { "PIT one-shot", "LAPIC one-shot", "LAPIC TSC-deadline" };
+
+static enum timer_backend backend = TIMER_PIT;
+static uint64_t tsc_base = 0;     // TSC value at ktime_init()
+static uint64_t tsc_hz = 0;
+static uint64_t lapic_hz = 0;     // APIC timer ticks per second (after the divider)
+static int tsc_invariant = 0;
+
+// cycles -> ns:  ns = cycles * ns_mult >> NS_SHIFT
+// ns -> ticks:   ticks = ns * tsc_mult >> TICKS_SHIFT (and lapic_mult for the APIC)
+static uint64_t ns_mult = 0;
+static uint64_t tsc_mult = 0;
+static uint64_t lapic_mult = 0;
+
+// --- Timer State ---
+// Written with interrupts disabled, read by the interrupt handler.
+static volatile int timer_armed = 0;
+static volatile uint64_t timer_deadline = 0;
+static ktimer_callback_t timer_callback = 0;
+
+// Multiplies a 64-bit value by a fixed-point factor. The product is formed in
+// 128 bits (a single 'mul'), so large inputs do not overflow.
+static inline uint64_t mul_shift(uint64_t value, uint64_t mult, int shift) {
+    return (uint64_t)(((unsigned __int128)value * mult) >> shift);
+}
+
+// --- Helper Function: calibrate ---
+// Measures the TSC and APIC timer rates against PIT channel 2, which is
+// polled through port 0x61 so no interrupt is needed.
+static void calibrate(int use_lapic) {
+    uint64_t best_tsc = ~0ULL;
+    uint64_t best_lapic = 0;
+
+    for (int run = 0; run < CALIBRATE_RUNS; run++) {
+        if (use_lapic) {
+            kapic_write(LAPIC_REG_TIMER_DIVIDE, LAPIC_DIVIDE_BY_16);
+            kapic_write(LAPIC_REG_LVT_TIMER, LAPIC_LVT_MASKED | LAPIC_TIMER_ONESHOT);
+            kapic_write(LAPIC_REG_TIMER_INITIAL, 0xFFFFFFFF);
+        }
+
+        // Gate on, speaker off; channel 2, lobyte/hibyte, mode 0 (output goes
+        // high when the count reaches zero).
+        outb(PIT_GATE_PORT, (inb(PIT_GATE_PORT) & ~0x02) | 0x01);
+        outb(PIT_COMMAND, 0xB0);
+        outb(PIT_CHANNEL2, CALIBRATE_LATCH & 0xFF);
+        outb(PIT_CHANNEL2, CALIBRATE_LATCH >> 8);
+
+        uint64_t tsc_start = k_rdtsc();
+        uint32_t lapic_start = use_lapic ? kapic_read(LAPIC_REG_TIMER_CURRENT) : 0;
+        while (!(inb(PIT_GATE_PORT) & 0x20)) {
+        }
+        uint64_t tsc_end = k_rdtsc();
+        uint32_t lapic_end = use_lapic ? kapic_read(LAPIC_REG_TIMER_CURRENT) : 0;
+
+        if (tsc_end - tsc_start < best_tsc) {
+            best_tsc = tsc_end - tsc_start;
+            best_lapic = lapic_start - lapic_end; // The APIC counter counts down
+        }
+    }
+
+    tsc_hz = best_tsc * PIT_HZ / CALIBRATE_LATCH;
+    lapic_hz = best_lapic * PIT_HZ / CALIBRATE_LATCH;
+}
+
+// --- Helper Function: timer_program ---
+// Starts one hardware timer period of (at most) delay_ns. If the hardware
+// cannot count that far the interrupt comes early and the handler re-arms.
+static void timer_program(uint64_t delay_ns) {
+    if (backend == TIMER_TSC_DEADLINE) {
+        k_wrmsr(IA32_TSC_DEADLINE_MSR, k_rdtsc() + mul_shift(delay_ns, tsc_mult, TICKS_SHIFT) + 1);
+    } else if (backend == TIMER_LAPIC) {
+        uint64_t ticks = mul_shift(delay_ns, lapic_mult, TICKS_SHIFT) + 1;
+        if (ticks > 0xFFFFFFFF) {
+            ticks = 0xFFFFFFFF;
+        }
+        kapic_write(LAPIC_REG_TIMER_INITIAL, (uint32_t)ticks);
+    } else {
+        // Round up so the interrupt does not arrive just before the deadline.
+        // Anything of a second or more is beyond the 16-bit counter anyway.
+        uint64_t ticks = PIT_MAX_TICKS;
+        if (delay_ns < KTIME_NS_PER_S) {
+            ticks = (delay_ns * PIT_HZ + KTIME_NS_PER_S - 1) / KTIME_NS_PER_S;
+        }
+        if (ticks == 0) {
+            ticks = 1;
+        } else if (ticks > PIT_MAX_TICKS) {
+            ticks = PIT_MAX_TICKS;
+        }
+        outb(PIT_COMMAND, 0x30); // Channel 0, lobyte/hibyte, mode 0 (one interrupt at zero)
+        outb(PIT_CHANNEL0, ticks & 0xFF);
+        outb(PIT_CHANNEL0, ticks >> 8);
+    }
+}
+
+// --- Interrupt Handler: timer_interrupt ---
+// Shared by all three timer sources. If the deadline has not been reached
+// yet (a long delay split into several hardware periods) the timer is
+// re-armed for the rest; otherwise the callback runs.
+static void timer_interrupt(struct interrupt_frame* frame) {
+    (void)frame;
+    if (backend != TIMER_PIT) {
+        kapic_eoi(); // isr_dispatch only acknowledges PIC interrupts
+    }
+    if (!timer_armed) {
+        return;
+    }
+    uint64_t now = ktime_ns();
+    if (now < timer_deadline) {
+        timer_program(timer_deadline - now);
+        return;
+    }
+    timer_armed = 0;
+    if (timer_callback) {
+        timer_callback();
+    }
+}
+
+// --- Public Function: ktime_init ---
+void ktime_init(void) {
+    uint32_t a, b, c, d;
+    k_cpuid(0x80000000, 0, &a, &b, &c, &d);
+    if (a >= 0x80000007) {
+        k_cpuid(0x80000007, 0, &a, &b, &c, &d);
+        tsc_invariant = (d >> 8) & 1;
+    }
+    k_cpuid(1, 0, &a, &b, &c, &d);
+    int has_tsc_deadline = (c >> 24) & 1;
+
+    int use_lapic = kapic_present();
+    calibrate(use_lapic);
+    if (tsc_hz == 0) {
+        tsc_hz = 1; // Keep the divisions below defined; ktime_ns() will be meaningless
+    }
+    tsc_base = k_rdtsc();
+
+    // Multipliers: ns = cycles * 10^9 / tsc_hz, ticks = ns * hz / 10^9.
+    // The divisions are done once here so the hot paths only multiply.
+    ns_mult = (KTIME_NS_PER_S << NS_SHIFT) / tsc_hz;
+    tsc_mult = (tsc_hz << TICKS_SHIFT) / KTIME_NS_PER_S;
+    lapic_mult = (lapic_hz << TICKS_SHIFT) / KTIME_NS_PER_S;
+
+    if (use_lapic && has_tsc_deadline) {
+        backend = TIMER_TSC_DEADLINE;
+        kapic_write(LAPIC_REG_LVT_TIMER, LAPIC_TIMER_TSC_DEADLINE | LAPIC_TIMER_VECTOR);
+    } else if (use_lapic && lapic_hz) {
+        backend = TIMER_LAPIC;
+        kapic_write(LAPIC_REG_TIMER_DIVIDE, LAPIC_DIVIDE_BY_16);
+        kapic_write(LAPIC_REG_LVT_TIMER, LAPIC_TIMER_ONESHOT | LAPIC_TIMER_VECTOR);
+    } else {
+        backend = TIMER_PIT;
+    }
+
+    if (backend == TIMER_PIT) {
+        kidt_register_handler(IRQ_VECTOR(IRQ_TIMER), timer_interrupt);
+        kpic_unmask(IRQ_TIMER);
+    } else {
+        kidt_register_handler(LAPIC_TIMER_VECTOR, timer_interrupt);
+    }
+}
+
+// --- Public Function: ktime_ns ---
+uint64_t ktime_ns(void) {
+    return mul_shift(k_rdtsc() - tsc_base, ns_mult, NS_SHIFT);
+}
+
+// --- Public Function: ktime_cycles_to_ns ---
+uint64_t ktime_cycles_to_ns(uint64_t cycles) {
+    return mul_shift(cycles, ns_mult, NS_SHIFT);
+}
+
+// --- Public Functions: ktime_tsc_hz / ktime_tsc_invariant / ktime_timer_name ---
+uint64_t ktime_tsc_hz(void) {
+    return tsc_hz;
+}
+
+int ktime_tsc_invariant(void) {
+    return tsc_invariant;
+}
+
+const char* ktime_timer_name(void) {
+    return timer_names[backend];
+}
+
+// --- Public Function: ktimer_set_deadline ---
+void ktimer_set_deadline(uint64_t deadline_ns, ktimer_callback_t callback) {
+    int interrupts_were_on = k_interrupts_enabled();
+    k_disable_interrupts(); // The handler must not see a half-updated deadline
+
+    timer_deadline = deadline_ns;
+    timer_callback = callback;
+    timer_armed = 1;
+    uint64_t now = ktime_ns();
+    timer_program(deadline_ns > now ? deadline_ns - now : 0);
+
+    if (interrupts_were_on) {
+        k_enable_interrupts();
+    }
+}
+
+// --- Public Function: ktimer_cancel ---
+void ktimer_cancel(void) {
+    timer_armed = 0; // A pending interrupt finds the timer disarmed and does nothing
+}
+
+// --- Public Function: ksleep_ns ---
+// Interrupts are disabled while the clock is checked; 'sti' only takes
+// effect after the following 'hlt' has started, so the timer interrupt
+// cannot slip in between the check and the halt.
+// The one-shot timer belongs to the BSP, so the other CPUs busy-wait.
+// Once threads run, only the calling thread sleeps and the others keep the
+// CPU in the meantime. A thread that may not block (preemption disabled)
+// busy-waits too: the timer then carries the scheduler's tick, which a
+// deadline of our own would replace.
+void ksleep_ns(uint64_t ns) {
+    uint64_t deadline = ktime_ns() + ns;
+
+    if (kthread_running() && k_interrupts_enabled()) {
+        uint64_t now;
+        while ((now = ktime_ns()) < deadline) {
+            kthread_sleep_ns(deadline - now);
+        }
+        return;
+    }
+
+    if (!k_interrupts_enabled() || ksmp_cpu_index() != 0 || ksmp_this_cpu()->preempt_count) {
+        while (ktime_ns() < deadline) {
+            k_pause();
+        }
+        return;
+    }
+
+    ktimer_set_deadline(deadline, 0);
+    while (1) {
+        k_disable_interrupts();
+        if (ktime_ns() >= deadline) {
+            k_enable_interrupts();
+            return;
+        }
+        __asm__ volatile ("sti; hlt" : : : "memory"); // Woken by the timer (or any other IRQ)
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef KTIME_H // Standard header guard to prevent multiple inclusions
+#define KTIME_H
+
+#include <stdint.h> // For uint64_t
+
+// --- Timekeeping ---
+// The clock is the TSC, converted to nanoseconds with a multiplier measured
+// against the PIT (whose 1.193182 MHz input is the same on every PC) at boot.
+// The timer is one-shot ("tickless"): it is only programmed for the next
+// deadline instead of interrupting at a fixed rate. The best hardware
+// available is used: the local APIC in TSC-deadline mode, the local APIC
+// one-shot counter, or PIT channel 0.
+
+#define KTIME_NS_PER_MS 1000000ULL
+#define KTIME_NS_PER_S  1000000000ULL
+
+// Called from the timer interrupt when a deadline passes.
+typedef void (*ktimer_callback_t)(void);
+
+// --- Function Declarations ---
+
+// ktime_init: Calibrates the TSC (and the APIC timer) against the PIT and
+// picks a timer. Takes about 30ms. Must run with interrupts disabled, after
+// kidt_init() and kapic_init().
+void ktime_init(void);
+
+// ktime_ns: Nanoseconds since ktime_init().
+uint64_t ktime_ns(void);
+
+// ktime_cycles_to_ns: Converts a TSC cycle count into nanoseconds.
+uint64_t ktime_cycles_to_ns(uint64_t cycles);
+
+// ktime_tsc_hz: The measured TSC frequency in Hz.
+uint64_t ktime_tsc_hz(void);
+
+// ktime_tsc_invariant: 1 if the TSC rate does not change with power states
+// (CPUID "invariant TSC"), i.e. ktime_ns() stays accurate when idle.
+int ktime_tsc_invariant(void);
+
+// ktime_timer_name: Name of the timer hardware in use, for diagnostics.
+const char* ktime_timer_name(void);
+
+// ktimer_set_deadline: Arms the one-shot timer. There is a single deadline;
+// setting a new one replaces the old. Long delays are split into several
+// hardware periods transparently. After kthread_init() the timer belongs to
+// the scheduler; use ksleep_ns() instead.
+// Parameters:
+//   deadline_ns: Absolute time in ktime_ns() units.
+//   callback: Called in interrupt context once the deadline has passed, or 0.
+void ktimer_set_deadline(uint64_t deadline_ns, ktimer_callback_t callback);
+
+// ktimer_cancel: Disarms the timer.
+void ktimer_cancel(void);
+
+// ksleep_ns: Waits at least 'ns' nanoseconds. A thread that may block
+// sleeps and lets other threads run; before the scheduler starts, the BSP
+// with interrupts enabled and preemption on halts until the timer fires;
+// otherwise it spins on the TSC.
+void ksleep_ns(uint64_t ns);
+
+#endif // KTIME_H
@@ -0,0 +1,182 @@
+#include <stdint.h>
+#include "ktrace.h"   // Our own declarations
+#include "kprint.h"   // Printing the report
+#include "kbench.h"   // kbench_print_u64, kbench_print_u64_padded
+#include "kutils.h"   // k_strlen, k_memset
+#include "kspinlock.h" // Drains from several threads
+
+#define MAX_DUMP_PROBES 64   // Probes considered when sorting for the report
+#define HISTOGRAM_ROWS  8    // Buckets shown for the hottest probe
+#define HISTOGRAM_BAR   40   // Width of the longest histogram bar
+
+struct ktrace_ring ktrace_rings[KTRACE_MAX_CPUS];
+
+// Every probe that has recorded at least once, in first-seen order.
+static struct ktrace_probe* probe_list = 0;
+
+// Serializes the consumers (the log flusher thread, the report, resets);
+// the rings' producers never take it.
+static struct kspinlock drain_lock = KSPINLOCK_INIT;
+
+// --- Helper Function: bucket_of ---
+// Log2 bucket of a latency: the index of its highest set bit.
+static inline int bucket_of(uint64_t cycles) {
+    int bucket = 63 - __builtin_clzll(cycles | 1);
+    return bucket < KTRACE_BUCKETS ? bucket : KTRACE_BUCKETS - 1;
+}
+
+// --- Public Function: ktrace_drain ---
+// If a ring was lapped since the last drain, the oldest records are gone;
+// they are counted in 'dropped' and skipped.
+// Another CPU may have reserved a slot but not filled it yet; such a slot
+// still holds an older record (or none), which is counted instead. The
+// statistics are approximate in that respect, never corrupted.
+static void drain_locked(void) {
+    for (int cpu = 0; cpu < KTRACE_MAX_CPUS; cpu++) {
+        struct ktrace_ring* ring = &ktrace_rings[cpu];
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint32_t tail = ring->tail;
+
+        if (head - tail > KTRACE_RING_SIZE) {
+            ring->dropped += head - tail - KTRACE_RING_SIZE;
+            tail = head - KTRACE_RING_SIZE;
+        }
+        for (; tail != head; tail++) {
+            struct ktrace_record* record = &ring->records[tail & (KTRACE_RING_SIZE - 1)];
+            struct ktrace_probe* probe = record->probe;
+            if (!probe) {
+                continue; // Slot never written
+            }
+            if (!probe->listed) {
+                probe->listed = 1;
+                probe->next = probe_list;
+                probe_list = probe;
+            }
+            probe->count++;
+            probe->total_cycles += record->cycles;
+            if (record->cycles > probe->max_cycles) {
+                probe->max_cycles = record->cycles;
+            }
+            probe->histogram[bucket_of(record->cycles)]++;
+        }
+        ring->tail = tail;
+    }
+}
+
+void ktrace_drain(void) {
+    kspin_lock(&drain_lock);
+    drain_locked();
+    kspin_unlock(&drain_lock);
+}
+
+// --- Public Function: ktrace_reset ---
+void ktrace_reset(void) {
+    kspin_lock(&drain_lock);
+    drain_locked(); // Consume pending records so they are not counted later
+    for (struct ktrace_probe* probe = probe_list; probe; probe = probe->next) {
+        probe->count = 0;
+        probe->total_cycles = 0;
+        probe->max_cycles = 0;
+        k_memset(probe->histogram, 0, sizeof(probe->histogram));
+    }
+    for (int cpu = 0; cpu < KTRACE_MAX_CPUS; cpu++) {
+        ktrace_rings[cpu].dropped = 0;
+    }
+    kspin_unlock(&drain_lock);
+}
+
+// --- Helper Function: percentile_bound ---
+// Upper bound (in cycles) of the bucket holding the given percentile.
+static uint64_t percentile_bound(const struct ktrace_probe* probe, int percent) {
+    uint64_t wanted = (probe->count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < KTRACE_BUCKETS; b++) {
+        seen += probe->histogram[b];
+        if (seen >= wanted) {
+            return (2ULL << b) - 1;
+        }
+    }
+    return probe->max_cycles;
+}
+
+// --- Helper Function: print_histogram ---
+// Draws up to HISTOGRAM_ROWS non-empty buckets of a probe as bars.
+static void print_histogram(const struct ktrace_probe* probe) {
+    uint32_t peak = 1;
+    for (int b = 0; b < KTRACE_BUCKETS; b++) {
+        if (probe->histogram[b] > peak) {
+            peak = probe->histogram[b];
+        }
+    }
+    int rows = 0;
+    for (int b = 0; b < KTRACE_BUCKETS && rows < HISTOGRAM_ROWS; b++) {
+        if (probe->histogram[b] == 0) {
+            continue;
+        }
+        kprint("<", VGA_ATTRIB_DARK_GREY_ON_BLACK);
+        kbench_print_u64_padded(2ULL << b, 11, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(probe->histogram[b], 9, VGA_ATTRIB_WHITE_ON_BLACK);
+        kprint(" ", VGA_ATTRIB_WHITE_ON_BLACK);
+        int bar = (int)((uint64_t)probe->histogram[b] * HISTOGRAM_BAR / peak);
+        for (int i = 0; i < (bar ? bar : 1); i++) {
+            kprint("#", VGA_ATTRIB_GREEN_ON_BLACK);
+        }
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+        rows++;
+    }
+}
+
+// --- Public Function: ktrace_dump_top ---
+void ktrace_dump_top(int n) {
+    ktrace_drain();
+
+    // Sort the probes by total time (insertion sort; there are only a few).
+    struct ktrace_probe* sorted[MAX_DUMP_PROBES];
+    int count = 0;
+    for (struct ktrace_probe* probe = probe_list; probe && count < MAX_DUMP_PROBES; probe = probe->next) {
+        if (probe->count == 0) {
+            continue;
+        }
+        int i = count++;
+        while (i > 0 && sorted[i - 1]->total_cycles < probe->total_cycles) {
+            sorted[i] = sorted[i - 1];
+            i--;
+        }
+        sorted[i] = probe;
+    }
+
+    uint64_t dropped = 0;
+    for (int cpu = 0; cpu < KTRACE_MAX_CPUS; cpu++) {
+        dropped += ktrace_rings[cpu].dropped;
+    }
+
+    kprint("probe                  calls    avg cyc   p50 <=   p99 <=    max cyc\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    if (count == 0) {
+        kprint(KTRACE_ENABLED ? "(no probe has fired yet)\n" : "(tracing compiled out: KTRACE=0)\n",
+               VGA_ATTRIB_DARK_GREY_ON_BLACK);
+        return;
+    }
+    for (int i = 0; i < count && i < n; i++) {
+        const struct ktrace_probe* probe = sorted[i];
+        kprint(probe->name, VGA_ATTRIB_WHITE_ON_BLACK);
+        for (int pad = k_strlen(probe->name); pad < 18; pad++) {
+            kprint(" ", VGA_ATTRIB_WHITE_ON_BLACK);
+        }
+        kbench_print_u64_padded(probe->count, 10, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(probe->total_cycles / probe->count, 11, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(percentile_bound(probe, 50), 9, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(percentile_bound(probe, 99), 9, VGA_ATTRIB_WHITE_ON_BLACK);
+        kbench_print_u64_padded(probe->max_cycles, 11, VGA_ATTRIB_WHITE_ON_BLACK);
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+    if (dropped) {
+        kprint("records lost to ring overflow: ", VGA_ATTRIB_RED_ON_BLACK);
+        kbench_print_u64(dropped, VGA_ATTRIB_RED_ON_BLACK);
+        kprint("\n", VGA_ATTRIB_WHITE_ON_BLACK);
+    }
+
+    kprint("\nLatency histogram of ", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    kprint(sorted[0]->name, VGA_ATTRIB_YELLOW_ON_BLACK);
+    kprint(" (cycles, calls):\n", VGA_ATTRIB_LIGHT_BLUE_ON_BLACK);
+    print_histogram(sorted[0]);
+}
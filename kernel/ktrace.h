@@ -0,0 +1,103 @@
+#ifndef KTRACE_H // Standard header guard to prevent multiple inclusions
+#define KTRACE_H
+
+#include <stdint.h> // For uint32_t, uint64_t
+#include "kcpu.h"   // k_rdtsc
+#include "ksmp.h"   // ksmp_cpu_index
+
+// --- Kernel Tracing ---
+// A probe measures how many TSC cycles a stretch of code takes:
+//
+//     KTRACE_DEFINE(draw_probe, "draw_calculator");   // once, at file scope
+//     ...
+//     KTRACE_BEGIN(draw_probe);
+//     ... code being measured ...
+//     KTRACE_END(draw_probe);
+//
+// KTRACE_END only appends {probe, start, cycles} to the current CPU's ring,
+// so a probe costs two RDTSCs and a few stores. Turning records into
+// per-probe statistics (call count, total, maximum and a log2 histogram)
+// happens later in ktrace_drain(), which runs when the CPU is idle and
+// before a dump.
+//
+// Build with KTRACE=0 (make KTRACE=0) to compile every probe out entirely.
+
+#ifndef KTRACE_ENABLED
+#define KTRACE_ENABLED 1
+#endif
+
+#define KTRACE_RING_SIZE 4096 // Records per CPU; must be a power of two
+#define KTRACE_MAX_CPUS  KSMP_MAX_CPUS
+#define KTRACE_BUCKETS   32   // Bucket b counts latencies of 2^b .. 2^(b+1)-1 cycles
+
+// Statistics of one probe, updated by ktrace_drain().
+struct ktrace_probe {
+    const char* name;
+    struct ktrace_probe* next; // Chain of every probe that has fired so far
+    int listed;                // 1 once the probe is on that chain
+    uint64_t count;
+    uint64_t total_cycles;
+    uint64_t max_cycles;
+    uint32_t histogram[KTRACE_BUCKETS];
+};
+
+// One ring entry.
+struct ktrace_record {
+    struct ktrace_probe* probe;
+    uint64_t start;  // TSC at KTRACE_BEGIN
+    uint64_t cycles; // TSC delta between KTRACE_BEGIN and KTRACE_END
+};
+
+// Per-CPU ring. Only its own CPU writes it (including from interrupt
+// handlers), so the slot is reserved with a non-locked xadd, which cannot be
+// torn by an interrupt. 'head' and 'tail' run freely and are masked on use.
+struct ktrace_ring {
+    uint32_t head; // Next slot to write
+    uint32_t tail; // Next slot ktrace_drain() reads
+    uint64_t dropped;
+    struct ktrace_record records[KTRACE_RING_SIZE];
+};
+
+extern struct ktrace_ring ktrace_rings[KTRACE_MAX_CPUS];
+
+// ktrace_cpu: Index of the current CPU's ring.
+static inline int ktrace_cpu(void) {
+    return (int)ksmp_cpu_index();
+}
+
+// ktrace_record: Appends a record (the body of KTRACE_END).
+static inline void ktrace_record(struct ktrace_probe* probe, uint64_t start) {
+    uint64_t end = k_rdtsc();
+    struct ktrace_ring* ring = &ktrace_rings[ktrace_cpu()];
+    uint32_t slot = 1;
+    __asm__ volatile ("xaddl %0, %1" : "+r"(slot), "+m"(ring->head) : : "memory");
+    struct ktrace_record* record = &ring->records[slot & (KTRACE_RING_SIZE - 1)];
+    record->probe = probe;
+    record->start = start;
+    record->cycles = end - start;
+}
+
+#if KTRACE_ENABLED
+#define KTRACE_DEFINE(probe, label) static struct ktrace_probe probe = { .name = (label) }
+#define KTRACE_BEGIN(probe) uint64_t probe##_start = k_rdtsc()
+#define KTRACE_END(probe) ktrace_record(&(probe), probe##_start)
+#else
+#define KTRACE_DEFINE(probe, label) struct ktrace_probe // Swallows the trailing ';'
+#define KTRACE_BEGIN(probe) do { } while (0)
+#define KTRACE_END(probe) do { } while (0)
+#endif
+
+// --- Function Declarations ---
+
+// ktrace_drain: Folds every pending record into its probe's statistics.
+// Must not be called from an interrupt handler, nor on two CPUs at once.
+void ktrace_drain(void);
+
+// ktrace_reset: Discards pending records and clears every probe's statistics.
+void ktrace_reset(void);
+
+// ktrace_dump_top: Prints the 'n' probes with the most total time, then the
+// latency histogram of the hottest one.
+void ktrace_dump_top(int n);
+
+#endif // KTRACE_H
@@ -0,0 +1,236 @@
+#include <stdint.h>
+#include "kui.h"      // Our own declarations
+#include "kprint.h"   // kprint_at and batching
+#include "kutils.h"   // k_strlen, k_memset, k_memcpy
+
+// --- Cell Map ---
+// What kui last wrote to each screen cell: the character and its color, as
+// in VGA memory. 0 means "unknown" (no real cell is 0, as kui never writes
+// a null character), so the next draw of that cell is always written.
+static uint16_t cell_map[KPRINT_MAX_COLUMNS * KPRINT_MAX_ROWS]; // Rows KPRINT_MAX_COLUMNS apart
+
+// --- Frame State ---
+static int frame_redraw_all = 0; // The current frame draws every widget completely
+static int frame_cells = 0;      // Cells written by the current frame
+static struct kui_stats stats;
+
+// --- Internal Helper Function: put_cells ---
+// Draws 'count' cells from (x, y) on: the first 'length' characters of
+// 'text', then spaces, all in 'color'. Cells that already show the same
+// character in the same color are skipped; the others are written with one
+// kprint_at per run of neighbouring cells. Cells past the right edge are
+// dropped.
+static void put_cells(int x, int y, const char* text, int length, int count, uint8_t color) {
+    if (x < 0 || y < 0 || y >= kprint_rows()) {
+        return;
+    }
+    if (count > kprint_columns() - x) {
+        count = kprint_columns() - x;
+    }
+
+    uint16_t* shown = &cell_map[y * KPRINT_MAX_COLUMNS + x];
+    char run[KPRINT_MAX_COLUMNS + 1];
+    int run_start = -1; // First cell of the run being collected, -1 if none
+    for (int i = 0; i <= count; i++) {
+        int differs = 0;
+        char c = ' ';
+        if (i < count) {
+            if (i < length) {
+                c = text[i];
+            }
+            uint16_t cell = (uint16_t)((color << 8) | (uint8_t)c);
+            if (shown[i] != cell) {
+                shown[i] = cell;
+                differs = 1;
+            }
+        }
+        if (differs) {
+            if (run_start < 0) {
+                run_start = i;
+            }
+            run[i - run_start] = c;
+        } else if (run_start >= 0) { // A run ends here (or at the end)
+            run[i - run_start] = '\0';
+            kprint_at(run, x + run_start, y, color);
+            frame_cells += i - run_start;
+            run_start = -1;
+        }
+    }
+}
+
+// --- Public Function: kui_frame_begin ---
+// Opens the kprint batch the frame is drawn in. For a redraw_all frame the
+// cell map is forgotten, so every cell drawn is written.
+void kui_frame_begin(int redraw_all) {
+    kprint_batch_begin();
+    if (redraw_all) {
+        k_memset(cell_map, 0, sizeof(cell_map));
+    }
+    frame_redraw_all = redraw_all;
+    frame_cells = 0;
+}
+
+// --- Public Function: kui_frame_end ---
+int kui_frame_end(void) {
+    kprint_batch_end(); // One flush for the whole frame
+    frame_redraw_all = 0;
+    stats.frames++;
+    stats.cells += (uint64_t)frame_cells;
+    stats.last_frame_cells = frame_cells;
+    return frame_cells;
+}
+
+// --- Public Function: kui_get_stats ---
+void kui_get_stats(struct kui_stats* out) {
+    k_memcpy(out, &stats, sizeof(stats));
+}
+
+// --- Public Function: kui_label_init ---
+void kui_label_init(struct kui_label* label, int x, int y, int width, uint8_t color) {
+    label->x = x;
+    label->y = y;
+    label->width = width < KUI_LABEL_SIZE - 1 ? width : KUI_LABEL_SIZE - 1;
+    label->color = color;
+    label->dirty = 1;
+    label->text[0] = '\0';
+}
+
+// --- Public Function: kui_label_set ---
+// Copies at most 'width' characters, noting whether anything changed.
+void kui_label_set(struct kui_label* label, const char* text) {
+    int i = 0;
+    for (; i < label->width && text[i]; i++) {
+        if (label->text[i] != text[i]) {
+            label->text[i] = text[i];
+            label->dirty = 1;
+        }
+    }
+    if (label->text[i] != '\0') { // The old text was longer
+        label->text[i] = '\0';
+        label->dirty = 1;
+    }
+}
+
+// --- Public Function: kui_label_set_color ---
+void kui_label_set_color(struct kui_label* label, uint8_t color) {
+    if (label->color != color) {
+        label->color = color;
+        label->dirty = 1;
+    }
+}
+
+// --- Public Function: kui_label_draw ---
+void kui_label_draw(struct kui_label* label) {
+    if (!label->dirty && !frame_redraw_all) {
+        return;
+    }
+    put_cells(label->x, label->y, label->text, k_strlen(label->text), label->width, label->color);
+    label->dirty = 0;
+}
+
+// --- Public Function: kui_grid_init ---
+void kui_grid_init(struct kui_grid* grid, int x, int y, int rows, int cols, int cell_width, int pitch,
+                   const char* const* labels, uint8_t color, uint8_t highlight_color) {
+    grid->x = x;
+    grid->y = y;
+    grid->rows = rows;
+    grid->cols = cols;
+    grid->cell_width = cell_width;
+    grid->pitch = pitch;
+    grid->labels = labels;
+    grid->color = color;
+    grid->highlight_color = highlight_color;
+    grid->selected_x = 0;
+    grid->selected_y = 0;
+    grid->shown_x = -1; // Nothing on the screen yet
+    grid->shown_y = -1;
+}
+
+// --- Public Function: kui_grid_select ---
+void kui_grid_select(struct kui_grid* grid, int col, int row) {
+    if (col >= 0 && col < grid->cols && row >= 0 && row < grid->rows) {
+        grid->selected_x = col;
+        grid->selected_y = row;
+    }
+}
+
+// --- Public Function: kui_grid_label ---
+const char* kui_grid_label(const struct kui_grid* grid) {
+    return grid->labels[grid->selected_y * grid->cols + grid->selected_x];
+}
+
+// --- Internal Helper Function: draw_button ---
+// One button: padding, the label (highlighted if selected), padding.
+static void draw_button(const struct kui_grid* grid, int col, int row) {
+    const char* label = grid->labels[row * grid->cols + col];
+    int length = k_strlen(label);
+    if (length > grid->cell_width) {
+        length = grid->cell_width;
+    }
+    int x = grid->x + col * grid->pitch;
+    int y = grid->y + row;
+    int before = (grid->cell_width - length) / 2;
+    int after = grid->cell_width - before - length;
+    uint8_t label_color = (col == grid->selected_x && row == grid->selected_y)
+        ? grid->highlight_color : grid->color;
+
+    put_cells(x, y, "", 0, before, grid->color);
+    put_cells(x + before, y, label, length, length, label_color);
+    put_cells(x + before + length, y, "", 0, after, grid->color);
+}
+
+// --- Public Function: kui_grid_draw ---
+void kui_grid_draw(struct kui_grid* grid) {
+    if (frame_redraw_all || grid->shown_x < 0) {
+        for (int row = 0; row < grid->rows; row++) {
+            for (int col = 0; col < grid->cols; col++) {
+                draw_button(grid, col, row);
+            }
+        }
+    } else if (grid->shown_x != grid->selected_x || grid->shown_y != grid->selected_y) {
+        draw_button(grid, grid->shown_x, grid->shown_y);       // Loses the highlight
+        draw_button(grid, grid->selected_x, grid->selected_y); // Gains it
+    }
+    grid->shown_x = grid->selected_x;
+    grid->shown_y = grid->selected_y;
+}
+
+// --- Public Function: kui_textbox_init ---
+void kui_textbox_init(struct kui_textbox* box, int x, int y, int width, int height, uint8_t color) {
+    box->x = x;
+    box->y = y;
+    box->width = width;
+    box->height = height;
+    box->color = color;
+    box->dirty = 1;
+    box->text = "";
+    box->length = 0;
+}
+
+// --- Public Function: kui_textbox_set ---
+// The text is compared when the box is drawn, not here, so setting the same
+// pointer again after its contents changed redraws it correctly.
+void kui_textbox_set(struct kui_textbox* box, const char* text, int length) {
+    int capacity = box->width * box->height;
+    box->text = text;
+    box->length = length < capacity ? length : capacity;
+    box->dirty = 1;
+}
+
+// --- Public Function: kui_textbox_draw ---
+// Line by line; lines past the end of the text are blanked. Lines whose
+// cells already show the right text cost no writes.
+void kui_textbox_draw(struct kui_textbox* box) {
+    if (!box->dirty && !frame_redraw_all) {
+        return;
+    }
+    for (int line = 0; line < box->height; line++) {
+        int offset = line * box->width;
+        int length = box->length - offset;
+        if (length < 0) {
+            length = 0;
+        }
+        put_cells(box->x, box->y + line, box->text + (length ? offset : 0), length, box->width, box->color);
+    }
+    box->dirty = 0;
+}
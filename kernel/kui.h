@@ -0,0 +1,123 @@
+#ifndef KUI_H // Standard header guard to prevent multiple inclusions
+#define KUI_H
+
+#include <stdint.h>  // For uint8_t, uint16_t, uint64_t
+#include "kprint.h"  // VGA_WIDTH, the grid size
+
+// --- Retained-Mode Text UI ---
+// Widgets (labels, button grids, text boxes) keep their state between
+// frames, and a screen is redrawn by drawing its widgets between
+// kui_frame_begin() and kui_frame_end(). Only what changed is drawn:
+//   - a widget whose state did not change since the last frame draws
+//     nothing (a grid whose selection moved draws just the two buttons);
+//   - kui.c remembers every cell it has written, so of the cells a widget
+//     draws, only those that differ from the screen are written, in runs,
+//     with kprint_at (the whole frame is one kprint batch).
+// kui_frame_end() reports the number of cells written, the measure of how
+// much a frame cost.
+//
+// The cell map assumes nothing else draws over the widgets. After the
+// screen was cleared or written by other code, start the next frame with
+// kui_frame_begin(1): every widget is then drawn completely. Widgets must
+// not cover the bottom-right cell (writing it would scroll the screen), and
+// only one thread at a time may draw with kui.
+
+#define KUI_LABEL_SIZE (KPRINT_MAX_COLUMNS + 1) // Longest label text (a full row), plus null
+
+// A single line of text in one color, padded with spaces to its width.
+struct kui_label {
+    int x, y, width;               // Cells owned on the screen
+    uint8_t color;
+    int dirty;                     // Changed since the last frame
+    char text[KUI_LABEL_SIZE];
+};
+
+// Buttons in rows and columns, one of them highlighted. Each button is
+// 'cell_width' cells wide with its label centered; only the label itself
+// takes the highlight color.
+struct kui_grid {
+    int x, y, rows, cols;
+    int cell_width;                // Cells per button
+    int pitch;                     // Cells from one button's start to the next on a row
+    const char* const* labels;     // rows * cols labels, row by row; "" for no button
+    uint8_t color, highlight_color;
+    int selected_x, selected_y;    // Highlighted button
+    int shown_x, shown_y;          // Highlighted button on the screen (-1: nothing drawn yet)
+};
+
+// A block of text wrapped at its width (no word wrapping: a long number
+// simply continues on the next line). The text is not copied.
+struct kui_textbox {
+    int x, y, width, height;
+    uint8_t color;
+    int dirty;
+    const char* text;              // Shown from here ...
+    int length;                    // ... for this many characters (at most width * height)
+};
+
+// Counters since boot (see Benchmarks -> UI).
+struct kui_stats {
+    uint64_t frames;
+    uint64_t cells;                // Cells written by all frames
+    int last_frame_cells;          // Cells written by the latest frame
+};
+
+// --- Function Declarations ---
+
+// kui_frame_begin: Starts a frame.
+// Parameters:
+//   redraw_all: 1 if the screen was drawn over since the last frame: every
+//               widget drawn in this frame is then drawn completely.
+void kui_frame_begin(int redraw_all);
+
+// kui_frame_end: Ends the frame and puts it on the screen in one flush.
+// Returns:
+//   The number of cells written by the frame.
+int kui_frame_end(void);
+
+// kui_get_stats: Copies the counters into *stats.
+void kui_get_stats(struct kui_stats* stats);
+
+// kui_label_init: Sets up an empty label at (x, y), 'width' cells wide.
+void kui_label_init(struct kui_label* label, int x, int y, int width, uint8_t color);
+
+// kui_label_set: Changes the text (cut at the label's width). Setting the
+// text it already has does not make the label dirty.
+void kui_label_set(struct kui_label* label, const char* text);
+
+// kui_label_set_color: Changes the color of the whole label.
+void kui_label_set_color(struct kui_label* label, uint8_t color);
+
+// kui_label_draw: Draws the label if it changed (or in a redraw_all frame).
+void kui_label_draw(struct kui_label* label);
+
+// kui_grid_init: Sets up a grid whose top-left button is at (x, y), with
+// the button at (0, 0) selected.
+// Parameters:
+//   labels: rows * cols strings, row by row; kept, not copied.
+//   cell_width, pitch: Width of a button and distance between button starts.
+void kui_grid_init(struct kui_grid* grid, int x, int y, int rows, int cols, int cell_width, int pitch,
+                   const char* const* labels, uint8_t color, uint8_t highlight_color);
+
+// kui_grid_select: Highlights the button in column 'col' of row 'row'
+// (ignored if that is outside the grid).
+void kui_grid_select(struct kui_grid* grid, int col, int row);
+
+// kui_grid_label: The label of the highlighted button.
+const char* kui_grid_label(const struct kui_grid* grid);
+
+// kui_grid_draw: Draws the whole grid the first time (or in a redraw_all
+// frame), afterwards only the buttons whose highlight changed.
+void kui_grid_draw(struct kui_grid* grid);
+
+// kui_textbox_init: Sets up an empty text box.
+void kui_textbox_init(struct kui_textbox* box, int x, int y, int width, int height, uint8_t color);
+
+// kui_textbox_set: Shows 'length' characters of 'text' (cut to what fits).
+// The text must stay unchanged until it is replaced with another call.
+void kui_textbox_set(struct kui_textbox* box, const char* text, int length);
+
+// kui_textbox_draw: Draws the text box if it changed (or in a redraw_all frame).
+void kui_textbox_draw(struct kui_textbox* box);
+
+#endif // KUI_H
@@ -1,20 +1,6 @@
 #include "kutils.h" // Include the header for our utility functions' declarations
 #include "kprint.h" // For kprint if we want to print debug messages from here (optional)
-
-// --- Function: k_strlen --- (No longer static)
-// Calculates the length of a null-terminated string.
-// Parameters:
-//   s: A pointer to the constant character string.
-// Returns:
-//   The number of characters in the string, excluding the null terminator.
-int k_strlen(const char* s) { // Removed 'static' keyword
-    int len = 0; // Initialize a counter for the length
-    // Loop through the string until the null terminator ('\0') is found
-    while (s[len] != '\0') {
-        len++; // Increment the counter for each character
-    }
-    return len; // Return the total count
-}
+#include "kcpu.h"   // For k_cpuid and k_xgetbv (SIMD feature detection)
 
 // --- Helper Function: k_reverse ---
 // Reverses a null-terminated string in place (modifies the original string).
@@ -140,3 +126,615 @@ char* k_itoa(int value, char* s, int base) {
 
     return s; // Return a pointer to the now correctly formatted string
 }
+
+// --- Table for k_u64toa ---
+// The decimal digits of 0..99, two characters each: the pair for n starts at
+// index 2 * n.
+static const char digit_pairs[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char digit_chars[36] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// 10^0 .. 10^19, for counting decimal digits.
+static const uint64_t powers_of_ten[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+// --- Helper Function: decimal_length ---
+// Number of decimal digits of 'value' without a loop: the bit length times
+// log10(2) (1233/4096) is the digit count or one less, which a single
+// comparison with the matching power of ten settles.
+static inline int decimal_length(uint64_t value) {
+    int bits = 64 - __builtin_clzll(value | 1);
+    int guess = (bits * 1233) >> 12;
+    return guess + 1 - ((value | 1) < powers_of_ten[guess]); // "| 1": zero has one digit too
+}
+
+// --- Function: k_u64toa ---
+int k_u64toa(uint64_t value, char* s, int base) {
+    if (base < 2 || base > 36) {
+        s[0] = '\0';
+        return 0;
+    }
+
+    // Bases 2, 8, 16 (and 4, 32): each digit is a group of 'shift' bits.
+    if ((base & (base - 1)) == 0) {
+        int shift = __builtin_ctz(base);
+        int bits = 64 - __builtin_clzll(value | 1);
+        int length = (bits + shift - 1) / shift;
+        uint64_t mask = (uint64_t)base - 1;
+        s[length] = '\0';
+        for (int i = length - 1; i >= 0; i--) {
+            s[i] = digit_chars[value & mask];
+            value >>= shift;
+        }
+        return length;
+    }
+
+    if (base == 10) {
+        int length = decimal_length(value);
+        char* p = s + length;
+        *p = '\0';
+        // Two digits per step, from the right.
+        while (value >= 100) {
+            const char* pair = &digit_pairs[(value % 100) * 2];
+            value /= 100;
+            *--p = pair[1];
+            *--p = pair[0];
+        }
+        if (value >= 10) {
+            *--p = digit_pairs[value * 2 + 1];
+            *--p = digit_pairs[value * 2];
+        } else {
+            *--p = (char)('0' + value);
+        }
+        return length;
+    }
+
+    // Any other base: count, then fill from the right.
+    int length = 1;
+    for (uint64_t rest = value; rest >= (uint64_t)base; rest /= (uint64_t)base) {
+        length++;
+    }
+    s[length] = '\0';
+    for (int i = length - 1; i >= 0; i--) {
+        s[i] = digit_chars[value % (uint64_t)base];
+        value /= (uint64_t)base;
+    }
+    return length;
+}
+
+// --- Function: k_i64toa ---
+int k_i64toa(int64_t value, char* s, int base) {
+    if (value >= 0) {
+        return k_u64toa((uint64_t)value, s, base);
+    }
+    if (base < 2 || base > 36) {
+        s[0] = '\0';
+        return 0;
+    }
+    s[0] = '-';
+    // Negating in unsigned arithmetic also handles INT64_MIN.
+    return 1 + k_u64toa(0 - (uint64_t)value, s + 1, base);
+}
+
+// --- Helper Function: digit_value ---
+// The value of 'c' as a digit, or 36 (larger than any base) if it is none.
+static inline unsigned digit_value(char c) {
+    if (c >= '0' && c <= '9') return (unsigned)(c - '0');
+    if (c >= 'a' && c <= 'z') return (unsigned)(c - 'a' + 10);
+    if (c >= 'A' && c <= 'Z') return (unsigned)(c - 'A' + 10);
+    return 36;
+}
+
+// --- Helper Function: parse_magnitude ---
+// Parses the digits at 'p' as an unsigned number no larger than 'limit'.
+// The overflow test compares against limit / base and limit % base, which
+// are computed once per call instead of dividing for every digit.
+// On overflow the remaining digits are still consumed and the result is
+// 'limit'.
+static int parse_magnitude(const char* p, const char** after, unsigned base, uint64_t limit, uint64_t* value) {
+    uint64_t cutoff = limit / base;
+    unsigned cutlim = (unsigned)(limit % base);
+    uint64_t result = 0;
+    int overflow = 0;
+    const char* start = p;
+    unsigned digit;
+
+    while ((digit = digit_value(*p)) < base) {
+        if (result > cutoff || (result == cutoff && digit > cutlim)) {
+            overflow = 1;
+        } else {
+            result = result * base + digit;
+        }
+        p++;
+    }
+
+    *after = p;
+    if (p == start) {
+        *value = 0;
+        return K_PARSE_NO_DIGITS;
+    }
+    *value = overflow ? limit : result;
+    return overflow ? K_PARSE_OVERFLOW : K_PARSE_OK;
+}
+
+// --- Helper Function: skip_space ---
+static inline const char* skip_space(const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+        p++;
+    }
+    return p;
+}
+
+// --- Function: k_parse_u64 ---
+int k_parse_u64(const char* str, const char** end, int base, uint64_t* value) {
+    const char* after = str;
+    int status = K_PARSE_NO_DIGITS;
+    *value = 0;
+    if (base >= 2 && base <= 36) {
+        const char* p = skip_space(str);
+        if (*p == '+') {
+            p++;
+        }
+        status = parse_magnitude(p, &after, (unsigned)base, UINT64_MAX, value);
+        if (status == K_PARSE_NO_DIGITS) {
+            after = str;
+        }
+    }
+    if (end) {
+        *end = after;
+    }
+    return status;
+}
+
+// --- Function: k_parse_i64 ---
+// The magnitude may reach 2^63 for negative numbers (INT64_MIN) but only
+// 2^63 - 1 for positive ones.
+int k_parse_i64(const char* str, const char** end, int base, int64_t* value) {
+    const char* after = str;
+    int status = K_PARSE_NO_DIGITS;
+    *value = 0;
+    if (base >= 2 && base <= 36) {
+        const char* p = skip_space(str);
+        int negative = 0;
+        if (*p == '-' || *p == '+') {
+            negative = (*p == '-');
+            p++;
+        }
+        uint64_t magnitude;
+        uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+        status = parse_magnitude(p, &after, (unsigned)base, limit, &magnitude);
+        if (status == K_PARSE_NO_DIGITS) {
+            after = str;
+        } else {
+            *value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+        }
+    }
+    if (end) {
+        *end = after;
+    }
+    return status;
+}
+
+// --- Memory and String Primitives ---
+// Three implementations of each primitive: scalar (8 bytes per store), SSE2
+// (16 bytes) and AVX2 (32 bytes). The kernel is built with -mno-sse, so the
+// vector versions enable the instruction sets per function with the 'target'
+// attribute and use GCC vector types instead of the intrinsics headers
+// (which pull in the hosted C library).
+//
+// K_NO_LIBCALL stops GCC from recognizing the scalar loops as memcpy/memset
+// and replacing them with calls to those functions, which would recurse.
+#define K_NO_LIBCALL __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+typedef uint64_t __attribute__((may_alias, aligned(1))) u64_unaligned;
+typedef long long v2di __attribute__((vector_size(16)));
+typedef long long v2di_u __attribute__((vector_size(16), may_alias, aligned(1)));
+typedef char v16qi __attribute__((vector_size(16)));
+typedef long long v4di __attribute__((vector_size(32)));
+typedef long long v4di_u __attribute__((vector_size(32), may_alias, aligned(1)));
+typedef char v32qi __attribute__((vector_size(32)));
+
+// --- Scalar Implementations ---
+
+K_NO_LIBCALL
+static void* memcpy_scalar(void* dest, const void* src, size_t n) {
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+    while (n >= 8) { // x86 allows unaligned 8-byte accesses
+        *(u64_unaligned*)d = *(const u64_unaligned*)s;
+        d += 8;
+        s += 8;
+        n -= 8;
+    }
+    while (n--) {
+        *d++ = *s++;
+    }
+    return dest;
+}
+
+K_NO_LIBCALL
+static void* memmove_scalar(void* dest, const void* src, size_t n) {
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+    if (d <= s || d >= s + n) {
+        // No overlap, or the destination is below the source: copy forwards.
+        // Every 8-byte block is read before the store that could overwrite it.
+        return memcpy_scalar(dest, src, n);
+    }
+    // Destination overlaps the end of the source: copy backwards.
+    d += n;
+    s += n;
+    while (n >= 8) {
+        d -= 8;
+        s -= 8;
+        n -= 8;
+        *(u64_unaligned*)d = *(const u64_unaligned*)s;
+    }
+    while (n--) {
+        *--d = *--s;
+    }
+    return dest;
+}
+
+// Fills 'n' bytes with the repeating 8-byte 'pattern'. Every store starts at
+// a multiple of 8 bytes from 'dest', so the pattern stays in phase.
+K_NO_LIBCALL
+static void fill_scalar(void* dest, uint64_t pattern, size_t n) {
+    uint8_t* d = (uint8_t*)dest;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        *(u64_unaligned*)(d + i) = pattern;
+    }
+    for (; i < n; i++) {
+        d[i] = (uint8_t)(pattern >> ((i & 7) * 8));
+    }
+}
+
+static size_t strlen_scalar(const char* s) {
+    size_t len = 0; // Initialize a counter for the length
+    // Loop through the string until the null terminator ('\0') is found
+    while (s[len] != '\0') {
+        len++; // Increment the counter for each character
+    }
+    return len; // Return the total count
+}
+
+// --- SSE2 Implementations ---
+
+__attribute__((target("sse2")))
+static void* memcpy_sse2(void* dest, const void* src, size_t n) {
+    if (n < 16) {
+        return memcpy_scalar(dest, src, n);
+    }
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+    // The last 16 bytes are loaded up front and stored last; this overlapping
+    // store covers whatever the 16-byte loop leaves over.
+    v2di tail = *(const v2di_u*)(s + n - 16);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        v2di a = *(const v2di_u*)(s + i);
+        v2di b = *(const v2di_u*)(s + i + 16);
+        v2di c = *(const v2di_u*)(s + i + 32);
+        v2di e = *(const v2di_u*)(s + i + 48);
+        *(v2di_u*)(d + i) = a;
+        *(v2di_u*)(d + i + 16) = b;
+        *(v2di_u*)(d + i + 32) = c;
+        *(v2di_u*)(d + i + 48) = e;
+    }
+    for (; i + 16 <= n; i += 16) {
+        *(v2di_u*)(d + i) = *(const v2di_u*)(s + i);
+    }
+    *(v2di_u*)(d + n - 16) = tail;
+    return dest;
+}
+
+__attribute__((target("sse2")))
+static void* memmove_sse2(void* dest, const void* src, size_t n) {
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+    if (d <= s || d >= s + n) {
+        // Forwards, one block at a time: each load happens before any store
+        // that could overwrite it.
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            *(v2di_u*)(d + i) = *(const v2di_u*)(s + i);
+        }
+        memmove_scalar(d + i, s + i, n - i);
+    } else {
+        // Backwards, mirror image of the loop above.
+        while (n >= 16) {
+            n -= 16;
+            *(v2di_u*)(d + n) = *(const v2di_u*)(s + n);
+        }
+        memmove_scalar(d, s, n);
+    }
+    return dest;
+}
+
+__attribute__((target("sse2")))
+static void fill_sse2(void* dest, uint64_t pattern, size_t n) {
+    if (n < 16) {
+        fill_scalar(dest, pattern, n);
+        return;
+    }
+    uint8_t* d = (uint8_t*)dest;
+    v2di v = { (long long)pattern, (long long)pattern };
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        *(v2di_u*)(d + i) = v;
+        *(v2di_u*)(d + i + 16) = v;
+        *(v2di_u*)(d + i + 32) = v;
+        *(v2di_u*)(d + i + 48) = v;
+    }
+    for (; i + 16 <= n; i += 16) {
+        *(v2di_u*)(d + i) = v;
+    }
+    fill_scalar(d + i, pattern, n - i); // Tail; i is a multiple of 8, so still in phase
+}
+
+// Compares 16 bytes at a time against zero. The first load is rounded down to
+// a 16-byte boundary and never crosses into the next page, so reading a few
+// bytes before the string (or past its end) cannot fault.
+__attribute__((target("sse2")))
+static size_t strlen_sse2(const char* s) {
+    const v16qi zero = { 0 };
+    uintptr_t offset = (uintptr_t)s & 15;
+    const v16qi* p = (const v16qi*)(s - offset);
+    uint32_t mask = (uint32_t)__builtin_ia32_pmovmskb128(*p == zero) >> offset;
+    if (mask) {
+        return __builtin_ctz(mask);
+    }
+    while (1) {
+        p++;
+        mask = (uint32_t)__builtin_ia32_pmovmskb128(*p == zero);
+        if (mask) {
+            return (size_t)((const char*)p - s) + __builtin_ctz(mask);
+        }
+    }
+}
+
+// --- AVX2 Implementations ---
+
+__attribute__((target("avx2")))
+static void* memcpy_avx2(void* dest, const void* src, size_t n) {
+    if (n < 32) {
+        return memcpy_sse2(dest, src, n);
+    }
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+    v4di tail = *(const v4di_u*)(s + n - 32);
+    size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        v4di a = *(const v4di_u*)(s + i);
+        v4di b = *(const v4di_u*)(s + i + 32);
+        v4di c = *(const v4di_u*)(s + i + 64);
+        v4di e = *(const v4di_u*)(s + i + 96);
+        *(v4di_u*)(d + i) = a;
+        *(v4di_u*)(d + i + 32) = b;
+        *(v4di_u*)(d + i + 64) = c;
+        *(v4di_u*)(d + i + 96) = e;
+    }
+    for (; i + 32 <= n; i += 32) {
+        *(v4di_u*)(d + i) = *(const v4di_u*)(s + i);
+    }
+    *(v4di_u*)(d + n - 32) = tail;
+    return dest;
+}
+
+__attribute__((target("avx2")))
+static void* memmove_avx2(void* dest, const void* src, size_t n) {
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+    if (d <= s || d >= s + n) {
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            *(v4di_u*)(d + i) = *(const v4di_u*)(s + i);
+        }
+        memmove_scalar(d + i, s + i, n - i);
+    } else {
+        while (n >= 32) {
+            n -= 32;
+            *(v4di_u*)(d + n) = *(const v4di_u*)(s + n);
+        }
+        memmove_scalar(d, s, n);
+    }
+    return dest;
+}
+
+__attribute__((target("avx2")))
+static void fill_avx2(void* dest, uint64_t pattern, size_t n) {
+    if (n < 32) {
+        fill_sse2(dest, pattern, n);
+        return;
+    }
+    uint8_t* d = (uint8_t*)dest;
+    v4di v = { (long long)pattern, (long long)pattern, (long long)pattern, (long long)pattern };
+    size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        *(v4di_u*)(d + i) = v;
+        *(v4di_u*)(d + i + 32) = v;
+        *(v4di_u*)(d + i + 64) = v;
+        *(v4di_u*)(d + i + 96) = v;
+    }
+    for (; i + 32 <= n; i += 32) {
+        *(v4di_u*)(d + i) = v;
+    }
+    fill_scalar(d + i, pattern, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t strlen_avx2(const char* s) {
+    const v32qi zero = { 0 };
+    uintptr_t offset = (uintptr_t)s & 31;
+    const v32qi* p = (const v32qi*)(s - offset);
+    uint32_t mask = (uint32_t)__builtin_ia32_pmovmskb256(*p == zero) >> offset;
+    if (mask) {
+        return __builtin_ctz(mask);
+    }
+    while (1) {
+        p++;
+        mask = (uint32_t)__builtin_ia32_pmovmskb256(*p == zero);
+        if (mask) {
+            return (size_t)((const char*)p - s) + __builtin_ctz(mask);
+        }
+    }
+}
+
+// --- Dispatch ---
+// Function pointers to the selected implementations. They start out scalar so
+// the primitives work before k_simd_init() runs.
+static void* (*memcpy_impl)(void*, const void*, size_t) = memcpy_scalar;
+static void* (*memmove_impl)(void*, const void*, size_t) = memmove_scalar;
+static void (*fill_impl)(void*, uint64_t, size_t) = fill_scalar;
+static size_t (*strlen_impl)(const char*) = strlen_scalar;
+static int simd_level = K_SIMD_SCALAR;
+static int simd_best_level = K_SIMD_SCALAR;
+
+// --- Function: k_simd_init ---
+// Detects the widest usable SIMD level and selects it.
+// AVX2 needs the CPUID bit (leaf 7, EBX bit 5) and OS support: CR4.OSXSAVE
+// (reported as CPUID.1:ECX bit 27) plus SSE and AVX state enabled in XCR0,
+// which boot.asm does when the CPU has AVX.
+void k_simd_init(void) {
+    uint32_t a, b, c, d;
+    int best = K_SIMD_SCALAR;
+
+    k_cpuid(1, 0, &a, &b, &c, &d);
+    if (d & (1u << 26)) { // SSE2 (always present on x86-64)
+        best = K_SIMD_SSE2;
+    }
+    int os_avx = (c & (1u << 27)) && (c & (1u << 28)) && ((k_xgetbv(0) & 0x6) == 0x6);
+
+    k_cpuid(0, 0, &a, &b, &c, &d);
+    if (os_avx && a >= 7) {
+        k_cpuid(7, 0, &a, &b, &c, &d);
+        if (b & (1u << 5)) { // AVX2
+            best = K_SIMD_AVX2;
+        }
+    }
+
+    simd_best_level = best;
+    k_simd_set_level(best);
+}
+
+// --- Function: k_simd_set_level ---
+int k_simd_set_level(int level) {
+    if (level > simd_best_level) {
+        level = simd_best_level;
+    }
+    if (level >= K_SIMD_AVX2) {
+        memcpy_impl = memcpy_avx2;
+        memmove_impl = memmove_avx2;
+        fill_impl = fill_avx2;
+        strlen_impl = strlen_avx2;
+    } else if (level == K_SIMD_SSE2) {
+        memcpy_impl = memcpy_sse2;
+        memmove_impl = memmove_sse2;
+        fill_impl = fill_sse2;
+        strlen_impl = strlen_sse2;
+    } else {
+        level = K_SIMD_SCALAR;
+        memcpy_impl = memcpy_scalar;
+        memmove_impl = memmove_scalar;
+        fill_impl = fill_scalar;
+        strlen_impl = strlen_scalar;
+    }
+    simd_level = level;
+    return level;
+}
+
+// --- Function: k_simd_level ---
+int k_simd_level(void) {
+    return simd_level;
+}
+
+// --- Function: k_simd_best_level ---
+int k_simd_best_level(void) {
+    return simd_best_level;
+}
+
+// --- Function: k_strlen ---
+// Calculates the length of a null-terminated string.
+// Parameters:
+//   s: A pointer to the constant character string.
+// Returns:
+//   The number of characters in the string, excluding the null terminator.
+int k_strlen(const char* s) {
+    return (int)strlen_impl(s);
+}
+
+// --- Function: k_memcpy ---
+void* k_memcpy(void* dest, const void* src, size_t n) {
+    return memcpy_impl(dest, src, n);
+}
+
+// --- Function: k_memmove ---
+void* k_memmove(void* dest, const void* src, size_t n) {
+    return memmove_impl(dest, src, n);
+}
+
+// --- Function: k_memset ---
+void* k_memset(void* dest, int value, size_t n) {
+    fill_impl(dest, (uint8_t)value * 0x0101010101010101ULL, n);
+    return dest;
+}
+
+// --- Function: k_memset16 ---
+void k_memset16(uint16_t* dest, uint16_t value, size_t count) {
+    fill_impl(dest, value * 0x0001000100010001ULL, count * 2);
+}
+
+// --- Function: k_strcpy ---
+char* k_strcpy(char* dest, const char* src) {
+    k_memcpy(dest, src, (size_t)k_strlen(src) + 1); // +1 copies the terminator
+    return dest;
+}
+
+// --- Function: k_strcat ---
+char* k_strcat(char* dest, const char* src) {
+    k_strcpy(dest + k_strlen(dest), src);
+    return dest;
+}
+
+// --- Compiler Support Functions ---
+// Even with -ffreestanding, GCC may emit calls to memcpy, memmove, memset and
+// memcmp (for example for large struct copies or array initializers), so the
+// kernel has to provide them.
+void* memcpy(void* dest, const void* src, size_t n) {
+    return k_memcpy(dest, src, n);
+}
+
+void* memmove(void* dest, const void* src, size_t n) {
+    return k_memmove(dest, src, n);
+}
+
+void* memset(void* dest, int value, size_t n) {
+    return k_memset(dest, value, n);
+}
+
+K_NO_LIBCALL
+int memcmp(const void* a, const void* b, size_t n) {
+    const uint8_t* p = (const uint8_t*)a;
+    const uint8_t* q = (const uint8_t*)b;
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] != q[i]) {
+            return p[i] - q[i];
+        }
+    }
+    return 0;
+}
@@ -2,10 +2,12 @@
 #define KUTILS_H
 
 #include <stdint.h> // Includes standard integer types like int, uint8_t, etc.
+#include <stddef.h> // For size_t
 
 // --- Function Declarations ---
 
 // k_strlen: Calculates the length of a null-terminated string.
+// Uses the fastest variant selected by k_simd_init() (see below).
 // Parameters:
 //   s: A pointer to the constant character string.
 // Returns:
@@ -18,6 +20,7 @@ int k_strlen(const char* s); // Now declared here to be public
 // Returns:
 //   The integer value represented by the string.
 // Example: "123" -> 123, "-45" -> -45
+// Values outside the int range wrap silently; use k_parse_i64 to detect them.
 int k_atoi(const char* str);
 
 // k_itoa: Converts an integer 'value' to a null-terminated string 's' in a given 'base'.
@@ -33,10 +36,102 @@ int k_atoi(const char* str);
 // Example: k_itoa(10, buffer, 2) -> "1010"
 char* k_itoa(int value, char* s, int base);
 
+// --- 64-bit Conversions ---
+// k_u64toa/k_i64toa count the digits first and then write the string from
+// its end, so nothing is reversed afterwards. Base 10 writes two digits per
+// step from a 200-byte table of "00".."99" (one division by 100, which the
+// compiler turns into a multiply, instead of a '%' and a '/' per digit);
+// bases 2, 8 and 16 use shifts and masks only.
+
+// k_u64toa / k_i64toa: Convert 'value' to a null-terminated string in 'base'
+// (2-36, lowercase letters). k_i64toa writes a '-' for negative values in
+// every base.
+// Parameters:
+//   s: Output buffer; 65 bytes hold any value in base 2 (66 with the sign).
+// Returns:
+//   The length of the string (0, with s empty, for an invalid base).
+int k_u64toa(uint64_t value, char* s, int base);
+int k_i64toa(int64_t value, char* s, int base);
+
+// Results of k_parse_u64 / k_parse_i64.
+#define K_PARSE_OK        0 // The whole number fit
+#define K_PARSE_NO_DIGITS 1 // No digit after the whitespace and sign; value is 0
+#define K_PARSE_OVERFLOW  2 // Too large: value is clamped to the type's limit
+
+// k_parse_u64 / k_parse_i64: Parse an integer in 'base' (2-36, letters in
+// either case) after optional whitespace and sign ('-' only for k_parse_i64).
+// Parsing stops at the first character that is not a digit in 'base'.
+// Parameters:
+//   str: The text to parse.
+//   end: If not 0, receives a pointer to the first character after the
+//        number (or 'str' itself when there are no digits).
+//   base: The numerical base.
+//   value: Receives the result.
+// Returns:
+//   K_PARSE_OK, K_PARSE_NO_DIGITS or K_PARSE_OVERFLOW.
+int k_parse_u64(const char* str, const char** end, int base, uint64_t* value);
+int k_parse_i64(const char* str, const char** end, int base, int64_t* value);
+
 // k_reverse: Reverses a null-terminated string in place.
 // This is a helper function primarily used internally by k_itoa, as k_itoa generates digits in reverse order.
 // Parameters:
 //   s: A pointer to the character array (string) to be reversed.
 void k_reverse(char s[]);
 
+// --- Memory and String Primitives ---
+// k_memcpy, k_memset, k_memset16, k_memmove and k_strlen each have a scalar,
+// an SSE2 and an AVX2 implementation. k_simd_init() checks CPUID once at boot
+// and points them at the best one the CPU (and boot.asm's XCR0 setup) supports.
+// Until then the scalar versions are used, so they are safe to call at any time.
+
+// SIMD levels, in increasing order of width.
+#define K_SIMD_SCALAR 0
+#define K_SIMD_SSE2   1
+#define K_SIMD_AVX2   2
+
+// k_simd_init: Detects SSE2/AVX2 support and selects the implementations.
+void k_simd_init(void);
+
+// k_simd_set_level: Forces a SIMD level (used by benchmarks to compare variants).
+// Parameters:
+//   level: One of K_SIMD_SCALAR, K_SIMD_SSE2, K_SIMD_AVX2.
+// Returns:
+//   The level actually selected, which is capped at what the CPU supports.
+int k_simd_set_level(int level);
+
+// k_simd_level: Returns the currently selected SIMD level.
+int k_simd_level(void);
+
+// k_simd_best_level: Returns the widest SIMD level the CPU supports.
+int k_simd_best_level(void);
+
+// k_memcpy: Copies 'n' bytes from 'src' to 'dest'. The regions must not overlap.
+// Returns:
+//   'dest'.
+void* k_memcpy(void* dest, const void* src, size_t n);
+
+// k_memmove: Copies 'n' bytes from 'src' to 'dest'; the regions may overlap.
+// Returns:
+//   'dest'.
+void* k_memmove(void* dest, const void* src, size_t n);
+
+// k_memset: Fills 'n' bytes at 'dest' with the byte 'value'.
+// Returns:
+//   'dest'.
+void* k_memset(void* dest, int value, size_t n);
+
+// k_memset16: Fills 'count' 16-bit words at 'dest' with 'value'
+// (for example, VGA character cells).
+void k_memset16(uint16_t* dest, uint16_t value, size_t count);
+
+// k_strcpy: Copies the null-terminated string 'src' (including the terminator) to 'dest'.
+// Returns:
+//   'dest'.
+char* k_strcpy(char* dest, const char* src);
+
+// k_strcat: Appends the null-terminated string 'src' to the end of 'dest'.
+// Returns:
+//   'dest'.
+char* k_strcat(char* dest, const char* src);
+
 #endif // KUTILS_H
@@ -0,0 +1,615 @@
+#include <stdint.h>
+#include "kvmm.h"     // Our own declarations
+#include "kpmm.h"     // Frames for page tables and lazily populated pages
+#include "kidt.h"     // Page fault handler registration, kidt_panic
+#include "kcpu.h"     // CR2/CR3, invlpg, CPUID, MSRs
+#include "kspinlock.h" // Page table updates from several CPUs
+#include "kmultiboot.h" // The memory map, to trim the direct map to RAM
+
+// Physical extent of the kernel image (defined in linker.ld). The boot page
+// tables live in its .data and must never be handed to the frame allocator.
+extern char _kernel_start[];
+extern char _kernel_end[];
+
+// --- Page Table Entry Bits ---
+#define PTE_PRESENT   0x001
+#define PTE_WRITE     0x002
+#define PTE_USER      0x004
+#define PTE_PWT       0x008
+#define PTE_PCD       0x010
+#define PTE_PS        0x080 // Large page (in PD and PDPT entries)
+#define PTE_PAT_4K    0x080 // PAT bit of a 4KB page (same position as PS)
+#define PTE_GLOBAL    0x100
+#define PTE_OWNED     0x200 // Software bit: the frame was allocated by the VMM
+#define PTE_PAT_LARGE 0x1000 // PAT bit of a 2MB/1GB page
+#define PTE_NX        (1ULL << 63)
+#define PTE_ADDR_MASK 0x000FFFFFFFFFF000ULL
+
+// Page fault error code bits.
+#define PF_PRESENT 0x1 // Set: protection violation; clear: page not present
+
+#define EFER_MSR 0xC0000080
+#define EFER_NXE (1ULL << 11)
+
+// Up to this many pages, each changed page is flushed with invlpg; bigger
+// operations reload CR3 once at the end instead.
+#define FLUSH_ALL_THRESHOLD 32
+
+#define MAX_LAZY_REGIONS 32
+
+static int has_1g_pages = 0;
+static int has_nx = 0;
+static struct kvmm_stats stats;
+
+// --- Lazy Regions ---
+struct lazy_region {
+    uint64_t start, end; // end == 0: slot unused
+    int flags;
+};
+static struct lazy_region lazy_regions[MAX_LAZY_REGIONS];
+static uint64_t dynamic_next = KVMM_DYNAMIC_BASE; // Address space is handed out once, never reused
+
+// Guards the page tables, the lazy region table and the statistics. Taken
+// with interrupts disabled, since the page fault handler needs it as well.
+// TLB invalidations only reach the CPU making the change; other CPUs must
+// not use a range while it is unmapped or reprotected.
+static struct kspinlock vmm_lock = KSPINLOCK_INIT;
+
+// --- Level Helpers ---
+// Level 1 is a page table (4KB pages), 2 a page directory (2MB), 3 a PDPT
+// (1GB) and 4 the PML4.
+static inline uint64_t level_size(int level) {
+    return 1ULL << (12 + 9 * (level - 1));
+}
+
+static inline int level_index(uint64_t virt, int level) {
+    return (int)((virt >> (12 + 9 * (level - 1))) & 511);
+}
+
+static inline uint64_t* pml4(void) {
+    return (uint64_t*)(k_read_cr3() & PTE_ADDR_MASK);
+}
+
+// Physical address of the page described by a leaf entry. In 2MB/1GB entries
+// bit 12 is the PAT bit, not part of the address.
+static inline uint64_t leaf_phys(uint64_t entry, int level) {
+    return entry & PTE_ADDR_MASK & ~(level_size(level) - 1);
+}
+
+// --- Helper Function: leaf_bits ---
+// Translates KVMM_* flags into the bits of a leaf entry at the given level.
+static uint64_t leaf_bits(int flags, int level) {
+    uint64_t bits = PTE_PRESENT;
+    if (flags & KVMM_WRITE) {
+        bits |= PTE_WRITE;
+    }
+    if (flags & KVMM_USER) {
+        bits |= PTE_USER;
+    }
+    if ((flags & KVMM_NOEXEC) && has_nx) {
+        bits |= PTE_NX; // Bit 63 is reserved (faults) without NX support
+    }
+    // PAT index = PAT*4 + PCD*2 + PWT; see the PAT layout in boot.asm.
+    switch (flags & KVMM_CACHE_MASK) {
+        case KVMM_CACHE_WT: bits |= PTE_PWT; break;
+        case KVMM_CACHE_UC: bits |= PTE_PCD | PTE_PWT; break;
+        case KVMM_CACHE_WC: bits |= (level == 1) ? PTE_PAT_4K : PTE_PAT_LARGE; break;
+    }
+    if (level > 1) {
+        bits |= PTE_PS;
+    }
+    return bits;
+}
+
+// --- Helper Function: zero_page ---
+// Clears a 4KB page with 'rep stosq'. The fault handler may interrupt a
+// k_memcpy that has live XMM/YMM registers, and interrupt entry does not save
+// them, so the dispatched SIMD routines must not be used here.
+static void zero_page(uint64_t virt) {
+    uint64_t count = KVMM_PAGE_4K / 8;
+    __asm__ volatile ("rep stosq" : "+D"(virt), "+c"(count) : "a"(0) : "memory");
+}
+
+// --- Table Allocation ---
+
+static uint64_t alloc_table(void) {
+    uint64_t phys = kpmm_alloc(KPMM_ORDER_4K, KPMM_DIRECT_ONLY);
+    if (phys) {
+        zero_page(phys); // Identity mapped
+        stats.tables++;
+    }
+    return phys;
+}
+
+static int is_boot_table(uint64_t phys) {
+    return phys >= (uint64_t)_kernel_start && phys < (uint64_t)_kernel_end;
+}
+
+// Frees the frame behind a leaf if the VMM allocated it.
+static void release_leaf(uint64_t entry, int level) {
+    if ((entry & PTE_PRESENT) && (entry & PTE_OWNED)) {
+        kpmm_free(leaf_phys(entry, level), level == 1 ? KPMM_ORDER_4K : KPMM_ORDER_2M);
+    }
+}
+
+// Frees a page table, everything below it, and the VMM-owned frames it maps.
+// Used when a large page replaces a range that was mapped more finely.
+static void release_table(uint64_t table_phys, int level) {
+    uint64_t* table = (uint64_t*)table_phys;
+    for (int i = 0; i < 512; i++) {
+        uint64_t entry = table[i];
+        if (!(entry & PTE_PRESENT)) {
+            continue;
+        }
+        if (level > 1 && !(entry & PTE_PS)) {
+            release_table(entry & PTE_ADDR_MASK, level - 1);
+        } else {
+            release_leaf(entry, level);
+        }
+    }
+    if (!is_boot_table(table_phys)) {
+        kpmm_free(table_phys, KPMM_ORDER_4K);
+    }
+}
+
+// --- Helper Function: split_large ---
+// Replaces the 1GB or 2MB page in *entry with a table of 512 pages of the next
+// smaller size that map the same memory with the same attributes.
+// Parameters:
+//   entry: The PDPT (level 3) or PD (level 2) entry holding the large page.
+//   level: 3 or 2.
+//   virt: Virtual address of the start of the large page.
+// Returns:
+//   0 on success, -1 if no frame was available for the new table.
+static int split_large(uint64_t* entry, int level, uint64_t virt) {
+    uint64_t table_phys = alloc_table();
+    if (!table_phys) {
+        return -1;
+    }
+    uint64_t old = *entry;
+    uint64_t base = leaf_phys(old, level);
+    uint64_t attrs = old & (PTE_PRESENT | PTE_WRITE | PTE_USER | PTE_PWT | PTE_PCD | PTE_GLOBAL | PTE_NX);
+    int pat = (old & PTE_PAT_LARGE) != 0;
+    uint64_t child_size = level_size(level - 1);
+
+    uint64_t* table = (uint64_t*)table_phys;
+    for (int i = 0; i < 512; i++) {
+        uint64_t child = (base + i * child_size) | attrs;
+        if (level - 1 == 1) {
+            child |= pat ? PTE_PAT_4K : 0;
+        } else {
+            child |= PTE_PS | (pat ? PTE_PAT_LARGE : 0);
+        }
+        table[i] = child;
+    }
+    // Access rights are checked at every level, so the new table entry is
+    // permissive and the leaves carry the real protection.
+    *entry = table_phys | PTE_PRESENT | PTE_WRITE | (old & PTE_USER);
+    k_invlpg(virt);
+    stats.splits++;
+    return 0;
+}
+
+// --- Helper Function: walk ---
+// Returns a pointer to the entry at 'level' that translates 'virt', allocating
+// missing tables and splitting large pages on the way down.
+// Parameters:
+//   table_bits: Extra bits OR-ed into every table entry passed (PTE_USER for
+//               user mappings, which must be allowed at every level).
+// Returns:
+//   The entry, or 0 if a table could not be allocated.
+static uint64_t* walk(uint64_t virt, int level, uint64_t table_bits) {
+    uint64_t* table = pml4();
+    for (int l = 4; l > level; l--) {
+        uint64_t* entry = &table[level_index(virt, l)];
+        if (!(*entry & PTE_PRESENT)) {
+            uint64_t table_phys = alloc_table();
+            if (!table_phys) {
+                return 0;
+            }
+            *entry = table_phys | PTE_PRESENT | PTE_WRITE;
+        } else if (*entry & PTE_PS) {
+            if (split_large(entry, l, virt & ~(level_size(l) - 1)) < 0) {
+                return 0;
+            }
+        }
+        *entry |= table_bits;
+        table = (uint64_t*)(*entry & PTE_ADDR_MASK);
+    }
+    return &table[level_index(virt, level)];
+}
+
+// --- Helper Function: find_leaf ---
+// Finds the leaf that translates 'virt' for an operation on
+// [virt, virt+remaining). A large page that the range covers only partly is
+// split first, so the caller always gets a leaf that lies entirely inside it.
+// Parameters:
+//   level_out: Receives the level of the returned leaf, or of the missing entry.
+//   error: Set to 1 if a split failed.
+// Returns:
+//   The leaf entry, or 0 if nothing is mapped there; the caller can then skip
+//   level_size(*level_out) bytes of address space.
+static uint64_t* find_leaf(uint64_t virt, uint64_t remaining, uint64_t table_bits,
+                           int* level_out, int* error) {
+    uint64_t* table = pml4();
+    for (int l = 4; ; l--) {
+        uint64_t* entry = &table[level_index(virt, l)];
+        *level_out = l;
+        if (!(*entry & PTE_PRESENT)) {
+            return 0;
+        }
+        if (l == 1) {
+            return entry;
+        }
+        if (*entry & PTE_PS) {
+            uint64_t size = level_size(l);
+            if ((virt & (size - 1)) == 0 && remaining >= size) {
+                return entry;
+            }
+            if (split_large(entry, l, virt & ~(size - 1)) < 0) {
+                *error = 1;
+                return 0;
+            }
+        }
+        *entry |= table_bits;
+        table = (uint64_t*)(*entry & PTE_ADDR_MASK);
+    }
+}
+
+// --- Public Function: kvmm_map ---
+int kvmm_map(uint64_t virt, uint64_t phys, uint64_t size, int flags) {
+    if ((virt | phys | size) & (KVMM_PAGE_4K - 1)) {
+        return -1;
+    }
+    uint64_t end = virt + size;
+    uint64_t table_bits = (flags & KVMM_USER) ? PTE_USER : 0;
+    int flush_each = size / KVMM_PAGE_4K <= FLUSH_ALL_THRESHOLD;
+    int result = 0;
+    int interrupts_were_on = kspin_lock_irqsave(&vmm_lock);
+
+    while (virt < end) {
+        // Largest page size that the alignment of both addresses and the
+        // remaining length allow.
+        uint64_t remaining = end - virt;
+        int level = 1;
+        if (!(flags & KVMM_SMALL_ONLY)) {
+            if (has_1g_pages && ((virt | phys) & (KVMM_PAGE_1G - 1)) == 0 && remaining >= KVMM_PAGE_1G) {
+                level = 3;
+            } else if (((virt | phys) & (KVMM_PAGE_2M - 1)) == 0 && remaining >= KVMM_PAGE_2M) {
+                level = 2;
+            }
+        }
+
+        uint64_t* entry = walk(virt, level, table_bits);
+        if (!entry) {
+            result = -1;
+            break;
+        }
+        uint64_t old = *entry;
+        if (old & PTE_PRESENT) {
+            if (level > 1 && !(old & PTE_PS)) {
+                // A finer mapping is being replaced: the TLB may hold any of
+                // its 4KB entries, so one invlpg is not enough.
+                release_table(old & PTE_ADDR_MASK, level - 1);
+                flush_each = 0;
+            } else {
+                release_leaf(old, level);
+            }
+        }
+        *entry = phys | leaf_bits(flags, level);
+        if (flush_each) {
+            k_invlpg(virt);
+        }
+
+        if (level == 3) {
+            stats.maps_1g++;
+        } else if (level == 2) {
+            stats.maps_2m++;
+        } else {
+            stats.maps_4k++;
+        }
+        virt += level_size(level);
+        phys += level_size(level);
+    }
+
+    if (!flush_each) {
+        k_write_cr3(k_read_cr3());
+    }
+    kspin_unlock_irqrestore(&vmm_lock, interrupts_were_on);
+    return result;
+}
+
+// --- Public Function: kvmm_unmap ---
+// Empty page tables left behind are kept; they are reused by later mappings
+// of the same area.
+int kvmm_unmap(uint64_t virt, uint64_t size) {
+    if ((virt | size) & (KVMM_PAGE_4K - 1)) {
+        return -1;
+    }
+    uint64_t end = virt + size;
+    int flush_each = size / KVMM_PAGE_4K <= FLUSH_ALL_THRESHOLD;
+    int result = 0;
+    int interrupts_were_on = kspin_lock_irqsave(&vmm_lock);
+
+    while (virt < end) {
+        int level, error = 0;
+        uint64_t* entry = find_leaf(virt, end - virt, 0, &level, &error);
+        if (error) {
+            result = -1;
+            break;
+        }
+        if (entry) {
+            release_leaf(*entry, level);
+            *entry = 0;
+            if (flush_each) {
+                k_invlpg(virt);
+            }
+        }
+        uint64_t step = level_size(level);
+        virt = (virt + step) & ~(step - 1);
+    }
+
+    if (!flush_each) {
+        k_write_cr3(k_read_cr3());
+    }
+    kspin_unlock_irqrestore(&vmm_lock, interrupts_were_on);
+    return result;
+}
+
+// --- Public Function: kvmm_protect ---
+int kvmm_protect(uint64_t virt, uint64_t size, int flags) {
+    if ((virt | size) & (KVMM_PAGE_4K - 1)) {
+        return -1;
+    }
+    uint64_t end = virt + size;
+    uint64_t table_bits = (flags & KVMM_USER) ? PTE_USER : 0;
+    int flush_each = size / KVMM_PAGE_4K <= FLUSH_ALL_THRESHOLD;
+    int result = 0;
+    int interrupts_were_on = kspin_lock_irqsave(&vmm_lock);
+
+    while (virt < end) {
+        int level, error = 0;
+        uint64_t* entry = find_leaf(virt, end - virt, table_bits, &level, &error);
+        if (error) {
+            result = -1;
+            break;
+        }
+        if (entry) {
+            uint64_t old = *entry;
+            *entry = leaf_phys(old, level) | (old & PTE_OWNED) | leaf_bits(flags, level);
+            if (flush_each) {
+                k_invlpg(virt);
+            }
+        }
+        uint64_t step = level_size(level);
+        virt = (virt + step) & ~(step - 1);
+    }
+
+    if (!flush_each) {
+        k_write_cr3(k_read_cr3());
+    }
+    kspin_unlock_irqrestore(&vmm_lock, interrupts_were_on);
+    return result;
+}
+
+// --- Public Function: kvmm_translate ---
+int kvmm_translate(uint64_t virt, uint64_t* phys) {
+    uint64_t* table = pml4();
+    for (int l = 4; l >= 1; l--) {
+        uint64_t entry = table[level_index(virt, l)];
+        if (!(entry & PTE_PRESENT)) {
+            return 0;
+        }
+        if (l == 1 || (entry & PTE_PS)) {
+            *phys = leaf_phys(entry, l) + (virt & (level_size(l) - 1));
+            return 1;
+        }
+        table = (uint64_t*)(entry & PTE_ADDR_MASK);
+    }
+    return 0;
+}
+
+// --- Public Function: kvmm_alloc_lazy ---
+// Regions of 2MB or more start on a 2MB boundary so they can also be mapped
+// with large pages.
+void* kvmm_alloc_lazy(uint64_t size, int flags) {
+    size = (size + KVMM_PAGE_4K - 1) & ~(KVMM_PAGE_4K - 1);
+    if (size == 0) {
+        return 0;
+    }
+    int interrupts_were_on = kspin_lock_irqsave(&vmm_lock);
+    uint64_t start = dynamic_next;
+    if (size >= KVMM_PAGE_2M) {
+        start = (start + KVMM_PAGE_2M - 1) & ~(KVMM_PAGE_2M - 1);
+    }
+    void* region = 0;
+    for (int i = 0; i < MAX_LAZY_REGIONS && start + size + KVMM_PAGE_4K <= KVMM_DYNAMIC_END; i++) {
+        if (lazy_regions[i].end == 0) {
+            lazy_regions[i].start = start;
+            lazy_regions[i].end = start + size;
+            lazy_regions[i].flags = flags;
+            dynamic_next = start + size + KVMM_PAGE_4K; // Leave a guard page
+            region = (void*)start;
+            break;
+        }
+    }
+    kspin_unlock_irqrestore(&vmm_lock, interrupts_were_on);
+    return region;
+}
+
+// --- Public Function: kvmm_free_lazy ---
+// The slot is released first and the pages unmapped afterwards, as
+// kvmm_unmap takes the lock itself.
+void kvmm_free_lazy(void* region) {
+    uint64_t start = 0, end = 0;
+    int interrupts_were_on = kspin_lock_irqsave(&vmm_lock);
+    for (int i = 0; i < MAX_LAZY_REGIONS; i++) {
+        if (lazy_regions[i].end != 0 && lazy_regions[i].start == (uint64_t)region) {
+            start = lazy_regions[i].start;
+            end = lazy_regions[i].end;
+            lazy_regions[i].end = 0;
+            break;
+        }
+    }
+    kspin_unlock_irqrestore(&vmm_lock, interrupts_were_on);
+    if (end) {
+        kvmm_unmap(start, end - start);
+    }
+}
+
+// --- Interrupt Handler: page_fault_handler ---
+// Populates a lazy region on first touch: allocates a frame (from any memory,
+// the VMM maps it), clears it and maps it with the region's flags. Every
+// other fault is fatal.
+static void page_fault_handler(struct interrupt_frame* frame) {
+    uint64_t address = k_read_cr2();
+
+    kspin_lock(&vmm_lock); // Interrupts are already off in a handler
+    if (!(frame->error_code & PF_PRESENT)) {
+        for (int i = 0; i < MAX_LAZY_REGIONS; i++) {
+            struct lazy_region* region = &lazy_regions[i];
+            if (region->end == 0 || address < region->start || address >= region->end) {
+                continue;
+            }
+            uint64_t page = address & ~(KVMM_PAGE_4K - 1);
+            uint64_t* entry = walk(page, 1, (region->flags & KVMM_USER) ? PTE_USER : 0);
+            if (!entry) {
+                break;
+            }
+            if (*entry & PTE_PRESENT) {
+                // Another CPU populated the page while this one waited for the lock.
+                kspin_unlock(&vmm_lock);
+                return;
+            }
+            uint64_t phys = kpmm_alloc(KPMM_ORDER_4K, 0);
+            if (!phys) {
+                break;
+            }
+            // Writable while it is cleared, then the region's real flags.
+            *entry = phys | PTE_PRESENT | PTE_WRITE | PTE_OWNED;
+            k_invlpg(page);
+            zero_page(page);
+            *entry = phys | leaf_bits(region->flags, 1) | PTE_OWNED;
+            k_invlpg(page);
+            stats.lazy_faults++;
+            kspin_unlock(&vmm_lock);
+            return;
+        }
+    }
+    kspin_unlock(&vmm_lock);
+    kidt_panic(frame);
+}
+
+// --- Helper Function: is_memory ---
+// Memory map types the direct map is for: RAM the kernel uses, and the ACPI
+// tables and NVS that it reads in place. Everything else is a hole (MMIO,
+// ROM, firmware-reserved) and must not get a write-back mapping.
+static int is_memory(uint32_t type) {
+    return type == MULTIBOOT_MEMORY_AVAILABLE || type == MULTIBOOT_MEMORY_ACPI_RECLAIMABLE ||
+           type == MULTIBOOT_MEMORY_NVS;
+}
+
+// --- Helper Function: memory_in ---
+// How much of [start, end) the memory map reports as memory (is_memory),
+// possibly as several adjacent entries.
+// Returns:
+//   0 for none of it, 1 for part of it, 2 for all of it.
+static int memory_in(const struct multiboot_tag_mmap* mmap, uint64_t start, uint64_t end) {
+    const uint8_t* first = (const uint8_t*)mmap + sizeof(*mmap);
+    const uint8_t* last = (const uint8_t*)mmap + mmap->size;
+    int any = 0;
+    uint64_t covered = start; // Everything below this is known to be memory
+    int advanced = 1;
+    while (covered < end && advanced) {
+        advanced = 0;
+        for (const uint8_t* entry = first; entry < last; entry += mmap->entry_size) {
+            const struct multiboot_mmap_entry* e = (const struct multiboot_mmap_entry*)entry;
+            if (!is_memory(e->type) || e->base_addr >= end || e->base_addr + e->length <= start) {
+                continue;
+            }
+            any = 1;
+            if (e->base_addr <= covered && e->base_addr + e->length > covered) {
+                covered = e->base_addr + e->length;
+                advanced = 1;
+            }
+        }
+    }
+    return covered >= end ? 2 : any;
+}
+
+// --- Helper Function: trim_directory ---
+// Removes the 2MB pages of a page directory that hold no memory. A 2MB
+// page that holds some keeps its mapping: RAM boundaries next to a hole
+// are 2MB-aligned on real machines, and the first 2MB (with the VGA
+// window and the BIOS area) get their memory types from the fixed MTRRs.
+static void trim_directory(const struct multiboot_tag_mmap* mmap, uint64_t* pd, uint64_t base) {
+    for (int i = 0; i < 512; i++) {
+        uint64_t start = base + (uint64_t)i * KVMM_PAGE_2M;
+        if ((pd[i] & PTE_PRESENT) && (pd[i] & PTE_PS) && memory_in(mmap, start, start + KVMM_PAGE_2M) == 0) {
+            pd[i] = 0;
+        }
+    }
+}
+
+// --- Public Function: kvmm_init ---
+void kvmm_init(void) {
+    uint32_t a, b, c, d;
+    k_cpuid(0x80000000, 0, &a, &b, &c, &d);
+    if (a >= 0x80000001) {
+        k_cpuid(0x80000001, 0, &a, &b, &c, &d);
+        has_1g_pages = (d >> 26) & 1; // PDPE1GB
+        has_nx = (d >> 20) & 1;       // NX / XD
+    }
+    if (has_nx) {
+        k_wrmsr(EFER_MSR, k_rdmsr(EFER_MSR) | EFER_NXE);
+    }
+    kidt_register_handler(14, page_fault_handler);
+
+    // boot.asm maps the whole first 512GB with 1GB pages when it can, and
+    // 32GB through its own 2MB-page directories otherwise. Keep only the
+    // gigabytes that hold RAM: a stray pointer past them faults, and MMIO up
+    // there is mapped with the right memory type by its driver.
+    uint64_t* pdpt = (uint64_t*)(pml4()[0] & PTE_ADDR_MASK);
+    uint64_t ram_gigabytes = kpmm_direct_map_end() / KVMM_PAGE_1G;
+    for (uint64_t i = ram_gigabytes; i < 512; i++) {
+        if ((pdpt[i] & PTE_PS) || ((pdpt[i] & PTE_PRESENT) && is_boot_table(pdpt[i] & PTE_ADDR_MASK))) {
+            pdpt[i] = 0;
+        }
+    }
+
+    // Below that, holes such as the PCI/LAPIC window under 4GB would still
+    // be mapped write-back, correct only if the MTRRs happen to override it.
+    // A gigabyte without memory loses its entry; one that is only partly
+    // memory is mapped with 2MB pages, and those over the hole are removed.
+    const struct multiboot_tag_mmap* mmap =
+        (const struct multiboot_tag_mmap*)kmultiboot_find_tag(MULTIBOOT_TAG_TYPE_MMAP);
+    for (uint64_t i = 0; mmap && i < ram_gigabytes; i++) {
+        uint64_t base = i * KVMM_PAGE_1G;
+        if (!(pdpt[i] & PTE_PRESENT)) {
+            continue;
+        }
+        int memory = memory_in(mmap, base, base + KVMM_PAGE_1G);
+        if (memory == 2) {
+            continue;
+        }
+        if (memory == 0 && ((pdpt[i] & PTE_PS) || is_boot_table(pdpt[i] & PTE_ADDR_MASK))) {
+            pdpt[i] = 0;
+            continue;
+        }
+        if ((pdpt[i] & PTE_PS) && split_large(&pdpt[i], 3, base) < 0) {
+            continue; // No frame for the table: keep the gigabyte as it was
+        }
+        trim_directory(mmap, (uint64_t*)(pdpt[i] & PTE_ADDR_MASK), base);
+    }
+    k_write_cr3(k_read_cr3());
+}
+
+// --- Public Function: kvmm_get_stats ---
+void kvmm_get_stats(struct kvmm_stats* out) {
+    *out = stats;
+}
+
+// --- Public Function: kvmm_has_1g_pages ---
+int kvmm_has_1g_pages(void) {
+    return has_1g_pages;
+}
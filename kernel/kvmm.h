@@ -0,0 +1,99 @@
+#ifndef KVMM_H // Standard header guard to prevent multiple inclusions
+#define KVMM_H
+
+#include <stdint.h> // For uint64_t
+
+// --- Virtual Memory Manager ---
+// Edits the live 4-level page tables (the ones CR3 points to, built by
+// boot.asm) at run time. Mappings may use 4KB, 2MB or 1GB pages; kvmm_map picks
+// the largest size the alignment of each piece allows, so big regions cost
+// few TLB entries. A large page that is only partly unmapped or re-protected
+// is split into the next smaller size first.
+// Page tables are allocated from identity-mapped frames, so the VMM can always
+// reach them at their physical address.
+//
+// Lazy regions are reserved with kvmm_alloc_lazy in the dynamic area above
+// 512GB (PML4 slot 1 onwards). Nothing is mapped until an address is touched;
+// the page fault handler then maps a zeroed frame there.
+
+// Start and end of the dynamic virtual area used by kvmm_alloc_lazy.
+#define KVMM_DYNAMIC_BASE 0x0000008000000000ULL // 512GB
+#define KVMM_DYNAMIC_END  0x0000800000000000ULL // End of the lower canonical half
+
+#define KVMM_PAGE_4K 0x1000ULL
+#define KVMM_PAGE_2M 0x200000ULL
+#define KVMM_PAGE_1G 0x40000000ULL
+
+// --- Mapping Flags ---
+#define KVMM_WRITE      0x01 // Writable (otherwise read-only)
+#define KVMM_USER       0x02 // Accessible from ring 3
+#define KVMM_NOEXEC     0x04 // No instruction fetch (ignored if the CPU lacks NX)
+#define KVMM_SMALL_ONLY 0x08 // Use 4KB pages even where large pages would fit
+
+// Memory type, selected through the PAT entries programmed in boot.asm.
+#define KVMM_CACHE_WB   0x00 // Write-back (normal RAM)
+#define KVMM_CACHE_WT   0x10 // Write-through
+#define KVMM_CACHE_UC   0x20 // Uncached (MMIO registers)
+#define KVMM_CACHE_WC   0x30 // Write-combining (framebuffers)
+#define KVMM_CACHE_MASK 0x30
+
+// Counters of VMM activity since boot.
+struct kvmm_stats {
+    uint64_t maps_4k, maps_2m, maps_1g; // Leaf entries written by kvmm_map
+    uint64_t splits;                    // Large pages split into smaller ones
+    uint64_t tables;                    // Page tables allocated
+    uint64_t lazy_faults;               // Pages populated by the fault handler
+};
+
+// --- Function Declarations ---
+
+// kvmm_init: Detects 1GB page and NX support (enabling NX in EFER), installs
+// the page fault handler and trims the boot direct map to the memory in the
+// Multiboot2 memory map: nothing past kpmm_direct_map_end(), and no 1GB or
+// 2MB page over a hole below it. Must run after kidt_init() and kpmm_init().
+void kvmm_init(void);
+
+// kvmm_map: Maps [virt, virt+size) to [phys, phys+size), replacing any
+// existing mappings in that range.
+// Parameters:
+//   virt, phys, size: Must all be multiples of 4KB.
+//   flags: KVMM_WRITE | KVMM_USER | KVMM_NOEXEC | KVMM_SMALL_ONLY | KVMM_CACHE_*.
+// Returns:
+//   0 on success, -1 on bad arguments or if a page table could not be allocated.
+int kvmm_map(uint64_t virt, uint64_t phys, uint64_t size, int flags);
+
+// kvmm_unmap: Removes every mapping in [virt, virt+size). Frames that were
+// allocated by the fault handler are returned to the frame allocator.
+// Returns:
+//   0 on success, -1 on bad arguments or if a large page could not be split.
+int kvmm_unmap(uint64_t virt, uint64_t size);
+
+// kvmm_protect: Changes the flags of the mapped pages in [virt, virt+size);
+// unmapped holes are skipped. The physical addresses stay the same.
+// Returns:
+//   0 on success, -1 on bad arguments or if a large page could not be split.
+int kvmm_protect(uint64_t virt, uint64_t size, int flags);
+
+// kvmm_translate: Looks up the physical address behind a virtual address.
+// Returns:
+//   1 and stores the address in *phys if mapped, 0 otherwise.
+int kvmm_translate(uint64_t virt, uint64_t* phys);
+
+// kvmm_alloc_lazy: Reserves 'size' bytes (rounded up to 4KB) of demand-zero
+// memory in the dynamic area. Each region is followed by an unmapped guard page.
+// Parameters:
+//   flags: Flags for the pages once they are populated.
+// Returns:
+//   The start of the region, or 0 if no region slot or address space is left.
+void* kvmm_alloc_lazy(uint64_t size, int flags);
+
+// kvmm_free_lazy: Unmaps a region from kvmm_alloc_lazy and frees its frames.
+void kvmm_free_lazy(void* region);
+
+// kvmm_get_stats: Copies the activity counters.
+void kvmm_get_stats(struct kvmm_stats* out);
+
+// kvmm_has_1g_pages: 1 if the CPU supports 1GB pages (CPUID PDPE1GB).
+int kvmm_has_1g_pages(void);
+
+#endif // KVMM_H